@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/memory.h"
 #include "common/lang/vector.h"
 #include "sql/expr/aggregate_hash_table.h"
+#include "sql/operator/parallel_executor.h"
 
 class AggregateHashTableBenchmark : public benchmark::Fixture
 {
@@ -67,7 +68,162 @@ BENCHMARK_DEFINE_F(DISABLED_StandardAggregateHashTableBenchmark, Aggregate)(benc
 
 BENCHMARK_REGISTER_F(DISABLED_StandardAggregateHashTableBenchmark, Aggregate)->Arg(16)->Arg(1024)->Arg(8192);
 
-#ifdef USE_SIMD
+/**
+ * @brief 分组数很多的场景，每个分组只出现一次，主要的开销是插入新的分组
+ * @details 分组键是两个 int 列，每轮测试都从空的哈希表开始，参数是分组的总数
+ */
+class StandardAggregateHashTableHighCardinalityBenchmark : public benchmark::Fixture
+{
+public:
+  static constexpr int CHUNK_ROWS = 4096;
+
+  void SetUp(const ::benchmark::State &state) override
+  {
+    group_chunk_.add_column(make_unique<Column>(AttrType::INTS, 4, CHUNK_ROWS), 0);
+    group_chunk_.add_column(make_unique<Column>(AttrType::INTS, 4, CHUNK_ROWS), 1);
+    aggr_chunk_.add_column(make_unique<Column>(AttrType::INTS, 4, CHUNK_ROWS), 0);
+    for (int i = 0; i < CHUNK_ROWS; i++) {
+      int high = i % 7;
+      group_chunk_.column(0).append_one((char *)&i);
+      group_chunk_.column(1).append_one((char *)&high);
+      aggr_chunk_.column(0).append_one((char *)&i);
+    }
+    aggregate_exprs_.push_back(&aggregate_expr_);
+  }
+
+  void TearDown(const ::benchmark::State &state) override
+  {
+    group_chunk_.reset();
+    aggr_chunk_.reset();
+    aggregate_exprs_.clear();
+  }
+
+protected:
+  Chunk                group_chunk_;
+  Chunk                aggr_chunk_;
+  AggregateExpr        aggregate_expr_{AggregateExpr::Type::SUM, nullptr};
+  vector<Expression *> aggregate_exprs_;
+};
+
+BENCHMARK_DEFINE_F(StandardAggregateHashTableHighCardinalityBenchmark, Aggregate)(benchmark::State &state)
+{
+  int *keys = reinterpret_cast<int *>(group_chunk_.column(0).data());
+  for (auto _ : state) {
+    StandardAggregateHashTable hash_table(aggregate_exprs_);
+    for (int64_t base = 0; base < state.range(0); base += CHUNK_ROWS) {
+      for (int i = 0; i < CHUNK_ROWS; i++) {
+        keys[i] = static_cast<int>(base) + i;
+      }
+      hash_table.add_chunk(group_chunk_, aggr_chunk_);
+    }
+    benchmark::DoNotOptimize(hash_table.group_count());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_REGISTER_F(StandardAggregateHashTableHighCardinalityBenchmark, Aggregate)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief 并行哈希聚合的扩展性，参数是线程数
+ * @details 数据总量固定。每个线程把一部分 chunk 聚合到自己的哈希表中，然后按照哈希值分区，每个线程把所有部分结果中
+ * 属于一个分区的分组合并起来。分组数比较多，合并阶段的开销不能忽略
+ */
+class ParallelAggregateHashTableBenchmark : public benchmark::Fixture
+{
+public:
+  static constexpr int CHUNK_ROWS = 4096;
+  static constexpr int CHUNK_NUM  = 256;
+  static constexpr int GROUP_NUM  = 1 << 17;
+
+  void SetUp(const ::benchmark::State &state) override
+  {
+    for (int c = 0; c < CHUNK_NUM; c++) {
+      auto group_chunk = make_unique<Chunk>();
+      auto aggr_chunk  = make_unique<Chunk>();
+      group_chunk->add_column(make_unique<Column>(AttrType::INTS, 4, CHUNK_ROWS), 0);
+      aggr_chunk->add_column(make_unique<Column>(AttrType::INTS, 4, CHUNK_ROWS), 0);
+      for (int i = 0; i < CHUNK_ROWS; i++) {
+        int value = c * CHUNK_ROWS + i;
+        int key   = static_cast<int>((value * 7919LL) % GROUP_NUM);
+        group_chunk->column(0).append_one((char *)&key);
+        aggr_chunk->column(0).append_one((char *)&value);
+      }
+      group_chunks_.push_back(std::move(group_chunk));
+      aggr_chunks_.push_back(std::move(aggr_chunk));
+    }
+    aggregate_exprs_.push_back(&aggregate_expr_);
+  }
+
+  void TearDown(const ::benchmark::State &state) override
+  {
+    group_chunks_.clear();
+    aggr_chunks_.clear();
+    aggregate_exprs_.clear();
+  }
+
+protected:
+  vector<unique_ptr<Chunk>> group_chunks_;
+  vector<unique_ptr<Chunk>> aggr_chunks_;
+  AggregateExpr             aggregate_expr_{AggregateExpr::Type::SUM, nullptr};
+  vector<Expression *>      aggregate_exprs_;
+};
+
+BENCHMARK_DEFINE_F(ParallelAggregateHashTableBenchmark, Aggregate)(benchmark::State &state)
+{
+  const int thread_num = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    vector<unique_ptr<StandardAggregateHashTable>> partials;
+    vector<unique_ptr<StandardAggregateHashTable>> merged;
+    for (int i = 0; i < thread_num; i++) {
+      partials.push_back(make_unique<StandardAggregateHashTable>(aggregate_exprs_));
+      merged.push_back(make_unique<StandardAggregateHashTable>(aggregate_exprs_));
+    }
+
+    RC rc = run_parallel(thread_num, [&](int t) {
+      for (int c = t; c < CHUNK_NUM; c += thread_num) {
+        RC rc = partials[t]->add_chunk(*group_chunks_[c], *aggr_chunks_[c]);
+        if (OB_FAIL(rc)) {
+          return rc;
+        }
+      }
+      return RC::SUCCESS;
+    });
+    if (OB_SUCC(rc)) {
+      rc = run_parallel(thread_num, [&](int partition) {
+        for (auto &partial : partials) {
+          RC rc = merged[partition]->merge(*partial, partition, thread_num);
+          if (OB_FAIL(rc)) {
+            return rc;
+          }
+        }
+        return RC::SUCCESS;
+      });
+    }
+    if (OB_FAIL(rc)) {
+      state.SkipWithError(strrc(rc));
+      break;
+    }
+
+    int groups = 0;
+    for (auto &hash_table : merged) {
+      groups += hash_table->group_count();
+    }
+    benchmark::DoNotOptimize(groups);
+  }
+  state.SetItemsProcessed(state.iterations() * CHUNK_NUM * CHUNK_ROWS);
+}
+
+BENCHMARK_REGISTER_F(ParallelAggregateHashTableBenchmark, Aggregate)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
 class DISABLED_LinearProbingAggregateHashTableBenchmark : public AggregateHashTableBenchmark
 {
 public:
@@ -90,6 +246,5 @@ BENCHMARK_DEFINE_F(DISABLED_LinearProbingAggregateHashTableBenchmark, Aggregate)
 }
 
 BENCHMARK_REGISTER_F(DISABLED_LinearProbingAggregateHashTableBenchmark, Aggregate)->Arg(16)->Arg(1024)->Arg(8192);
-#endif
 
 BENCHMARK_MAIN();
\ No newline at end of file
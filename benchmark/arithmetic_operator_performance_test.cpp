@@ -63,18 +63,23 @@ BENCHMARK_DEFINE_F(DISABLED_ArithmeticBenchmark, Sub)(benchmark::State &state)
 
 BENCHMARK_REGISTER_F(DISABLED_ArithmeticBenchmark, Sub)->Arg(10)->Arg(1000)->Arg(10000);
 
-#ifdef USE_SIMD
+/// range(0) 是 SIMD 级别，超过 CPU 支持的级别时使用支持的最高级别
 static void DISABLED_benchmark_sum_simd(benchmark::State &state)
 {
-  int              size = state.range(0);
-  std::vector<int> data(state.range(0), 1);
+  const SimdKernels &kernels = simd_kernels(static_cast<SimdLevel>(state.range(0)));
+  int                size    = state.range(1);
+  std::vector<int>   data(size, 1);
   for (auto _ : state) {
-    mm256_sum_epi32(data.data(), size);
+    benchmark::DoNotOptimize(kernels.sum_epi32(data.data(), size));
   }
+  state.SetLabel(simd_level_name(kernels.level));
 }
 
-BENCHMARK(DISABLED_benchmark_sum_simd)->RangeMultiplier(2)->Range(1 << 10, 1 << 12);
-#endif
+BENCHMARK(DISABLED_benchmark_sum_simd)
+    ->Args({static_cast<int>(SimdLevel::SCALAR), 1 << 12})
+    ->Args({static_cast<int>(SimdLevel::SSE4_2), 1 << 12})
+    ->Args({static_cast<int>(SimdLevel::AVX2), 1 << 12})
+    ->Args({static_cast<int>(SimdLevel::AVX512), 1 << 12});
 
 static int sum_scalar(const int *data, int size)
 {
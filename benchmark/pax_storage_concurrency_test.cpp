@@ -255,7 +255,7 @@ public:
       Chunk     chunk;
       FieldMeta fm;
       fm.init("col1", AttrType::INTS, 0, 4, true, 0);
-      auto col1 = make_unique<Column>(fm, 2048);
+      auto col1 = make_unique<Column>(fm, Column::DEFAULT_CAPACITY);
       chunk.add_column(std::move(col1), 0);
       while (OB_SUCC(rc = scanner.next_chunk(chunk))) {
         chunk.reset_data();
@@ -437,6 +437,51 @@ BENCHMARK_REGISTER_F(DISABLED_ScanChunkBenchmark, ScanChunk)->Threads(10)->Arg(4
 
 ////////////////////////////////////////////////////////////////////////////////
 
+class DISABLED_SparseScanChunkBenchmark : public BenchmarkBase
+{
+public:
+  string Name() const override { return "sparse_scan_chunk"; }
+
+  void SetUp(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    BenchmarkBase::SetUp(state);
+
+    int32_t max = state.range(0) * 3;
+    ASSERT(max > 0, "invalid argument count. %ld", state.range(0));
+    vector<RID> rids;
+    FillUp(0, max, rids);
+
+    // 只保留 1/4 的记录，让页面中的有效槽位变得稀疏
+    Stat stat;
+    for (size_t i = 0; i < rids.size(); i++) {
+      if (i % 4 != 0) {
+        Delete(rids[i], stat);
+      }
+    }
+  }
+};
+
+BENCHMARK_DEFINE_F(DISABLED_SparseScanChunkBenchmark, SparseScanChunk)(State &state)
+{
+  Stat stat;
+  for (auto _ : state) {
+    ScanChunk(stat);
+  }
+
+  state.counters["success"]               = Counter(stat.scan_success_count, Counter::kIsRate);
+  state.counters["open_failed_count"]     = Counter(stat.scan_open_failed_count, Counter::kIsRate);
+  state.counters["mismatch_number_count"] = Counter(stat.mismatch_count, Counter::kIsRate);
+  state.counters["other"]                 = Counter(stat.scan_other_count, Counter::kIsRate);
+}
+
+BENCHMARK_REGISTER_F(DISABLED_SparseScanChunkBenchmark, SparseScanChunk)->Threads(10)->Arg(4 * 10000);
+
+////////////////////////////////////////////////////////////////////////////////
+
 struct DISABLED_MixtureBenchmark : public BenchmarkBase
 {
   string Name() const override { return "mixture"; }
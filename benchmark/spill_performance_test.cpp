@@ -0,0 +1,179 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <benchmark/benchmark.h>
+
+#include "common/lang/memory.h"
+#include "common/lang/vector.h"
+#include "sql/expr/aggregate_hash_table.h"
+#include "sql/operator/hash_join_vec_physical_operator.h"
+#include "storage/field/field_meta.h"
+
+// 比较内存足够与内存不足(数据量是内存限制的数倍)时 hash join 和 hash 聚合的性能。
+// 参数是内存限制，单位 KB，0 表示不限制。
+
+static constexpr int ROW_NUM = 1 << 20;
+
+/**
+ * @brief 依次输出内存中的 Chunk
+ */
+class ChunkSourceOperator : public PhysicalOperator
+{
+public:
+  explicit ChunkSourceOperator(const vector<unique_ptr<Chunk>> &chunks) : chunks_(chunks) {}
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::TABLE_SCAN_VEC; }
+
+  RC open(Trx *) override
+  {
+    pos_ = 0;
+    return RC::SUCCESS;
+  }
+
+  RC next(Chunk &chunk) override
+  {
+    if (pos_ >= chunks_.size()) {
+      return RC::RECORD_EOF;
+    }
+    return chunk.reference(*chunks_[pos_++]);
+  }
+
+  RC close() override { return RC::SUCCESS; }
+
+private:
+  const vector<unique_ptr<Chunk>> &chunks_;
+  size_t                           pos_ = 0;
+};
+
+/**
+ * @brief 生成两列整数的 Chunk，第一列是 key，第二列是 payload
+ */
+static void make_chunks(vector<unique_ptr<Chunk>> &chunks, int rows, int key_mod)
+{
+  for (int start = 0; start < rows; start += Column::DEFAULT_CAPACITY) {
+    auto chunk = make_unique<Chunk>();
+    chunk->add_column(make_unique<Column>(AttrType::INTS, 4), 0);
+    chunk->add_column(make_unique<Column>(AttrType::INTS, 4), 1);
+    for (int i = start; i < rows && i < start + static_cast<int>(Column::DEFAULT_CAPACITY); i++) {
+      int key = (i * 7919) % key_mod;
+      chunk->column(0).append_one((char *)&key);
+      chunk->column(1).append_one((char *)&i);
+    }
+    chunks.push_back(std::move(chunk));
+  }
+}
+
+class HashJoinSpillBenchmark : public benchmark::Fixture
+{
+public:
+  void SetUp(const ::benchmark::State &state) override
+  {
+    if (build_chunks_.empty()) {
+      make_chunks(build_chunks_, ROW_NUM, ROW_NUM);
+      make_chunks(probe_chunks_, ROW_NUM, ROW_NUM);
+    }
+  }
+
+protected:
+  vector<unique_ptr<Chunk>> build_chunks_;
+  vector<unique_ptr<Chunk>> probe_chunks_;
+  FieldMeta key_meta_{"key", AttrType::INTS, 0, 4, true, 0};
+};
+
+BENCHMARK_DEFINE_F(HashJoinSpillBenchmark, Join)(benchmark::State &state)
+{
+  int64_t output_rows = 0;
+  for (auto _ : state) {
+    vector<unique_ptr<Expression>> left_keys;
+    vector<unique_ptr<Expression>> right_keys;
+    left_keys.push_back(make_unique<FieldExpr>(nullptr, &key_meta_));
+    right_keys.push_back(make_unique<FieldExpr>(nullptr, &key_meta_));
+    HashJoinVecPhysicalOperator join(std::move(left_keys), std::move(right_keys));
+    if (state.range(0) > 0) {
+      join.set_memory_limit(state.range(0) * 1024);
+    }
+    join.add_child(make_unique<ChunkSourceOperator>(probe_chunks_));
+    join.add_child(make_unique<ChunkSourceOperator>(build_chunks_));
+
+    Chunk chunk;
+    join.open(nullptr);
+    while (join.next(chunk) == RC::SUCCESS) {
+      output_rows += chunk.rows();
+    }
+    join.close();
+  }
+  state.SetItemsProcessed(state.iterations() * ROW_NUM * 2);
+  benchmark::DoNotOptimize(output_rows);
+}
+
+// 哈希表大约需要 32MB 内存
+BENCHMARK_REGISTER_F(HashJoinSpillBenchmark, Join)
+    ->Arg(0)
+    ->Arg(8 * 1024)
+    ->Arg(2 * 1024)
+    ->Unit(benchmark::kMillisecond);
+
+class AggregateSpillBenchmark : public benchmark::Fixture
+{
+public:
+  void SetUp(const ::benchmark::State &state) override
+  {
+    if (chunks_.empty()) {
+      make_chunks(chunks_, ROW_NUM, ROW_NUM / 8);
+    }
+  }
+
+protected:
+  vector<unique_ptr<Chunk>> chunks_;
+};
+
+BENCHMARK_DEFINE_F(AggregateSpillBenchmark, Aggregate)(benchmark::State &state)
+{
+  AggregateExpr        aggregate_expr(AggregateExpr::Type::SUM, nullptr);
+  vector<Expression *> aggregate_exprs{&aggregate_expr};
+  int64_t              groups = 0;
+  for (auto _ : state) {
+    const int64_t memory_limit =
+        state.range(0) > 0 ? state.range(0) * 1024 : StandardAggregateHashTable::DEFAULT_MEMORY_LIMIT;
+    StandardAggregateHashTable hash_table(aggregate_exprs, memory_limit);
+    for (const unique_ptr<Chunk> &chunk : chunks_) {
+      Chunk group_chunk;
+      Chunk aggr_chunk;
+      group_chunk.add_column(make_unique<Column>(), 0);
+      aggr_chunk.add_column(make_unique<Column>(), 0);
+      group_chunk.column(0).reference(chunk->column(0));
+      aggr_chunk.column(0).reference(chunk->column(1));
+      hash_table.add_chunk(group_chunk, aggr_chunk);
+    }
+
+    StandardAggregateHashTable::Scanner scanner(&hash_table);
+    scanner.open_scan();
+    while (true) {
+      Chunk output;
+      output.add_column(make_unique<Column>(AttrType::INTS, 4), 0);
+      output.add_column(make_unique<Column>(AttrType::INTS, 4), 1);
+      if (scanner.next(output) != RC::SUCCESS) {
+        break;
+      }
+      groups += output.rows();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * ROW_NUM);
+  benchmark::DoNotOptimize(groups);
+}
+
+// 哈希表大约需要 16MB 内存
+BENCHMARK_REGISTER_F(AggregateSpillBenchmark, Aggregate)
+    ->Arg(0)
+    ->Arg(8 * 1024)
+    ->Arg(2 * 1024)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,207 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// 注意：这个文件没有 #pragma once。
+// simd_util.cpp 为每个指令集定义一个命名空间和其中的 Ops（向量类型和基本操作），然后包含这个文件，
+// 在编译选项相应的区域中生成这个指令集的所有算子和 KERNELS。这里不能包含其它头文件。
+
+/**
+ * @brief 数组求和，每次累加 WIDTH 个数，最后把向量中的值加起来
+ */
+template <typename T>
+static T sum(const T *values, int size)
+{
+  auto acc = Ops::zero(T());
+  int  i   = 0;
+  for (; i + Ops::WIDTH <= size; i += Ops::WIDTH) {
+    acc = Ops::template arithmetic<SimdArithmetic::ADD>(acc, Ops::load(values + i));
+  }
+
+  T result = Ops::reduce_add(acc);
+  for (; i < size; i++) {
+    result += values[i];
+  }
+  return result;
+}
+
+/**
+ * @brief 读取一批数据。常量重复第一个值，没有选择向量时连续读取，否则按照行号 gather
+ */
+template <typename T, bool CONSTANT>
+static inline auto load_rows(const T *data, int offset, const int *sel, typename Ops::IntVec rows)
+{
+  if constexpr (CONSTANT) {
+    return Ops::set1(data[0]);
+  } else {
+    return sel == nullptr ? Ops::load(data + offset) : Ops::gather(data, rows);
+  }
+}
+
+template <typename T, SimdCompare OP, bool LEFT_CONSTANT, bool RIGHT_CONSTANT>
+static int select(const T *left, const T *right, const int *sel, int n, int *result_sel)
+{
+  int count = 0;
+  int i     = 0;
+  for (; i + Ops::WIDTH <= n; i += Ops::WIDTH) {
+    // 先把这一批的行号读出来，输出可能会覆盖 sel 中的数据
+    const auto rows        = sel == nullptr ? Ops::row_ids(i) : Ops::load(sel + i);
+    const auto left_value  = load_rows<T, LEFT_CONSTANT>(left, i, sel, rows);
+    const auto right_value = load_rows<T, RIGHT_CONSTANT>(right, i, sel, rows);
+    count = Ops::append_selected(Ops::template compare<OP>(left_value, right_value), rows, result_sel, count);
+  }
+
+  for (; i < n; i++) {
+    const int row     = sel == nullptr ? i : sel[i];
+    result_sel[count] = row;
+    count += compare_value<OP>(left[LEFT_CONSTANT ? 0 : row], right[RIGHT_CONSTANT ? 0 : row]) ? 1 : 0;
+  }
+  return count;
+}
+
+template <typename T, SimdCompare OP, bool LEFT_CONSTANT, bool RIGHT_CONSTANT>
+static void compare(const T *left, const T *right, int n, uint8_t *result)
+{
+  int i = 0;
+  for (; i + Ops::WIDTH <= n; i += Ops::WIDTH) {
+    const auto left_value  = load_rows<T, LEFT_CONSTANT>(left, i, nullptr, Ops::row_ids(i));
+    const auto right_value = load_rows<T, RIGHT_CONSTANT>(right, i, nullptr, Ops::row_ids(i));
+    const int  mask        = Ops::template compare<OP>(left_value, right_value);
+    for (int j = 0; j < Ops::WIDTH; j++) {
+      result[i + j] &= (mask >> j) & 1;
+    }
+  }
+
+  for (; i < n; i++) {
+    result[i] &= compare_value<OP>(left[LEFT_CONSTANT ? 0 : i], right[RIGHT_CONSTANT ? 0 : i]) ? 1 : 0;
+  }
+}
+
+template <typename T, SimdArithmetic OP, bool LEFT_CONSTANT, bool RIGHT_CONSTANT>
+static void arithmetic(const T *left, const T *right, T *result, int n)
+{
+  int i = 0;
+  // 没有整数除法指令，转换成浮点数计算在数值较大时结果不同，使用标量计算
+  if constexpr (!(std::is_same_v<T, int> && OP == SimdArithmetic::DIV)) {
+    for (; i + Ops::WIDTH <= n; i += Ops::WIDTH) {
+      const auto left_value  = load_rows<T, LEFT_CONSTANT>(left, i, nullptr, Ops::row_ids(i));
+      const auto right_value = load_rows<T, RIGHT_CONSTANT>(right, i, nullptr, Ops::row_ids(i));
+      Ops::store(result + i, Ops::template arithmetic<OP>(left_value, right_value));
+    }
+  }
+
+  for (; i < n; i++) {
+    result[i] = arithmetic_value<OP>(left[LEFT_CONSTANT ? 0 : i], right[RIGHT_CONSTANT ? 0 : i]);
+  }
+}
+
+// 下面的函数把运行时的参数转换成模板参数，与 SimdKernels 中函数指针的类型一致
+
+template <typename T, SimdCompare OP>
+static int select_op(const T *left, bool left_const, const T *right, bool right_const, const int *sel, int n,
+    int *result_sel)
+{
+  if (left_const && right_const) {
+    return select<T, OP, true, true>(left, right, sel, n, result_sel);
+  } else if (left_const) {
+    return select<T, OP, true, false>(left, right, sel, n, result_sel);
+  } else if (right_const) {
+    return select<T, OP, false, true>(left, right, sel, n, result_sel);
+  }
+  return select<T, OP, false, false>(left, right, sel, n, result_sel);
+}
+
+template <typename T>
+static int select_any(SimdCompare op, const T *left, bool left_const, const T *right, bool right_const,
+    const int *sel, int n, int *result_sel)
+{
+  switch (op) {
+    case SimdCompare::EQ: return select_op<T, SimdCompare::EQ>(left, left_const, right, right_const, sel, n, result_sel);
+    case SimdCompare::NE: return select_op<T, SimdCompare::NE>(left, left_const, right, right_const, sel, n, result_sel);
+    case SimdCompare::LT: return select_op<T, SimdCompare::LT>(left, left_const, right, right_const, sel, n, result_sel);
+    case SimdCompare::LE: return select_op<T, SimdCompare::LE>(left, left_const, right, right_const, sel, n, result_sel);
+    case SimdCompare::GT: return select_op<T, SimdCompare::GT>(left, left_const, right, right_const, sel, n, result_sel);
+    case SimdCompare::GE: return select_op<T, SimdCompare::GE>(left, left_const, right, right_const, sel, n, result_sel);
+  }
+  return 0;
+}
+
+template <typename T, SimdCompare OP>
+static void compare_op(const T *left, bool left_const, const T *right, bool right_const, int n, uint8_t *result)
+{
+  if (left_const && right_const) {
+    compare<T, OP, true, true>(left, right, n, result);
+  } else if (left_const) {
+    compare<T, OP, true, false>(left, right, n, result);
+  } else if (right_const) {
+    compare<T, OP, false, true>(left, right, n, result);
+  } else {
+    compare<T, OP, false, false>(left, right, n, result);
+  }
+}
+
+template <typename T>
+static void compare_any(
+    SimdCompare op, const T *left, bool left_const, const T *right, bool right_const, int n, uint8_t *result)
+{
+  switch (op) {
+    case SimdCompare::EQ: compare_op<T, SimdCompare::EQ>(left, left_const, right, right_const, n, result); break;
+    case SimdCompare::NE: compare_op<T, SimdCompare::NE>(left, left_const, right, right_const, n, result); break;
+    case SimdCompare::LT: compare_op<T, SimdCompare::LT>(left, left_const, right, right_const, n, result); break;
+    case SimdCompare::LE: compare_op<T, SimdCompare::LE>(left, left_const, right, right_const, n, result); break;
+    case SimdCompare::GT: compare_op<T, SimdCompare::GT>(left, left_const, right, right_const, n, result); break;
+    case SimdCompare::GE: compare_op<T, SimdCompare::GE>(left, left_const, right, right_const, n, result); break;
+  }
+}
+
+template <typename T, SimdArithmetic OP>
+static void arithmetic_op(const T *left, bool left_const, const T *right, bool right_const, T *result, int n)
+{
+  if (left_const && right_const) {
+    arithmetic<T, OP, true, true>(left, right, result, n);
+  } else if (left_const) {
+    arithmetic<T, OP, true, false>(left, right, result, n);
+  } else if (right_const) {
+    arithmetic<T, OP, false, true>(left, right, result, n);
+  } else {
+    arithmetic<T, OP, false, false>(left, right, result, n);
+  }
+}
+
+template <typename T>
+static void arithmetic_any(
+    SimdArithmetic op, const T *left, bool left_const, const T *right, bool right_const, T *result, int n)
+{
+  switch (op) {
+    case SimdArithmetic::ADD:
+      arithmetic_op<T, SimdArithmetic::ADD>(left, left_const, right, right_const, result, n);
+      break;
+    case SimdArithmetic::SUB:
+      arithmetic_op<T, SimdArithmetic::SUB>(left, left_const, right, right_const, result, n);
+      break;
+    case SimdArithmetic::MUL:
+      arithmetic_op<T, SimdArithmetic::MUL>(left, left_const, right, right_const, result, n);
+      break;
+    case SimdArithmetic::DIV:
+      arithmetic_op<T, SimdArithmetic::DIV>(left, left_const, right, right_const, result, n);
+      break;
+  }
+}
+
+static const SimdKernels KERNELS = {
+    Ops::LEVEL,
+    &sum<int>,
+    &sum<float>,
+    &select_any<int>,
+    &select_any<float>,
+    &compare_any<int>,
+    &compare_any<float>,
+    &arithmetic_any<int>,
+    &arithmetic_any<float>,
+};
@@ -8,50 +8,524 @@ EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
 MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
-#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+
+#include "common/lang/atomic.h"
 #include "common/math/simd_util.h"
 
-#if defined(USE_SIMD)
+// 各个指令集的算子放在编译选项不同的区域中，只有区域中定义的函数可以使用对应的指令。
+// 区域中只能定义 static 函数，也不能包含头文件，避免同一个 inline 函数有多个不同指令集的版本
+#define SIMD_PRAGMA(x) _Pragma(#x)
+#if defined(__clang__)
+#define SIMD_BEGIN_TARGET(isa) SIMD_PRAGMA(clang attribute push(__attribute__((target(isa))), apply_to = function))
+#define SIMD_END_TARGET() SIMD_PRAGMA(clang attribute pop)
+#else
+#define SIMD_BEGIN_TARGET(isa) SIMD_PRAGMA(GCC push_options) SIMD_PRAGMA(GCC target(isa))
+#define SIMD_END_TARGET() SIMD_PRAGMA(GCC pop_options)
+#endif
+
+namespace {
 
-int mm256_extract_epi32_var_indx(const __m256i vec, const unsigned int i)
+template <SimdCompare OP, typename T>
+inline bool compare_value(T left, T right)
 {
-  __m128i idx = _mm_cvtsi32_si128(i);
-  __m256i val = _mm256_permutevar8x32_epi32(vec, _mm256_castsi128_si256(idx));
-  return _mm_cvtsi128_si32(_mm256_castsi256_si128(val));
+  switch (OP) {
+    case SimdCompare::EQ: return left == right;
+    case SimdCompare::NE: return left != right;
+    case SimdCompare::LT: return left < right;
+    case SimdCompare::LE: return left <= right;
+    case SimdCompare::GT: return left > right;
+    case SimdCompare::GE: return left >= right;
+  }
+  return false;
 }
 
-int mm256_sum_epi32(const int *values, int size)
+template <SimdArithmetic OP, typename T>
+inline T arithmetic_value(T left, T right)
 {
-  // your code here
-  int sum = 0;
-  for (int i = 0; i < size; i++) {
-    sum += values[i];
+  switch (OP) {
+    case SimdArithmetic::ADD: return left + right;
+    case SimdArithmetic::SUB: return left - right;
+    case SimdArithmetic::MUL: return left * right;
+    case SimdArithmetic::DIV: return left / right;  // TODO: `right = 0` is invalid
   }
-  return sum;
+  return T();
 }
 
-float mm256_sum_ps(const float *values, int size)
+namespace scalar {
+
+/**
+ * @brief 标量实现，一次处理一个值
+ */
+struct Ops
 {
-  // your code here
-  float sum = 0;
-  for (int i = 0; i < size; i++) {
-    sum += values[i];
+  static constexpr SimdLevel LEVEL = SimdLevel::SCALAR;
+  static constexpr int       WIDTH = 1;
+
+  using IntVec = int;
+
+  static int   zero(int) { return 0; }
+  static float zero(float) { return 0; }
+  static int   set1(int value) { return value; }
+  static float set1(float value) { return value; }
+  static int   load(const int *data) { return *data; }
+  static float load(const float *data) { return *data; }
+  static void  store(int *data, int value) { *data = value; }
+  static void  store(float *data, float value) { *data = value; }
+  static int   row_ids(int start) { return start; }
+  static int   gather(const int *data, int row) { return data[row]; }
+  static float gather(const float *data, int row) { return data[row]; }
+  static int   reduce_add(int value) { return value; }
+  static float reduce_add(float value) { return value; }
+
+  template <SimdCompare OP, typename T>
+  static int compare(T left, T right)
+  {
+    return compare_value<OP>(left, right) ? 1 : 0;
+  }
+
+  template <SimdArithmetic OP, typename T>
+  static T arithmetic(T left, T right)
+  {
+    return arithmetic_value<OP>(left, right);
+  }
+
+  static int append_selected(int mask, int row, int *result_sel, int count)
+  {
+    result_sel[count] = row;
+    return count + mask;
   }
-  return sum;
+};
+
+#include "common/math/simd_kernel_impl.h"
+
+}  // namespace scalar
+
+#if defined(SIMD_X86)
+
+/**
+ * @brief 把比较结果的掩码中为 1 的位对应的行号追加到 result_sel 中
+ * @details 不使用分支，每一行都写入 result_sel，但只有满足条件的行才会增加 count
+ */
+template <int WIDTH>
+inline int append_rows(int mask, const int *rows, int *result_sel, int count)
+{
+  for (int j = 0; j < WIDTH; j++) {
+    result_sel[count] = rows[j];
+    count += (mask >> j) & 1;
+  }
+  return count;
 }
 
-template <typename V>
-void selective_load(V *memory, int offset, V *vec, __m256i &inv)
+SIMD_BEGIN_TARGET("sse4.2")
+namespace sse4_2 {
+
+struct Ops
+{
+  static constexpr SimdLevel LEVEL = SimdLevel::SSE4_2;
+  static constexpr int       WIDTH = 4;
+
+  using IntVec = __m128i;
+
+  static __m128i zero(int) { return _mm_setzero_si128(); }
+  static __m128  zero(float) { return _mm_setzero_ps(); }
+  static __m128i set1(int value) { return _mm_set1_epi32(value); }
+  static __m128  set1(float value) { return _mm_set1_ps(value); }
+  static __m128i load(const int *data) { return _mm_loadu_si128((const __m128i *)data); }
+  static __m128  load(const float *data) { return _mm_loadu_ps(data); }
+  static void    store(int *data, __m128i value) { _mm_storeu_si128((__m128i *)data, value); }
+  static void    store(float *data, __m128 value) { _mm_storeu_ps(data, value); }
+  static __m128i row_ids(int start) { return _mm_add_epi32(_mm_set1_epi32(start), _mm_setr_epi32(0, 1, 2, 3)); }
+
+  // SSE 没有 gather 指令
+  static __m128i gather(const int *data, __m128i rows)
+  {
+    alignas(16) int row[WIDTH];
+    store(row, rows);
+    return _mm_setr_epi32(data[row[0]], data[row[1]], data[row[2]], data[row[3]]);
+  }
+  static __m128 gather(const float *data, __m128i rows)
+  {
+    alignas(16) int row[WIDTH];
+    store(row, rows);
+    return _mm_setr_ps(data[row[0]], data[row[1]], data[row[2]], data[row[3]]);
+  }
+
+  static int reduce_add(__m128i value)
+  {
+    alignas(16) int lanes[WIDTH];
+    store(lanes, value);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  }
+  static float reduce_add(__m128 value)
+  {
+    alignas(16) float lanes[WIDTH];
+    store(lanes, value);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  }
+
+  template <SimdCompare OP>
+  static int compare(__m128i left, __m128i right)
+  {
+    constexpr int ALL = (1 << WIDTH) - 1;
+    switch (OP) {
+      case SimdCompare::EQ: return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(left, right)));
+      case SimdCompare::NE: return ALL ^ _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(left, right)));
+      case SimdCompare::LT: return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(left, right)));
+      case SimdCompare::LE: return ALL ^ _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(left, right)));
+      case SimdCompare::GT: return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(left, right)));
+      case SimdCompare::GE: return ALL ^ _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(left, right)));
+    }
+    return 0;
+  }
+
+  template <SimdCompare OP>
+  static int compare(__m128 left, __m128 right)
+  {
+    switch (OP) {
+      case SimdCompare::EQ: return _mm_movemask_ps(_mm_cmpeq_ps(left, right));
+      case SimdCompare::NE: return _mm_movemask_ps(_mm_cmpneq_ps(left, right));
+      case SimdCompare::LT: return _mm_movemask_ps(_mm_cmplt_ps(left, right));
+      case SimdCompare::LE: return _mm_movemask_ps(_mm_cmple_ps(left, right));
+      case SimdCompare::GT: return _mm_movemask_ps(_mm_cmpgt_ps(left, right));
+      case SimdCompare::GE: return _mm_movemask_ps(_mm_cmpge_ps(left, right));
+    }
+    return 0;
+  }
+
+  template <SimdArithmetic OP>
+  static __m128i arithmetic(__m128i left, __m128i right)
+  {
+    switch (OP) {
+      case SimdArithmetic::ADD: return _mm_add_epi32(left, right);
+      case SimdArithmetic::SUB: return _mm_sub_epi32(left, right);
+      default: return _mm_mullo_epi32(left, right);
+    }
+  }
+
+  template <SimdArithmetic OP>
+  static __m128 arithmetic(__m128 left, __m128 right)
+  {
+    switch (OP) {
+      case SimdArithmetic::ADD: return _mm_add_ps(left, right);
+      case SimdArithmetic::SUB: return _mm_sub_ps(left, right);
+      case SimdArithmetic::MUL: return _mm_mul_ps(left, right);
+      case SimdArithmetic::DIV: return _mm_div_ps(left, right);
+    }
+    return left;
+  }
+
+  static int append_selected(int mask, __m128i rows, int *result_sel, int count)
+  {
+    alignas(16) int row[WIDTH];
+    store(row, rows);
+    return append_rows<WIDTH>(mask, row, result_sel, count);
+  }
+};
+
+#include "common/math/simd_kernel_impl.h"
+
+}  // namespace sse4_2
+SIMD_END_TARGET()
+
+SIMD_BEGIN_TARGET("avx2")
+namespace avx2 {
+
+struct Ops
 {
-  int *inv_ptr = reinterpret_cast<int *>(&inv);
-  for (int i = 0; i < SIMD_WIDTH; i++) {
-    if (inv_ptr[i] == -1) {
-      vec[i] = memory[offset++];
+  static constexpr SimdLevel LEVEL = SimdLevel::AVX2;
+  static constexpr int       WIDTH = 8;
+
+  using IntVec = __m256i;
+
+  static __m256i zero(int) { return _mm256_setzero_si256(); }
+  static __m256  zero(float) { return _mm256_setzero_ps(); }
+  static __m256i set1(int value) { return _mm256_set1_epi32(value); }
+  static __m256  set1(float value) { return _mm256_set1_ps(value); }
+  static __m256i load(const int *data) { return _mm256_loadu_si256((const __m256i *)data); }
+  static __m256  load(const float *data) { return _mm256_loadu_ps(data); }
+  static void    store(int *data, __m256i value) { _mm256_storeu_si256((__m256i *)data, value); }
+  static void    store(float *data, __m256 value) { _mm256_storeu_ps(data, value); }
+  static __m256i row_ids(int start)
+  {
+    return _mm256_add_epi32(_mm256_set1_epi32(start), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  }
+  static __m256i gather(const int *data, __m256i rows) { return _mm256_i32gather_epi32(data, rows, sizeof(int)); }
+  static __m256  gather(const float *data, __m256i rows) { return _mm256_i32gather_ps(data, rows, sizeof(float)); }
+
+  static int reduce_add(__m256i value)
+  {
+    alignas(32) int lanes[WIDTH];
+    store(lanes, value);
+    int result = 0;
+    for (int lane : lanes) {
+      result += lane;
+    }
+    return result;
+  }
+  static float reduce_add(__m256 value)
+  {
+    alignas(32) float lanes[WIDTH];
+    store(lanes, value);
+    float result = 0;
+    for (float lane : lanes) {
+      result += lane;
+    }
+    return result;
+  }
+
+  static int movemask(__m256i value) { return _mm256_movemask_ps(_mm256_castsi256_ps(value)); }
+
+  template <SimdCompare OP>
+  static int compare(__m256i left, __m256i right)
+  {
+    constexpr int ALL = (1 << WIDTH) - 1;
+    switch (OP) {
+      case SimdCompare::EQ: return movemask(_mm256_cmpeq_epi32(left, right));
+      case SimdCompare::NE: return ALL ^ movemask(_mm256_cmpeq_epi32(left, right));
+      case SimdCompare::LT: return movemask(_mm256_cmpgt_epi32(right, left));
+      case SimdCompare::LE: return ALL ^ movemask(_mm256_cmpgt_epi32(left, right));
+      case SimdCompare::GT: return movemask(_mm256_cmpgt_epi32(left, right));
+      case SimdCompare::GE: return ALL ^ movemask(_mm256_cmpgt_epi32(right, left));
     }
+    return 0;
   }
+
+  // 与标量的比较结果一致：NaN 与任何值都不相等
+  template <SimdCompare OP>
+  static int compare(__m256 left, __m256 right)
+  {
+    switch (OP) {
+      case SimdCompare::EQ: return _mm256_movemask_ps(_mm256_cmp_ps(left, right, _CMP_EQ_OQ));
+      case SimdCompare::NE: return _mm256_movemask_ps(_mm256_cmp_ps(left, right, _CMP_NEQ_UQ));
+      case SimdCompare::LT: return _mm256_movemask_ps(_mm256_cmp_ps(left, right, _CMP_LT_OQ));
+      case SimdCompare::LE: return _mm256_movemask_ps(_mm256_cmp_ps(left, right, _CMP_LE_OQ));
+      case SimdCompare::GT: return _mm256_movemask_ps(_mm256_cmp_ps(left, right, _CMP_GT_OQ));
+      case SimdCompare::GE: return _mm256_movemask_ps(_mm256_cmp_ps(left, right, _CMP_GE_OQ));
+    }
+    return 0;
+  }
+
+  template <SimdArithmetic OP>
+  static __m256i arithmetic(__m256i left, __m256i right)
+  {
+    switch (OP) {
+      case SimdArithmetic::ADD: return _mm256_add_epi32(left, right);
+      case SimdArithmetic::SUB: return _mm256_sub_epi32(left, right);
+      default: return _mm256_mullo_epi32(left, right);
+    }
+  }
+
+  template <SimdArithmetic OP>
+  static __m256 arithmetic(__m256 left, __m256 right)
+  {
+    switch (OP) {
+      case SimdArithmetic::ADD: return _mm256_add_ps(left, right);
+      case SimdArithmetic::SUB: return _mm256_sub_ps(left, right);
+      case SimdArithmetic::MUL: return _mm256_mul_ps(left, right);
+      case SimdArithmetic::DIV: return _mm256_div_ps(left, right);
+    }
+    return left;
+  }
+
+  static int append_selected(int mask, __m256i rows, int *result_sel, int count)
+  {
+    alignas(32) int row[WIDTH];
+    store(row, rows);
+    return append_rows<WIDTH>(mask, row, result_sel, count);
+  }
+};
+
+#include "common/math/simd_kernel_impl.h"
+
+}  // namespace avx2
+SIMD_END_TARGET()
+
+SIMD_BEGIN_TARGET("avx512f")
+namespace avx512 {
+
+struct Ops
+{
+  static constexpr SimdLevel LEVEL = SimdLevel::AVX512;
+  static constexpr int       WIDTH = 16;
+
+  using IntVec = __m512i;
+
+  static __m512i zero(int) { return _mm512_setzero_si512(); }
+  static __m512  zero(float) { return _mm512_setzero_ps(); }
+  static __m512i set1(int value) { return _mm512_set1_epi32(value); }
+  static __m512  set1(float value) { return _mm512_set1_ps(value); }
+  static __m512i load(const int *data) { return _mm512_loadu_si512(data); }
+  static __m512  load(const float *data) { return _mm512_loadu_ps(data); }
+  static void    store(int *data, __m512i value) { _mm512_storeu_si512(data, value); }
+  static void    store(float *data, __m512 value) { _mm512_storeu_ps(data, value); }
+  static __m512i row_ids(int start)
+  {
+    return _mm512_add_epi32(
+        _mm512_set1_epi32(start), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+  }
+  static __m512i gather(const int *data, __m512i rows) { return _mm512_i32gather_epi32(rows, data, sizeof(int)); }
+  static __m512  gather(const float *data, __m512i rows) { return _mm512_i32gather_ps(rows, data, sizeof(float)); }
+  static int     reduce_add(__m512i value) { return _mm512_reduce_add_epi32(value); }
+  static float   reduce_add(__m512 value) { return _mm512_reduce_add_ps(value); }
+
+  // AVX-512 的比较结果直接是掩码
+  template <SimdCompare OP>
+  static int compare(__m512i left, __m512i right)
+  {
+    switch (OP) {
+      case SimdCompare::EQ: return _mm512_cmp_epi32_mask(left, right, _MM_CMPINT_EQ);
+      case SimdCompare::NE: return _mm512_cmp_epi32_mask(left, right, _MM_CMPINT_NE);
+      case SimdCompare::LT: return _mm512_cmp_epi32_mask(left, right, _MM_CMPINT_LT);
+      case SimdCompare::LE: return _mm512_cmp_epi32_mask(left, right, _MM_CMPINT_LE);
+      case SimdCompare::GT: return _mm512_cmp_epi32_mask(left, right, _MM_CMPINT_NLE);
+      case SimdCompare::GE: return _mm512_cmp_epi32_mask(left, right, _MM_CMPINT_NLT);
+    }
+    return 0;
+  }
+
+  template <SimdCompare OP>
+  static int compare(__m512 left, __m512 right)
+  {
+    switch (OP) {
+      case SimdCompare::EQ: return _mm512_cmp_ps_mask(left, right, _CMP_EQ_OQ);
+      case SimdCompare::NE: return _mm512_cmp_ps_mask(left, right, _CMP_NEQ_UQ);
+      case SimdCompare::LT: return _mm512_cmp_ps_mask(left, right, _CMP_LT_OQ);
+      case SimdCompare::LE: return _mm512_cmp_ps_mask(left, right, _CMP_LE_OQ);
+      case SimdCompare::GT: return _mm512_cmp_ps_mask(left, right, _CMP_GT_OQ);
+      case SimdCompare::GE: return _mm512_cmp_ps_mask(left, right, _CMP_GE_OQ);
+    }
+    return 0;
+  }
+
+  template <SimdArithmetic OP>
+  static __m512i arithmetic(__m512i left, __m512i right)
+  {
+    switch (OP) {
+      case SimdArithmetic::ADD: return _mm512_add_epi32(left, right);
+      case SimdArithmetic::SUB: return _mm512_sub_epi32(left, right);
+      default: return _mm512_mullo_epi32(left, right);
+    }
+  }
+
+  template <SimdArithmetic OP>
+  static __m512 arithmetic(__m512 left, __m512 right)
+  {
+    switch (OP) {
+      case SimdArithmetic::ADD: return _mm512_add_ps(left, right);
+      case SimdArithmetic::SUB: return _mm512_sub_ps(left, right);
+      case SimdArithmetic::MUL: return _mm512_mul_ps(left, right);
+      case SimdArithmetic::DIV: return _mm512_div_ps(left, right);
+    }
+    return left;
+  }
+
+  // compress store 只写入满足条件的行号
+  static int append_selected(int mask, __m512i rows, int *result_sel, int count)
+  {
+    _mm512_mask_compressstoreu_epi32(result_sel + count, static_cast<__mmask16>(mask), rows);
+    return count + __builtin_popcount(mask);
+  }
+};
+
+#include "common/math/simd_kernel_impl.h"
+
+}  // namespace avx512
+SIMD_END_TARGET()
+
+#endif  // SIMD_X86
+
+/**
+ * @brief 启动时使用的级别：CPU 支持的最高级别，可以用环境变量 MINIOB_SIMD_LEVEL 降低
+ */
+SimdLevel initial_simd_level()
+{
+  SimdLevel   level = detect_simd_level();
+  const char *name  = getenv("MINIOB_SIMD_LEVEL");
+  SimdLevel   limit;
+  if (name != nullptr && parse_simd_level(name, limit) && limit < level) {
+    level = limit;
+  }
+  return level;
+}
+
+atomic<const SimdKernels *> &current_kernels()
+{
+  static atomic<const SimdKernels *> kernels(&simd_kernels(initial_simd_level()));
+  return kernels;
+}
+
+}  // namespace
+
+SimdLevel detect_simd_level()
+{
+#if defined(SIMD_X86)
+  static const SimdLevel level = []() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+      return SimdLevel::SSE4_2;
+    }
+    return SimdLevel::SCALAR;
+  }();
+  return level;
+#else
+  return SimdLevel::SCALAR;
+#endif
+}
+
+SimdLevel simd_level() { return simd_kernels().level; }
+
+SimdLevel set_simd_level(SimdLevel level)
+{
+  const SimdKernels &kernels = simd_kernels(level);
+  current_kernels().store(&kernels);
+  return kernels.level;
 }
-template void selective_load<uint32_t>(uint32_t *memory, int offset, uint32_t *vec, __m256i &inv);
-template void selective_load<int>(int *memory, int offset, int *vec, __m256i &inv);
-template void selective_load<float>(float *memory, int offset, float *vec, __m256i &inv);
 
-#endif
\ No newline at end of file
+const char *simd_level_name(SimdLevel level)
+{
+  switch (level) {
+    case SimdLevel::SCALAR: return "scalar";
+    case SimdLevel::SSE4_2: return "sse4.2";
+    case SimdLevel::AVX2: return "avx2";
+    case SimdLevel::AVX512: return "avx512";
+  }
+  return "unknown";
+}
+
+bool parse_simd_level(const char *name, SimdLevel &level)
+{
+  for (SimdLevel candidate : {SimdLevel::SCALAR, SimdLevel::SSE4_2, SimdLevel::AVX2, SimdLevel::AVX512}) {
+    if (strcasecmp(name, simd_level_name(candidate)) == 0) {
+      level = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+const SimdKernels &simd_kernels() { return *current_kernels().load(); }
+
+const SimdKernels &simd_kernels(SimdLevel level)
+{
+  if (level > detect_simd_level()) {
+    level = detect_simd_level();
+  }
+
+  switch (level) {
+#if defined(SIMD_X86)
+    case SimdLevel::SSE4_2: return sse4_2::KERNELS;
+    case SimdLevel::AVX2: return avx2::KERNELS;
+    case SimdLevel::AVX512: return avx512::KERNELS;
+#endif
+    default: return scalar::KERNELS;
+  }
+}
@@ -10,19 +10,131 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
-#if defined(USE_SIMD)
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
 #include <immintrin.h>
 
-static constexpr int SIMD_WIDTH = 8;  // AVX2 (256bit)
+/// 只对一个函数启用指令集，整个程序仍然按照最基础的指令集编译
+#define SIMD_TARGET_SSE4_2 __attribute__((target("sse4.2")))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#define SIMD_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+/**
+ * @brief SIMD 指令集的级别，高级别包含低级别的指令
+ * @details SIMD 算子为每个级别各编译一个版本，启动时根据 cpuid 选择 CPU 支持的最高级别，同一个程序可以运行在不同的机器上。
+ * 可以用环境变量 MINIOB_SIMD_LEVEL(scalar/sse4.2/avx2/avx512) 限制使用的级别，比如排查问题或者对比性能。
+ */
+enum class SimdLevel
+{
+  SCALAR = 0,
+  SSE4_2,
+  AVX2,
+  AVX512,
+};
+
+/// CPU 支持的最高级别
+SimdLevel detect_simd_level();
+
+/// 当前使用的级别
+SimdLevel simd_level();
+
+/**
+ * @brief 修改使用的级别，主要用于测试
+ * @return 实际使用的级别，不会超过 CPU 支持的最高级别
+ */
+SimdLevel set_simd_level(SimdLevel level);
+
+const char *simd_level_name(SimdLevel level);
+
+/**
+ * @brief 解析级别的名字，与 simd_level_name 对应
+ * @return 名字不合法时返回 false
+ */
+bool parse_simd_level(const char *name, SimdLevel &level);
+
+/// 比较运算
+enum class SimdCompare
+{
+  EQ,
+  NE,
+  LT,
+  LE,
+  GT,
+  GE,
+};
+
+/// 算术运算
+enum class SimdArithmetic
+{
+  ADD,
+  SUB,
+  MUL,
+  DIV,
+};
+
+/**
+ * @brief 一个级别的所有 SIMD 算子
+ * @details 参数中的 left_const/right_const 表示对应的数组是常量，只有一个值。
+ * 整数除法不使用 SIMD 指令，保证与标量计算的结果完全相同。
+ */
+struct SimdKernels
+{
+  SimdLevel level;
+
+  /// 数组求和
+  int   (*sum_epi32)(const int *values, int size);
+  float (*sum_ps)(const float *values, int size);
+
+  /**
+   * @brief 比较两列数据，把满足条件的行号按顺序写到 result_sel 中
+   * @param sel 需要比较的行号，为 nullptr 时比较 [0, n) 中的所有行
+   * @param result_sel 可以与 sel 是同一个数组
+   * @return 满足条件的行数
+   */
+  int (*select_epi32)(SimdCompare op, const int *left, bool left_const, const int *right, bool right_const,
+      const int *sel, int n, int *result_sel);
+  int (*select_ps)(SimdCompare op, const float *left, bool left_const, const float *right, bool right_const,
+      const int *sel, int n, int *result_sel);
+
+  /// result[i] &= (left[i] op right[i])
+  void (*compare_epi32)(
+      SimdCompare op, const int *left, bool left_const, const int *right, bool right_const, int n, uint8_t *result);
+  void (*compare_ps)(SimdCompare op, const float *left, bool left_const, const float *right, bool right_const, int n,
+      uint8_t *result);
+
+  /// result[i] = left[i] op right[i]
+  void (*arithmetic_epi32)(
+      SimdArithmetic op, const int *left, bool left_const, const int *right, bool right_const, int *result, int n);
+  void (*arithmetic_ps)(SimdArithmetic op, const float *left, bool left_const, const float *right, bool right_const,
+      float *result, int n);
+};
+
+/// 当前级别的 SIMD 算子
+const SimdKernels &simd_kernels();
 
-/// @brief 从 vec 中提取下标为 i 的 int 类型的值。
-int mm256_extract_epi32_var_indx(const __m256i vec, const unsigned int i);
+/// 指定级别的 SIMD 算子，超过 CPU 支持的级别时返回支持的最高级别
+const SimdKernels &simd_kernels(SimdLevel level);
 
-/// @brief 数组求和
-int   mm256_sum_epi32(const int *values, int size);
-float mm256_sum_ps(const float *values, int size);
+/// 数组求和，使用当前级别的算子
+inline int   simd_sum_epi32(const int *values, int size) { return simd_kernels().sum_epi32(values, size); }
+inline float simd_sum_ps(const float *values, int size) { return simd_kernels().sum_ps(values, size); }
 
-/// @brief selective load 的标量实现
+/**
+ * @brief selective load 的标量实现
+ * @details 把 memory[offset] 开始的数据依次读到 vec 中 inv[i] != 0 的位置，AVX-512 可以直接使用 expandload 指令
+ * @return 读取的个数
+ */
 template <typename V>
-void selective_load(V *memory, int offset, V *vec, __m256i &inv);
-#endif
\ No newline at end of file
+inline int selective_load(const V *memory, int offset, V *vec, const int *inv, int width)
+{
+  int count = 0;
+  for (int i = 0; i < width; i++) {
+    if (inv[i] != 0) {
+      vec[i] = memory[offset + count++];
+    }
+  }
+  return count;
+}
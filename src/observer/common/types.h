@@ -64,13 +64,15 @@ enum class StorageEngine
 
 /**
  * @brief 执行引擎模式
- * @details 当前支持按行处理（TUPLE_ITERATOR）以及按批处理(CHUNK_ITERATOR)两种模式。
+ * @details 当前支持按行处理（TUPLE_ITERATOR）、按批处理(CHUNK_ITERATOR)以及 push 模式按批处理(PIPELINE)三种模式。
+ * PIPELINE 与 CHUNK_ITERATOR 使用相同的向量化算子，但是由 Pipeline 驱动算子执行，参考 PipelineVecPhysicalOperator。
  */
 enum class ExecutionMode
 {
   UNKNOWN_MODE = 0,
   TUPLE_ITERATOR,
-  CHUNK_ITERATOR
+  CHUNK_ITERATOR,
+  PIPELINE
 };
 
 /// page的CRC校验和
@@ -945,7 +945,7 @@ RC MysqlCommunicator::send_result_rows(SessionEvent *event, SqlResult *sql_resul
   packet.resize(4 * 1024 * 1024);  // TODO warning: length cannot be fix
 
   int    affected_rows = 0;
-  if (event->session()->get_execution_mode() == ExecutionMode::CHUNK_ITERATOR
+  if (event->session()->get_execution_mode() != ExecutionMode::TUPLE_ITERATOR
       && event->session()->used_chunk_mode()) {
     rc = write_chunk_result(sql_result, packet, affected_rows, need_disconnect);
   } else {
@@ -1025,7 +1025,8 @@ RC MysqlCommunicator::write_chunk_result(SqlResult *sql_result, vector<char> &pa
     if (column_num == 0) {
       continue;
     }
-    for (int i = 0; i < chunk.rows(); i++) {
+    for (int i = 0; i < chunk.selected_rows(); i++) {
+      const int row_idx = chunk.selected_row(i);
       affected_rows++;
       // https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_com_query_response_text_resultset.html
       // https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_com_query_response_text_resultset_row.html
@@ -1037,7 +1038,7 @@ RC MysqlCommunicator::write_chunk_result(SqlResult *sql_result, vector<char> &pa
       pos += store_int1(buf + pos, sequence_id_++);
 
       for (int col_idx = 0; col_idx < column_num; col_idx++) {
-        Value value = chunk.get_value(col_idx, i);
+        Value value = chunk.get_value(col_idx, row_idx);
         pos += store_lenenc_string(buf + pos, value.to_string().c_str());
       }
 
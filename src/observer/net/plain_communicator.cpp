@@ -237,7 +237,7 @@ RC PlainCommunicator::write_result_internal(SessionEvent *event, bool &need_disc
   }
 
   rc = RC::SUCCESS;
-  if (event->session()->get_execution_mode() == ExecutionMode::CHUNK_ITERATOR
+  if (event->session()->get_execution_mode() != ExecutionMode::TUPLE_ITERATOR
       && event->session()->used_chunk_mode()) {
     rc = write_chunk_result(sql_result);
   } else {
@@ -330,7 +330,8 @@ RC PlainCommunicator::write_chunk_result(SqlResult *sql_result)
   Chunk chunk;
   while (RC::SUCCESS == (rc = sql_result->next_chunk(chunk))) {
     int col_num = chunk.column_num();
-    for (int row_idx = 0; row_idx < chunk.rows(); row_idx++) {
+    for (int i = 0; i < chunk.selected_rows(); i++) {
+      const int row_idx = chunk.selected_row(i);
       for (int col_idx = 0; col_idx < col_num; col_idx++) {
         if (col_idx != 0) {
           const char *delim = " | ";
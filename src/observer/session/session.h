@@ -88,6 +88,12 @@ public:
   void set_use_cascade(bool use_cascade) { use_cascade_ = use_cascade; }
   bool use_cascade() const { return use_cascade_; }
 
+  void set_parallel_degree(int parallel_degree) { parallel_degree_ = parallel_degree; }
+  int  parallel_degree() const { return parallel_degree_; }
+
+  void    set_operator_memory_limit(int64_t memory_limit) { operator_memory_limit_ = memory_limit; }
+  int64_t operator_memory_limit() const { return operator_memory_limit_; }
+
   void          set_execution_mode(const ExecutionMode mode) { execution_mode_ = mode; }
   ExecutionMode get_execution_mode() const { return execution_mode_; }
 
@@ -115,9 +121,13 @@ private:
   bool trx_multi_operation_mode_ = false;  ///< 当前事务的模式，是否多语句模式. 单语句模式自动提交
 
   bool sql_debug_   = false;  ///< 是否输出SQL调试信息
-  bool hash_join_   = false;  ///< 是否使用hash join
+  bool hash_join_   = true;   ///< 有等值连接条件时是否使用hash join
   bool use_cascade_ = false;  ///< 是否使用 cascade 优化器
 
+  int parallel_degree_ = 1;  ///< 向量化执行时并行扫描的线程数，1 表示不并行
+
+  int64_t operator_memory_limit_ = 256LL * 1024 * 1024;  ///< 单个算子(hash join/hash 聚合)可以使用的内存，超过后写临时文件
+
   // 是否使用了 `chunk_iterator` 模式。 只有在设置了 `chunk_iterator`
   // 并且可以生成相关物理执行计划时才会使用 `chunk_iterator` 模式。
   bool used_chunk_mode_ = false;
@@ -26,6 +26,9 @@ See the Mulan PSL v2 for more details. */
 
 using namespace common;
 
+/// 导入数据时每攒够这么多行，调用一次 Table::insert_records
+static constexpr int LOAD_DATA_BATCH_SIZE = 1024;
+
 /**
  * 解析CSV行，针对ClickBench数据集优化，支持自定义分隔符和引号字符
  * ClickBench数据集通常使用Tab分隔符，这个函数针对此进行了优化
@@ -92,15 +95,16 @@ RC LoadDataExecutor::execute(SQLStageEvent *sql_event)
 }
 
 /**
- * 从文件中导入数据时使用。尝试向表中插入解析后的一行数据。
+ * 从文件中导入数据时使用。把解析后的一行数据转换成表中的一条记录。
  * @param table  要导入的表
  * @param file_values 从文件中读取到的一行数据，使用分隔符拆分后的几个字段值
- * @param record_values Table::insert_record使用的参数，为了防止频繁的申请内存
+ * @param record_values Table::make_record使用的参数，为了防止频繁的申请内存
+ * @param record 生成的记录
  * @param errmsg 如果出现错误，通过这个参数返回错误信息
  * @return 成功返回RC::SUCCESS
  */
-RC insert_record_from_file(
-    Table *table, vector<string> &file_values, vector<Value> &record_values, stringstream &errmsg)
+RC make_record_from_file(
+    Table *table, vector<string> &file_values, vector<Value> &record_values, Record &record, stringstream &errmsg)
 {
 
   const int field_num     = record_values.size();
@@ -124,17 +128,47 @@ RC insert_record_from_file(
   }
 
   if (RC::SUCCESS == rc) {
-    Record record;
     rc = table->make_record(field_num, record_values.data(), record);
     if (rc != RC::SUCCESS) {
       errmsg << "insert failed.";
-    } else if (RC::SUCCESS != (rc = table->insert_record(record))) {
-      errmsg << "insert failed.";
     }
   }
   return rc;
 }
 
+/**
+ * 把攒下来的一批记录插入到表中
+ * @details 批量插入是整批成功或者整批失败的。失败时再逐条插入，这样出错位置之前的数据
+ * 仍然会被导入，与逐行导入时的行为保持一致。
+ * @param inserted 成功插入的记录数
+ */
+RC flush_records(Table *table, vector<Record> &records, int &inserted, stringstream &errmsg)
+{
+  inserted = 0;
+  if (records.empty()) {
+    return RC::SUCCESS;
+  }
+
+  RC rc = table->insert_records(records);
+  if (OB_SUCC(rc)) {
+    inserted = static_cast<int>(records.size());
+  } else {
+    LOG_WARN("failed to insert records in batch, retry one by one. batch size=%d, rc=%s",
+             static_cast<int>(records.size()), strrc(rc));
+    for (Record &record : records) {
+      rc = table->insert_record(record);
+      if (OB_FAIL(rc)) {
+        errmsg << "insert failed.";
+        break;
+      }
+      inserted++;
+    }
+  }
+
+  records.clear();
+  return rc;
+}
+
 void LoadDataExecutor::load_data(
     Table *table, const char *file_name, string terminated, string enclosed, SqlResult *sql_result)
 {
@@ -158,6 +192,9 @@ void LoadDataExecutor::load_data(
     vector<Value>  record_values(field_num);
     vector<string> file_values;
     file_values.reserve(field_num + 10);  // 预留一些额外空间防止频繁重分配
+    vector<Record> records;
+    records.reserve(LOAD_DATA_BATCH_SIZE);
+    int inserted = 0;
 
     // 逐行读取CSV文件，这种方式对大文件更友好
     char *line;
@@ -180,16 +217,25 @@ void LoadDataExecutor::load_data(
         continue;
       }
 
-      // 插入记录
-      RC insert_rc = insert_record_from_file(table, file_values, record_values, errmsg);
+      // 生成记录，攒够一批后再插入
+      Record record;
+      RC     insert_rc = make_record_from_file(table, file_values, record_values, record, errmsg);
       if (insert_rc == RC::SUCCESS) {
-        insertion_count++;
+        records.push_back(std::move(record));
+        if (records.size() < static_cast<size_t>(LOAD_DATA_BATCH_SIZE)) {
+          continue;
+        }
 
+        const int last_count = insertion_count;
+        insert_rc            = flush_records(table, records, inserted, errmsg);
+        insertion_count += inserted;
         // 每处理10000行打印一次进度（对大数据集有用）
-        if (insertion_count % 10000 == 0) {
+        if (insertion_count / 10000 != last_count / 10000) {
           LOG_INFO("Processed %d records from %s", insertion_count, file_name);
         }
-      } else {
+      }
+
+      if (insert_rc != RC::SUCCESS) {
         // 如果插入失败，记录错误但继续处理
         LOG_WARN("Failed to insert record at line %d: %s", line_num, errmsg.str().c_str());
         errmsg.clear();
@@ -207,6 +253,14 @@ void LoadDataExecutor::load_data(
       }
     }
 
+    if (RC::SUCCESS == rc) {
+      rc = flush_records(table, records, inserted, errmsg);
+      insertion_count += inserted;
+      if (OB_FAIL(rc)) {
+        LOG_WARN("Failed to insert records at the end of file: %s", errmsg.str().c_str());
+      }
+    }
+
   } catch (const io::error::base &e) {
     // Fast-CSV库异常处理
     result_string << "CSV parsing error: " << e.what();
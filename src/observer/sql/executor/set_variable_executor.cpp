@@ -42,6 +42,20 @@ RC SetVariableExecutor::execute(SQLStageEvent *sql_event)
           session->set_hash_join(bool_value);
           LOG_TRACE("set hash_join to %d", bool_value);
         }
+      } else if (strcasecmp(var_name, "parallel_degree") == 0) {
+        if (var_value.attr_type() == AttrType::INTS && var_value.get_int() >= 1) {
+          session->set_parallel_degree(var_value.get_int());
+          LOG_TRACE("set parallel_degree to %d", var_value.get_int());
+        } else {
+          rc = RC::INVALID_ARGUMENT;
+        }
+      } else if (strcasecmp(var_name, "operator_memory_limit") == 0) {
+        if (var_value.attr_type() == AttrType::INTS && var_value.get_int() > 0) {
+          session->set_operator_memory_limit(var_value.get_int());
+          LOG_TRACE("set operator_memory_limit to %d", var_value.get_int());
+        } else {
+          rc = RC::INVALID_ARGUMENT;
+        }
       } else if (strcasecmp(var_name, "use_cascade") == 0) {
         // TODO: remove this params, due to the dblab needed, likely to be long-existing
         bool bool_value = false;
@@ -101,6 +115,8 @@ RC SetVariableExecutor::get_execution_mode(const Value &var_value, ExecutionMode
         execution_mode = ExecutionMode::TUPLE_ITERATOR;
       } else if (strcasecmp(var_value.get_string().c_str(), "CHUNK_ITERATOR") == 0) {
         execution_mode = ExecutionMode::CHUNK_ITERATOR;
+      } else if (strcasecmp(var_value.get_string().c_str(), "PIPELINE") == 0) {
+        execution_mode = ExecutionMode::PIPELINE;
       } else {
         execution_mode = ExecutionMode::UNKNOWN_MODE;
         rc = RC::VARIABLE_NOT_VALID;
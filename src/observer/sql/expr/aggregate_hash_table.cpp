@@ -9,70 +9,681 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #include "sql/expr/aggregate_hash_table.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/functional.h"
+#include "common/lang/string_view.h"
 
 // ----------------------------------StandardAggregateHashTable------------------
 
+template <typename T>
+static inline T load(const char *data)
+{
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+template <typename T>
+static inline void store(char *data, T value)
+{
+  memcpy(data, &value, sizeof(T));
+}
+
+static inline uint64_t mix_hash(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+/**
+ * @brief 计算序列化之后的一个 group by 值的哈希值
+ */
+static inline uint64_t hash_field(const char *data, int len)
+{
+  if (len == sizeof(uint32_t)) {
+    return mix_hash(load<uint32_t>(data));
+  }
+  return hash<string_view>()(string_view(data, len));
+}
+
+static inline uint64_t combine_hash(uint64_t seed, uint64_t h) { return mix_hash(seed * 0x9e3779b97f4a7c15ULL + h); }
+
+/**
+ * @brief 获取列上第 row 行的数据，常量列只有一个值
+ */
+static inline const char *cell_data(const Column &column, int row)
+{
+  if (column.column_type() == Column::Type::CONSTANT_COLUMN) {
+    row = 0;
+  }
+  return column.data() + static_cast<size_t>(row) * column.attr_len();
+}
+
+/**
+ * @brief 把一个值序列化成 len 个字节
+ * @details 字符串后面填充 '\0'，+0 和 -0 统一成 +0，保证相等的值序列化之后的字节也相同，可以直接比较和计算哈希值
+ */
+static inline void encode_field(AttrType attr_type, const char *src, int src_len, char *dst, int len)
+{
+  switch (attr_type) {
+    case AttrType::CHARS: {
+      const int size = static_cast<int>(strnlen(src, min(src_len, len)));
+      memcpy(dst, src, size);
+      memset(dst + size, 0, len - size);
+    } break;
+    case AttrType::FLOATS: {
+      float value = load<float>(src);
+      if (value == 0) {
+        value = 0;
+      }
+      store(dst, value);
+    } break;
+    default: {
+      const int size = min(src_len, len);
+      memcpy(dst, src, size);
+      memset(dst + size, 0, len - size);
+    } break;
+  }
+}
+
+static inline Value field_value(AttrType attr_type, const char *data, int len)
+{
+  Value value;
+  if (attr_type == AttrType::CHARS) {
+    value.set_string(data, static_cast<int>(strnlen(data, len)));
+  } else {
+    value.set_type(attr_type);
+    value.set_data(data, len);
+  }
+  return value;
+}
+
+static inline int compare_field(AttrType attr_type, const char *left, const char *right, int len)
+{
+  switch (attr_type) {
+    case AttrType::INTS:
+    case AttrType::DATES: {
+      const int l = load<int>(left);
+      const int r = load<int>(right);
+      return (l > r) - (l < r);
+    }
+    case AttrType::FLOATS: {
+      const float l = load<float>(left);
+      const float r = load<float>(right);
+      return (l > r) - (l < r);
+    }
+    case AttrType::CHARS: return strncmp(left, right, len);
+    default: return memcmp(left, right, len);
+  }
+}
+
+/**
+ * @brief 更新 MAX/MIN 的状态，状态前面的一个字节标记是否已经有值
+ */
+static inline void update_extreme(
+    AttrType attr_type, char *state, int len, const char *value, int value_len, bool is_max)
+{
+  if (state[-1] != 0) {
+    const int cmp = compare_field(attr_type, value, state, len);
+    if (is_max ? cmp <= 0 : cmp >= 0) {
+      return;
+    }
+  }
+  encode_field(attr_type, value, value_len, state, len);
+  state[-1] = 1;
+}
+
+/**
+ * @brief 把一列数值累加到每一行所属分组的状态上。count_offset >= 0 时同时累加行数，用于 AVG
+ */
+template <typename T>
+static void sum_column(const Column &column, const Chunk &rows_chunk, const vector<int> &groups, char *rows,
+    int row_width, int offset, int count_offset)
+{
+  const bool constant = column.column_type() == Column::Type::CONSTANT_COLUMN;
+  const T   *values   = reinterpret_cast<const T *>(column.data());
+  for (size_t i = 0; i < groups.size(); i++) {
+    char   *row   = rows + static_cast<size_t>(groups[i]) * row_width;
+    const T value = values[constant ? 0 : rows_chunk.selected_row(static_cast<int>(i))];
+    store<T>(row + offset, load<T>(row + offset) + value);
+    if (count_offset >= 0) {
+      store<int>(row + count_offset, load<int>(row + count_offset) + 1);
+    }
+  }
+}
+
+/**
+ * @brief 把值追加到列中，字符串不足列宽的部分填充 '\0'
+ */
+static inline void append_value(Column &column, const Value &value)
+{
+  if (value.attr_type() != AttrType::CHARS) {
+    column.append_one(const_cast<char *>(value.data()));
+    return;
+  }
+
+  vector<char> buffer(column.attr_len(), 0);
+  memcpy(buffer.data(), value.data(), min(value.length(), column.attr_len()));
+  column.append_one(buffer.data());
+}
+
+/**
+ * @brief 把行中的一个字段追加到列中，长度相同时直接复制字节
+ */
+static inline void append_field(Column &column, AttrType attr_type, const char *data, int len)
+{
+  if (column.attr_len() == len) {
+    column.append_one(const_cast<char *>(data));
+  } else {
+    append_value(column, field_value(attr_type, data, len));
+  }
+}
+
+RC StandardAggregateHashTable::init_layout(Chunk &groups_chunk, Chunk &aggrs_chunk)
+{
+  int offset = 0;
+  key_fields_.clear();
+  for (int i = 0; i < groups_chunk.column_num(); i++) {
+    const Column &column = groups_chunk.column(i);
+    key_fields_.push_back(Field{column.attr_type(), offset, column.attr_len()});
+    offset += column.attr_len();
+  }
+  key_width_ = offset;
+
+  state_fields_.clear();
+  avg_count_offsets_.clear();
+  for (size_t i = 0; i < aggr_types_.size(); i++) {
+    const Column &column       = aggrs_chunk.column(static_cast<int>(i));
+    Field         field;
+    int           count_offset = -1;
+    switch (aggr_types_[i]) {
+      case AggregateExpr::Type::COUNT: {
+        field = Field{AttrType::INTS, offset, static_cast<int>(sizeof(int))};
+        offset += field.length;
+      } break;
+      case AggregateExpr::Type::SUM:
+      case AggregateExpr::Type::AVG: {
+        if (column.attr_type() != AttrType::INTS && column.attr_type() != AttrType::FLOATS) {
+          LOG_WARN("unsupported type of sum/avg in hash table. type=%s", attr_type_to_string(column.attr_type()));
+          return RC::UNSUPPORTED;
+        }
+        field = Field{column.attr_type(), offset, static_cast<int>(sizeof(int))};
+        offset += field.length;
+        if (aggr_types_[i] == AggregateExpr::Type::AVG) {
+          count_offset = offset;
+          offset += sizeof(int);
+        }
+      } break;
+      case AggregateExpr::Type::MAX:
+      case AggregateExpr::Type::MIN: {
+        field = Field{column.attr_type(), offset + 1, column.attr_len()};
+        offset += 1 + field.length;
+      } break;
+      default: {
+        LOG_WARN("unsupported aggregate type in hash table. type=%d", static_cast<int>(aggr_types_[i]));
+        return RC::UNIMPLEMENTED;
+      }
+    }
+    state_fields_.push_back(field);
+    avg_count_offsets_.push_back(count_offset);
+  }
+  row_width_    = offset;
+  layout_ready_ = true;
+  return RC::SUCCESS;
+}
+
 RC StandardAggregateHashTable::add_chunk(Chunk &groups_chunk, Chunk &aggrs_chunk)
 {
-  // your code here
-  exit(-1);
+  if (groups_chunk.column_num() > 0 && aggrs_chunk.column_num() > 0 && groups_chunk.rows() != aggrs_chunk.rows()) {
+    LOG_WARN("groups_chunk and aggrs_chunk rows must be equal.");
+    return RC::INVALID_ARGUMENT;
+  }
+  if (aggrs_chunk.column_num() != static_cast<int>(aggr_types_.size())) {
+    LOG_WARN("aggrs_chunk column num must be equal to aggregation num.");
+    return RC::INVALID_ARGUMENT;
+  }
+
+  RC rc = RC::SUCCESS;
+  if (!layout_ready_ && OB_FAIL(rc = init_layout(groups_chunk, aggrs_chunk))) {
+    return rc;
+  }
+  if (groups_chunk.column_num() != static_cast<int>(key_fields_.size())) {
+    LOG_WARN("groups_chunk column num changed. expect=%d, actual=%d",
+             static_cast<int>(key_fields_.size()), groups_chunk.column_num());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  // 没有分组列时（整张表作为一个分组）按照聚合列遍历
+  const Chunk &rows_chunk = groups_chunk.column_num() > 0 ? groups_chunk : aggrs_chunk;
+  const int    rows       = rows_chunk.selected_rows();
+  serialize_keys(groups_chunk, rows_chunk);
+  input_groups_.resize(rows);
+  for (int i = 0; i < rows; i++) {
+    input_groups_[i] = find_or_insert(input_keys_.data() + static_cast<size_t>(i) * key_width_, input_hashes_[i]);
+  }
+  for (int i = 0; i < aggrs_chunk.column_num(); i++) {
+    aggregate_column(i, aggrs_chunk.column(i), rows_chunk);
+  }
+  return spill_if_needed();
 }
 
-void StandardAggregateHashTable::Scanner::open_scan()
+RC StandardAggregateHashTable::merge(const StandardAggregateHashTable &other, int partition, int partition_num)
 {
-  it_  = static_cast<StandardAggregateHashTable *>(hash_table_)->begin();
-  end_ = static_cast<StandardAggregateHashTable *>(hash_table_)->end();
+  if (!other.layout_ready_) {
+    return RC::SUCCESS;
+  }
+  if (!layout_ready_) {
+    key_fields_        = other.key_fields_;
+    state_fields_      = other.state_fields_;
+    avg_count_offsets_ = other.avg_count_offsets_;
+    key_width_         = other.key_width_;
+    row_width_         = other.row_width_;
+    layout_ready_      = true;
+  } else if (key_width_ != other.key_width_ || row_width_ != other.row_width_) {
+    LOG_WARN("cannot merge aggregate hash tables with different layout. key width=%d:%d, row width=%d:%d",
+             key_width_, other.key_width_, row_width_, other.row_width_);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  // 与 add_chunk 一样每合并一批分组检查一次内存
+  static constexpr int CHECK_MEMORY_INTERVAL = 1024;
+
+  RC  rc     = RC::SUCCESS;
+  int merged = 0;
+  for (int row = 0; row < other.group_count(); row++) {
+    const uint64_t hash = other.row_hashes_[row];
+    if (partition_num > 1 && partition_of(hash, partition_num) != partition) {
+      continue;
+    }
+    const char *other_row = other.row_data(row);
+    merge_row(row_data(find_or_insert(other_row, hash)), other_row);
+    if (++merged % CHECK_MEMORY_INTERVAL == 0 && OB_FAIL(rc = spill_if_needed())) {
+      return rc;
+    }
+  }
+  return spill_if_needed();
 }
 
-RC StandardAggregateHashTable::Scanner::next(Chunk &output_chunk)
+void StandardAggregateHashTable::serialize_keys(Chunk &groups_chunk, const Chunk &rows_chunk)
 {
-  if (it_ == end_) {
-    return RC::RECORD_EOF;
+  const int rows = rows_chunk.selected_rows();
+  input_keys_.resize(static_cast<size_t>(rows) * key_width_);
+  input_hashes_.assign(rows, 0);
+  for (size_t col = 0; col < key_fields_.size(); col++) {
+    const Field  &field  = key_fields_[col];
+    const Column &column = groups_chunk.column(static_cast<int>(col));
+    for (int i = 0; i < rows; i++) {
+      char *key = input_keys_.data() + static_cast<size_t>(i) * key_width_ + field.offset;
+      encode_field(field.type, cell_data(column, rows_chunk.selected_row(i)), column.attr_len(), key, field.length);
+      input_hashes_[i] = combine_hash(input_hashes_[i], hash_field(key, field.length));
+    }
   }
-  while (it_ != end_ && output_chunk.rows() <= output_chunk.capacity()) {
-    auto &group_by_values = it_->first;
-    auto &aggrs           = it_->second;
-    for (int i = 0; i < output_chunk.column_num(); i++) {
-      auto col_idx = output_chunk.column_ids(i);
-      if (col_idx >= static_cast<int>(group_by_values.size())) {
-        output_chunk.column(i).append_one((char *)aggrs[col_idx - group_by_values.size()].data());
+}
+
+int StandardAggregateHashTable::find_or_insert(const char *key, uint64_t hash)
+{
+  const uint32_t tag = static_cast<uint32_t>(hash >> 32);
+  uint64_t       pos = hash & slot_mask_;
+  while (slots_[pos].row >= 0) {
+    const Slot &slot = slots_[pos];
+    if (slot.tag == tag && (key_width_ == 0 || memcmp(row_data(slot.row), key, key_width_) == 0)) {
+      return slot.row;
+    }
+    pos = (pos + 1) & slot_mask_;
+  }
+
+  // 新的分组追加到最后，聚合状态都初始化为 0
+  const int row = group_count();
+  rows_.resize(rows_.size() + row_width_, 0);
+  if (key_width_ > 0) {
+    memcpy(row_data(row), key, key_width_);
+  }
+  row_hashes_.push_back(hash);
+  slots_[pos] = Slot{row, tag};
+  if (row_hashes_.size() * 2 > slots_.size()) {
+    grow();
+  }
+  return row;
+}
+
+void StandardAggregateHashTable::grow()
+{
+  slots_.assign(slots_.size() * 2, Slot());
+  slot_mask_ = slots_.size() - 1;
+  for (int row = 0; row < group_count(); row++) {
+    uint64_t pos = row_hashes_[row] & slot_mask_;
+    while (slots_[pos].row >= 0) {
+      pos = (pos + 1) & slot_mask_;
+    }
+    slots_[pos] = Slot{row, static_cast<uint32_t>(row_hashes_[row] >> 32)};
+  }
+}
+
+void StandardAggregateHashTable::aggregate_column(int aggr_idx, const Column &column, const Chunk &rows_chunk)
+{
+  const Field &field = state_fields_[aggr_idx];
+  switch (aggr_types_[aggr_idx]) {
+    case AggregateExpr::Type::COUNT: {
+      for (int group : input_groups_) {
+        char *state = row_data(group) + field.offset;
+        store<int>(state, load<int>(state) + 1);
+      }
+    } break;
+    case AggregateExpr::Type::SUM:
+    case AggregateExpr::Type::AVG: {
+      if (field.type == AttrType::FLOATS) {
+        sum_column<float>(
+            column, rows_chunk, input_groups_, rows_.data(), row_width_, field.offset, avg_count_offsets_[aggr_idx]);
       } else {
-        output_chunk.column(i).append_one((char *)group_by_values[col_idx].data());
+        sum_column<int>(
+            column, rows_chunk, input_groups_, rows_.data(), row_width_, field.offset, avg_count_offsets_[aggr_idx]);
+      }
+    } break;
+    case AggregateExpr::Type::MAX:
+    case AggregateExpr::Type::MIN: {
+      const bool is_max = aggr_types_[aggr_idx] == AggregateExpr::Type::MAX;
+      for (size_t i = 0; i < input_groups_.size(); i++) {
+        update_extreme(field.type,
+            row_data(input_groups_[i]) + field.offset,
+            field.length,
+            cell_data(column, rows_chunk.selected_row(static_cast<int>(i))),
+            column.attr_len(),
+            is_max);
       }
+    } break;
+    default: break;
+  }
+}
+
+uint64_t StandardAggregateHashTable::encode_key(const vector<Value> &values, char *key) const
+{
+  uint64_t hash = 0;
+  for (size_t i = 0; i < key_fields_.size(); i++) {
+    const Field &field = key_fields_[i];
+    encode_field(field.type, values[i].data(), values[i].length(), key + field.offset, field.length);
+    hash = combine_hash(hash, hash_field(key + field.offset, field.length));
+  }
+  return hash;
+}
+
+void StandardAggregateHashTable::merge_values(const vector<Value> &values)
+{
+  // 先把 values 转换成一行，再按行合并。行的前面是 group by 值，可以直接用来查找分组
+  input_keys_.assign(row_width_, 0);
+  char          *temp_row  = input_keys_.data();
+  const uint64_t hash      = encode_key(values, temp_row);
+  size_t         count_idx = key_fields_.size() + aggr_types_.size();
+  for (size_t i = 0; i < aggr_types_.size(); i++) {
+    const Field &field = state_fields_[i];
+    const Value &value = values[key_fields_.size() + i];
+    char        *state = temp_row + field.offset;
+    switch (aggr_types_[i]) {
+      case AggregateExpr::Type::COUNT: {
+        store<int>(state, value.get_int());
+      } break;
+      case AggregateExpr::Type::SUM:
+      case AggregateExpr::Type::AVG: {
+        if (field.type == AttrType::FLOATS) {
+          store<float>(state, value.get_float());
+        } else {
+          store<int>(state, value.get_int());
+        }
+        if (avg_count_offsets_[i] >= 0) {
+          store<int>(temp_row + avg_count_offsets_[i], values[count_idx++].get_int());
+        }
+      } break;
+      case AggregateExpr::Type::MAX:
+      case AggregateExpr::Type::MIN: {
+        if (value.attr_type() != AttrType::UNDEFINED) {
+          encode_field(field.type, value.data(), value.length(), state, field.length);
+          state[-1] = 1;
+        }
+      } break;
+      default: break;
+    }
+  }
+
+  merge_row(row_data(find_or_insert(temp_row, hash)), temp_row);
+}
+
+void StandardAggregateHashTable::merge_row(char *row, const char *other) const
+{
+  for (size_t i = 0; i < aggr_types_.size(); i++) {
+    const Field &field       = state_fields_[i];
+    char        *state       = row + field.offset;
+    const char  *other_state = other + field.offset;
+    switch (aggr_types_[i]) {
+      case AggregateExpr::Type::COUNT: {
+        store<int>(state, load<int>(state) + load<int>(other_state));
+      } break;
+      case AggregateExpr::Type::SUM:
+      case AggregateExpr::Type::AVG: {
+        if (field.type == AttrType::FLOATS) {
+          store<float>(state, load<float>(state) + load<float>(other_state));
+        } else {
+          store<int>(state, load<int>(state) + load<int>(other_state));
+        }
+        const int count_offset = avg_count_offsets_[i];
+        if (count_offset >= 0) {
+          store<int>(row + count_offset, load<int>(row + count_offset) + load<int>(other + count_offset));
+        }
+      } break;
+      case AggregateExpr::Type::MAX:
+      case AggregateExpr::Type::MIN: {
+        if (other_state[-1] != 0) {
+          update_extreme(field.type,
+              state,
+              field.length,
+              other_state,
+              field.length,
+              aggr_types_[i] == AggregateExpr::Type::MAX);
+        }
+      } break;
+      default: break;
     }
-    it_++;
   }
-  if (it_ == end_) {
+}
+
+void StandardAggregateHashTable::row_values(int row, vector<Value> &values) const
+{
+  const char *data = row_data(row);
+  values.clear();
+  for (const Field &field : key_fields_) {
+    values.push_back(field_value(field.type, data + field.offset, field.length));
+  }
+  for (size_t i = 0; i < aggr_types_.size(); i++) {
+    const Field &field      = state_fields_[i];
+    const bool   is_extreme = aggr_types_[i] == AggregateExpr::Type::MAX || aggr_types_[i] == AggregateExpr::Type::MIN;
+    if (is_extreme && data[field.offset - 1] == 0) {
+      values.emplace_back();
+    } else {
+      values.push_back(field_value(field.type, data + field.offset, field.length));
+    }
+  }
+  // AVG 的行数放在所有聚合值的后面
+  for (int offset : avg_count_offsets_) {
+    if (offset >= 0) {
+      values.push_back(Value(load<int>(data + offset)));
+    }
+  }
+}
+
+int64_t StandardAggregateHashTable::memory_usage() const
+{
+  return static_cast<int64_t>(rows_.size() + row_hashes_.size() * sizeof(uint64_t) + slots_.size() * sizeof(Slot));
+}
+
+RC StandardAggregateHashTable::spill_if_needed()
+{
+  if (memory_usage() <= memory_limit_) {
     return RC::SUCCESS;
   }
+  if (partitions_ == nullptr) {
+    LOG_INFO("aggregate hash table exceeds memory limit, spill to disk. memory usage=%ld, limit=%ld",
+             memory_usage(), memory_limit_);
+    partitions_ = make_unique<SpillPartitions>(0 /*depth*/);
+    spilled_    = true;
+  }
+  return spill(*partitions_);
+}
 
+RC StandardAggregateHashTable::spill(SpillPartitions &partitions)
+{
+  for (int row = 0; row < group_count(); row++) {
+    row_values(row, spill_values_);
+
+    SpillFile *file = nullptr;
+    RC         rc   = partitions.file(partitions.partition_of(row_hashes_[row]), file);
+    if (OB_SUCC(rc)) {
+      rc = file->write_values(spill_values_);
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to spill aggregate hash table. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+  clear();
   return RC::SUCCESS;
 }
 
-size_t StandardAggregateHashTable::VectorHash::operator()(const vector<Value> &vec) const
+void StandardAggregateHashTable::clear()
+{
+  rows_.clear();
+  row_hashes_.clear();
+  slots_.assign(INITIAL_SLOTS, Slot());
+  slot_mask_ = INITIAL_SLOTS - 1;
+}
+
+void StandardAggregateHashTable::collect_partitions(SpillPartitions &partitions)
 {
-  size_t hash_val = 0;
-  for (const auto &elem : vec) {
-    hash_val ^= hash<string>()(elem.to_string());
+  for (int i = 0; i < SpillPartitions::PARTITION_NUM; i++) {
+    unique_ptr<SpillFile> file = partitions.release(i);
+    if (file != nullptr) {
+      pending_partitions_.emplace_back(std::move(file), partitions.depth());
+    }
   }
-  return hash_val;
 }
 
-bool StandardAggregateHashTable::VectorEqual::operator()(const vector<Value> &lhs, const vector<Value> &rhs) const
+RC StandardAggregateHashTable::load_next_partition()
 {
-  if (lhs.size() != rhs.size()) {
-    return false;
+  if (!spilled_) {
+    return RC::RECORD_EOF;
+  }
+
+  RC rc = RC::SUCCESS;
+  if (partitions_ != nullptr) {
+    // 第一次读取，哈希表中剩余的数据也要写到分区中，与之前写入的部分聚合结果合并
+    if (OB_FAIL(rc = spill(*partitions_))) {
+      return rc;
+    }
+    collect_partitions(*partitions_);
+    partitions_.reset();
   }
-  for (size_t i = 0; i < lhs.size(); ++i) {
-    if (rhs[i].compare(lhs[i]) != 0) {
-      return false;
+
+  clear();
+  while (!pending_partitions_.empty()) {
+    unique_ptr<SpillFile> file  = std::move(pending_partitions_.back().first);
+    const int             depth = pending_partitions_.back().second;
+    pending_partitions_.pop_back();
+
+    bool too_large = false;
+    if (OB_FAIL(rc = file->rewind())) {
+      return rc;
+    }
+    while (OB_SUCC(rc = file->read_values(spill_values_))) {
+      merge_values(spill_values_);
+      if (memory_usage() > memory_limit_ && depth + 1 < SpillPartitions::MAX_DEPTH) {
+        too_large = true;
+        break;
+      }
+    }
+    if (rc != RC::SUCCESS && rc != RC::RECORD_EOF) {
+      return rc;
+    }
+
+    if (!too_large) {
+      return RC::SUCCESS;
+    }
+
+    // 分区中不同的分组太多，用哈希值的下一组位继续分区
+    LOG_INFO("aggregate partition exceeds memory limit, partition again. depth=%d, rows=%ld", depth + 1, file->records());
+    clear();
+    SpillPartitions partitions(depth + 1);
+    if (OB_FAIL(rc = file->rewind())) {
+      return rc;
+    }
+    input_keys_.resize(key_width_);
+    while (OB_SUCC(rc = file->read_values(spill_values_))) {
+      SpillFile *sub_file = nullptr;
+      rc = partitions.file(partitions.partition_of(encode_key(spill_values_, input_keys_.data())), sub_file);
+      if (OB_SUCC(rc)) {
+        rc = sub_file->write_values(spill_values_);
+      }
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+    if (rc != RC::RECORD_EOF) {
+      return rc;
     }
+    collect_partitions(partitions);
   }
-  return true;
+  return RC::RECORD_EOF;
+}
+
+void StandardAggregateHashTable::Scanner::open_scan()
+{
+  auto *hash_table = static_cast<StandardAggregateHashTable *>(hash_table_);
+  pos_             = 0;
+  // 写过临时文件时哈希表中只有部分数据，需要在 next 中逐个分区读取
+  end_ = hash_table->spilled() ? 0 : hash_table->group_count();
+}
+
+RC StandardAggregateHashTable::Scanner::next(Chunk &output_chunk)
+{
+  auto *hash_table = static_cast<StandardAggregateHashTable *>(hash_table_);
+  while (pos_ == end_) {
+    RC rc = hash_table->load_next_partition();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    pos_ = 0;
+    end_ = hash_table->group_count();
+  }
+
+  const int key_num = static_cast<int>(hash_table->key_fields_.size());
+  while (pos_ < end_ && output_chunk.rows() < output_chunk.capacity()) {
+    const char *row = hash_table->row_data(pos_);
+    for (int i = 0; i < output_chunk.column_num(); i++) {
+      const int col_idx = output_chunk.column_ids(i);
+      Column   &column  = output_chunk.column(i);
+      if (col_idx < key_num) {
+        const Field &field = hash_table->key_fields_[col_idx];
+        append_field(column, field.type, row + field.offset, field.length);
+        continue;
+      }
+
+      const int    aggr_idx     = col_idx - key_num;
+      const Field &field        = hash_table->state_fields_[aggr_idx];
+      const int    count_offset = hash_table->avg_count_offsets_[aggr_idx];
+      if (count_offset >= 0) {
+        const char *sum = row + field.offset;
+        float       avg = (field.type == AttrType::FLOATS ? load<float>(sum) : load<int>(sum)) / load<int>(row + count_offset);
+        column.append_one(reinterpret_cast<char *>(&avg));
+      } else {
+        append_field(column, field.type, row + field.offset, field.length);
+      }
+    }
+    pos_++;
+  }
+  return RC::SUCCESS;
 }
 
 // ----------------------------------LinearProbingAggregateHashTable------------------
-#ifdef USE_SIMD
 template <typename V>
 RC LinearProbingAggregateHashTable<V>::add_chunk(Chunk &group_chunk, Chunk &aggr_chunk)
 {
@@ -84,27 +695,56 @@ RC LinearProbingAggregateHashTable<V>::add_chunk(Chunk &group_chunk, Chunk &aggr
     LOG_WARN("group_chunk and aggr _chunk rows must be equal.");
     return RC::INVALID_ARGUMENT;
   }
-  add_batch((int *)group_chunk.column(0).data(), (V *)aggr_chunk.column(0).data(), group_chunk.rows());
+
+  // 选中的行复制到连续的内存中，常量列展开，与 EMPTY_KEY 相等的键单独聚合
+  const Column &key_column     = group_chunk.column(0);
+  const Column &value_column   = aggr_chunk.column(0);
+  const int    *keys           = reinterpret_cast<const int *>(key_column.data());
+  const V      *values         = reinterpret_cast<const V *>(value_column.data());
+  const bool    constant_key   = key_column.column_type() == Column::Type::CONSTANT_COLUMN;
+  const bool    constant_value = value_column.column_type() == Column::Type::CONSTANT_COLUMN;
+  input_keys_.clear();
+  input_values_.clear();
+  for (int i = 0; i < group_chunk.selected_rows(); i++) {
+    const int row   = group_chunk.selected_row(i);
+    const int key   = keys[constant_key ? 0 : row];
+    const V   value = values[constant_value ? 0 : row];
+    if (key == EMPTY_KEY) {
+      if (!has_empty_key_) {
+        has_empty_key_   = true;
+        empty_key_value_ = value;
+      } else {
+        aggregate(&empty_key_value_, value);
+      }
+      continue;
+    }
+    input_keys_.push_back(key);
+    input_values_.push_back(value);
+  }
+
+  add_batch(input_keys_.data(), input_values_.data(), static_cast<int>(input_keys_.size()));
   return RC::SUCCESS;
 }
 
 template <typename V>
 void LinearProbingAggregateHashTable<V>::Scanner::open_scan()
 {
-  capacity_   = static_cast<LinearProbingAggregateHashTable *>(hash_table_)->capacity();
-  size_       = static_cast<LinearProbingAggregateHashTable *>(hash_table_)->size();
-  scan_pos_   = 0;
-  scan_count_ = 0;
+  capacity_       = static_cast<LinearProbingAggregateHashTable *>(hash_table_)->capacity();
+  size_           = static_cast<LinearProbingAggregateHashTable *>(hash_table_)->size();
+  scan_pos_       = 0;
+  scan_count_     = 0;
+  empty_key_done_ = false;
 }
 
 template <typename V>
 RC LinearProbingAggregateHashTable<V>::Scanner::next(Chunk &output_chunk)
 {
-  if (scan_pos_ >= capacity_ || scan_count_ >= size_) {
+  auto linear_probing_hash_table = static_cast<LinearProbingAggregateHashTable *>(hash_table_);
+  const bool table_done          = scan_pos_ >= capacity_ || scan_count_ >= size_;
+  if (table_done && (empty_key_done_ || !linear_probing_hash_table->has_empty_key_)) {
     return RC::RECORD_EOF;
   }
-  auto linear_probing_hash_table = static_cast<LinearProbingAggregateHashTable *>(hash_table_);
-  while (scan_pos_ < capacity_ && scan_count_ < size_ && output_chunk.rows() <= output_chunk.capacity()) {
+  while (scan_pos_ < capacity_ && scan_count_ < size_ && output_chunk.rows() < output_chunk.capacity()) {
     int key;
     V   value;
     RC  rc = linear_probing_hash_table->iter_get(scan_pos_, key, value);
@@ -115,23 +755,38 @@ RC LinearProbingAggregateHashTable<V>::Scanner::next(Chunk &output_chunk)
     }
     scan_pos_++;
   }
+  if (linear_probing_hash_table->has_empty_key_ && !empty_key_done_ && scan_count_ >= size_ &&
+      output_chunk.rows() < output_chunk.capacity()) {
+    output_chunk.column(0).append_one((char *)&EMPTY_KEY);
+    output_chunk.column(1).append_one((char *)&linear_probing_hash_table->empty_key_value_);
+    empty_key_done_ = true;
+  }
   return RC::SUCCESS;
 }
 
 template <typename V>
 void LinearProbingAggregateHashTable<V>::Scanner::close_scan()
 {
-  capacity_   = -1;
-  size_       = -1;
-  scan_pos_   = -1;
-  scan_count_ = 0;
+  capacity_       = -1;
+  size_           = -1;
+  scan_pos_       = -1;
+  scan_count_     = 0;
+  empty_key_done_ = false;
 }
 
 template <typename V>
 RC LinearProbingAggregateHashTable<V>::get(int key, V &value)
 {
+  if (key == EMPTY_KEY) {
+    if (!has_empty_key_) {
+      return RC::NOT_EXIST;
+    }
+    value = empty_key_value_;
+    return RC::SUCCESS;
+  }
+
   RC  rc          = RC::SUCCESS;
-  int index       = (key % capacity_ + capacity_) % capacity_;
+  int index       = hash_index(key);
   int iterate_cnt = 0;
   while (true) {
     if (keys_[index] == EMPTY_KEY) {
@@ -180,14 +835,14 @@ template <typename V>
 void LinearProbingAggregateHashTable<V>::resize()
 {
   capacity_ *= 2;
-  vector<int> new_keys(capacity_);
-  vector<V>   new_values(capacity_);
+  vector<int> new_keys(capacity_, EMPTY_KEY);
+  vector<V>   new_values(capacity_, 0);
 
   for (size_t i = 0; i < keys_.size(); i++) {
     auto &key   = keys_[i];
     auto &value = values_[i];
     if (key != EMPTY_KEY) {
-      int index = (key % capacity_ + capacity_) % capacity_;
+      int index = hash_index(key);
       while (new_keys[index] != EMPTY_KEY) {
         index = (index + 1) % capacity_;
       }
@@ -208,32 +863,143 @@ void LinearProbingAggregateHashTable<V>::resize_if_need()
   }
 }
 
+template <typename V>
+void LinearProbingAggregateHashTable<V>::add_one(int key, V value)
+{
+  resize_if_need();
+  int index = hash_index(key);
+  while (true) {
+    if (keys_[index] == EMPTY_KEY) {
+      keys_[index]   = key;
+      values_[index] = value;
+      size_++;
+      return;
+    }
+    if (keys_[index] == key) {
+      aggregate(&values_[index], value);
+      return;
+    }
+    index = (index + 1) & (capacity_ - 1);
+  }
+}
+
+namespace {
+
+#if defined(SIMD_X86)
+/**
+ * @brief 计算探测位置 hash[j] = (key[j] + off[j]) & (capacity - 1)，gather 哈希表中对应位置的键
+ * @return 哈希表中的键与 key[j] 相等或者为空的位置的掩码
+ */
+SIMD_TARGET_AVX2 int probe_avx2(const int *table, int capacity, int empty_key, const int *key, const int *off, int *hash)
+{
+  __m256i keys    = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(key));
+  __m256i offsets = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(off));
+  __m256i indexes = _mm256_and_si256(_mm256_add_epi32(keys, offsets), _mm256_set1_epi32(capacity - 1));
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(hash), indexes);
+
+  __m256i table_keys = _mm256_i32gather_epi32(table, indexes, sizeof(int));
+  __m256i matched    = _mm256_or_si256(
+      _mm256_cmpeq_epi32(table_keys, keys), _mm256_cmpeq_epi32(table_keys, _mm256_set1_epi32(empty_key)));
+  return _mm256_movemask_ps(_mm256_castsi256_ps(matched));
+}
+
+SIMD_TARGET_AVX512 int probe_avx512(
+    const int *table, int capacity, int empty_key, const int *key, const int *off, int *hash)
+{
+  __m512i keys    = _mm512_loadu_si512(key);
+  __m512i indexes = _mm512_and_si512(_mm512_add_epi32(keys, _mm512_loadu_si512(off)), _mm512_set1_epi32(capacity - 1));
+  _mm512_storeu_si512(hash, indexes);
+
+  __m512i table_keys = _mm512_i32gather_epi32(indexes, table, sizeof(int));
+  return _mm512_cmpeq_epi32_mask(table_keys, keys) | _mm512_cmpeq_epi32_mask(table_keys, _mm512_set1_epi32(empty_key));
+}
+#endif  // SIMD_X86
+
+}  // namespace
+
 template <typename V>
 void LinearProbingAggregateHashTable<V>::add_batch(int *input_keys, V *input_values, int len)
 {
-  // your code here
-  exit(-1);
+  int i = 0;
+#if defined(SIMD_X86)
+  const SimdLevel level = simd_level();
+  if (level >= SimdLevel::AVX512) {
+    i = add_batch<16>(input_keys, input_values, len, probe_avx512);
+  } else if (level >= SimdLevel::AVX2) {
+    i = add_batch<8>(input_keys, input_values, len, probe_avx2);
+  }
+#endif
 
-  // inv (invalid) 表示是否有效，inv[i] = -1 表示有效，inv[i] = 0 表示无效。
-  // key[SIMD_WIDTH],value[SIMD_WIDTH] 表示当前循环中处理的键值对。
-  // off (offset) 表示线性探测冲突时的偏移量，key[i] 每次遇到冲突键，则off[i]++，如果key[i] 已经完成聚合，则off[i] = 0，
-  // i = 0 表示selective load 的起始位置。
-  // inv 全部初始化为 -1
-  // off 全部初始化为 0
+  for (; i < len; i++) {
+    add_one(input_keys[i], input_values[i]);
+  }
 
-  // for (; i + SIMD_WIDTH <= len;) {
-    // 1: 根据 `inv` 变量的值，从 `input_keys` 中 `selective load` `SIMD_WIDTH` 个不同的输入键值对。
-    // 2. 计算 i += |inv|, `|inv|` 表示 `inv` 中有效的个数 
-    // 3. 计算 hash 值，
-    // 4. 根据聚合类型（目前只支持 sum），在哈希表中更新聚合结果。如果本次循环，没有找到key[i] 在哈希表中的位置，则不更新聚合结果。
-    // 5. gather 操作，根据 hash 值将 keys_ 的 gather 结果写入 table_key 中。
-    // 6. 更新 inv 和 off。如果本次循环key[i] 聚合完成，则inv[i]=-1，表示该位置在下次循环中读取新的键值对。
-    // 如果本次循环 key[i] 未在哈希表中聚合完成（table_key[i] != key[i]），则inv[i] = 0，表示该位置在下次循环中不需要读取新的键值对。
-    // 如果本次循环中，key[i]聚合完成，则off[i] 更新为 0，表示线性探测偏移量为 0，key[i] 未完成聚合，则off[i]++,表示线性探测偏移量加 1。
-  // }
-  //7. 通过标量线性探测，处理剩余键值对
+  resize_if_need();
+}
 
-  // resize_if_need();
+template <typename V>
+template <int WIDTH, typename Probe>
+int LinearProbingAggregateHashTable<V>::add_batch(int *input_keys, V *input_values, int len, Probe probe)
+{
+  // done[j] != 0 表示 key[j] 已经完成聚合，下一轮需要从输入中读入新的键值对。
+  // key[WIDTH],value[WIDTH] 表示当前循环中处理的键值对。
+  // off (offset) 表示线性探测冲突时的偏移量，key[j] 每次遇到冲突键，则off[j]++，如果key[j] 已经完成聚合，则off[j] = 0，
+  // i 表示selective load 的起始位置。
+  int key[WIDTH]   = {0};
+  V   value[WIDTH] = {0};
+  int off[WIDTH]   = {0};
+  int hash[WIDTH];
+  int done[WIDTH];
+  for (int j = 0; j < WIDTH; j++) {
+    done[j] = 1;
+  }
+
+  int i = 0;
+  for (; i + WIDTH <= len;) {
+    // 扩容之后所有未完成的键从新的位置重新探测。保证哈希表中总有空位，探测一定会结束
+    if (size_ + WIDTH > capacity_ / 2) {
+      resize();
+      memset(off, 0, sizeof(off));
+    }
+
+    // 1. 根据 done 从输入中 selective load 新的键值对，已经完成的位置读入下一个键值对
+    selective_load(input_values, i, value, done, WIDTH);
+    // 2. i += |done|
+    i += selective_load(input_keys, i, key, done, WIDTH);
+
+    // 3. 计算 hash 值，gather 哈希表中对应位置的键，容量是 2 的幂，(key + off) & (capacity - 1) 就是线性探测的位置
+    const int matched = probe(keys_.data(), capacity_, EMPTY_KEY, key, off, hash);
+
+    // 4. 在哈希表中更新聚合结果。gather 时为空的位置可能已经被同一批中前面的键占用，需要重新检查
+    for (int j = 0; j < WIDTH; j++) {
+      done[j] = 0;
+      if (((matched >> j) & 1) == 0) {
+        off[j]++;
+        continue;
+      }
+      const int index = hash[j];
+      if (keys_[index] == key[j]) {
+        aggregate(&values_[index], value[j]);
+        done[j] = 1;
+      } else if (keys_[index] == EMPTY_KEY) {
+        keys_[index]   = key[j];
+        values_[index] = value[j];
+        size_++;
+        done[j] = 1;
+      }
+
+      // 5. 完成聚合的位置 off = 0，未完成的位置 off + 1
+      off[j] = done[j] ? 0 : off[j] + 1;
+    }
+  }
+
+  // 6. 通过标量线性探测，处理向量中还没有完成的键，剩余的输入由调用者处理
+  for (int j = 0; j < WIDTH; j++) {
+    if (!done[j]) {
+      add_one(key[j], value[j]);
+    }
+  }
+  return i;
 }
 
 template <typename V>
@@ -243,4 +1009,3 @@ const int LinearProbingAggregateHashTable<V>::DEFAULT_CAPACITY = 16384;
 
 template class LinearProbingAggregateHashTable<int>;
 template class LinearProbingAggregateHashTable<float>;
-#endif
@@ -11,10 +11,10 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include "common/lang/vector.h"
-#include "common/lang/unordered_map.h"
 #include "common/math/simd_util.h"
 #include "common/sys/rc.h"
 #include "sql/expr/expression.h"
+#include "storage/common/spill_file.h"
 
 /**
  * @brief 用于hash group by 的哈希表实现，不支持并发访问。
@@ -49,21 +49,18 @@ public:
   virtual ~AggregateHashTable() = default;
 };
 
+/**
+ * @brief 开放地址法实现的哈希表，支持任意类型和数量的 group by 列与聚合列
+ * @details 每个分组保存为定长的一行：group by 值序列化成定长的字节，后面紧跟着各个聚合的状态，
+ * 所有分组连续存放在 rows_ 中，哈希表的槽位中只保存分组的行号。新增分组不需要单独分配内存，
+ * 比较分组时直接比较序列化后的字节。add_chunk 按列计算整个 chunk 的分组键和哈希值，再按列更新聚合状态。
+ *
+ * 哈希表使用的内存超过限制时，把当前的部分聚合结果按照 group by 值的哈希值分区写到临时文件中，
+ * 然后清空哈希表继续聚合。扫描时再逐个分区读取、合并部分聚合结果，某个分区仍然超过内存限制时继续分区。
+ */
 class StandardAggregateHashTable : public AggregateHashTable
 {
-private:
-  struct VectorHash
-  {
-    size_t operator()(const vector<Value> &vec) const;
-  };
-
-  struct VectorEqual
-  {
-    bool operator()(const vector<Value> &lhs, const vector<Value> &rhs) const;
-  };
-
 public:
-  using StandardHashTable = unordered_map<vector<Value>, vector<Value>, VectorHash, VectorEqual>;
   class Scanner : public AggregateHashTable::Scanner
   {
   public:
@@ -75,36 +72,179 @@ public:
     RC next(Chunk &chunk) override;
 
   private:
-    StandardHashTable::iterator end_;
-    StandardHashTable::iterator it_;
+    int pos_ = 0;  ///< 下一个要输出的分组
+    int end_ = 0;
   };
-  StandardAggregateHashTable(const vector<Expression *> aggregations)
+
+  static constexpr int64_t DEFAULT_MEMORY_LIMIT = 256LL * 1024 * 1024;
+
+  StandardAggregateHashTable(const vector<Expression *> aggregations, int64_t memory_limit = DEFAULT_MEMORY_LIMIT)
+      : memory_limit_(memory_limit)
   {
     for (auto &expr : aggregations) {
       ASSERT(expr->type() == ExprType::AGGREGATION, "expect aggregate expression");
       auto *aggregation_expr = static_cast<AggregateExpr *>(expr);
       aggr_types_.push_back(aggregation_expr->aggregate_type());
     }
+    clear();
   }
 
   virtual ~StandardAggregateHashTable() {}
 
   RC add_chunk(Chunk &groups_chunk, Chunk &aggrs_chunk) override;
 
-  StandardHashTable::iterator begin() { return aggr_values_.begin(); }
-  StandardHashTable::iterator end() { return aggr_values_.end(); }
+  /// 哈希表中的分组数
+  int group_count() const { return static_cast<int>(row_hashes_.size()); }
+
+  /// 是否有数据写到了临时文件中。这时哈希表中只有部分聚合结果，需要通过 load_next_partition 逐个分区读取
+  bool spilled() const { return spilled_; }
+
+  /**
+   * @brief 把下一个分区的数据读到哈希表中，合并相同分组的部分聚合结果
+   * @return 没有分区时返回 RECORD_EOF
+   */
+  RC load_next_partition();
+
+  /**
+   * @brief 把另一个哈希表中的部分聚合结果合并到当前哈希表中
+   * @details 用于并行聚合：每个线程先聚合到自己的哈希表中，再按照哈希值分区，每个线程合并一个分区。
+   * 两个哈希表的聚合必须相同。other 写过临时文件时只合并它当前在内存中的数据。
+   * @param partition 只合并 partition_of(hash, partition_num) 等于 partition 的分组
+   */
+  RC merge(const StandardAggregateHashTable &other, int partition = 0, int partition_num = 1);
+
+  /**
+   * @brief 并行合并时分组所属的分区
+   * @details 使用哈希值的 32 到 63 位，槽位使用低位，不同分区的哈希表中槽位的分布不受影响
+   */
+  static int partition_of(uint64_t hash, int partition_num)
+  {
+    return static_cast<int>(static_cast<uint32_t>(hash >> 32) % static_cast<uint32_t>(partition_num));
+  }
+
+private:
+  /**
+   * @brief 行中的一个字段，即一个 group by 值或者一个聚合状态
+   */
+  struct Field
+  {
+    AttrType type   = AttrType::UNDEFINED;
+    int      offset = 0;  ///< 在行中的偏移
+    int      length = 0;
+  };
+
+  /**
+   * @brief 哈希表的槽位。保存哈希值的高位，大部分不相等的分组不需要访问行数据就可以排除
+   */
+  struct Slot
+  {
+    int32_t  row = -1;  ///< 分组的行号，-1 表示空槽位
+    uint32_t tag = 0;
+  };
+
+  /**
+   * @brief 根据第一个 chunk 中列的类型和长度确定行的格式
+   */
+  RC init_layout(Chunk &groups_chunk, Chunk &aggrs_chunk);
+
+  /**
+   * @brief 按列把选中行的 group by 值序列化到 input_keys_ 中，同时计算哈希值
+   */
+  void serialize_keys(Chunk &groups_chunk, const Chunk &rows_chunk);
+
+  /**
+   * @brief 查找分组，不存在时插入新的分组
+   * @return 分组的行号
+   */
+  int find_or_insert(const char *key, uint64_t hash);
+
+  /// 槽位数量扩大一倍，重新放置所有的分组
+  void grow();
+
+  /**
+   * @brief 用一列数据更新 input_groups_ 中每一行对应分组的聚合状态
+   */
+  void aggregate_column(int aggr_idx, const Column &column, const Chunk &rows_chunk);
+
+  /**
+   * @brief 把一个分组的部分聚合结果合并到哈希表中
+   * @param values group by 值、聚合结果，以及 AVG 的行数，与 row_values 的格式相同
+   */
+  void merge_values(const vector<Value> &values);
+
+  /**
+   * @brief 把格式相同的另一行的聚合状态合并到 row 中
+   */
+  void merge_row(char *row, const char *other) const;
+
+  /**
+   * @brief 把一个分组转换成 group by 值、聚合结果和 AVG 的行数，用于写临时文件
+   */
+  void row_values(int row, vector<Value> &values) const;
+
+  /**
+   * @brief 把 values 中的 group by 值序列化到 key 中
+   * @return group by 值的哈希值
+   */
+  uint64_t encode_key(const vector<Value> &values, char *key) const;
+
+  char       *row_data(int row) { return rows_.data() + static_cast<size_t>(row) * row_width_; }
+  const char *row_data(int row) const { return rows_.data() + static_cast<size_t>(row) * row_width_; }
+
+  /// 哈希表当前使用的内存
+  int64_t memory_usage() const;
+
+  /**
+   * @brief 超过内存限制时把哈希表中的数据写到临时文件中
+   */
+  RC spill_if_needed();
+
+  /**
+   * @brief 把哈希表中的数据按照分区写到临时文件中，并清空哈希表
+   */
+  RC spill(SpillPartitions &partitions);
+
+  void clear();
+
+  /**
+   * @brief 把所有分区文件放到待处理的分区中
+   */
+  void collect_partitions(SpillPartitions &partitions);
 
 private:
-  /// group by values -> aggregate values
-  StandardHashTable           aggr_values_;
+  static constexpr int INITIAL_SLOTS = 16;
+
   vector<AggregateExpr::Type> aggr_types_;
+
+  bool          layout_ready_ = false;
+  vector<Field> key_fields_;
+  vector<Field> state_fields_;  ///< 每个聚合的状态。MAX/MIN 的状态前面有一个字节标记是否已经有值
+  vector<int>   avg_count_offsets_;  ///< AVG 的行数(int)在行中的位置，其它聚合为 -1
+  int           key_width_ = 0;
+  int           row_width_ = 0;
+
+  vector<char>     rows_;        ///< 所有的分组，每个分组一行
+  vector<uint64_t> row_hashes_;  ///< 每个分组的哈希值，扩容和写临时文件时使用
+  vector<Slot>     slots_;
+  uint64_t         slot_mask_ = 0;
+
+  vector<char>     input_keys_;    ///< 当前 chunk 中选中行序列化后的 group by 值
+  vector<uint64_t> input_hashes_;  ///< 当前 chunk 中选中行的哈希值
+  vector<int>      input_groups_;  ///< 当前 chunk 中选中行所属分组的行号
+
+  int64_t memory_limit_ = DEFAULT_MEMORY_LIMIT;
+
+  bool                                     spilled_ = false;
+  unique_ptr<SpillPartitions>              partitions_;          ///< 聚合过程中写入的分区
+  vector<pair<unique_ptr<SpillFile>, int>> pending_partitions_;  ///< 待处理的分区和它的层数
+  vector<Value>                            spill_values_;
 };
 
 /**
  * @brief 线性探测哈希表实现
- * @note 当前只支持group by 列为 char/char(4) 类型，且聚合列为单列。
+ * @note 只支持一个 int 类型的 group by 列和一个 SUM 聚合列。容量必须是 2 的幂。
+ * 与 EMPTY_KEY 相等的键不放在哈希表中，单独保存。
  */
-#ifdef USE_SIMD
 template <typename V>
 class LinearProbingAggregateHashTable : public AggregateHashTable
 {
@@ -122,15 +262,18 @@ public:
     void close_scan() override;
 
   private:
-    int capacity_   = -1;
-    int size_       = -1;
-    int scan_pos_   = -1;
-    int scan_count_ = 0;
+    int  capacity_      = -1;
+    int  size_          = -1;
+    int  scan_pos_      = -1;
+    int  scan_count_    = 0;
+    bool empty_key_done_ = false;  ///< 单独保存的 EMPTY_KEY 是否已经输出
   };
 
   LinearProbingAggregateHashTable(AggregateExpr::Type aggregate_type, int capacity = DEFAULT_CAPACITY)
       : keys_(capacity, EMPTY_KEY), values_(capacity, 0), capacity_(capacity), aggregate_type_(aggregate_type)
-  {}
+  {
+    ASSERT(capacity > 0 && (capacity & (capacity - 1)) == 0, "capacity must be power of 2. capacity=%d", capacity);
+  }
   virtual ~LinearProbingAggregateHashTable() {}
 
   RC get(int key, V &value);
@@ -146,18 +289,33 @@ private:
   /**
    * @brief 将键值对以批量的形式写入哈希表中，这里参考了论文
    * `Rethinking SIMD Vectorization for In-Memory Databases` 中的 `Algorithm 5`。
+   * @details 根据当前的 SIMD 级别选择一次探测 16 个键(AVX-512)或者 8 个键(AVX2)，否则逐个写入。
    * @param input_keys 输入的键数组
    * @param input_values 输入的值数组，与键数组一一对应。
    * @param len 键值对数组的长度
    */
   void add_batch(int *input_keys, V *input_values, int len);
 
+  /**
+   * @brief 一次探测 WIDTH 个键，probe 计算探测位置并用 SIMD 指令比较哈希表中的键
+   * @return 已经处理的输入个数，剩余的输入和没有完成的键已经用标量方式写入
+   */
+  template <int WIDTH, typename Probe>
+  int add_batch(int *input_keys, V *input_values, int len, Probe probe);
+
   void aggregate(V *value, V value_to_aggregate);
 
+  /**
+   * @brief 用标量的方式写入一个键值对
+   */
+  void add_one(int key, V value);
+
   void resize();
 
   void resize_if_need();
 
+  int hash_index(int key) const { return key & (capacity_ - 1); }
+
 private:
   static const int EMPTY_KEY;
   static const int DEFAULT_CAPACITY;
@@ -167,5 +325,10 @@ private:
   int                 size_     = 0;
   int                 capacity_ = 0;
   AggregateExpr::Type aggregate_type_;
+
+  bool has_empty_key_   = false;  ///< 是否出现过与 EMPTY_KEY 相等的键
+  V    empty_key_value_ = 0;
+
+  vector<int> input_keys_;  ///< add_chunk 时把选中的行复制到连续的内存中
+  vector<V>   input_values_;
 };
-#endif  // USE_SIMD
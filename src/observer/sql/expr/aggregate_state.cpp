@@ -8,26 +8,84 @@ EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
 MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
-#include "sql/expr/aggregate_state.h"
+#include <type_traits>
 
-#ifdef USE_SIMD
 #include "common/math/simd_util.h"
-#endif
+#include "sql/expr/aggregate_state.h"
+
 template <typename T>
 void SumState<T>::update(const T *values, int size)
 {
-#ifdef USE_SIMD
-  if constexpr (is_same<T, float>::value) {
-    value += mm256_sum_ps(values, size);
-  } else if constexpr (is_same<T, int>::value) {
-    value += mm256_sum_epi32(values, size);
+  if constexpr (std::is_same<T, float>::value) {
+    value += simd_sum_ps(values, size);
+  } else if constexpr (std::is_same<T, int>::value) {
+    value += simd_sum_epi32(values, size);
+  } else {
+    for (int i = 0; i < size; ++i) {
+      value += values[i];
+    }
+  }
+}
+
+template <typename T>
+void SumState<T>::update(const T *values, const int *sel, int size)
+{
+  for (int i = 0; i < size; ++i) {
+    value += values[sel[i]];
+  }
+}
+
+template <typename T>
+void MaxState<T>::update(const T *values, int size)
+{
+  for (int i = 0; i < size; ++i) {
+    value = values[i] > value ? values[i] : value;
   }
-#else
+}
+
+template <typename T>
+void MaxState<T>::update(const T *values, const int *sel, int size)
+{
   for (int i = 0; i < size; ++i) {
- 	  value += values[i];
+    value = values[sel[i]] > value ? values[sel[i]] : value;
   }
-#endif
+}
+
+template <typename T>
+void MinState<T>::update(const T *values, int size)
+{
+  for (int i = 0; i < size; ++i) {
+    value = values[i] < value ? values[i] : value;
+  }
+}
+
+template <typename T>
+void MinState<T>::update(const T *values, const int *sel, int size)
+{
+  for (int i = 0; i < size; ++i) {
+    value = values[sel[i]] < value ? values[sel[i]] : value;
+  }
+}
+
+template <typename T>
+void AvgState<T>::update(const T *values, int size)
+{
+  sum.update(values, size);
+  count += size;
+}
+
+template <typename T>
+void AvgState<T>::update(const T *values, const int *sel, int size)
+{
+  sum.update(values, sel, size);
+  count += size;
 }
 
 template class SumState<int>;
 template class SumState<float>;
+template class MaxState<int>;
+template class MaxState<float>;
+template class MinState<int>;
+template class MinState<float>;
+template class AvgState<int>;
+template class AvgState<float>;
@@ -8,6 +8,10 @@ EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
 MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
+#pragma once
+
+#include "common/lang/limits.h"
+
 template <class T>
 class SumState
 {
@@ -15,4 +19,64 @@ public:
   SumState() : value(0) {}
   T    value;
   void update(const T *values, int size);
-};
\ No newline at end of file
+  /// 只累加 sel 中的 size 行
+  void update(const T *values, const int *sel, int size);
+  /// 合并另一个线程计算的部分结果
+  void merge(const SumState &other) { value += other.value; }
+};
+
+/**
+ * @brief COUNT 只统计行数，不读取数据。模板参数只是为了与其它状态使用相同的接口
+ */
+template <class T>
+class CountState
+{
+public:
+  CountState() : value(0) {}
+  int  value;
+  void update(const T *values, int size) { value += size; }
+  void update(const T *values, const int *sel, int size) { value += size; }
+  void merge(const CountState &other) { value += other.value; }
+};
+
+template <class T>
+class MaxState
+{
+public:
+  MaxState() : value(numeric_limits<T>::lowest()) {}
+  T    value;
+  void update(const T *values, int size);
+  void update(const T *values, const int *sel, int size);
+  void merge(const MaxState &other) { value = other.value > value ? other.value : value; }
+};
+
+template <class T>
+class MinState
+{
+public:
+  MinState() : value(numeric_limits<T>::max()) {}
+  T    value;
+  void update(const T *values, int size);
+  void update(const T *values, const int *sel, int size);
+  void merge(const MinState &other) { value = other.value < value ? other.value : value; }
+};
+
+/**
+ * @brief AVG 的结果总是浮点数，由 sum 和 count 在输出时计算
+ */
+template <class T>
+class AvgState
+{
+public:
+  AvgState() : count(0) {}
+  SumState<T> sum;
+  int         count;
+  void        update(const T *values, int size);
+  void        update(const T *values, const int *sel, int size);
+  void        merge(const AvgState &other)
+  {
+    sum.merge(other.sum);
+    count += other.count;
+  }
+  float value() const { return count == 0 ? 0 : static_cast<float>(sum.value) / count; }
+};
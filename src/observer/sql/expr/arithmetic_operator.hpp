@@ -10,189 +10,119 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
-#if defined(USE_SIMD)
-#include "common/math/simd_util.h"
-#endif
+#include <type_traits>
 
+#include "common/math/simd_util.h"
 #include "storage/common/column.h"
 
 struct Equal
 {
+  static constexpr SimdCompare SIMD_OP = SimdCompare::EQ;
+
   template <class T>
   static inline bool operation(const T &left, const T &right)
   {
     return left == right;
   }
-#if defined(USE_SIMD)
-  static inline __m256 operation(const __m256 &left, const __m256 &right)
-  {
-    return _mm256_cmp_ps(left, right, _CMP_EQ_OS);
-  }
-
-  static inline __m256i operation(const __m256i &left, const __m256i &right) { return _mm256_cmpeq_epi32(left, right); }
-#endif
 };
 struct NotEqual
 {
+  static constexpr SimdCompare SIMD_OP = SimdCompare::NE;
+
   template <class T>
   static inline bool operation(const T &left, const T &right)
   {
     return left != right;
   }
-#if defined(USE_SIMD)
-  static inline __m256 operation(const __m256 &left, const __m256 &right)
-  {
-    return _mm256_cmp_ps(left, right, _CMP_NEQ_OS);
-  }
-
-  static inline __m256i operation(const __m256i &left, const __m256i &right)
-  {
-    return _mm256_xor_si256(_mm256_set1_epi32(-1), _mm256_cmpeq_epi32(left, right));
-  }
-#endif
 };
 
 struct GreatThan
 {
+  static constexpr SimdCompare SIMD_OP = SimdCompare::GT;
+
   template <class T>
   static inline bool operation(const T &left, const T &right)
   {
     return left > right;
   }
-#if defined(USE_SIMD)
-  static inline __m256 operation(const __m256 &left, const __m256 &right)
-  {
-    return _mm256_cmp_ps(left, right, _CMP_GT_OS);
-  }
-
-  static inline __m256i operation(const __m256i &left, const __m256i &right) { return _mm256_cmpgt_epi32(left, right); }
-#endif
 };
 
 struct GreatEqual
 {
+  static constexpr SimdCompare SIMD_OP = SimdCompare::GE;
+
   template <class T>
   static inline bool operation(const T &left, const T &right)
   {
     return left >= right;
   }
-
-#if defined(USE_SIMD)
-  static inline __m256 operation(const __m256 &left, const __m256 &right)
-  {
-    return _mm256_cmp_ps(left, right, _CMP_GE_OS);
-  }
-
-  static inline __m256i operation(const __m256i &left, const __m256i &right)
-  {
-    return _mm256_cmpgt_epi32(left, right) | _mm256_cmpeq_epi32(left, right);
-  }
-#endif
 };
 
 struct LessThan
 {
+  static constexpr SimdCompare SIMD_OP = SimdCompare::LT;
+
   template <class T>
   static inline bool operation(const T &left, const T &right)
   {
     return left < right;
   }
-#if defined(USE_SIMD)
-  static inline __m256 operation(const __m256 &left, const __m256 &right)
-  {
-    return _mm256_cmp_ps(left, right, _CMP_LT_OS);
-  }
-
-  static inline __m256i operation(const __m256i &left, const __m256i &right) { return _mm256_cmpgt_epi32(right, left); }
-#endif
 };
 
 struct LessEqual
 {
+  static constexpr SimdCompare SIMD_OP = SimdCompare::LE;
+
   template <class T>
   static inline bool operation(const T &left, const T &right)
   {
     return left <= right;
   }
-#if defined(USE_SIMD)
-  static inline __m256 operation(const __m256 &left, const __m256 &right)
-  {
-    return _mm256_cmp_ps(left, right, _CMP_LE_OS);
-  }
-
-  static inline __m256i operation(const __m256i &left, const __m256i &right)
-  {
-    return _mm256_or_si256(_mm256_cmpgt_epi32(right, left), _mm256_cmpeq_epi32(left, right));
-  }
-#endif
 };
 
 struct AddOperator
 {
+  static constexpr SimdArithmetic SIMD_OP = SimdArithmetic::ADD;
+
   template <class T>
   static inline T operation(T left, T right)
   {
     return left + right;
   }
-
-#if defined(USE_SIMD)
-  static inline __m256 operation(__m256 left, __m256 right) { return _mm256_add_ps(left, right); }
-
-  static inline __m256i operation(__m256i left, __m256i right) { return _mm256_add_epi32(left, right); }
-#endif
 };
 
 struct SubtractOperator
 {
+  static constexpr SimdArithmetic SIMD_OP = SimdArithmetic::SUB;
+
   template <class T>
   static inline T operation(T left, T right)
   {
     return left - right;
   }
-  // your code here
-#if defined(USE_SIMD)
-  static inline __m256 operation(__m256 left, __m256 right) { exit(-1); }
-
-  static inline __m256i operation(__m256i left, __m256i right) { exit(-1); }
-#endif
 };
 
 struct MultiplyOperator
 {
+  static constexpr SimdArithmetic SIMD_OP = SimdArithmetic::MUL;
+
   template <class T>
   static inline T operation(T left, T right)
   {
     return left * right;
   }
-// your code here
-#if defined(USE_SIMD)
-  static inline __m256 operation(__m256 left, __m256 right) { exit(-1); }
-
-  static inline __m256i operation(__m256i left, __m256i right) { exit(-1); }
-#endif
 };
 
 struct DivideOperator
 {
+  static constexpr SimdArithmetic SIMD_OP = SimdArithmetic::DIV;
+
   template <class T>
   static inline T operation(T left, T right)
   {
     // TODO: `right = 0` is invalid
     return left / right;
   }
-
-#if defined(USE_SIMD)
-  static inline __m256  operation(__m256 left, __m256 right) { return _mm256_div_ps(left, right); }
-  static inline __m256i operation(__m256i left, __m256i right)
-  {
-
-    __m256 left_float   = _mm256_cvtepi32_ps(left);
-    __m256 right_float  = _mm256_cvtepi32_ps(right);
-    __m256 result_float = _mm256_div_ps(left_float, right_float);
-    return _mm256_cvttps_epi32(result_float);
-    ;
-  }
-#endif
 };
 
 struct NegateOperator
@@ -204,131 +134,39 @@ struct NegateOperator
   }
 };
 
+/**
+ * @details int 和 float 使用 SIMD 算子，算子的指令集在启动时根据 CPU 选择，参考 simd_kernels
+ */
 template <typename T, bool LEFT_CONSTANT, bool RIGHT_CONSTANT, class OP>
 void compare_operation(T *left, T *right, int n, vector<uint8_t> &result)
 {
-#if defined(USE_SIMD)
-  int           i          = 0;
-  if constexpr (is_same<T, float>::value) {
-    for (; i <= n - SIMD_WIDTH; i += SIMD_WIDTH) {
-      __m256 left_value, right_value;
-
-      if constexpr (LEFT_CONSTANT) {
-        left_value = _mm256_set1_ps(left[0]);
-      } else {
-        left_value = _mm256_loadu_ps(&left[i]);
-      }
-
-      if constexpr (RIGHT_CONSTANT) {
-        right_value = _mm256_set1_ps(right[0]);
-      } else {
-        right_value = _mm256_loadu_ps(&right[i]);
-      }
-
-      __m256  result_values = OP::operation(left_value, right_value);
-      __m256i mask          = _mm256_castps_si256(result_values);
-
-      for (int j = 0; j < SIMD_WIDTH; j++) {
-        result[i + j] &= mm256_extract_epi32_var_indx(mask, j) ? 1 : 0;
-      }
-    }
-  } else if constexpr (is_same<T, int>::value) {
-    for (; i <= n - SIMD_WIDTH; i += SIMD_WIDTH) {
-      __m256i left_value, right_value;
-
-      if (LEFT_CONSTANT) {
-        left_value = _mm256_set1_epi32(left[0]);
-      } else {
-        left_value = _mm256_loadu_si256((__m256i *)&left[i]);
-      }
-
-      if (RIGHT_CONSTANT) {
-        right_value = _mm256_set1_epi32(right[0]);
-      } else {
-        right_value = _mm256_loadu_si256((__m256i *)&right[i]);
-      }
-
-      __m256i result_values = OP::operation(left_value, right_value);
-
-      for (int j = 0; j < SIMD_WIDTH; j++) {
-        result[i + j] &= mm256_extract_epi32_var_indx(result_values, j) ? 1 : 0;
-      }
+  if constexpr (std::is_same<T, int>::value) {
+    simd_kernels().compare_epi32(OP::SIMD_OP, left, LEFT_CONSTANT, right, RIGHT_CONSTANT, n, result.data());
+  } else if constexpr (std::is_same<T, float>::value) {
+    simd_kernels().compare_ps(OP::SIMD_OP, left, LEFT_CONSTANT, right, RIGHT_CONSTANT, n, result.data());
+  } else {
+    for (int i = 0; i < n; i++) {
+      auto &left_value  = left[LEFT_CONSTANT ? 0 : i];
+      auto &right_value = right[RIGHT_CONSTANT ? 0 : i];
+      result[i] &= OP::operation(left_value, right_value) ? 1 : 0;
     }
   }
-
-  for (; i < n; i++) {
-    auto &left_value  = left[LEFT_CONSTANT ? 0 : i];
-    auto &right_value = right[RIGHT_CONSTANT ? 0 : i];
-    result[i] &= OP::operation(left_value, right_value) ? 1 : 0;
-  }
-#else
-  for (int i = 0; i < n; i++) {
-    auto &left_value  = left[LEFT_CONSTANT ? 0 : i];
-    auto &right_value = right[RIGHT_CONSTANT ? 0 : i];
-    result[i] &= OP::operation(left_value, right_value) ? 1 : 0;
-  }
-#endif
 }
 
 template <bool LEFT_CONSTANT, bool RIGHT_CONSTANT, typename T, class OP>
 void binary_operator(T *left_data, T *right_data, T *result_data, int size)
 {
-#if defined(USE_SIMD)
-  int i = 0;
-
-  if constexpr (is_same<T, float>::value) {
-    for (; i <= size - SIMD_WIDTH; i += SIMD_WIDTH) {
-      __m256 left_value, right_value;
-
-      if (LEFT_CONSTANT) {
-        left_value = _mm256_set1_ps(left_data[0]);
-      } else {
-        left_value = _mm256_loadu_ps(&left_data[i]);
-      }
-
-      if (RIGHT_CONSTANT) {
-        right_value = _mm256_set1_ps(right_data[0]);
-      } else {
-        right_value = _mm256_loadu_ps(&right_data[i]);
-      }
-
-      __m256 result_value = OP::operation(left_value, right_value);
-      _mm256_storeu_ps(&result_data[i], result_value);
+  if constexpr (std::is_same<T, int>::value) {
+    simd_kernels().arithmetic_epi32(OP::SIMD_OP, left_data, LEFT_CONSTANT, right_data, RIGHT_CONSTANT, result_data, size);
+  } else if constexpr (std::is_same<T, float>::value) {
+    simd_kernels().arithmetic_ps(OP::SIMD_OP, left_data, LEFT_CONSTANT, right_data, RIGHT_CONSTANT, result_data, size);
+  } else {
+    for (int i = 0; i < size; i++) {
+      auto &left_value  = left_data[LEFT_CONSTANT ? 0 : i];
+      auto &right_value = right_data[RIGHT_CONSTANT ? 0 : i];
+      result_data[i]    = OP::template operation<T>(left_value, right_value);
     }
-  } else if constexpr (is_same<T, int>::value) {
-    for (; i <= size - SIMD_WIDTH; i += SIMD_WIDTH) {
-      __m256i left_value, right_value;
-
-      if (LEFT_CONSTANT) {
-        left_value = _mm256_set1_epi32(left_data[0]);
-      } else {
-        left_value = _mm256_loadu_si256((const __m256i *)&left_data[i]);
-      }
-
-      if (RIGHT_CONSTANT) {
-        right_value = _mm256_set1_epi32(right_data[0]);
-      } else {
-        right_value = _mm256_loadu_si256((const __m256i *)&right_data[i]);
-      }
-
-      __m256i result_value = OP::operation(left_value, right_value);
-      _mm256_storeu_si256((__m256i *)&result_data[i], result_value);
-    }
-  }
-
-  // 处理剩余未对齐的数据
-  for (; i < size; i++) {
-    auto &left_value  = left_data[LEFT_CONSTANT ? 0 : i];
-    auto &right_value = right_data[RIGHT_CONSTANT ? 0 : i];
-    result_data[i]    = OP::template operation<T>(left_value, right_value);
-  }
-#else
-  for (int i = 0; i < size; i++) {
-    auto &left_value  = left_data[LEFT_CONSTANT ? 0 : i];
-    auto &right_value = right_data[RIGHT_CONSTANT ? 0 : i];
-    result_data[i]    = OP::template operation<T>(left_value, right_value);
   }
-#endif
 }
 
 template <bool CONSTANT, typename T, class OP>
@@ -340,7 +178,6 @@ void unary_operator(T *input, T *result_data, int size)
   }
 }
 
-// TODO: optimized with simd
 template <typename T, bool LEFT_CONSTANT, bool RIGHT_CONSTANT>
 void compare_result(T *left, T *right, int n, vector<uint8_t> &result, CompOp op)
 {
@@ -372,3 +209,51 @@ void compare_result(T *left, T *right, int n, vector<uint8_t> &result, CompOp op
     default: break;
   }
 }
+
+/**
+ * @brief 比较两列数据，把满足条件的行号按顺序写到 result_sel 中
+ * @param sel 需要比较的行号，为 nullptr 时比较 [0, n) 中的所有行
+ * @param n 需要比较的行数
+ * @param result_sel 输出满足条件的行号，可以与 sel 是同一个数组
+ * @return 满足条件的行数
+ * @details int 和 float 使用当前级别的 SIMD 算子，一次比较一个向量宽度的行，得到比较结果的掩码。
+ * 有选择向量时用 gather 指令按照行号读取数据，不需要先把数据复制到连续的内存中。
+ */
+template <typename T, bool LEFT_CONSTANT, bool RIGHT_CONSTANT, class OP>
+int select_operation(const T *left, const T *right, const int *sel, int n, int *result_sel)
+{
+  if constexpr (std::is_same<T, int>::value) {
+    return simd_kernels().select_epi32(OP::SIMD_OP, left, LEFT_CONSTANT, right, RIGHT_CONSTANT, sel, n, result_sel);
+  } else if constexpr (std::is_same<T, float>::value) {
+    return simd_kernels().select_ps(OP::SIMD_OP, left, LEFT_CONSTANT, right, RIGHT_CONSTANT, sel, n, result_sel);
+  } else {
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+      const int row         = sel == nullptr ? i : sel[i];
+      const T  &left_value  = left[LEFT_CONSTANT ? 0 : row];
+      const T  &right_value = right[RIGHT_CONSTANT ? 0 : row];
+      result_sel[count]     = row;
+      count += OP::template operation<T>(left_value, right_value) ? 1 : 0;
+    }
+    return count;
+  }
+}
+
+template <typename T, bool LEFT_CONSTANT, bool RIGHT_CONSTANT>
+int compare_select(const T *left, const T *right, const int *sel, int n, int *result_sel, CompOp op)
+{
+  switch (op) {
+    case CompOp::EQUAL_TO: return select_operation<T, LEFT_CONSTANT, RIGHT_CONSTANT, Equal>(left, right, sel, n, result_sel);
+    case CompOp::NOT_EQUAL:
+      return select_operation<T, LEFT_CONSTANT, RIGHT_CONSTANT, NotEqual>(left, right, sel, n, result_sel);
+    case CompOp::GREAT_EQUAL:
+      return select_operation<T, LEFT_CONSTANT, RIGHT_CONSTANT, GreatEqual>(left, right, sel, n, result_sel);
+    case CompOp::GREAT_THAN:
+      return select_operation<T, LEFT_CONSTANT, RIGHT_CONSTANT, GreatThan>(left, right, sel, n, result_sel);
+    case CompOp::LESS_EQUAL:
+      return select_operation<T, LEFT_CONSTANT, RIGHT_CONSTANT, LessEqual>(left, right, sel, n, result_sel);
+    case CompOp::LESS_THAN:
+      return select_operation<T, LEFT_CONSTANT, RIGHT_CONSTANT, LessThan>(left, right, sel, n, result_sel);
+    default: return 0;
+  }
+}
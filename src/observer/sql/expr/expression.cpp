@@ -18,6 +18,26 @@ See the Mulan PSL v2 for more details. */
 
 using namespace std;
 
+RC Expression::filter(Chunk &chunk, vector<int> &selection)
+{
+  Column column;
+  RC     rc = get_column(chunk, column);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get column of expression. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  const bool is_const = column.column_type() == Column::Type::CONSTANT_COLUMN;
+  size_t     count    = 0;
+  for (int row : selection) {
+    if (column.get_value(is_const ? 0 : row).get_boolean()) {
+      selection[count++] = row;
+    }
+  }
+  selection.resize(count);
+  return RC::SUCCESS;
+}
+
 RC FieldExpr::get_value(const Tuple &tuple, Value &value) const
 {
   return tuple.find_cell(TupleCellSpec(table_name(), field_name()), value);
@@ -249,6 +269,88 @@ RC ComparisonExpr::compare_column(const Column &left, const Column &right, vecto
   return rc;
 }
 
+/**
+ * @brief selection 是否包含 chunk 中的所有行，这时可以连续读取数据
+ */
+static bool is_dense_selection(const vector<int> &selection, int rows)
+{
+  return static_cast<int>(selection.size()) == rows && (rows == 0 || selection.back() == rows - 1);
+}
+
+RC ComparisonExpr::filter(Chunk &chunk, vector<int> &selection)
+{
+  if (selection.empty()) {
+    return RC::SUCCESS;
+  }
+
+  Column left_column;
+  Column right_column;
+  RC     rc = left_->get_column(chunk, left_column);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get value of left expression. rc=%s", strrc(rc));
+    return rc;
+  }
+  rc = right_->get_column(chunk, right_column);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get value of right expression. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  const AttrType left_type  = left_column.attr_type();
+  const AttrType right_type = right_column.attr_type();
+  if (left_type == right_type && (left_type == AttrType::INTS || left_type == AttrType::DATES)) {
+    filter_column<int>(left_column, right_column, selection, is_dense_selection(selection, chunk.rows()));
+  } else if (left_type == right_type && left_type == AttrType::FLOATS) {
+    filter_column<float>(left_column, right_column, selection, is_dense_selection(selection, chunk.rows()));
+  } else {
+    rc = filter_value(left_column, right_column, selection);
+  }
+  return rc;
+}
+
+template <typename T>
+void ComparisonExpr::filter_column(const Column &left, const Column &right, vector<int> &selection, bool dense) const
+{
+  const T   *left_data   = reinterpret_cast<const T *>(left.data());
+  const T   *right_data  = reinterpret_cast<const T *>(right.data());
+  const int *sel         = dense ? nullptr : selection.data();
+  const int  n           = static_cast<int>(selection.size());
+  const bool left_const  = left.column_type() == Column::Type::CONSTANT_COLUMN;
+  const bool right_const = right.column_type() == Column::Type::CONSTANT_COLUMN;
+
+  int count = 0;
+  if (left_const && right_const) {
+    count = compare_select<T, true, true>(left_data, right_data, sel, n, selection.data(), comp_);
+  } else if (left_const) {
+    count = compare_select<T, true, false>(left_data, right_data, sel, n, selection.data(), comp_);
+  } else if (right_const) {
+    count = compare_select<T, false, true>(left_data, right_data, sel, n, selection.data(), comp_);
+  } else {
+    count = compare_select<T, false, false>(left_data, right_data, sel, n, selection.data(), comp_);
+  }
+  selection.resize(count);
+}
+
+RC ComparisonExpr::filter_value(const Column &left, const Column &right, vector<int> &selection) const
+{
+  const bool left_const  = left.column_type() == Column::Type::CONSTANT_COLUMN;
+  const bool right_const = right.column_type() == Column::Type::CONSTANT_COLUMN;
+
+  size_t count = 0;
+  for (int row : selection) {
+    bool result = false;
+    RC   rc     = compare_value(left.get_value(left_const ? 0 : row), right.get_value(right_const ? 0 : row), result);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    if (result) {
+      selection[count++] = row;
+    }
+  }
+  selection.resize(count);
+  return RC::SUCCESS;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ConjunctionExpr::ConjunctionExpr(Type type, vector<unique_ptr<Expression>> &children)
     : conjunction_type_(type), children_(std::move(children))
@@ -281,6 +383,56 @@ RC ConjunctionExpr::get_value(const Tuple &tuple, Value &value) const
   return rc;
 }
 
+RC ConjunctionExpr::filter(Chunk &chunk, vector<int> &selection)
+{
+  RC rc = RC::SUCCESS;
+  if (conjunction_type_ == Type::AND) {
+    for (unique_ptr<Expression> &child : children_) {
+      if (selection.empty()) {
+        break;
+      }
+      rc = child->filter(chunk, selection);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+    return rc;
+  }
+
+  if (children_.empty()) {
+    return rc;
+  }
+
+  // OR: remaining 是还没有满足任何一个子表达式的行，matched 是已经满足条件的行，两者都是有序的
+  vector<int> remaining = selection;
+  vector<int> matched;
+  vector<int> candidates;
+  vector<int> merged;
+  for (unique_ptr<Expression> &child : children_) {
+    if (remaining.empty()) {
+      break;
+    }
+    candidates = remaining;
+    rc         = child->filter(chunk, candidates);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    if (candidates.empty()) {
+      continue;
+    }
+
+    merged.clear();
+    set_union(matched.begin(), matched.end(), candidates.begin(), candidates.end(), back_inserter(merged));
+    matched.swap(merged);
+
+    merged.clear();
+    set_difference(remaining.begin(), remaining.end(), candidates.begin(), candidates.end(), back_inserter(merged));
+    remaining.swap(merged);
+  }
+  selection.swap(matched);
+  return rc;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 ArithmeticExpr::ArithmeticExpr(ArithmeticExpr::Type type, Expression *left, Expression *right)
@@ -538,6 +690,24 @@ RC AggregateExpr::get_column(Chunk &chunk, Column &column)
   return rc;
 }
 
+AttrType AggregateExpr::value_type() const
+{
+  switch (aggregate_type_) {
+    case Type::COUNT: return AttrType::INTS;
+    case Type::AVG: return AttrType::FLOATS;
+    default: return child_->value_type();
+  }
+}
+
+int AggregateExpr::value_length() const
+{
+  switch (aggregate_type_) {
+    case Type::COUNT: return sizeof(int);
+    case Type::AVG: return sizeof(float);
+    default: return child_->value_length();
+  }
+}
+
 bool AggregateExpr::equal(const Expression &other) const
 {
   if (this == &other) {
@@ -558,6 +728,22 @@ unique_ptr<Aggregator> AggregateExpr::create_aggregator() const
       aggregator = make_unique<SumAggregator>();
       break;
     }
+    case Type::COUNT: {
+      aggregator = make_unique<CountAggregator>();
+      break;
+    }
+    case Type::AVG: {
+      aggregator = make_unique<AvgAggregator>();
+      break;
+    }
+    case Type::MAX: {
+      aggregator = make_unique<MaxAggregator>();
+      break;
+    }
+    case Type::MIN: {
+      aggregator = make_unique<MinAggregator>();
+      break;
+    }
     default: {
       ASSERT(false, "unsupported aggregate type");
       break;
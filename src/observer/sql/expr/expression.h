@@ -128,6 +128,14 @@ public:
    */
   virtual RC eval(Chunk &chunk, vector<uint8_t> &select) { return RC::UNIMPLEMENTED; }
 
+  /**
+   * @brief 在 chunk 上计算过滤条件，只保留 selection 中满足条件的行
+   * @param selection 按升序保存需要计算的行号，计算后只剩下满足条件的行
+   * @details 用于向量化执行的过滤，只计算 selection 中的行，不会移动 chunk 中的数据。
+   * 默认通过 get_column 计算出整列的值，再逐行判断是否为真
+   */
+  virtual RC filter(Chunk &chunk, vector<int> &selection);
+
 protected:
   /**
    * @brief 表达式在下层算子返回的 chunk 中的位置
@@ -312,6 +320,11 @@ public:
    */
   RC eval(Chunk &chunk, vector<uint8_t> &select) override;
 
+  /**
+   * @brief 整数、日期和浮点数使用向量化的比较，其它类型逐行比较
+   */
+  RC filter(Chunk &chunk, vector<int> &selection) override;
+
   unique_ptr<Expression> &left() { return left_; }
   unique_ptr<Expression> &right() { return right_; }
 
@@ -330,6 +343,12 @@ public:
   template <typename T>
   RC compare_column(const Column &left, const Column &right, vector<uint8_t> &result) const;
 
+private:
+  template <typename T>
+  void filter_column(const Column &left, const Column &right, vector<int> &selection, bool dense) const;
+
+  RC filter_value(const Column &left, const Column &right, vector<int> &selection) const;
+
 private:
   CompOp                 comp_;
   unique_ptr<Expression> left_;
@@ -368,6 +387,11 @@ public:
   AttrType value_type() const override { return AttrType::BOOLEANS; }
   RC       get_value(const Tuple &tuple, Value &value) const override;
 
+  /**
+   * @brief AND 依次用每个子表达式缩小 selection；OR 只在还没有满足条件的行上计算下一个子表达式，最后合并结果
+   */
+  RC filter(Chunk &chunk, vector<int> &selection) override;
+
   Type conjunction_type() const { return conjunction_type_; }
 
   vector<unique_ptr<Expression>> &children() { return children_; }
@@ -493,8 +517,11 @@ public:
 
   ExprType type() const override { return ExprType::AGGREGATION; }
 
-  AttrType value_type() const override { return child_->value_type(); }
-  int      value_length() const override { return child_->value_length(); }
+  /**
+   * @brief 聚合结果的类型。COUNT 总是整数，AVG 总是浮点数，其它与参数类型相同
+   */
+  AttrType value_type() const override;
+  int      value_length() const override;
 
   RC get_value(const Tuple &tuple, Value &value) const override;
 
@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 #include "sql/expr/aggregate_state.h"
 #include "sql/expr/expression_tuple.h"
 #include "sql/expr/composite_tuple.h"
+#include "sql/operator/parallel_executor.h"
 
 using namespace common;
 
@@ -33,79 +34,265 @@ AggregateVecPhysicalOperator::AggregateVecPhysicalOperator(vector<Expression *>
     auto &expr = aggregate_expressions_[i];
     ASSERT(expr->type() == ExprType::AGGREGATION, "expected an aggregation expression");
     auto *aggregate_expr = static_cast<AggregateExpr *>(expr);
+    ASSERT(support(*aggregate_expr), "not supported aggregation");
+    output_chunk_.add_column(make_unique<Column>(aggregate_expr->value_type(), aggregate_expr->value_length()), i);
+  }
+  init_values(aggr_values_);
+}
 
-    if (aggregate_expr->aggregate_type() == AggregateExpr::Type::SUM) {
-      if (aggregate_expr->value_type() == AttrType::INTS) {
-        void *aggr_value                     = malloc(sizeof(SumState<int>));
-        ((SumState<int> *)aggr_value)->value = 0;
-        aggr_values_.insert(aggr_value);
-        output_chunk_.add_column(make_unique<Column>(AttrType::INTS, sizeof(int)), i);
-      } else if (aggregate_expr->value_type() == AttrType::FLOATS) {
-        void *aggr_value                       = malloc(sizeof(SumState<float>));
-        ((SumState<float> *)aggr_value)->value = 0;
-        aggr_values_.insert(aggr_value);
-        output_chunk_.add_column(make_unique<Column>(AttrType::FLOATS, sizeof(float)), i);
-      }
+void AggregateVecPhysicalOperator::init_values(AggregateValues &values)
+{
+  for (size_t i = 0; i < aggregate_expressions_.size(); i++) {
+    auto *aggregate_expr = static_cast<AggregateExpr *>(aggregate_expressions_[i]);
+    if (value_expressions_[i]->value_type() == AttrType::FLOATS) {
+      values.insert(create_state<float>(aggregate_expr->aggregate_type()));
     } else {
-      ASSERT(false, "not supported aggregation type");
+      values.insert(create_state<int>(aggregate_expr->aggregate_type()));
     }
   }
 }
 
+bool AggregateVecPhysicalOperator::support(const AggregateExpr &aggregate_expr)
+{
+  switch (aggregate_expr.child()->value_type()) {
+    case AttrType::INTS:
+    case AttrType::FLOATS:
+    case AttrType::DATES: return true;
+    default: return aggregate_expr.aggregate_type() == AggregateExpr::Type::COUNT;
+  }
+}
+
+template <typename T>
+void *AggregateVecPhysicalOperator::create_state(AggregateExpr::Type aggregate_type)
+{
+  switch (aggregate_type) {
+    case AggregateExpr::Type::COUNT: return create_state<CountState<T>>();
+    case AggregateExpr::Type::SUM: return create_state<SumState<T>>();
+    case AggregateExpr::Type::AVG: return create_state<AvgState<T>>();
+    case AggregateExpr::Type::MAX: return create_state<MaxState<T>>();
+    case AggregateExpr::Type::MIN: return create_state<MinState<T>>();
+  }
+  return nullptr;
+}
+
 RC AggregateVecPhysicalOperator::open(Trx *trx)
 {
-  ASSERT(children_.size() == 1, "group by operator only support one child, but got %d", children_.size());
+  ASSERT(!children_.empty(), "aggregate operator should have at least one child");
+
+  RC rc = RC::SUCCESS;
+  child_closed_.assign(children_.size(), false);
+  for (unique_ptr<PhysicalOperator> &child : children_) {
+    rc = child->open(trx);
+    if (OB_FAIL(rc)) {
+      LOG_INFO("failed to open child operator. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
 
-  PhysicalOperator &child = *children_[0];
-  RC                rc    = child.open(trx);
+  rc = prepare_sink(static_cast<int>(children_.size()));
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  if (children_.size() > 1) {
+    rc = parallel_consume();
+  } else {
+    rc = consume(*children_[0], chunk_, 0);
+  }
   if (OB_FAIL(rc)) {
-    LOG_INFO("failed to open child operator. rc=%s", strrc(rc));
     return rc;
   }
+  return finish_sink();
+}
+
+vector<PhysicalOperator *> AggregateVecPhysicalOperator::sink_children()
+{
+  vector<PhysicalOperator *> children;
+  for (unique_ptr<PhysicalOperator> &child : children_) {
+    children.push_back(child.get());
+  }
+  return children;
+}
+
+RC AggregateVecPhysicalOperator::prepare_sink(int task_num)
+{
+  partial_values_.clear();
+  for (int i = 0; i < task_num; i++) {
+    partial_values_.push_back(make_unique<AggregateValues>());
+    init_values(*partial_values_.back());
+  }
+  partial_rows_.assign(task_num, 0);
+  rows_    = 0;
+  emitted_ = false;
+  return RC::SUCCESS;
+}
+
+RC AggregateVecPhysicalOperator::sink(int task, Chunk &chunk)
+{
+  if (chunk.selected_rows() == 0) {
+    return RC::SUCCESS;
+  }
+  partial_rows_[task] += chunk.selected_rows();
+
+  AggregateValues &values = *partial_values_[task];
+  for (size_t aggr_idx = 0; aggr_idx < aggregate_expressions_.size(); aggr_idx++) {
+    Column column;
+    RC     rc = value_expressions_[aggr_idx]->get_column(chunk, column);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get column of aggregation. rc=%s", strrc(rc));
+      return rc;
+    }
+    // 常量列只有一个值，比如 count(*)
+    column.expand_constant(chunk.rows());
+
+    ASSERT(aggregate_expressions_[aggr_idx]->type() == ExprType::AGGREGATION, "expect aggregate expression");
+    auto *aggregate_expr = static_cast<AggregateExpr *>(aggregate_expressions_[aggr_idx]);
+    if (value_expressions_[aggr_idx]->value_type() == AttrType::FLOATS) {
+      update_state<float>(aggregate_expr->aggregate_type(), values.at(aggr_idx), column, chunk);
+    } else {
+      update_state<int>(aggregate_expr->aggregate_type(), values.at(aggr_idx), column, chunk);
+    }
+  }
+  return RC::SUCCESS;
+}
 
-  while (OB_SUCC(rc = child.next(chunk_))) {
+RC AggregateVecPhysicalOperator::finish_sink()
+{
+  for (size_t i = 0; i < partial_values_.size(); i++) {
+    rows_ += partial_rows_[i];
     for (size_t aggr_idx = 0; aggr_idx < aggregate_expressions_.size(); aggr_idx++) {
-      Column column;
-      value_expressions_[aggr_idx]->get_column(chunk_, column);
-      ASSERT(aggregate_expressions_[aggr_idx]->type() == ExprType::AGGREGATION, "expect aggregate expression");
       auto *aggregate_expr = static_cast<AggregateExpr *>(aggregate_expressions_[aggr_idx]);
-      if (aggregate_expr->aggregate_type() == AggregateExpr::Type::SUM) {
-        if (aggregate_expr->value_type() == AttrType::INTS) {
-          update_aggregate_state<SumState<int>, int>(aggr_values_.at(aggr_idx), column);
-        } else if (aggregate_expr->value_type() == AttrType::FLOATS) {
-          update_aggregate_state<SumState<float>, float>(aggr_values_.at(aggr_idx), column);
-        } else {
-          ASSERT(false, "not supported value type");
-        }
+      if (value_expressions_[aggr_idx]->value_type() == AttrType::FLOATS) {
+        merge_state<float>(aggregate_expr->aggregate_type(), aggr_values_.at(aggr_idx), partial_values_[i]->at(aggr_idx));
       } else {
-        ASSERT(false, "not supported aggregation type");
+        merge_state<int>(aggregate_expr->aggregate_type(), aggr_values_.at(aggr_idx), partial_values_[i]->at(aggr_idx));
       }
     }
   }
+  LOG_TRACE("aggregation done. tasks=%d, rows=%ld", static_cast<int>(partial_values_.size()), rows_);
+  partial_values_.clear();
+  partial_rows_.clear();
+  return RC::SUCCESS;
+}
+
+RC AggregateVecPhysicalOperator::consume(PhysicalOperator &child, Chunk &chunk, int task)
+{
+  RC rc = RC::SUCCESS;
+  while (OB_SUCC(rc = child.next(chunk))) {
+    rc = sink(task, chunk);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
 
   if (rc == RC::RECORD_EOF) {
     rc = RC::SUCCESS;
   }
-
   return rc;
 }
+
+RC AggregateVecPhysicalOperator::parallel_consume()
+{
+  const int worker_num = static_cast<int>(children_.size());
+
+  RC rc = run_parallel(worker_num, [&](int i) {
+    Chunk chunk;
+    RC    rc = consume(*children_[i], chunk, i);
+    // 子算子在工作线程中关闭，表扫描持有的页面锁只能由加锁的线程释放
+    RC close_rc = children_[i]->close();
+    if (OB_FAIL(close_rc)) {
+      LOG_WARN("failed to close child operator of aggregate. rc=%s", strrc(close_rc));
+    }
+    return rc;
+  });
+  child_closed_.assign(children_.size(), true);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to aggregate in parallel. rc=%s", strrc(rc));
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+template <typename T>
+void AggregateVecPhysicalOperator::update_state(
+    AggregateExpr::Type aggregate_type, void *state, const Column &column, const Chunk &chunk)
+{
+  switch (aggregate_type) {
+    case AggregateExpr::Type::COUNT: update_aggregate_state<CountState<T>, T>(state, column, chunk); break;
+    case AggregateExpr::Type::SUM: update_aggregate_state<SumState<T>, T>(state, column, chunk); break;
+    case AggregateExpr::Type::AVG: update_aggregate_state<AvgState<T>, T>(state, column, chunk); break;
+    case AggregateExpr::Type::MAX: update_aggregate_state<MaxState<T>, T>(state, column, chunk); break;
+    case AggregateExpr::Type::MIN: update_aggregate_state<MinState<T>, T>(state, column, chunk); break;
+  }
+}
+
 template <class STATE, typename T>
-void AggregateVecPhysicalOperator::update_aggregate_state(void *state, const Column &column)
+void AggregateVecPhysicalOperator::update_aggregate_state(void *state, const Column &column, const Chunk &chunk)
 {
   STATE *state_ptr = reinterpret_cast<STATE *>(state);
   T *    data      = (T *)column.data();
-  state_ptr->update(data, column.count());
+  if (chunk.has_selection()) {
+    state_ptr->update(data, chunk.selection().data(), chunk.selected_rows());
+  } else {
+    state_ptr->update(data, column.count());
+  }
+}
+
+template <typename T>
+void AggregateVecPhysicalOperator::merge_state(AggregateExpr::Type aggregate_type, void *state, void *other)
+{
+  switch (aggregate_type) {
+    case AggregateExpr::Type::COUNT: merge_aggregate_state<CountState<T>>(state, other); break;
+    case AggregateExpr::Type::SUM: merge_aggregate_state<SumState<T>>(state, other); break;
+    case AggregateExpr::Type::AVG: merge_aggregate_state<AvgState<T>>(state, other); break;
+    case AggregateExpr::Type::MAX: merge_aggregate_state<MaxState<T>>(state, other); break;
+    case AggregateExpr::Type::MIN: merge_aggregate_state<MinState<T>>(state, other); break;
+  }
+}
+
+template <typename T>
+void AggregateVecPhysicalOperator::append_state(AggregateExpr::Type aggregate_type, void *state, Column &column)
+{
+  switch (aggregate_type) {
+    case AggregateExpr::Type::COUNT: append_to_column<CountState<T>, T>(state, column); break;
+    case AggregateExpr::Type::SUM: append_to_column<SumState<T>, T>(state, column); break;
+    case AggregateExpr::Type::AVG: {
+      float value = reinterpret_cast<AvgState<T> *>(state)->value();
+      column.append_one((char *)&value);
+    } break;
+    case AggregateExpr::Type::MAX: append_to_column<MaxState<T>, T>(state, column); break;
+    case AggregateExpr::Type::MIN: append_to_column<MinState<T>, T>(state, column); break;
+  }
 }
 
 RC AggregateVecPhysicalOperator::next(Chunk &chunk)
 {
-  // your code here
-  exit(-1);
+  if (emitted_ || rows_ == 0) {
+    return RC::RECORD_EOF;
+  }
+
+  output_chunk_.reset_data();
+  for (size_t aggr_idx = 0; aggr_idx < aggregate_expressions_.size(); aggr_idx++) {
+    auto *aggregate_expr = static_cast<AggregateExpr *>(aggregate_expressions_[aggr_idx]);
+    if (value_expressions_[aggr_idx]->value_type() == AttrType::FLOATS) {
+      append_state<float>(aggregate_expr->aggregate_type(), aggr_values_.at(aggr_idx), output_chunk_.column(aggr_idx));
+    } else {
+      append_state<int>(aggregate_expr->aggregate_type(), aggr_values_.at(aggr_idx), output_chunk_.column(aggr_idx));
+    }
+  }
+
+  emitted_ = true;
+  chunk.reference(output_chunk_);
+  return RC::SUCCESS;
 }
 
 RC AggregateVecPhysicalOperator::close()
 {
-  children_[0]->close();
+  for (size_t i = 0; i < children_.size(); i++) {
+    if (i >= child_closed_.size() || !child_closed_[i]) {
+      children_[i]->close();
+    }
+  }
   LOG_INFO("close group by operator");
   return RC::SUCCESS;
 }
@@ -15,6 +15,9 @@ See the Mulan PSL v2 for more details. */
 /**
  * @brief 聚合物理算子 (Vectorized)
  * @ingroup PhysicalOperator
+ * @details 有多个子算子时并行聚合。每个子算子在一个单独的线程中执行，比如共享同一个 morsel 队列的多个表扫描算子，
+ * 各自聚合到线程私有的聚合状态中，全部结束后再合并成最终结果。
+ * 在 pipeline 中作为 sink，每个任务聚合到自己的聚合状态中，finish_sink 时合并。
  */
 class AggregateVecPhysicalOperator : public PhysicalOperator
 {
@@ -29,9 +32,63 @@ public:
   RC next(Chunk &chunk) override;
   RC close() override;
 
+  bool                       is_sink() const override { return true; }
+  vector<PhysicalOperator *> sink_children() override;
+  RC                         prepare_sink(int task_num) override;
+  RC                         sink(int task, Chunk &chunk) override;
+  RC                         finish_sink() override;
+
+  /**
+   * @brief 是否可以用这个算子计算。参数是 int/float/date 时使用定长的聚合状态，其它类型需要使用哈希聚合
+   */
+  static bool support(const AggregateExpr &aggregate_expr);
+
 private:
+  class AggregateValues;
+
+  /**
+   * @brief 为每个聚合表达式创建初始的聚合状态
+   */
+  void init_values(AggregateValues &values);
+
+  /**
+   * @brief 读取子算子的所有数据，聚合到第 task 个任务的聚合状态中
+   */
+  RC consume(PhysicalOperator &child, Chunk &chunk, int task);
+
+  /**
+   * @brief 每个子算子在一个线程中聚合
+   */
+  RC parallel_consume();
+
+  template <class STATE>
+  static void *create_state()
+  {
+    void *state = malloc(sizeof(STATE));
+    new (state) STATE();
+    return state;
+  }
+
+  template <typename T>
+  static void *create_state(AggregateExpr::Type aggregate_type);
+
+  template <typename T>
+  static void update_state(AggregateExpr::Type aggregate_type, void *state, const Column &column, const Chunk &chunk);
+
   template <class STATE, typename T>
-  void update_aggregate_state(void *state, const Column &column);
+  static void update_aggregate_state(void *state, const Column &column, const Chunk &chunk);
+
+  template <typename T>
+  static void merge_state(AggregateExpr::Type aggregate_type, void *state, void *other);
+
+  template <class STATE>
+  static void merge_aggregate_state(void *state, void *other)
+  {
+    reinterpret_cast<STATE *>(state)->merge(*reinterpret_cast<STATE *>(other));
+  }
+
+  template <typename T>
+  void append_state(AggregateExpr::Type aggregate_type, void *state, Column &column);
 
   template <class STATE, typename T>
   void append_to_column(void *state, Column &column)
@@ -46,6 +103,9 @@ private:
   public:
     AggregateValues() = default;
 
+    AggregateValues(const AggregateValues &)            = delete;
+    AggregateValues &operator=(const AggregateValues &) = delete;
+
     void insert(void *aggr_value) { data_.push_back(aggr_value); }
 
     void *at(size_t index)
@@ -71,4 +131,11 @@ private:
   Chunk                chunk_;
   Chunk                output_chunk_;
   AggregateValues      aggr_values_;
+
+  vector<unique_ptr<AggregateValues>> partial_values_;  ///< 每个任务的聚合状态
+  vector<int64_t>                     partial_rows_;    ///< 每个任务参与聚合的行数
+
+  int64_t              rows_    = 0;      ///< 参与聚合的行数，没有数据时不输出结果，与 ScalarGroupBy 一致
+  bool                 emitted_ = false;
+  vector<bool>         child_closed_;  ///< 子算子是否已经被工作线程关闭
 };
@@ -41,18 +41,41 @@ RC ExprVecPhysicalOperator::next(Chunk &chunk)
 
   PhysicalOperator &child = *children_[0];
   chunk.reset();
-  evaled_chunk_.reset();
   if (OB_SUCC(rc = child.next(chunk_))) {
-    for (size_t i = 0; i < expressions_.size(); i++) {
-      auto column = make_unique<Column>();
-      expressions_[i]->get_column(chunk_, *column);
-      evaled_chunk_.add_column(std::move(column), i);
-    }
-    chunk.reference(evaled_chunk_);
+    rc = eval(chunk_, evaled_chunk_, chunk);
   }
   return rc;
 }
 
+RC ExprVecPhysicalOperator::prepare_push(int task_num)
+{
+  task_evaled_chunks_.clear();
+  for (int i = 0; i < task_num; i++) {
+    task_evaled_chunks_.emplace_back(make_unique<Chunk>());
+  }
+  return RC::SUCCESS;
+}
+
+RC ExprVecPhysicalOperator::push(int task, Chunk &input, Chunk &output, bool &has_more_output)
+{
+  has_more_output = false;
+  return eval(input, *task_evaled_chunks_[task], output);
+}
+
+RC ExprVecPhysicalOperator::eval(Chunk &input, Chunk &evaled_chunk, Chunk &output)
+{
+  evaled_chunk.reset();
+  for (size_t i = 0; i < expressions_.size(); i++) {
+    auto column = make_unique<Column>();
+    expressions_[i]->get_column(input, *column);
+    evaled_chunk.add_column(std::move(column), i);
+  }
+  if (input.has_selection()) {
+    evaled_chunk.set_selection(input.selection());
+  }
+  return output.reference(evaled_chunk);
+}
+
 RC ExprVecPhysicalOperator::close()
 {
   children_[0]->close();
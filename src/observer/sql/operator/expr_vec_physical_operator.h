@@ -29,8 +29,19 @@ public:
   RC next(Chunk &chunk) override;
   RC close() override;
 
+  bool is_streaming() const override { return true; }
+  RC   prepare_push(int task_num) override;
+  RC   push(int task, Chunk &input, Chunk &output, bool &has_more_output) override;
+
+private:
+  /**
+   * @brief 计算 input 上所有的表达式，结果写到 evaled_chunk 中
+   */
+  RC eval(Chunk &input, Chunk &evaled_chunk, Chunk &output);
+
 private:
-  vector<Expression *> expressions_;  /// 表达式
-  Chunk                chunk_;
-  Chunk                evaled_chunk_;
+  vector<Expression *>      expressions_;  /// 表达式
+  Chunk                     chunk_;
+  Chunk                     evaled_chunk_;
+  vector<unique_ptr<Chunk>> task_evaled_chunks_;  ///< push 模式下每个任务的计算结果
 };
@@ -0,0 +1,192 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/gather_vec_physical_operator.h"
+#include "common/log/log.h"
+#include "sql/operator/parallel_executor.h"
+
+/**
+ * @brief 把 src 中的数据复制到 dst 中，dst 的列在第一次使用时创建，之后复用
+ */
+static void copy_chunk(Chunk &src, Chunk &dst)
+{
+  if (dst.column_num() != src.column_num()) {
+    dst.reset();
+    for (int i = 0; i < src.column_num(); i++) {
+      Column &column = src.column(i);
+      dst.add_column(make_unique<Column>(column.attr_type(), column.attr_len(), Column::DEFAULT_CAPACITY),
+          src.column_ids(i));
+    }
+  }
+
+  for (int i = 0; i < src.column_num(); i++) {
+    Column &from = src.column(i);
+    Column &to   = dst.column(i);
+    if (to.capacity() < from.count()) {
+      to.init(from.attr_type(), from.attr_len(), from.count());
+    }
+    to.reset_data();
+    to.set_column_type(from.column_type());
+    if (!src.has_selection() || from.column_type() == Column::Type::CONSTANT_COLUMN) {
+      to.append(from.data(), from.count());
+      continue;
+    }
+    // 只复制选择向量中的行，复制后的数据是紧凑的，不再需要选择向量
+    for (int j = 0; j < src.selected_rows(); j++) {
+      to.append_one(from.data() + static_cast<size_t>(src.selected_row(j)) * from.attr_len());
+    }
+  }
+}
+
+GatherVecPhysicalOperator::~GatherVecPhysicalOperator() { stop_workers(); }
+
+string GatherVecPhysicalOperator::param() const { return "workers=" + to_string(children_.size()); }
+
+RC GatherVecPhysicalOperator::open(Trx *trx)
+{
+  RC rc = RC::SUCCESS;
+  child_closed_.assign(children_.size(), false);
+  for (unique_ptr<PhysicalOperator> &child : children_) {
+    rc = child->open(trx);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to open child operator of gather. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  {
+    lock_guard guard(lock_);
+    max_ready_chunks_ = 2 * children_.size();
+    running_workers_  = static_cast<int>(children_.size());
+    stopped_          = false;
+    worker_rc_        = RC::SUCCESS;
+  }
+
+  common::ThreadPoolExecutor &executor = parallel_executor();
+  for (size_t i = 0; i < children_.size(); i++) {
+    if (executor.execute([this, i]() { run_worker(i); }) != 0) {
+      LOG_WARN("failed to submit gather worker");
+      lock_guard guard(lock_);
+      running_workers_--;
+      worker_rc_ = RC::INTERNAL;
+      not_empty_.notify_all();
+    }
+  }
+  return rc;
+}
+
+RC GatherVecPhysicalOperator::next(Chunk &chunk)
+{
+  unique_lock lock(lock_);
+  if (current_chunk_ != nullptr) {
+    free_chunks_.push_back(std::move(current_chunk_));
+  }
+
+  not_empty_.wait(
+      lock, [this]() { return !ready_chunks_.empty() || running_workers_ == 0 || worker_rc_ != RC::SUCCESS; });
+  if (worker_rc_ != RC::SUCCESS) {
+    return worker_rc_;
+  }
+  if (ready_chunks_.empty()) {
+    return RC::RECORD_EOF;
+  }
+
+  current_chunk_ = std::move(ready_chunks_.front());
+  ready_chunks_.pop_front();
+  not_full_.notify_one();
+  lock.unlock();
+
+  chunk.reference(*current_chunk_);
+  return RC::SUCCESS;
+}
+
+RC GatherVecPhysicalOperator::close()
+{
+  stop_workers();
+
+  RC rc = RC::SUCCESS;
+  for (size_t i = 0; i < children_.size(); i++) {
+    if (child_closed_[i]) {
+      continue;
+    }
+    RC rc2 = children_[i]->close();
+    if (OB_FAIL(rc2)) {
+      LOG_WARN("failed to close child operator of gather. rc=%s", strrc(rc2));
+      rc = rc2;
+    }
+  }
+
+  ready_chunks_.clear();
+  free_chunks_.clear();
+  current_chunk_.reset();
+  return rc;
+}
+
+void GatherVecPhysicalOperator::run_worker(size_t index)
+{
+  PhysicalOperator *child = children_[index].get();
+
+  Chunk chunk;
+  RC    rc = RC::SUCCESS;
+  while (OB_SUCC(rc = child->next(chunk))) {
+    if (chunk.selected_rows() > 0 && !push_chunk(chunk)) {
+      break;
+    }
+  }
+
+  RC close_rc = child->close();
+  if (OB_FAIL(close_rc)) {
+    LOG_WARN("failed to close child operator of gather. rc=%s", strrc(close_rc));
+  }
+
+  lock_guard guard(lock_);
+  child_closed_[index] = true;
+  if (rc != RC::SUCCESS && rc != RC::RECORD_EOF) {
+    LOG_WARN("gather worker failed. rc=%s", strrc(rc));
+    if (worker_rc_ == RC::SUCCESS) {
+      worker_rc_ = rc;
+    }
+  }
+  running_workers_--;
+  not_empty_.notify_all();
+}
+
+bool GatherVecPhysicalOperator::push_chunk(Chunk &chunk)
+{
+  unique_ptr<Chunk> copy;
+  {
+    lock_guard guard(lock_);
+    if (!free_chunks_.empty()) {
+      copy = std::move(free_chunks_.back());
+      free_chunks_.pop_back();
+    }
+  }
+  if (copy == nullptr) {
+    copy = make_unique<Chunk>();
+  }
+  copy_chunk(chunk, *copy);
+
+  unique_lock lock(lock_);
+  not_full_.wait(lock, [this]() { return stopped_ || ready_chunks_.size() < max_ready_chunks_; });
+  if (stopped_) {
+    return false;
+  }
+  ready_chunks_.push_back(std::move(copy));
+  not_empty_.notify_one();
+  return true;
+}
+
+void GatherVecPhysicalOperator::stop_workers()
+{
+  unique_lock lock(lock_);
+  stopped_ = true;
+  not_full_.notify_all();
+  not_empty_.wait(lock, [this]() { return running_workers_ == 0; });
+}
@@ -0,0 +1,73 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/condition_variable.h"
+#include "common/lang/deque.h"
+#include "common/lang/mutex.h"
+#include "sql/operator/physical_operator.h"
+
+/**
+ * @brief 汇总多个子算子输出的物理算子(Vectorized)
+ * @ingroup PhysicalOperator
+ * @details 每个子算子在一个单独的线程中执行，产生的 Chunk 复制一份后放到一个有界队列中，
+ * 由 next 依次取出。子算子之间通常共享同一个数据源，比如共享同一个 morsel 队列的多个表扫描算子，
+ * 输出的数据没有顺序保证。
+ */
+class GatherVecPhysicalOperator : public PhysicalOperator
+{
+public:
+  GatherVecPhysicalOperator() = default;
+
+  virtual ~GatherVecPhysicalOperator();
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::GATHER_VEC; }
+
+  string param() const override;
+
+  RC open(Trx *trx) override;
+  RC next(Chunk &chunk) override;
+  RC close() override;
+
+private:
+  /**
+   * @brief 工作线程的执行函数，不停的从子算子中拉取数据，直到结束或者算子被关闭
+   * @details 子算子也在工作线程中关闭。提前结束时表扫描可能还持有页面的读锁，只能由加锁的线程释放
+   */
+  void run_worker(size_t index);
+
+  /**
+   * @brief 把 chunk 复制一份放到队列中
+   * @return 算子已经被关闭时返回 false
+   */
+  bool push_chunk(Chunk &chunk);
+
+  /**
+   * @brief 通知所有工作线程退出，并等待它们结束
+   */
+  void stop_workers();
+
+private:
+  mutex              lock_;
+  condition_variable not_empty_;
+  condition_variable not_full_;
+
+  deque<unique_ptr<Chunk>>  ready_chunks_;  ///< 工作线程产生的数据
+  vector<unique_ptr<Chunk>> free_chunks_;   ///< 已经被消费的 Chunk，可以复用
+  unique_ptr<Chunk>         current_chunk_;  ///< next 返回的数据引用的 Chunk
+
+  vector<bool> child_closed_;  ///< 子算子是否已经被工作线程关闭
+
+  size_t max_ready_chunks_ = 0;
+  int    running_workers_  = 0;
+  bool   stopped_          = false;
+  RC     worker_rc_        = RC::SUCCESS;  ///< 工作线程遇到的第一个错误
+};
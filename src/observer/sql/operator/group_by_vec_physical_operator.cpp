@@ -8,4 +8,325 @@ EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
 MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
-#include "sql/operator/group_by_vec_physical_operator.h"
\ No newline at end of file
+#include "sql/operator/group_by_vec_physical_operator.h"
+#include "common/log/log.h"
+#include "sql/operator/parallel_executor.h"
+
+using namespace std;
+using namespace common;
+
+GroupByVecPhysicalOperator::GroupByVecPhysicalOperator(
+    vector<unique_ptr<Expression>> &&group_by_exprs, vector<Expression *> &&expressions)
+    : group_by_exprs_(std::move(group_by_exprs)), aggregate_expressions_(std::move(expressions))
+{
+  value_expressions_.reserve(aggregate_expressions_.size());
+  for (Expression *expr : aggregate_expressions_) {
+    ASSERT(expr->type() == ExprType::AGGREGATION, "expected an aggregation expression");
+    Expression *child_expr = static_cast<AggregateExpr *>(expr)->child().get();
+    ASSERT(child_expr != nullptr, "aggregation expression must have a child expression");
+    value_expressions_.push_back(child_expr);
+  }
+
+  for (size_t i = 0; i < group_by_exprs_.size(); i++) {
+    Expression *expr = group_by_exprs_[i].get();
+    output_chunk_.add_column(make_unique<Column>(expr->value_type(), expr->value_length()), i);
+  }
+  for (size_t i = 0; i < aggregate_expressions_.size(); i++) {
+    Expression *expr = aggregate_expressions_[i];
+    output_chunk_.add_column(
+        make_unique<Column>(expr->value_type(), expr->value_length()), group_by_exprs_.size() + i);
+  }
+}
+
+void GroupByVecPhysicalOperator::create_hash_table()
+{
+  unique_ptr<AggregateHashTable>          hash_table;
+  unique_ptr<AggregateHashTable::Scanner> scanner;
+  if (simd_level() >= SimdLevel::AVX2 && group_by_exprs_.size() == 1 && group_by_exprs_[0]->value_type() == AttrType::INTS &&
+      aggregate_expressions_.size() == 1 &&
+      static_cast<AggregateExpr *>(aggregate_expressions_[0])->aggregate_type() == AggregateExpr::Type::SUM) {
+    AttrType value_type = value_expressions_[0]->value_type();
+    if (value_type == AttrType::INTS) {
+      hash_table = make_unique<LinearProbingAggregateHashTable<int>>(AggregateExpr::Type::SUM);
+      scanner    = make_unique<LinearProbingAggregateHashTable<int>::Scanner>(hash_table.get());
+    } else if (value_type == AttrType::FLOATS) {
+      hash_table = make_unique<LinearProbingAggregateHashTable<float>>(AggregateExpr::Type::SUM);
+      scanner    = make_unique<LinearProbingAggregateHashTable<float>::Scanner>(hash_table.get());
+    }
+  }
+
+  if (hash_table == nullptr) {
+    hash_table = make_unique<StandardAggregateHashTable>(aggregate_expressions_, memory_limit_);
+    scanner    = make_unique<StandardAggregateHashTable::Scanner>(hash_table.get());
+  }
+  hash_tables_.push_back(std::move(hash_table));
+  scanners_.push_back(std::move(scanner));
+}
+
+RC GroupByVecPhysicalOperator::open(Trx *trx)
+{
+  ASSERT(!children_.empty(), "group by operator should have at least one child");
+
+  RC rc = RC::SUCCESS;
+  child_closed_.assign(children_.size(), false);
+  for (unique_ptr<PhysicalOperator> &child : children_) {
+    rc = child->open(trx);
+    if (OB_FAIL(rc)) {
+      LOG_INFO("failed to open child operator. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  rc = prepare_sink(static_cast<int>(children_.size()));
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  if (children_.size() > 1) {
+    rc = parallel_consume();
+  } else {
+    rc = consume(*children_[0], chunk_, 0);
+  }
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  return finish_sink();
+}
+
+vector<PhysicalOperator *> GroupByVecPhysicalOperator::sink_children()
+{
+  vector<PhysicalOperator *> children;
+  for (unique_ptr<PhysicalOperator> &child : children_) {
+    children.push_back(child.get());
+  }
+  return children;
+}
+
+RC GroupByVecPhysicalOperator::prepare_sink(int task_num)
+{
+  hash_tables_.clear();
+  scanners_.clear();
+  scan_index_ = 0;
+  partials_.clear();
+  task_chunks_.clear();
+
+  // 只有一个任务时直接写入最终的哈希表，多个任务时每个任务写入自己的哈希表
+  if (task_num == 1) {
+    create_hash_table();
+  } else {
+    for (int i = 0; i < task_num; i++) {
+      partials_.push_back(make_unique<StandardAggregateHashTable>(aggregate_expressions_, memory_limit_ / task_num));
+    }
+  }
+  for (int i = 0; i < task_num; i++) {
+    task_chunks_.push_back(make_unique<TaskChunks>());
+  }
+  return RC::SUCCESS;
+}
+
+RC GroupByVecPhysicalOperator::sink(int task, Chunk &chunk)
+{
+  if (chunk.selected_rows() == 0) {
+    return RC::SUCCESS;
+  }
+
+  Chunk &groups_chunk = task_chunks_[task]->groups_chunk;
+  Chunk &aggrs_chunk  = task_chunks_[task]->aggrs_chunk;
+  groups_chunk.reset();
+  aggrs_chunk.reset();
+
+  RC rc = RC::SUCCESS;
+  for (size_t i = 0; i < group_by_exprs_.size(); i++) {
+    auto column = make_unique<Column>();
+    rc          = group_by_exprs_[i]->get_column(chunk, *column);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get column of group by expression. rc=%s", strrc(rc));
+      return rc;
+    }
+    column->expand_constant(chunk.rows());
+    groups_chunk.add_column(std::move(column), i);
+  }
+  for (size_t i = 0; i < value_expressions_.size(); i++) {
+    auto column = make_unique<Column>();
+    rc          = value_expressions_[i]->get_column(chunk, *column);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get column of aggregation. rc=%s", strrc(rc));
+      return rc;
+    }
+    column->expand_constant(chunk.rows());
+    aggrs_chunk.add_column(std::move(column), i);
+  }
+  if (chunk.has_selection()) {
+    groups_chunk.set_selection(chunk.selection());
+    aggrs_chunk.set_selection(chunk.selection());
+  }
+
+  AggregateHashTable &hash_table = partials_.empty() ? *hash_tables_[0] : *partials_[task];
+  rc                             = hash_table.add_chunk(groups_chunk, aggrs_chunk);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to add chunk to aggregate hash table. rc=%s", strrc(rc));
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+RC GroupByVecPhysicalOperator::finish_sink()
+{
+  RC rc = RC::SUCCESS;
+  if (!partials_.empty()) {
+    bool spilled = false;
+    for (unique_ptr<StandardAggregateHashTable> &partial : partials_) {
+      spilled = spilled || partial->spilled();
+    }
+    rc = spilled ? merge_partials(partials_) : merge_partitions(partials_);
+    partials_.clear();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  task_chunks_.clear();
+
+  for (unique_ptr<AggregateHashTable::Scanner> &scanner : scanners_) {
+    scanner->open_scan();
+  }
+  return rc;
+}
+
+RC GroupByVecPhysicalOperator::consume(PhysicalOperator &child, Chunk &chunk, int task)
+{
+  RC rc = RC::SUCCESS;
+  while (OB_SUCC(rc = child.next(chunk))) {
+    rc = sink(task, chunk);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to get next chunk from child. rc=%s", strrc(rc));
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+RC GroupByVecPhysicalOperator::parallel_consume()
+{
+  // 第一阶段：每个线程把一个子算子的数据聚合到线程私有的哈希表中
+  const int worker_num = static_cast<int>(children_.size());
+
+  RC rc = run_parallel(worker_num, [&](int i) {
+    Chunk chunk;
+    RC    rc = consume(*children_[i], chunk, i);
+    // 子算子在工作线程中关闭，表扫描持有的页面锁只能由加锁的线程释放
+    RC close_rc = children_[i]->close();
+    if (OB_FAIL(close_rc)) {
+      LOG_WARN("failed to close child operator of group by. rc=%s", strrc(close_rc));
+    }
+    return rc;
+  });
+  child_closed_.assign(children_.size(), true);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to aggregate in parallel. rc=%s", strrc(rc));
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+RC GroupByVecPhysicalOperator::merge_partitions(vector<unique_ptr<StandardAggregateHashTable>> &partials)
+{
+  // 第二阶段：按照哈希值分区，每个线程把所有部分结果中属于一个分区的分组合并起来，不同分区之间没有相同的分组
+  const int                                      partition_num = static_cast<int>(partials.size());
+  vector<unique_ptr<StandardAggregateHashTable>> merged;
+  for (int i = 0; i < partition_num; i++) {
+    merged.push_back(make_unique<StandardAggregateHashTable>(aggregate_expressions_, memory_limit_ / partition_num));
+  }
+  RC rc = run_parallel(partition_num, [&](int partition) {
+    for (unique_ptr<StandardAggregateHashTable> &partial : partials) {
+      RC rc = merged[partition]->merge(*partial, partition, partition_num);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+    return RC::SUCCESS;
+  });
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to merge partial aggregation in parallel. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  for (unique_ptr<StandardAggregateHashTable> &hash_table : merged) {
+    scanners_.push_back(make_unique<StandardAggregateHashTable::Scanner>(hash_table.get()));
+    hash_tables_.push_back(std::move(hash_table));
+  }
+  LOG_TRACE("parallel group by done. partitions=%d", partition_num);
+  return RC::SUCCESS;
+}
+
+RC GroupByVecPhysicalOperator::merge_partials(vector<unique_ptr<StandardAggregateHashTable>> &partials)
+{
+  LOG_INFO("partial aggregation spilled to disk, merge partials in one thread");
+  auto hash_table = make_unique<StandardAggregateHashTable>(aggregate_expressions_, memory_limit_);
+  for (unique_ptr<StandardAggregateHashTable> &partial : partials) {
+    RC rc = RC::SUCCESS;
+    if (!partial->spilled()) {
+      rc = hash_table->merge(*partial);
+    } else {
+      // 写过临时文件的哈希表逐个分区读到内存中再合并
+      while (OB_SUCC(rc = partial->load_next_partition())) {
+        if (OB_FAIL(rc = hash_table->merge(*partial))) {
+          break;
+        }
+      }
+      if (rc == RC::RECORD_EOF) {
+        rc = RC::SUCCESS;
+      }
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to merge partial aggregation. rc=%s", strrc(rc));
+      return rc;
+    }
+    partial.reset();
+  }
+
+  scanners_.push_back(make_unique<StandardAggregateHashTable::Scanner>(hash_table.get()));
+  hash_tables_.push_back(std::move(hash_table));
+  return RC::SUCCESS;
+}
+
+RC GroupByVecPhysicalOperator::next(Chunk &chunk)
+{
+  output_chunk_.reset_data();
+  while (scan_index_ < scanners_.size()) {
+    RC rc = scanners_[scan_index_]->next(output_chunk_);
+    if (rc == RC::RECORD_EOF || (OB_SUCC(rc) && output_chunk_.rows() == 0)) {
+      scan_index_++;
+      continue;
+    }
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    break;
+  }
+  if (output_chunk_.rows() == 0) {
+    return RC::RECORD_EOF;
+  }
+
+  chunk.reference(output_chunk_);
+  return RC::SUCCESS;
+}
+
+RC GroupByVecPhysicalOperator::close()
+{
+  for (unique_ptr<AggregateHashTable::Scanner> &scanner : scanners_) {
+    scanner->close_scan();
+  }
+  scanners_.clear();
+  hash_tables_.clear();
+  for (size_t i = 0; i < children_.size(); i++) {
+    if (i >= child_closed_.size() || !child_closed_[i]) {
+      children_[i]->close();
+    }
+  }
+  LOG_INFO("close group by(vec) operator");
+  return RC::SUCCESS;
+}
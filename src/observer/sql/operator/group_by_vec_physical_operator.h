@@ -16,19 +16,86 @@ See the Mulan PSL v2 for more details. */
 /**
  * @brief Group By 物理算子(vectorized)
  * @ingroup PhysicalOperator
+ * @details open 时读取子算子的所有数据，计算分组表达式和聚合函数的参数后写入哈希表，next 时扫描哈希表输出结果。
+ * 输出的 chunk 中先是所有分组表达式的值，然后是所有聚合函数的值。
+ * CPU 支持 AVX2 且只有一个 int 分组列和一个 SUM 聚合时使用线性探测哈希表，其它情况使用 StandardAggregateHashTable，
+ * 支持任意数量和类型的分组列以及所有的聚合函数，内存不足时写临时文件。
+ * 有多个子算子时并行聚合：每个子算子在一个线程中聚合到自己的 StandardAggregateHashTable，
+ * 然后按照分组的哈希值分区，每个线程把所有线程的部分结果中属于同一个分区的分组合并到一个哈希表中，依次输出。
+ * 在 pipeline 中作为 sink，每个任务相当于一个子算子，finish_sink 时合并所有任务的部分结果。
  */
 class GroupByVecPhysicalOperator : public PhysicalOperator
 {
 public:
-  GroupByVecPhysicalOperator(vector<unique_ptr<Expression>> &&group_by_exprs, vector<Expression *> &&expressions){};
+  GroupByVecPhysicalOperator(vector<unique_ptr<Expression>> &&group_by_exprs, vector<Expression *> &&expressions);
 
   virtual ~GroupByVecPhysicalOperator() = default;
 
   PhysicalOperatorType type() const override { return PhysicalOperatorType::GROUP_BY_VEC; }
 
-  RC open(Trx *trx) override { return RC::UNIMPLEMENTED; }
-  RC next(Chunk &chunk) override { return RC::UNIMPLEMENTED; }
-  RC close() override { return RC::UNIMPLEMENTED; }
+  /**
+   * @brief 设置哈希表可以使用的内存，单位字节
+   */
+  void set_memory_limit(int64_t memory_limit) { memory_limit_ = memory_limit; }
+
+  RC open(Trx *trx) override;
+  RC next(Chunk &chunk) override;
+  RC close() override;
+
+  bool                       is_sink() const override { return true; }
+  vector<PhysicalOperator *> sink_children() override;
+  RC                         prepare_sink(int task_num) override;
+  RC                         sink(int task, Chunk &chunk) override;
+  RC                         finish_sink() override;
 
 private:
+  /**
+   * @brief 每个任务计算表达式时使用的缓存
+   */
+  struct TaskChunks
+  {
+    Chunk groups_chunk;  ///< 分组表达式的值
+    Chunk aggrs_chunk;   ///< 聚合函数参数的值
+  };
+
+  void create_hash_table();
+
+  /**
+   * @brief 读取子算子的所有数据，写入第 task 个任务的哈希表
+   */
+  RC consume(PhysicalOperator &child, Chunk &chunk, int task);
+
+  /**
+   * @brief 每个子算子在一个线程中聚合
+   */
+  RC parallel_consume();
+
+  /**
+   * @brief 按照分区并行合并所有任务的部分结果
+   */
+  RC merge_partitions(vector<unique_ptr<StandardAggregateHashTable>> &partials);
+
+  /**
+   * @brief 有部分结果写过临时文件时，在当前线程中把所有部分结果合并到一个哈希表中
+   */
+  RC merge_partials(vector<unique_ptr<StandardAggregateHashTable>> &partials);
+
+private:
+  vector<unique_ptr<Expression>> group_by_exprs_;
+  vector<Expression *>           aggregate_expressions_;  ///< 聚合表达式
+  vector<Expression *>           value_expressions_;      ///< 聚合函数的参数
+
+  int64_t memory_limit_ = StandardAggregateHashTable::DEFAULT_MEMORY_LIMIT;
+
+  /// 聚合结果。串行执行时只有一个哈希表，并行执行时每个哈希表是一个分区，不同哈希表中的分组不会重复
+  vector<unique_ptr<AggregateHashTable>>          hash_tables_;
+  vector<unique_ptr<AggregateHashTable::Scanner>> scanners_;
+  size_t                                          scan_index_ = 0;  ///< 当前输出的哈希表
+  vector<bool>                                    child_closed_;  ///< 子算子是否已经被工作线程关闭
+
+  vector<unique_ptr<StandardAggregateHashTable>> partials_;     ///< 多个任务时每个任务的部分结果
+  vector<unique_ptr<TaskChunks>>                 task_chunks_;
+
+  Chunk chunk_;  ///< 子算子的输出
+  Chunk output_chunk_;
 };
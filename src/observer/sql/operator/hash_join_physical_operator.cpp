@@ -9,3 +9,476 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #include "sql/operator/hash_join_physical_operator.h"
+#include "common/lang/functional.h"
+#include "common/log/log.h"
+
+HashJoinPhysicalOperator::HashJoinPhysicalOperator(
+    vector<unique_ptr<Expression>> &&left_keys, vector<unique_ptr<Expression>> &&right_keys)
+    : left_keys_(std::move(left_keys)), right_keys_(std::move(right_keys))
+{
+  ASSERT(left_keys_.size() == right_keys_.size(), "left keys and right keys should have the same size");
+}
+
+/**
+ * @brief 连接键在执行计划中的显示名称，字段显示为 表名.字段名
+ */
+static string key_name(const Expression &expr)
+{
+  if (expr.type() == ExprType::FIELD) {
+    const auto &field_expr = static_cast<const FieldExpr &>(expr);
+    return string(field_expr.table_name()) + "." + field_expr.field_name();
+  }
+  return expr.name();
+}
+
+string HashJoinPhysicalOperator::param() const
+{
+  string param;
+  for (size_t i = 0; i < left_keys_.size(); i++) {
+    if (i > 0) {
+      param += " AND ";
+    }
+    param += key_name(*left_keys_[i]) + "=" + key_name(*right_keys_[i]);
+  }
+  return param;
+}
+
+RC HashJoinPhysicalOperator::open(Trx *trx)
+{
+  if (children_.size() != 2) {
+    LOG_WARN("hash join operator should have 2 children");
+    return RC::INTERNAL;
+  }
+
+  left_         = children_[0].get();
+  right_        = children_[1].get();
+  matched_rows_ = nullptr;
+  matched_pos_  = 0;
+  spilled_      = false;
+
+  RC rc = right_->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open right child of hash join. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  SpillPartitions build_partitions(0 /*depth*/);
+  rc = build(build_partitions);
+  RC rc2 = right_->close();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  if (OB_FAIL(rc2)) {
+    LOG_WARN("failed to close right child of hash join. rc=%s", strrc(rc2));
+    return rc2;
+  }
+
+  rc = left_->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open left child of hash join. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  if (spilled_) {
+    rc = partition_probe(build_partitions);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to partition left child of hash join. rc=%s", strrc(rc));
+    }
+  }
+  return rc;
+}
+
+RC HashJoinPhysicalOperator::build(SpillPartitions &partitions)
+{
+  clear_build();
+  build_specs_.clear();
+
+  RC            rc = RC::SUCCESS;
+  vector<Value> keys;
+  string        hash_key;
+  while (OB_SUCC(rc = right_->next())) {
+    Tuple *tuple = right_->current_tuple();
+    if (build_specs_.empty()) {
+      for (int i = 0; i < tuple->cell_num(); i++) {
+        TupleCellSpec spec;
+        rc = tuple->spec_at(i, spec);
+        if (OB_FAIL(rc)) {
+          LOG_WARN("failed to get tuple spec. index=%d, rc=%s", i, strrc(rc));
+          return rc;
+        }
+        build_specs_.push_back(spec);
+      }
+      build_tuple_.set_names(build_specs_);
+    }
+
+    rc = eval_keys(right_keys_, *tuple, keys, hash_key);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    vector<Value> row(tuple->cell_num());
+    for (int i = 0; i < tuple->cell_num(); i++) {
+      rc = tuple->cell_at(i, row[i]);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to get tuple cell. index=%d, rc=%s", i, strrc(rc));
+        return rc;
+      }
+    }
+
+    if (spilled_) {
+      rc = spill_row(keys, row, hash_key, partitions);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+      continue;
+    }
+
+    insert_build_row(std::move(keys), std::move(row), hash_key);
+    if (memory_usage_ > memory_limit_) {
+      LOG_INFO("hash join build side exceeds memory limit, spill to disk. memory usage=%ld, limit=%ld",
+               memory_usage_, memory_limit_);
+      spilled_ = true;
+      rc       = spill_build(partitions);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+  }
+
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to read right child of hash join. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  LOG_TRACE("hash join build done. rows=%d, distinct keys=%d, spilled=%d",
+            static_cast<int>(build_rows_.size()), static_cast<int>(hash_table_.size()), spilled_);
+  return RC::SUCCESS;
+}
+
+/**
+ * @brief 估算一行数据在内存中占用的空间
+ */
+static int64_t values_memory(const vector<Value> &values)
+{
+  int64_t bytes = sizeof(vector<Value>) + values.size() * sizeof(Value);
+  for (const Value &value : values) {
+    if (value.attr_type() == AttrType::CHARS) {
+      bytes += value.length();
+    }
+  }
+  return bytes;
+}
+
+void HashJoinPhysicalOperator::insert_build_row(vector<Value> &&keys, vector<Value> &&row, const string &hash_key)
+{
+  memory_usage_ += values_memory(keys) + values_memory(row) + sizeof(int);
+
+  auto iter = hash_table_.find(hash_key);
+  if (iter == hash_table_.end()) {
+    // 哈希表中的每个键还有节点、字符串和 vector 的开销
+    memory_usage_ += hash_key.size() + sizeof(string) + sizeof(vector<int>) + 2 * sizeof(void *);
+    iter = hash_table_.emplace(hash_key, vector<int>()).first;
+  }
+  iter->second.push_back(static_cast<int>(build_rows_.size()));
+  build_rows_.push_back(std::move(row));
+  build_keys_.push_back(std::move(keys));
+}
+
+void HashJoinPhysicalOperator::clear_build()
+{
+  build_rows_.clear();
+  build_keys_.clear();
+  hash_table_.clear();
+  memory_usage_ = 0;
+}
+
+RC HashJoinPhysicalOperator::spill_build(SpillPartitions &partitions)
+{
+  string hash_key;
+  for (size_t row = 0; row < build_rows_.size(); row++) {
+    make_hash_key(build_keys_[row], hash_key);
+    RC rc = spill_row(build_keys_[row], build_rows_[row], hash_key, partitions);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  clear_build();
+  return RC::SUCCESS;
+}
+
+RC HashJoinPhysicalOperator::spill_row(
+    const vector<Value> &keys, const vector<Value> &row, const string &hash_key, SpillPartitions &partitions)
+{
+  spill_values_.clear();
+  spill_values_.insert(spill_values_.end(), keys.begin(), keys.end());
+  spill_values_.insert(spill_values_.end(), row.begin(), row.end());
+
+  SpillFile *file = nullptr;
+  RC         rc   = partitions.file(partitions.partition_of(std::hash<string>()(hash_key)), file);
+  if (OB_SUCC(rc)) {
+    rc = file->write_values(spill_values_);
+  }
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to spill hash join rows. rc=%s", strrc(rc));
+  }
+  return rc;
+}
+
+RC HashJoinPhysicalOperator::partition_probe(SpillPartitions &build_partitions)
+{
+  SpillPartitions probe_partitions(build_partitions.depth());
+
+  RC            rc = RC::SUCCESS;
+  vector<Value> keys;
+  vector<Value> row;
+  string        hash_key;
+  while (OB_SUCC(rc = left_->next())) {
+    Tuple *tuple = left_->current_tuple();
+    if (probe_specs_.empty()) {
+      for (int i = 0; i < tuple->cell_num(); i++) {
+        TupleCellSpec spec;
+        rc = tuple->spec_at(i, spec);
+        if (OB_FAIL(rc)) {
+          LOG_WARN("failed to get tuple spec. index=%d, rc=%s", i, strrc(rc));
+          return rc;
+        }
+        probe_specs_.push_back(spec);
+      }
+      probe_tuple_.set_names(probe_specs_);
+    }
+
+    rc = eval_keys(left_keys_, *tuple, keys, hash_key);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    row.resize(tuple->cell_num());
+    for (int i = 0; i < tuple->cell_num(); i++) {
+      rc = tuple->cell_at(i, row[i]);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to get tuple cell. index=%d, rc=%s", i, strrc(rc));
+        return rc;
+      }
+    }
+
+    rc = spill_row(keys, row, hash_key, probe_partitions);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to read left child of hash join. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  // 内连接，只有两边都有数据的分区才可能有结果
+  for (int i = 0; i < SpillPartitions::PARTITION_NUM; i++) {
+    unique_ptr<SpillFile> build_file = build_partitions.release(i);
+    unique_ptr<SpillFile> probe_file = probe_partitions.release(i);
+    if (build_file != nullptr && probe_file != nullptr) {
+      pending_partitions_.push_back({std::move(build_file), std::move(probe_file), build_partitions.depth()});
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC HashJoinPhysicalOperator::next_partition()
+{
+  const size_t key_num = right_keys_.size();
+
+  RC     rc = RC::SUCCESS;
+  string hash_key;
+  while (!pending_partitions_.empty()) {
+    PartitionPair partition = std::move(pending_partitions_.back());
+    pending_partitions_.pop_back();
+
+    clear_build();
+    matched_rows_  = nullptr;
+    bool too_large = false;
+    if (OB_FAIL(rc = partition.build->rewind())) {
+      return rc;
+    }
+    while (OB_SUCC(rc = partition.build->read_values(spill_values_))) {
+      vector<Value> keys(spill_values_.begin(), spill_values_.begin() + key_num);
+      vector<Value> row(spill_values_.begin() + key_num, spill_values_.end());
+      make_hash_key(keys, hash_key);
+      insert_build_row(std::move(keys), std::move(row), hash_key);
+      if (memory_usage_ > memory_limit_ && partition.depth + 1 < SpillPartitions::MAX_DEPTH) {
+        too_large = true;
+        break;
+      }
+    }
+    if (rc != RC::SUCCESS && rc != RC::RECORD_EOF) {
+      return rc;
+    }
+
+    if (!too_large) {
+      probe_file_ = std::move(partition.probe);
+      return probe_file_->rewind();
+    }
+
+    // 分区仍然太大，用哈希值的下一组位继续分区
+    LOG_INFO("hash join partition exceeds memory limit, partition again. depth=%d, build rows=%ld",
+             partition.depth + 1, partition.build->records());
+    clear_build();
+    SpillPartitions  build_partitions(partition.depth + 1);
+    SpillPartitions  probe_partitions(partition.depth + 1);
+    SpillFile       *files[2]      = {partition.build.get(), partition.probe.get()};
+    SpillPartitions *partitions[2] = {&build_partitions, &probe_partitions};
+    for (int side = 0; side < 2; side++) {
+      if (OB_FAIL(rc = files[side]->rewind())) {
+        return rc;
+      }
+      while (OB_SUCC(rc = files[side]->read_values(spill_values_))) {
+        make_hash_key(vector<Value>(spill_values_.begin(), spill_values_.begin() + key_num), hash_key);
+
+        SpillFile *file = nullptr;
+        rc = partitions[side]->file(partitions[side]->partition_of(std::hash<string>()(hash_key)), file);
+        if (OB_SUCC(rc)) {
+          rc = file->write_values(spill_values_);
+        }
+        if (OB_FAIL(rc)) {
+          return rc;
+        }
+      }
+      if (rc != RC::RECORD_EOF) {
+        return rc;
+      }
+    }
+
+    for (int i = 0; i < SpillPartitions::PARTITION_NUM; i++) {
+      unique_ptr<SpillFile> build_file = build_partitions.release(i);
+      unique_ptr<SpillFile> probe_file = probe_partitions.release(i);
+      if (build_file != nullptr && probe_file != nullptr) {
+        pending_partitions_.push_back({std::move(build_file), std::move(probe_file), partition.depth + 1});
+      }
+    }
+  }
+  return RC::RECORD_EOF;
+}
+
+RC HashJoinPhysicalOperator::fetch_probe_row()
+{
+  RC rc = RC::SUCCESS;
+  if (!spilled_) {
+    rc = left_->next();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    Tuple *left_tuple = left_->current_tuple();
+    rc                = eval_keys(left_keys_, *left_tuple, probe_keys_, probe_hash_key_);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    joined_tuple_.set_left(left_tuple);
+    return RC::SUCCESS;
+  }
+
+  const size_t key_num = left_keys_.size();
+  while (true) {
+    if (probe_file_ != nullptr) {
+      rc = probe_file_->read_values(spill_values_);
+      if (OB_SUCC(rc)) {
+        break;
+      }
+      if (rc != RC::RECORD_EOF) {
+        return rc;
+      }
+      probe_file_.reset();
+    }
+
+    rc = next_partition();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  probe_keys_.assign(spill_values_.begin(), spill_values_.begin() + key_num);
+  make_hash_key(probe_keys_, probe_hash_key_);
+  probe_tuple_.set_cells(vector<Value>(spill_values_.begin() + key_num, spill_values_.end()));
+  joined_tuple_.set_left(&probe_tuple_);
+  return RC::SUCCESS;
+}
+
+RC HashJoinPhysicalOperator::next()
+{
+  RC rc = RC::SUCCESS;
+  while (true) {
+    while (matched_rows_ != nullptr && matched_pos_ < matched_rows_->size()) {
+      int row = (*matched_rows_)[matched_pos_++];
+      if (!keys_equal(row)) {
+        continue;
+      }
+
+      build_tuple_.set_cells(build_rows_[row]);
+      joined_tuple_.set_right(&build_tuple_);
+      return RC::SUCCESS;
+    }
+
+    rc = fetch_probe_row();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    auto iter     = hash_table_.find(probe_hash_key_);
+    matched_rows_ = iter == hash_table_.end() ? nullptr : &iter->second;
+    matched_pos_  = 0;
+  }
+  return rc;
+}
+
+RC HashJoinPhysicalOperator::close()
+{
+  clear_build();
+  pending_partitions_.clear();
+  probe_file_.reset();
+  probe_specs_.clear();
+  matched_rows_ = nullptr;
+  spilled_      = false;
+
+  if (left_ == nullptr) {
+    return RC::SUCCESS;
+  }
+  RC rc = left_->close();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to close left child of hash join. rc=%s", strrc(rc));
+  }
+  return rc;
+}
+
+Tuple *HashJoinPhysicalOperator::current_tuple() { return &joined_tuple_; }
+
+RC HashJoinPhysicalOperator::eval_keys(
+    const vector<unique_ptr<Expression>> &keys, const Tuple &tuple, vector<Value> &values, string &hash_key)
+{
+  values.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    RC rc = keys[i]->get_value(tuple, values[i]);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to evaluate join key. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+  make_hash_key(values, hash_key);
+  return RC::SUCCESS;
+}
+
+void HashJoinPhysicalOperator::make_hash_key(const vector<Value> &values, string &hash_key)
+{
+  hash_key.clear();
+  for (const Value &value : values) {
+    hash_key.append(value.to_string());
+    hash_key.push_back('\0');
+  }
+}
+
+bool HashJoinPhysicalOperator::keys_equal(int row) const
+{
+  const vector<Value> &build_keys = build_keys_[row];
+  for (size_t i = 0; i < build_keys.size(); i++) {
+    if (probe_keys_[i].compare(build_keys[i]) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
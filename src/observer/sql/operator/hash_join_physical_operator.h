@@ -10,12 +10,139 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/unordered_map.h"
 #include "sql/operator/physical_operator.h"
 #include "sql/parser/parse.h"
+#include "storage/common/spill_file.h"
 
 /**
  * @brief Hash Join 算子
  * @ingroup PhysicalOperator
+ * @details 只支持等值连接。open 时读取右表(build 端)的所有数据，按照连接键放到哈希表中；
+ * next 时依次读取左表(probe 端)的每一行，在哈希表中查找连接键相同的行。
+ * left_keys_[i] 只引用左表的字段，right_keys_[i] 只引用右表的字段，连接条件是它们两两相等。
+ *
+ * 右表的数据超过内存限制时，转为 grace hash join：两边的每一行连同连接键一起，按照连接键的哈希值分区写到临时文件中，
+ * 再依次对每一对分区做 hash join。
  */
-class HashJoinPhysicalOperator
-{};
\ No newline at end of file
+class HashJoinPhysicalOperator : public PhysicalOperator
+{
+public:
+  static constexpr int64_t DEFAULT_MEMORY_LIMIT = 256LL * 1024 * 1024;
+
+  HashJoinPhysicalOperator(vector<unique_ptr<Expression>> &&left_keys, vector<unique_ptr<Expression>> &&right_keys);
+  virtual ~HashJoinPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::HASH_JOIN; }
+
+  OpType get_op_type() const override { return OpType::INNERHASHJOIN; }
+
+  string param() const override;
+
+  /**
+   * @brief 设置哈希表可以使用的内存，单位字节
+   */
+  void set_memory_limit(int64_t memory_limit) { memory_limit_ = memory_limit; }
+
+  RC     open(Trx *trx) override;
+  RC     next() override;
+  RC     close() override;
+  Tuple *current_tuple() override;
+
+private:
+  /**
+   * @brief 一对还没有处理的分区
+   */
+  struct PartitionPair
+  {
+    unique_ptr<SpillFile> build;
+    unique_ptr<SpillFile> probe;
+    int                   depth = 0;
+  };
+
+  /**
+   * @brief 读取右表的所有数据，构建哈希表。超过内存限制时把右表的数据分区写到临时文件中
+   */
+  RC build(SpillPartitions &partitions);
+
+  /**
+   * @brief 把一行数据放到哈希表中
+   */
+  void insert_build_row(vector<Value> &&keys, vector<Value> &&row, const string &hash_key);
+
+  void clear_build();
+
+  /**
+   * @brief 把哈希表中的数据按照分区写到临时文件中，并清空哈希表
+   */
+  RC spill_build(SpillPartitions &partitions);
+
+  /**
+   * @brief 把连接键和一行数据写到分区中，连接键在前
+   */
+  RC spill_row(const vector<Value> &keys, const vector<Value> &row, const string &hash_key, SpillPartitions &partitions);
+
+  /**
+   * @brief 读取左表的所有数据，按照分区写到临时文件中，生成待处理的分区
+   */
+  RC partition_probe(SpillPartitions &build_partitions);
+
+  /**
+   * @brief 取出下一对分区，用右表的分区构建哈希表。分区太大时继续分区
+   * @return 没有分区时返回 RECORD_EOF
+   */
+  RC next_partition();
+
+  /**
+   * @brief 读取下一行左表的数据，计算连接键
+   */
+  RC fetch_probe_row();
+
+  /**
+   * @brief 根据连接键的值生成哈希表中的键
+   */
+  static void make_hash_key(const vector<Value> &values, string &hash_key);
+
+  /**
+   * @brief 计算 tuple 上的连接键
+   * @param keys   连接键表达式
+   * @param values 连接键的值
+   * @param hash_key 用于在哈希表中查找的键。不同的值可能得到相同的 hash_key，需要再比较 values
+   */
+  static RC eval_keys(
+      const vector<unique_ptr<Expression>> &keys, const Tuple &tuple, vector<Value> &values, string &hash_key);
+
+  /**
+   * @brief 当前左表的行与第 row 行是否满足连接条件
+   */
+  bool keys_equal(int row) const;
+
+private:
+  vector<unique_ptr<Expression>> left_keys_;
+  vector<unique_ptr<Expression>> right_keys_;
+
+  PhysicalOperator *left_  = nullptr;
+  PhysicalOperator *right_ = nullptr;
+
+  vector<vector<Value>>                build_rows_;   ///< 右表的所有行
+  vector<vector<Value>>                build_keys_;   ///< 右表每一行的连接键
+  unordered_map<string, vector<int>>   hash_table_;   ///< 连接键到右表行号的映射
+  vector<TupleCellSpec>                build_specs_;  ///< 右表每一列的描述
+  int64_t                              memory_usage_ = 0;  ///< 哈希表使用的内存，估算值
+
+  const vector<int> *matched_rows_ = nullptr;  ///< 当前左表的行在哈希表中找到的行
+  size_t             matched_pos_  = 0;
+  vector<Value>      probe_keys_;
+  string             probe_hash_key_;
+
+  ValueListTuple build_tuple_;
+  JoinedTuple    joined_tuple_;
+
+  int64_t               memory_limit_ = DEFAULT_MEMORY_LIMIT;
+  bool                  spilled_      = false;
+  vector<TupleCellSpec> probe_specs_;  ///< 左表每一列的描述
+  vector<PartitionPair> pending_partitions_;
+  unique_ptr<SpillFile> probe_file_;   ///< 当前正在处理的左表分区
+  ValueListTuple        probe_tuple_;  ///< 从临时文件中读取的左表的行
+  vector<Value>         spill_values_;
+};
@@ -0,0 +1,790 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/hash_join_vec_physical_operator.h"
+#include "common/lang/functional.h"
+#include "common/lang/string_view.h"
+#include "common/log/log.h"
+#include "sql/expr/expression.h"
+
+HashJoinVecPhysicalOperator::HashJoinVecPhysicalOperator(
+    vector<unique_ptr<Expression>> &&left_keys, vector<unique_ptr<Expression>> &&right_keys)
+    : left_keys_(std::move(left_keys)), right_keys_(std::move(right_keys))
+{}
+
+/**
+ * @brief 获取列上第 index 行数据的地址，常量列只有一个值
+ */
+static inline const char *cell_data(const Column &column, int index)
+{
+  if (column.column_type() == Column::Type::CONSTANT_COLUMN) {
+    return column.data();
+  }
+  return column.data() + static_cast<size_t>(index) * column.attr_len();
+}
+
+static inline uint64_t mix_hash(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+static inline uint64_t hash_cell(AttrType attr_type, const char *data, int len)
+{
+  switch (attr_type) {
+    case AttrType::CHARS: {
+      // 字符串后面可能填充了 '\0'，只计算有效部分
+      return hash<string_view>()(string_view(data, strnlen(data, len)));
+    }
+    case AttrType::FLOATS: {
+      float value = *reinterpret_cast<const float *>(data);
+      if (value == 0) {
+        value = 0;  // +0 和 -0 相等，哈希值也要相同
+      }
+      uint32_t bits = 0;
+      memcpy(&bits, &value, sizeof(bits));
+      return mix_hash(bits);
+    }
+    default: {
+      if (len == sizeof(int32_t)) {
+        return mix_hash(*reinterpret_cast<const uint32_t *>(data));
+      }
+      return hash<string_view>()(string_view(data, len));
+    }
+  }
+}
+
+static inline bool cell_equal(AttrType attr_type, const char *left, int left_len, const char *right, int right_len)
+{
+  switch (attr_type) {
+    case AttrType::CHARS: {
+      size_t left_size  = strnlen(left, left_len);
+      size_t right_size = strnlen(right, right_len);
+      return left_size == right_size && memcmp(left, right, left_size) == 0;
+    }
+    case AttrType::FLOATS: {
+      return *reinterpret_cast<const float *>(left) == *reinterpret_cast<const float *>(right);
+    }
+    default: {
+      return left_len == right_len && memcmp(left, right, left_len) == 0;
+    }
+  }
+}
+
+/**
+ * @brief 把列上被 chunk 的选择向量选中的行追加到 build 端的列存中
+ */
+template <typename BuildColumn>
+static void append_column(BuildColumn &to, const Column &from, const Chunk &chunk)
+{
+  const int rows = chunk.selected_rows();
+  if (to.attr_type == AttrType::UNDEFINED) {
+    to.attr_type = from.attr_type();
+    to.attr_len  = from.attr_len();
+  }
+
+  const size_t offset = to.data.size();
+  to.data.resize(offset + static_cast<size_t>(rows) * to.attr_len);
+  if (from.column_type() == Column::Type::CONSTANT_COLUMN) {
+    for (int i = 0; i < rows; i++) {
+      memcpy(to.data.data() + offset + static_cast<size_t>(i) * to.attr_len, from.data(), to.attr_len);
+    }
+  } else if (!chunk.has_selection()) {
+    memcpy(to.data.data() + offset, from.data(), static_cast<size_t>(rows) * to.attr_len);
+  } else {
+    for (int i = 0; i < rows; i++) {
+      memcpy(to.data.data() + offset + static_cast<size_t>(i) * to.attr_len,
+          cell_data(from, chunk.selected_row(i)),
+          to.attr_len);
+    }
+  }
+}
+
+string HashJoinVecPhysicalOperator::param() const
+{
+  auto key_name = [](const Expression &expr) -> string {
+    if (expr.type() == ExprType::FIELD) {
+      const auto &field_expr = static_cast<const FieldExpr &>(expr);
+      return string(field_expr.table_name()) + "." + field_expr.field_name();
+    }
+    return expr.name();
+  };
+
+  string param;
+  for (size_t i = 0; i < left_keys_.size(); i++) {
+    if (i > 0) {
+      param += " AND ";
+    }
+    param += key_name(*left_keys_[i]) + "=" + key_name(*right_keys_[i]);
+  }
+  return param;
+}
+
+RC HashJoinVecPhysicalOperator::open(Trx *trx)
+{
+  if (children_.size() != 2) {
+    LOG_WARN("hash join operator should have 2 children");
+    return RC::INTERNAL;
+  }
+
+  RC rc = prepare_sink(1);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  rc = right_->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open right child of hash join. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rc          = build();
+  RC close_rc = right_->close();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to build hash table. rc=%s", strrc(rc));
+    return rc;
+  }
+  if (OB_FAIL(close_rc)) {
+    LOG_WARN("failed to close right child of hash join. rc=%s", strrc(close_rc));
+    return close_rc;
+  }
+
+  rc = left_->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open left child of hash join. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  if (spilled_) {
+    rc = partition_probe();
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to partition left child of hash join. rc=%s", strrc(rc));
+    }
+  }
+  return rc;
+}
+
+RC HashJoinVecPhysicalOperator::build()
+{
+  RC    rc = RC::SUCCESS;
+  Chunk chunk;
+  while (OB_SUCC(rc = right_->next(chunk))) {
+    rc = build_chunk(chunk);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to get next chunk from right child. rc=%s", strrc(rc));
+    return rc;
+  }
+  return finish_sink();
+}
+
+RC HashJoinVecPhysicalOperator::build_chunk(Chunk &chunk)
+{
+  if (chunk.selected_rows() == 0) {
+    return RC::SUCCESS;
+  }
+
+  if (build_schema_.empty()) {
+    for (int i = 0; i < chunk.column_num(); i++) {
+      build_schema_.emplace_back(chunk.column(i).attr_type(), chunk.column(i).attr_len());
+    }
+  }
+
+  if (spilled_) {
+    return spill_chunk(chunk, right_keys_, *build_partitions_);
+  }
+
+  RC rc = append_build_chunk(chunk);
+  if (OB_SUCC(rc) && memory_usage() > memory_limit_) {
+    LOG_INFO("hash join build side exceeds memory limit, spill to disk. memory usage=%ld, limit=%ld",
+             memory_usage(), memory_limit_);
+    spilled_ = true;
+    rc       = spill_build(*build_partitions_);
+  }
+  return rc;
+}
+
+RC HashJoinVecPhysicalOperator::prepare_sink(int task_num)
+{
+  if (children_.size() != 2) {
+    LOG_WARN("hash join operator should have 2 children");
+    return RC::INTERNAL;
+  }
+
+  left_             = children_[0].get();
+  right_            = children_[1].get();
+  probe_done_       = false;
+  spilled_          = false;
+  partitioned_      = false;
+  build_partitions_ = make_unique<SpillPartitions>(0 /*depth*/);
+  return RC::SUCCESS;
+}
+
+RC HashJoinVecPhysicalOperator::sink(int task, Chunk &chunk)
+{
+  lock_guard guard(lock_);
+  return build_chunk(chunk);
+}
+
+RC HashJoinVecPhysicalOperator::finish_sink()
+{
+  if (!spilled_) {
+    finish_build();
+  }
+  return RC::SUCCESS;
+}
+
+RC HashJoinVecPhysicalOperator::append_build_chunk(Chunk &chunk)
+{
+  if (build_columns_.empty()) {
+    build_columns_.resize(chunk.column_num());
+    build_keys_.resize(right_keys_.size());
+  }
+  for (int i = 0; i < chunk.column_num(); i++) {
+    append_column(build_columns_[i], chunk.column(i), chunk);
+  }
+
+  RC rc = eval_keys(right_keys_, chunk, build_key_columns_);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  for (size_t i = 0; i < build_key_columns_.size(); i++) {
+    append_column(build_keys_[i], *build_key_columns_[i], chunk);
+  }
+
+  hash_keys(build_key_columns_, chunk.rows(), hashes_);
+  for (int i = 0; i < chunk.selected_rows(); i++) {
+    build_hashes_.push_back(hashes_[chunk.selected_row(i)]);
+  }
+  return RC::SUCCESS;
+}
+
+void HashJoinVecPhysicalOperator::finish_build()
+{
+  const size_t rows         = build_hashes_.size();
+  size_t       bucket_count = 16;
+  while (bucket_count < rows * 2) {
+    bucket_count <<= 1;
+  }
+  bucket_mask_ = bucket_count - 1;
+  buckets_.assign(bucket_count, -1);
+  next_.resize(rows);
+  for (size_t i = 0; i < rows; i++) {
+    int &head = buckets_[build_hashes_[i] & bucket_mask_];
+    next_[i]  = head;
+    head      = static_cast<int>(i);
+  }
+
+  LOG_TRACE("hash join build done. rows=%ld, buckets=%ld", rows, bucket_count);
+}
+
+void HashJoinVecPhysicalOperator::clear_build()
+{
+  build_columns_.clear();
+  build_keys_.clear();
+  build_hashes_.clear();
+  buckets_.clear();
+  next_.clear();
+}
+
+int64_t HashJoinVecPhysicalOperator::memory_usage() const
+{
+  int64_t bytes = 0;
+  for (const BuildColumn &column : build_columns_) {
+    bytes += column.data.size();
+  }
+  for (const BuildColumn &column : build_keys_) {
+    bytes += column.data.size();
+  }
+  // 每一行还需要一个哈希值、一个 next 指针，以及平均两个哈希桶
+  bytes += static_cast<int64_t>(build_hashes_.size()) * (sizeof(uint64_t) + 3 * sizeof(int));
+  return bytes;
+}
+
+RC HashJoinVecPhysicalOperator::spill_build(SpillPartitions &partitions)
+{
+  const size_t rows = build_hashes_.size();
+  for (size_t row = 0; row < rows; row++) {
+    row_buffer_.clear();
+    for (const BuildColumn &column : build_columns_) {
+      const char *data = column.row(static_cast<int>(row));
+      row_buffer_.insert(row_buffer_.end(), data, data + column.attr_len);
+    }
+
+    SpillFile *file = nullptr;
+    RC         rc   = partitions.file(partitions.partition_of(build_hashes_[row]), file);
+    if (OB_SUCC(rc)) {
+      rc = file->write(row_buffer_.data(), static_cast<int>(row_buffer_.size()));
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to spill hash join build side. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  clear_build();
+  return RC::SUCCESS;
+}
+
+RC HashJoinVecPhysicalOperator::spill_chunk(
+    Chunk &chunk, vector<unique_ptr<Expression>> &keys, SpillPartitions &partitions)
+{
+  vector<unique_ptr<Column>> key_columns;
+  RC                         rc = eval_keys(keys, chunk, key_columns);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  hash_keys(key_columns, chunk.rows(), hashes_);
+  for (int i = 0; i < chunk.selected_rows(); i++) {
+    const int row = chunk.selected_row(i);
+    row_buffer_.clear();
+    for (int i = 0; i < chunk.column_num(); i++) {
+      const Column &column = chunk.column(i);
+      const char   *data   = cell_data(column, row);
+      row_buffer_.insert(row_buffer_.end(), data, data + column.attr_len());
+    }
+
+    SpillFile *file = nullptr;
+    rc              = partitions.file(partitions.partition_of(hashes_[row]), file);
+    if (OB_SUCC(rc)) {
+      rc = file->write(row_buffer_.data(), static_cast<int>(row_buffer_.size()));
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to spill hash join rows. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC HashJoinVecPhysicalOperator::load_chunk(SpillFile &file, const vector<pair<AttrType, int>> &schema, Chunk &chunk)
+{
+  if (chunk.column_num() != static_cast<int>(schema.size())) {
+    chunk.reset();
+    for (size_t i = 0; i < schema.size(); i++) {
+      chunk.add_column(make_unique<Column>(schema[i].first, schema[i].second), static_cast<int>(i));
+    }
+  }
+  chunk.reset_data();
+
+  RC rc = RC::SUCCESS;
+  for (int rows = 0; rows < static_cast<int>(Column::DEFAULT_CAPACITY); rows++) {
+    rc = file.read(row_buffer_);
+    if (OB_FAIL(rc)) {
+      break;
+    }
+
+    char *data = row_buffer_.data();
+    for (size_t i = 0; i < schema.size(); i++) {
+      chunk.column(i).append_one(data);
+      data += schema[i].second;
+    }
+  }
+
+  if (rc != RC::SUCCESS && rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to read spill file. rc=%s", strrc(rc));
+    return rc;
+  }
+  return chunk.rows() > 0 ? RC::SUCCESS : RC::RECORD_EOF;
+}
+
+RC HashJoinVecPhysicalOperator::partition_probe()
+{
+  probe_partitions_ = make_unique<SpillPartitions>(build_partitions_->depth());
+
+  RC    rc = RC::SUCCESS;
+  Chunk chunk;
+  while (OB_SUCC(rc = left_->next(chunk))) {
+    rc = spill_probe_chunk(chunk);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to get next chunk from left child. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  pair_partitions();
+  return RC::SUCCESS;
+}
+
+RC HashJoinVecPhysicalOperator::spill_probe_chunk(Chunk &chunk)
+{
+  if (chunk.selected_rows() == 0) {
+    return RC::SUCCESS;
+  }
+  if (probe_schema_.empty()) {
+    for (int i = 0; i < chunk.column_num(); i++) {
+      probe_schema_.emplace_back(chunk.column(i).attr_type(), chunk.column(i).attr_len());
+    }
+  }
+  return spill_chunk(chunk, left_keys_, *probe_partitions_);
+}
+
+void HashJoinVecPhysicalOperator::pair_partitions()
+{
+  // 内连接，只有两边都有数据的分区才可能有结果
+  for (int i = 0; i < SpillPartitions::PARTITION_NUM; i++) {
+    unique_ptr<SpillFile> build_file = build_partitions_->release(i);
+    unique_ptr<SpillFile> probe_file = probe_partitions_->release(i);
+    if (build_file != nullptr && probe_file != nullptr) {
+      pending_partitions_.push_back({std::move(build_file), std::move(probe_file), build_partitions_->depth()});
+    }
+  }
+  build_partitions_.reset();
+  probe_partitions_.reset();
+  partitioned_ = true;
+}
+
+RC HashJoinVecPhysicalOperator::next_partition()
+{
+  RC rc = RC::SUCCESS;
+  while (!pending_partitions_.empty()) {
+    PartitionPair partition = std::move(pending_partitions_.back());
+    pending_partitions_.pop_back();
+
+    clear_build();
+    bool too_large = false;
+    if (OB_FAIL(rc = partition.build->rewind())) {
+      return rc;
+    }
+    while (OB_SUCC(rc = load_chunk(*partition.build, build_schema_, load_chunk_))) {
+      if (OB_FAIL(rc = append_build_chunk(load_chunk_))) {
+        return rc;
+      }
+      if (memory_usage() > memory_limit_ && partition.depth + 1 < SpillPartitions::MAX_DEPTH) {
+        too_large = true;
+        break;
+      }
+    }
+    if (rc != RC::SUCCESS && rc != RC::RECORD_EOF) {
+      return rc;
+    }
+
+    if (!too_large) {
+      finish_build();
+      probe_file_ = std::move(partition.probe);
+      return probe_file_->rewind();
+    }
+
+    // 分区仍然太大，用哈希值的下一组位继续分区
+    LOG_INFO("hash join partition exceeds memory limit, partition again. depth=%d, build rows=%ld",
+             partition.depth + 1, partition.build->records());
+    clear_build();
+    SpillPartitions build_partitions(partition.depth + 1);
+    SpillPartitions probe_partitions(partition.depth + 1);
+    SpillFile      *files[2]       = {partition.build.get(), partition.probe.get()};
+    SpillPartitions *partitions[2] = {&build_partitions, &probe_partitions};
+    const vector<pair<AttrType, int>> *schemas[2] = {&build_schema_, &probe_schema_};
+    vector<unique_ptr<Expression>>    *keys[2]    = {&right_keys_, &left_keys_};
+    for (int side = 0; side < 2; side++) {
+      if (OB_FAIL(rc = files[side]->rewind())) {
+        return rc;
+      }
+      while (OB_SUCC(rc = load_chunk(*files[side], *schemas[side], load_chunk_))) {
+        if (OB_FAIL(rc = spill_chunk(load_chunk_, *keys[side], *partitions[side]))) {
+          return rc;
+        }
+      }
+      if (rc != RC::RECORD_EOF) {
+        return rc;
+      }
+    }
+
+    for (int i = 0; i < SpillPartitions::PARTITION_NUM; i++) {
+      unique_ptr<SpillFile> build_file = build_partitions.release(i);
+      unique_ptr<SpillFile> probe_file = probe_partitions.release(i);
+      if (build_file != nullptr && probe_file != nullptr) {
+        pending_partitions_.push_back({std::move(build_file), std::move(probe_file), partition.depth + 1});
+      }
+    }
+  }
+  return RC::RECORD_EOF;
+}
+
+RC HashJoinVecPhysicalOperator::eval_keys(
+    vector<unique_ptr<Expression>> &keys, Chunk &chunk, vector<unique_ptr<Column>> &key_columns)
+{
+  key_columns.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    key_columns[i] = make_unique<Column>();
+    RC rc          = keys[i]->get_column(chunk, *key_columns[i]);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to evaluate join key. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+void HashJoinVecPhysicalOperator::hash_keys(
+    const vector<unique_ptr<Column>> &key_columns, int rows, vector<uint64_t> &hashes)
+{
+  hashes.assign(rows, 0);
+  for (const unique_ptr<Column> &column : key_columns) {
+    const AttrType attr_type = column->attr_type();
+    const int      attr_len  = column->attr_len();
+    for (int i = 0; i < rows; i++) {
+      hashes[i] = mix_hash(hashes[i] * 0x9e3779b97f4a7c15ULL + hash_cell(attr_type, cell_data(*column, i), attr_len));
+    }
+  }
+}
+
+bool HashJoinVecPhysicalOperator::keys_equal(const ProbeState &state, int probe_row, int build_row) const
+{
+  for (size_t i = 0; i < state.probe_keys.size(); i++) {
+    const Column      &probe_key = *state.probe_keys[i];
+    const BuildColumn &build_key = build_keys_[i];
+    if (!cell_equal(probe_key.attr_type(),
+            cell_data(probe_key, probe_row),
+            probe_key.attr_len(),
+            build_key.row(build_row),
+            build_key.attr_len)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+RC HashJoinVecPhysicalOperator::fetch_probe_chunk()
+{
+  RC rc = RC::SUCCESS;
+  if (!spilled_) {
+    rc = left_->next(probe_.probe_chunk);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  } else {
+    while (true) {
+      if (probe_file_ != nullptr) {
+        rc = load_chunk(*probe_file_, probe_schema_, spill_probe_chunk_);
+        if (OB_SUCC(rc)) {
+          probe_.probe_chunk.reference(spill_probe_chunk_);
+          break;
+        }
+        if (rc != RC::RECORD_EOF) {
+          return rc;
+        }
+        probe_file_.reset();
+      }
+
+      rc = next_partition();
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+  }
+
+  return begin_probe(probe_);
+}
+
+RC HashJoinVecPhysicalOperator::begin_probe(ProbeState &state)
+{
+  RC rc = eval_keys(left_keys_, state.probe_chunk, state.probe_keys);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  hash_keys(state.probe_keys, state.probe_chunk.rows(), state.probe_hashes);
+
+  state.probe_row = 0;
+  state.build_row = -1;
+  if (state.probe_chunk.selected_rows() > 0) {
+    state.build_row = buckets_[state.probe_hashes[state.probe_chunk.selected_row(0)] & bucket_mask_];
+  }
+  return RC::SUCCESS;
+}
+
+void HashJoinVecPhysicalOperator::probe(ProbeState &state)
+{
+  const size_t capacity = Column::DEFAULT_CAPACITY;
+  const int    rows     = state.probe_chunk.selected_rows();
+  state.probe_sel.clear();
+  state.build_sel.clear();
+  while (state.probe_row < rows && state.probe_sel.size() < capacity) {
+    if (state.build_row == -1) {
+      state.probe_row++;
+      if (state.probe_row < rows) {
+        state.build_row = buckets_[state.probe_hashes[state.probe_chunk.selected_row(state.probe_row)] & bucket_mask_];
+      }
+      continue;
+    }
+
+    const int probe_row = state.probe_chunk.selected_row(state.probe_row);
+    const int build_row = state.build_row;
+    state.build_row     = next_[build_row];
+    if (build_hashes_[build_row] == state.probe_hashes[probe_row] && keys_equal(state, probe_row, build_row)) {
+      state.probe_sel.push_back(probe_row);
+      state.build_sel.push_back(build_row);
+    }
+  }
+}
+
+RC HashJoinVecPhysicalOperator::next(Chunk &chunk)
+{
+  if (probe_done_ || (!spilled_ && build_hashes_.empty())) {
+    return RC::RECORD_EOF;
+  }
+
+  while (true) {
+    probe(probe_);
+
+    // 输出引用了当前左表 Chunk 的数据，必须在读取下一个 Chunk 之前输出
+    if (!probe_.probe_sel.empty()) {
+      break;
+    }
+
+    RC rc = fetch_probe_chunk();
+    if (rc == RC::RECORD_EOF) {
+      probe_done_ = true;
+      return rc;
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get next chunk from left child. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  gather(probe_);
+  return chunk.reference(probe_.output);
+}
+
+RC HashJoinVecPhysicalOperator::prepare_push(int task_num)
+{
+  task_probes_.clear();
+  for (int i = 0; i < task_num; i++) {
+    task_probes_.emplace_back(make_unique<ProbeState>());
+  }
+  if (spilled_ && probe_partitions_ == nullptr) {
+    probe_partitions_ = make_unique<SpillPartitions>(build_partitions_->depth());
+  }
+  return RC::SUCCESS;
+}
+
+RC HashJoinVecPhysicalOperator::push(int task, Chunk &input, Chunk &output, bool &has_more_output)
+{
+  has_more_output = false;
+  if (spilled_) {
+    lock_guard guard(lock_);
+    return spill_probe_chunk(input);
+  }
+  if (build_hashes_.empty()) {
+    return RC::SUCCESS;
+  }
+
+  ProbeState &state = *task_probes_[task];
+  if (!state.in_progress) {
+    state.probe_chunk.reference(input);
+    RC rc = begin_probe(state);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  probe(state);
+  state.in_progress = state.probe_row < state.probe_chunk.selected_rows();
+  has_more_output   = state.in_progress;
+  if (state.probe_sel.empty()) {
+    return RC::SUCCESS;
+  }
+  gather(state);
+  return output.reference(state.output);
+}
+
+RC HashJoinVecPhysicalOperator::finish_push(int task, Chunk &output, bool &has_more_output)
+{
+  has_more_output = false;
+  if (!spilled_) {
+    return RC::SUCCESS;
+  }
+
+  // 所有任务都已经把左表的数据写到分区中，依次处理每一对分区
+  if (!partitioned_) {
+    pair_partitions();
+  }
+  RC rc = next(output);
+  if (rc == RC::RECORD_EOF) {
+    return RC::SUCCESS;
+  }
+  has_more_output = OB_SUCC(rc);
+  return rc;
+}
+
+void HashJoinVecPhysicalOperator::gather(ProbeState &state)
+{
+  const int    rows          = static_cast<int>(state.probe_sel.size());
+  Chunk       &probe_chunk   = state.probe_chunk;
+  Chunk       &output        = state.output;
+  const int    probe_columns = probe_chunk.column_num();
+  if (output.column_num() != probe_columns + static_cast<int>(build_columns_.size())) {
+    output.reset();
+    for (int i = 0; i < probe_columns; i++) {
+      const Column &column = probe_chunk.column(i);
+      output.add_column(make_unique<Column>(column.attr_type(), column.attr_len(), Column::DEFAULT_CAPACITY), i);
+    }
+    for (size_t i = 0; i < build_columns_.size(); i++) {
+      const BuildColumn &column = build_columns_[i];
+      output.add_column(make_unique<Column>(column.attr_type, column.attr_len, Column::DEFAULT_CAPACITY),
+          probe_columns + static_cast<int>(i));
+    }
+  }
+
+  for (int i = 0; i < probe_columns; i++) {
+    const Column &from = probe_chunk.column(i);
+    Column       &to   = output.column(i);
+    const int     len  = from.attr_len();
+    for (int row = 0; row < rows; row++) {
+      memcpy(to.data() + static_cast<size_t>(row) * len, cell_data(from, state.probe_sel[row]), len);
+    }
+    to.set_count(rows);
+  }
+
+  for (size_t i = 0; i < build_columns_.size(); i++) {
+    const BuildColumn &from = build_columns_[i];
+    Column            &to   = output.column(probe_columns + i);
+    for (int row = 0; row < rows; row++) {
+      memcpy(to.data() + static_cast<size_t>(row) * from.attr_len, from.row(state.build_sel[row]), from.attr_len);
+    }
+    to.set_count(rows);
+  }
+}
+
+RC HashJoinVecPhysicalOperator::close()
+{
+  clear_build();
+  pending_partitions_.clear();
+  probe_file_.reset();
+  build_schema_.clear();
+  probe_schema_.clear();
+  build_partitions_.reset();
+  probe_partitions_.reset();
+  spilled_ = false;
+  probe_.probe_chunk.reset();
+  probe_.probe_keys.clear();
+  probe_.probe_hashes.clear();
+  probe_.probe_sel.clear();
+  probe_.build_sel.clear();
+  probe_.output.reset();
+  task_probes_.clear();
+
+  if (left_ != nullptr) {
+    return left_->close();
+  }
+  return RC::SUCCESS;
+}
@@ -0,0 +1,238 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/mutex.h"
+#include "sql/operator/physical_operator.h"
+#include "storage/common/spill_file.h"
+
+/**
+ * @brief Hash Join 算子(Vectorized)
+ * @ingroup PhysicalOperator
+ * @details 只支持等值连接。open 时读取右表(build 端)的所有 Chunk，按列保存到 build 端的列存中，
+ * 同时计算每一行连接键的哈希值，用链式哈希表组织起来；next 时一次计算整个左表(probe 端) Chunk 的
+ * 连接键哈希值，查找哈希表得到匹配的行对，记录在两个选择向量中，最后按照选择向量把左右两边的列拷贝到输出 Chunk。
+ * 输出 Chunk 中先是左表的所有列，然后是右表的所有列。两边输入的 Chunk 带有选择向量时只处理选中的行。
+ * left_keys_[i] 只引用左表的字段，right_keys_[i] 只引用右表的字段，两两之间的类型相同。
+ *
+ * 右表的数据超过内存限制时，转为 grace hash join：按照连接键的哈希值把两边的数据都分区写到临时文件中，
+ * 再依次对每一对分区做 hash join。某个分区仍然超过内存限制时，用哈希值的其它位继续分区。
+ *
+ * 在 pipeline 中，这个算子是右表所在 pipeline 的 sink，多个任务的数据串行写入哈希表；
+ * 同时是左表所在 pipeline 中的流式算子，每个任务使用自己的探测状态并发地查找哈希表。
+ * 写过临时文件时，push 只把左表的数据写到分区中，finish_push 再依次处理每一对分区。
+ */
+class HashJoinVecPhysicalOperator : public PhysicalOperator
+{
+public:
+  static constexpr int64_t DEFAULT_MEMORY_LIMIT = 256LL * 1024 * 1024;
+
+  HashJoinVecPhysicalOperator(vector<unique_ptr<Expression>> &&left_keys, vector<unique_ptr<Expression>> &&right_keys);
+  virtual ~HashJoinVecPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::HASH_JOIN_VEC; }
+
+  string param() const override;
+
+  /**
+   * @brief 设置哈希表可以使用的内存，单位字节
+   */
+  void set_memory_limit(int64_t memory_limit) { memory_limit_ = memory_limit; }
+
+  RC open(Trx *trx) override;
+  RC next(Chunk &chunk) override;
+  RC close() override;
+
+  bool                       is_sink() const override { return true; }
+  vector<PhysicalOperator *> sink_children() override { return {children_[1].get()}; }
+  RC                         prepare_sink(int task_num) override;
+  RC                         sink(int task, Chunk &chunk) override;
+  RC                         finish_sink() override;
+
+  bool is_streaming() const override { return true; }
+  RC   prepare_push(int task_num) override;
+  RC   push(int task, Chunk &input, Chunk &output, bool &has_more_output) override;
+  RC   finish_push(int task, Chunk &output, bool &has_more_output) override;
+
+private:
+  /**
+   * @brief build 端按列保存的数据，可以一直追加
+   */
+  struct BuildColumn
+  {
+    AttrType     attr_type = AttrType::UNDEFINED;
+    int          attr_len  = 0;
+    vector<char> data;
+
+    const char *row(int index) const { return data.data() + static_cast<size_t>(index) * attr_len; }
+  };
+
+  /**
+   * @brief 一对还没有处理的分区
+   */
+  struct PartitionPair
+  {
+    unique_ptr<SpillFile> build;
+    unique_ptr<SpillFile> probe;
+    int                   depth = 0;
+  };
+
+  /**
+   * @brief 左表一个 Chunk 的探测状态。一个 Chunk 的结果可能超过一个输出 Chunk 的容量，需要分多次输出
+   */
+  struct ProbeState
+  {
+    Chunk                      probe_chunk;
+    vector<unique_ptr<Column>> probe_keys;
+    vector<uint64_t>           probe_hashes;
+    int                        probe_row = 0;   ///< 正在处理的左表的行在选择向量中的位置
+    int                        build_row = -1;  ///< probe_row 在哈希桶中下一个要比较的行，-1 表示已经比较完
+
+    vector<int> probe_sel;  ///< 输出的每一行对应的左表行号
+    vector<int> build_sel;  ///< 输出的每一行对应的右表行号
+    Chunk       output;
+
+    bool in_progress = false;  ///< push 模式下当前 Chunk 是否还有没有输出的结果
+  };
+
+  /**
+   * @brief 读取右表的所有数据，构建哈希表。超过内存限制时把右表的数据分区写到临时文件中
+   */
+  RC build();
+
+  /**
+   * @brief 把右表的一个 Chunk 写入哈希表或者临时文件
+   */
+  RC build_chunk(Chunk &chunk);
+
+  /**
+   * @brief 把 chunk 中的数据追加到哈希表中，还没有建立哈希桶
+   */
+  RC append_build_chunk(Chunk &chunk);
+
+  /**
+   * @brief 根据 build 端每一行的哈希值建立哈希桶
+   */
+  void finish_build();
+
+  void clear_build();
+
+  /**
+   * @brief 哈希表使用的内存，包括还没有建立的哈希桶
+   */
+  int64_t memory_usage() const;
+
+  /**
+   * @brief 把哈希表中的数据按照分区写到临时文件中，并清空哈希表
+   */
+  RC spill_build(SpillPartitions &partitions);
+
+  /**
+   * @brief 计算 chunk 中每一行连接键的哈希值，按照分区写到临时文件中
+   */
+  RC spill_chunk(Chunk &chunk, vector<unique_ptr<Expression>> &keys, SpillPartitions &partitions);
+
+  /**
+   * @brief 从临时文件中读取最多一个 Chunk 的数据
+   * @return 没有数据时返回 RECORD_EOF
+   */
+  RC load_chunk(SpillFile &file, const vector<pair<AttrType, int>> &schema, Chunk &chunk);
+
+  /**
+   * @brief 读取左表的所有数据，按照分区写到临时文件中，生成待处理的分区
+   */
+  RC partition_probe();
+
+  /**
+   * @brief 把左表的一个 Chunk 按照分区写到临时文件中
+   */
+  RC spill_probe_chunk(Chunk &chunk);
+
+  /**
+   * @brief 两边的数据都分区之后，生成待处理的分区
+   */
+  void pair_partitions();
+
+  /**
+   * @brief 取出下一对分区，用右表的分区构建哈希表。分区太大时继续分区
+   * @return 没有分区时返回 RECORD_EOF
+   */
+  RC next_partition();
+
+  /**
+   * @brief 读取下一个左表的 Chunk，计算连接键和哈希值
+   */
+  RC fetch_probe_chunk();
+
+  /**
+   * @brief 计算 state.probe_chunk 的连接键和哈希值，从第一行开始探测
+   */
+  RC begin_probe(ProbeState &state);
+
+  /**
+   * @brief 从上次的位置继续查找哈希表，直到处理完整个左表 Chunk 或者结果填满一个输出 Chunk
+   */
+  void probe(ProbeState &state);
+
+  /**
+   * @brief 计算 keys 在 chunk 上的值
+   */
+  static RC eval_keys(vector<unique_ptr<Expression>> &keys, Chunk &chunk, vector<unique_ptr<Column>> &key_columns);
+
+  /**
+   * @brief 计算每一行连接键的哈希值，多个连接键的哈希值合并在一起
+   */
+  static void hash_keys(const vector<unique_ptr<Column>> &key_columns, int rows, vector<uint64_t> &hashes);
+
+  /**
+   * @brief 左表当前 Chunk 的第 probe_row 行与右表第 build_row 行的连接键是否相等
+   */
+  bool keys_equal(const ProbeState &state, int probe_row, int build_row) const;
+
+  /**
+   * @brief 按照选择向量生成输出数据
+   */
+  void gather(ProbeState &state);
+
+private:
+  vector<unique_ptr<Expression>> left_keys_;
+  vector<unique_ptr<Expression>> right_keys_;
+
+  PhysicalOperator *left_  = nullptr;
+  PhysicalOperator *right_ = nullptr;
+
+  vector<BuildColumn> build_columns_;  ///< 右表的所有列
+  vector<BuildColumn> build_keys_;     ///< 右表每一行的连接键
+  vector<uint64_t>    build_hashes_;   ///< 右表每一行连接键的哈希值
+  vector<int>         buckets_;        ///< 哈希桶中第一行的行号，-1 表示空桶
+  vector<int>         next_;           ///< 同一个哈希桶中下一行的行号
+  uint64_t            bucket_mask_ = 0;
+
+  ProbeState                     probe_;        ///< next 使用的探测状态
+  vector<unique_ptr<ProbeState>> task_probes_;  ///< push 模式下每个任务的探测状态
+  bool                           probe_done_ = false;
+
+  int64_t                     memory_limit_ = DEFAULT_MEMORY_LIMIT;
+  bool                        spilled_      = false;
+  vector<pair<AttrType, int>> build_schema_;  ///< 右表每一列的类型和长度，写到临时文件中的一行就是所有列依次排列
+  vector<pair<AttrType, int>> probe_schema_;  ///< 左表每一列的类型和长度
+  unique_ptr<SpillPartitions> build_partitions_;
+  unique_ptr<SpillPartitions> probe_partitions_;
+  bool                        partitioned_ = false;  ///< 是否已经生成了待处理的分区
+  vector<PartitionPair>       pending_partitions_;
+  unique_ptr<SpillFile>       probe_file_;  ///< 当前正在处理的左表分区
+  Chunk                       load_chunk_;         ///< 从临时文件中读取的右表数据
+  Chunk                       spill_probe_chunk_;  ///< 从临时文件中读取的左表数据
+  vector<char>                row_buffer_;
+  vector<unique_ptr<Column>>  build_key_columns_;
+  vector<uint64_t>            hashes_;
+  mutex                       lock_;  ///< push 模式下保护哈希表的构建和左表的分区
+};
@@ -0,0 +1,42 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/operator/physical_operator.h"
+
+/**
+ * @brief 限制输出行数的物理算子
+ * @ingroup PhysicalOperator
+ * @details 输出子算子的前 limit 行，之后不再从子算子读取数据
+ */
+class LimitPhysicalOperator : public PhysicalOperator
+{
+public:
+  explicit LimitPhysicalOperator(int limit) : limit_(limit) {}
+  virtual ~LimitPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::LIMIT; }
+  OpType               get_op_type() const override { return OpType::LIMIT; }
+
+  string param() const override { return std::to_string(limit_); }
+
+  RC open(Trx *trx) override;
+  RC next() override;
+  RC close() override;
+
+  Tuple *current_tuple() override { return children_[0]->current_tuple(); }
+
+  RC tuple_schema(TupleSchema &schema) const override { return children_[0]->tuple_schema(schema); }
+
+private:
+  int limit_ = 0;
+  int count_ = 0;  ///< 已经输出的行数
+};
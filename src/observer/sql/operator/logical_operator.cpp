@@ -28,6 +28,8 @@ bool LogicalOperator::can_generate_vectorized_operator(const LogicalOperatorType
   case LogicalOperatorType::CALC:
   case LogicalOperatorType::DELETE:
   case LogicalOperatorType::INSERT:
+  case LogicalOperatorType::ORDER_BY:
+  case LogicalOperatorType::LIMIT:
     bool_ret = false;
     break;
   
@@ -38,6 +40,19 @@ bool LogicalOperator::can_generate_vectorized_operator(const LogicalOperatorType
   return bool_ret;
 }
 
+bool LogicalOperator::can_generate_vectorized_operator() const
+{
+  if (!can_generate_vectorized_operator(type())) {
+    return false;
+  }
+  for (const unique_ptr<LogicalOperator> &child : children_) {
+    if (!child->can_generate_vectorized_operator()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void LogicalOperator::generate_general_child()
 {
   for (auto &child : children_) {
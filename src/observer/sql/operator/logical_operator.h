@@ -40,6 +40,8 @@ enum class LogicalOperatorType
   DELETE,      ///< 删除，删除可能会有子查询
   EXPLAIN,     ///< 查看执行计划
   GROUP_BY,    ///< 分组
+  ORDER_BY,    ///< 排序
+  LIMIT,       ///< 限制输出的行数
 };
 
 /**
@@ -62,6 +64,8 @@ public:
   auto        children() -> vector<unique_ptr<LogicalOperator>>        &{ return children_; }
   auto        expressions() -> vector<unique_ptr<Expression>>        &{ return expressions_; }
   static bool can_generate_vectorized_operator(const LogicalOperatorType &type);
+  /// 以当前算子为根的整棵树是否都可以生成向量化算子
+  bool can_generate_vectorized_operator() const;
   // TODO: used by cascade optimizer, tmp function, need to be remove
   void generate_general_child();
 
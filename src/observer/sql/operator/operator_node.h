@@ -29,6 +29,7 @@ enum class OpType
   LOGICALGET,
   LOGICALCALCULATE,
   LOGICALGROUPBY,
+  LOGICALORDERBY,
   LOGICALPROJECTION,
   LOGICALFILTER,
   LOGICALINNERJOIN,
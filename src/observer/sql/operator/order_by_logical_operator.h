@@ -0,0 +1,43 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/operator/logical_operator.h"
+
+/**
+ * @brief 排序逻辑算子
+ * @ingroup LogicalOperator
+ * @details 按照 order_by_exprs 依次比较，ascending 表示每个表达式是否升序。
+ * limit 不是 -1 时表示只需要输出前 limit 行，可以用 top-N 的方式执行。
+ */
+class OrderByLogicalOperator : public LogicalOperator
+{
+public:
+  OrderByLogicalOperator(vector<unique_ptr<Expression>> &&order_by_exprs, vector<bool> &&ascending)
+      : order_by_exprs_(std::move(order_by_exprs)), ascending_(std::move(ascending))
+  {}
+
+  virtual ~OrderByLogicalOperator() = default;
+
+  LogicalOperatorType type() const override { return LogicalOperatorType::ORDER_BY; }
+  OpType              get_op_type() const override { return OpType::LOGICALORDERBY; }
+
+  vector<unique_ptr<Expression>> &order_by_expressions() { return order_by_exprs_; }
+  vector<bool>                   &ascending() { return ascending_; }
+
+  int  limit() const { return limit_; }
+  void set_limit(int limit) { limit_ = limit; }
+
+private:
+  vector<unique_ptr<Expression>> order_by_exprs_;
+  vector<bool>                   ascending_;
+  int                            limit_ = -1;
+};
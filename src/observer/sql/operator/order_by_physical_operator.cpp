@@ -0,0 +1,342 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/order_by_physical_operator.h"
+#include "common/lang/algorithm.h"
+#include "common/log/log.h"
+#include "sql/operator/sort_key.h"
+
+OrderByPhysicalOperator::OrderByPhysicalOperator(
+    vector<unique_ptr<Expression>> &&order_by_exprs, vector<bool> &&ascending)
+    : order_by_exprs_(std::move(order_by_exprs)), ascending_(std::move(ascending))
+{
+  ASSERT(order_by_exprs_.size() == ascending_.size(), "order by expressions and directions should have the same size");
+}
+
+string OrderByPhysicalOperator::order_by_param(
+    const vector<unique_ptr<Expression>> &exprs, const vector<bool> &ascending)
+{
+  string param;
+  for (size_t i = 0; i < exprs.size(); i++) {
+    if (i > 0) {
+      param += ", ";
+    }
+    param += exprs[i]->name();
+    if (!ascending[i]) {
+      param += " DESC";
+    }
+  }
+  return param;
+}
+
+string OrderByPhysicalOperator::param() const { return order_by_param(order_by_exprs_, ascending_); }
+
+RC OrderByPhysicalOperator::open(Trx *trx)
+{
+  if (children_.size() != 1) {
+    LOG_WARN("order by operator must has one child");
+    return RC::INTERNAL;
+  }
+
+  RC rc = children_[0]->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open child operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rows_.clear();
+  runs_.clear();
+  memory_usage_ = 0;
+  run_count_    = 0;
+  row_index_    = 0;
+  merging_      = false;
+  specs_.clear();
+
+  rc = fetch_rows();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  if (runs_.empty()) {
+    stable_sort(rows_.begin(), rows_.end(), [](const SortRow &a, const SortRow &b) { return a.key < b.key; });
+    return RC::SUCCESS;
+  }
+
+  // 已经有数据写到了临时文件中，剩下的数据也作为一个有序段，然后统一归并
+  if (!rows_.empty()) {
+    rc = spill_run();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  rc = reduce_runs();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  LOG_INFO("order by spilled. runs=%d", run_count_);
+  merging_ = true;
+  return merger_.init(std::move(runs_));
+}
+
+RC OrderByPhysicalOperator::fetch_rows()
+{
+  RC                rc    = RC::SUCCESS;
+  PhysicalOperator *child = children_[0].get();
+  while (OB_SUCC(rc = child->next())) {
+    Tuple *tuple = child->current_tuple();
+    if (nullptr == tuple) {
+      LOG_WARN("failed to get tuple from child operator");
+      return RC::INTERNAL;
+    }
+
+    const int cell_num = tuple->cell_num();
+    if (specs_.empty()) {
+      for (int i = 0; i < cell_num; i++) {
+        TupleCellSpec spec;
+        rc = tuple->spec_at(i, spec);
+        if (OB_FAIL(rc)) {
+          LOG_WARN("failed to get tuple cell spec. index=%d, rc=%s", i, strrc(rc));
+          return rc;
+        }
+        specs_.push_back(spec);
+      }
+      tuple_.set_names(specs_);
+    }
+
+    SortRow row;
+    rc = SortKey::encode(order_by_exprs_, ascending_, *tuple, row.key);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    row.values.resize(cell_num);
+    for (int i = 0; i < cell_num; i++) {
+      rc = tuple->cell_at(i, row.values[i]);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to get tuple cell. index=%d, rc=%s", i, strrc(rc));
+        return rc;
+      }
+    }
+
+    memory_usage_ += row_memory(row);
+    rows_.push_back(std::move(row));
+    if (memory_usage_ > memory_limit_) {
+      rc = spill_run();
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+  }
+
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to get next tuple from child operator. rc=%s", strrc(rc));
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+int64_t OrderByPhysicalOperator::row_memory(const SortRow &row)
+{
+  int64_t size = sizeof(SortRow) + row.key.size() + row.values.size() * sizeof(Value);
+  for (const Value &value : row.values) {
+    if (value.attr_type() == AttrType::CHARS) {
+      size += value.length();
+    }
+  }
+  return size;
+}
+
+RC OrderByPhysicalOperator::spill_run()
+{
+  stable_sort(rows_.begin(), rows_.end(), [](const SortRow &a, const SortRow &b) { return a.key < b.key; });
+
+  auto run = make_unique<SpillFile>();
+  RC   rc  = run->open();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  for (const SortRow &row : rows_) {
+    rc = write_row(*run, row, buffer_);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  LOG_TRACE("write sort run. rows=%ld, bytes=%ld", run->records(), run->bytes());
+  runs_.push_back(std::move(run));
+  run_count_++;
+  rows_.clear();
+  memory_usage_ = 0;
+  return RC::SUCCESS;
+}
+
+RC OrderByPhysicalOperator::reduce_runs()
+{
+  while (static_cast<int>(runs_.size()) > MERGE_WAYS) {
+    vector<unique_ptr<SpillFile>> merged_runs;
+    for (size_t start = 0; start < runs_.size(); start += MERGE_WAYS) {
+      const size_t end = min(runs_.size(), start + MERGE_WAYS);
+      if (end - start == 1) {
+        merged_runs.push_back(std::move(runs_[start]));
+        continue;
+      }
+
+      RunMerger                     merger;
+      vector<unique_ptr<SpillFile>> group;
+      for (size_t i = start; i < end; i++) {
+        group.push_back(std::move(runs_[i]));
+      }
+      RC rc = merger.init(std::move(group));
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+
+      auto merged = make_unique<SpillFile>();
+      rc          = merged->open();
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+
+      SortRow row;
+      while (OB_SUCC(rc = merger.next(row))) {
+        rc = write_row(*merged, row, buffer_);
+        if (OB_FAIL(rc)) {
+          return rc;
+        }
+      }
+      if (rc != RC::RECORD_EOF) {
+        return rc;
+      }
+      merged_runs.push_back(std::move(merged));
+    }
+
+    LOG_TRACE("merge sort runs. before=%d, after=%d", static_cast<int>(runs_.size()), static_cast<int>(merged_runs.size()));
+    runs_.swap(merged_runs);
+  }
+  return RC::SUCCESS;
+}
+
+RC OrderByPhysicalOperator::write_row(SpillFile &file, const SortRow &row, vector<char> &buffer)
+{
+  // 记录格式：[排序键长度][排序键][所有的值]
+  const int32_t key_length = static_cast<int32_t>(row.key.size());
+  buffer.clear();
+  buffer.insert(buffer.end(),
+      reinterpret_cast<const char *>(&key_length), reinterpret_cast<const char *>(&key_length) + sizeof(key_length));
+  buffer.insert(buffer.end(), row.key.begin(), row.key.end());
+  SpillFile::serialize_values(row.values, buffer);
+  return file.write(buffer.data(), static_cast<int>(buffer.size()));
+}
+
+RC OrderByPhysicalOperator::read_row(SpillFile &file, SortRow &row, vector<char> &buffer)
+{
+  RC rc = file.read(buffer);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  int32_t key_length = 0;
+  if (buffer.size() < sizeof(key_length)) {
+    LOG_WARN("invalid sort run record. size=%d", static_cast<int>(buffer.size()));
+    return RC::IOERR_READ;
+  }
+  memcpy(&key_length, buffer.data(), sizeof(key_length));
+  const char *data = buffer.data() + sizeof(key_length);
+  row.key.assign(data, key_length);
+  data += key_length;
+  SpillFile::deserialize_values(data, static_cast<int>(buffer.data() + buffer.size() - data), row.values);
+  return RC::SUCCESS;
+}
+
+RC OrderByPhysicalOperator::RunMerger::init(vector<unique_ptr<SpillFile>> &&runs)
+{
+  runs_ = std::move(runs);
+  heads_.clear();
+  heads_.resize(runs_.size());
+  heap_.clear();
+
+  for (size_t i = 0; i < runs_.size(); i++) {
+    RC rc = runs_[i]->rewind();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    rc = read_row(*runs_[i], heads_[i], buffer_);
+    if (rc == RC::RECORD_EOF) {
+      continue;
+    }
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    heap_.push_back(static_cast<int>(i));
+  }
+
+  auto cmp = [this](int left, int right) { return greater(left, right); };
+  make_heap(heap_.begin(), heap_.end(), cmp);
+  return RC::SUCCESS;
+}
+
+bool OrderByPhysicalOperator::RunMerger::greater(int left, int right) const
+{
+  const int result = heads_[left].key.compare(heads_[right].key);
+  return result > 0 || (result == 0 && left > right);
+}
+
+RC OrderByPhysicalOperator::RunMerger::next(SortRow &row)
+{
+  if (heap_.empty()) {
+    return RC::RECORD_EOF;
+  }
+
+  auto cmp = [this](int left, int right) { return greater(left, right); };
+  pop_heap(heap_.begin(), heap_.end(), cmp);
+  const int run = heap_.back();
+  row       = std::move(heads_[run]);
+  RC rc = read_row(*runs_[run], heads_[run], buffer_);
+  if (rc == RC::RECORD_EOF) {
+    heap_.pop_back();
+    runs_[run].reset();
+    return RC::SUCCESS;
+  }
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  push_heap(heap_.begin(), heap_.end(), cmp);
+  return RC::SUCCESS;
+}
+
+RC OrderByPhysicalOperator::next()
+{
+  if (merging_) {
+    RC rc = merger_.next(current_row_);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    tuple_.set_cells(current_row_.values);
+    return RC::SUCCESS;
+  }
+
+  if (row_index_ >= rows_.size()) {
+    return RC::RECORD_EOF;
+  }
+  tuple_.set_cells(rows_[row_index_].values);
+  row_index_++;
+  return RC::SUCCESS;
+}
+
+RC OrderByPhysicalOperator::close()
+{
+  rows_.clear();
+  runs_.clear();
+  merger_ = RunMerger();
+  return children_[0]->close();
+}
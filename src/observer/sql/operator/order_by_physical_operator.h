@@ -0,0 +1,132 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/expr/tuple.h"
+#include "sql/operator/physical_operator.h"
+#include "storage/common/spill_file.h"
+
+/**
+ * @brief 排序物理算子
+ * @ingroup PhysicalOperator
+ * @details open 时读取子算子的所有数据，每一行计算排序键(参考 SortKey)后和这一行的所有值一起缓存在内存中。
+ * 缓存的数据超过内存限制时，排好序后作为一个有序段(run)写到临时文件中，最后对所有有序段做多路归并。
+ * 有序段太多时先分批归并成较少的有序段，每次最多同时归并 MERGE_WAYS 个。
+ * 排序是稳定的，排序键相同的行按照子算子输出的顺序输出。
+ */
+class OrderByPhysicalOperator : public PhysicalOperator
+{
+public:
+  static constexpr int64_t DEFAULT_MEMORY_LIMIT = 256LL * 1024 * 1024;
+  static constexpr int     MERGE_WAYS           = 64;
+
+  OrderByPhysicalOperator(vector<unique_ptr<Expression>> &&order_by_exprs, vector<bool> &&ascending);
+  virtual ~OrderByPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::ORDER_BY; }
+  OpType               get_op_type() const override { return OpType::ORDERBY; }
+
+  string param() const override;
+
+  /**
+   * @brief 设置排序可以使用的内存，单位字节
+   */
+  void set_memory_limit(int64_t memory_limit) { memory_limit_ = memory_limit; }
+
+  RC open(Trx *trx) override;
+  RC next() override;
+  RC close() override;
+
+  Tuple *current_tuple() override { return &tuple_; }
+
+  RC tuple_schema(TupleSchema &schema) const override { return children_[0]->tuple_schema(schema); }
+
+  /**
+   * @brief 生成的有序段的个数，没有写临时文件时是 0
+   */
+  int run_count() const { return run_count_; }
+
+  /**
+   * @brief 排序键和表达式在 explain 中的显示，top-N 算子也使用
+   */
+  static string order_by_param(const vector<unique_ptr<Expression>> &exprs, const vector<bool> &ascending);
+
+private:
+  struct SortRow
+  {
+    string        key;
+    vector<Value> values;
+  };
+
+  /**
+   * @brief 对多个有序段做归并
+   * @details 每个有序段当前的第一行放在一个小根堆中，排序键相同时编号小的有序段在前，保证排序的稳定
+   */
+  class RunMerger
+  {
+  public:
+    RC init(vector<unique_ptr<SpillFile>> &&runs);
+
+    /**
+     * @brief 取出下一行
+     * @return 所有有序段都已经读完时返回 RECORD_EOF
+     */
+    RC next(SortRow &row);
+
+  private:
+    bool greater(int left, int right) const;
+
+  private:
+    vector<unique_ptr<SpillFile>> runs_;
+    vector<SortRow>               heads_;  ///< 每个有序段当前的第一行
+    vector<int>                   heap_;   ///< 还没有读完的有序段的编号
+    vector<char>                  buffer_;
+  };
+
+  /**
+   * @brief 读取子算子的所有数据，必要时生成有序段
+   */
+  RC fetch_rows();
+
+  /**
+   * @brief 把内存中的数据排序后写成一个有序段
+   */
+  RC spill_run();
+
+  /**
+   * @brief 把多个有序段分批归并，直到有序段的个数不超过 MERGE_WAYS
+   */
+  RC reduce_runs();
+
+  static int64_t row_memory(const SortRow &row);
+
+  static RC write_row(SpillFile &file, const SortRow &row, vector<char> &buffer);
+  static RC read_row(SpillFile &file, SortRow &row, vector<char> &buffer);
+
+private:
+  vector<unique_ptr<Expression>> order_by_exprs_;
+  vector<bool>                   ascending_;
+  int64_t                        memory_limit_ = DEFAULT_MEMORY_LIMIT;
+
+  vector<SortRow>               rows_;  ///< 内存中还没有写成有序段的数据
+  int64_t                       memory_usage_ = 0;
+  vector<unique_ptr<SpillFile>> runs_;
+  int                           run_count_ = 0;
+  vector<char>                  buffer_;
+
+  bool      merging_   = false;  ///< 是否从有序段中归并输出
+  size_t    row_index_ = 0;      ///< 不需要归并时，下一个输出的行
+  RunMerger merger_;
+  SortRow   current_row_;
+
+  vector<TupleCellSpec> specs_;
+  ValueListTuple        tuple_;
+};
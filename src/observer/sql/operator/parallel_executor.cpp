@@ -0,0 +1,61 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/parallel_executor.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/condition_variable.h"
+#include "common/lang/mutex.h"
+#include "common/lang/thread.h"
+#include "common/log/log.h"
+
+common::ThreadPoolExecutor &parallel_executor()
+{
+  static common::ThreadPoolExecutor *executor = []() {
+    auto *executor    = new common::ThreadPoolExecutor();
+    int   max_threads = max(1, static_cast<int>(thread::hardware_concurrency()));
+    if (executor->init("ParallelExec", 0 /*core_pool_size*/, max_threads, 60 * 1000 /*keep_alive_time_ms*/) != 0) {
+      LOG_ERROR("failed to init parallel executor");
+    }
+    return executor;
+  }();
+  return *executor;
+}
+
+RC run_parallel(int task_num, const function<RC(int)> &task)
+{
+  mutex              lock;
+  condition_variable done;
+  int                running = task_num;
+  RC                 rc      = RC::SUCCESS;
+
+  auto run = [&](int index) {
+    RC task_rc = task(index);
+
+    lock_guard guard(lock);
+    if (OB_FAIL(task_rc) && OB_SUCC(rc)) {
+      rc = task_rc;
+    }
+    if (--running == 0) {
+      done.notify_all();
+    }
+  };
+
+  common::ThreadPoolExecutor &executor = parallel_executor();
+  for (int i = 0; i < task_num; i++) {
+    if (executor.execute([&run, i]() { run(i); }) != 0) {
+      LOG_WARN("failed to submit parallel task, run it in current thread. index=%d", i);
+      run(i);
+    }
+  }
+
+  unique_lock guard(lock);
+  done.wait(guard, [&running]() { return running == 0; });
+  return rc;
+}
@@ -0,0 +1,31 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/functional.h"
+#include "common/sys/rc.h"
+#include "common/thread/thread_pool_executor.h"
+
+/**
+ * @brief 执行并行算子的线程池，所有查询共享
+ * @ingroup PhysicalOperator
+ * @details 不设置核心线程，空闲的线程一段时间后会自动退出。
+ * 线程池不会被释放，避免进程退出时与其它全局对象的析构顺序产生问题。
+ */
+common::ThreadPoolExecutor &parallel_executor();
+
+/**
+ * @brief 在 parallel_executor 中并行执行 task(0) 到 task(task_num - 1)，等待所有任务结束
+ * @ingroup PhysicalOperator
+ * @details 任务之间不能互相等待。提交失败的任务在当前线程中执行。
+ * @return 第一个失败的任务的返回值
+ */
+RC run_parallel(int task_num, const function<RC(int)> &task);
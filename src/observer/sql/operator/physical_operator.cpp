@@ -21,8 +21,13 @@ string physical_operator_type_name(PhysicalOperatorType type)
     case PhysicalOperatorType::INDEX_SCAN: return "INDEX_SCAN";
     case PhysicalOperatorType::NESTED_LOOP_JOIN: return "NESTED_LOOP_JOIN";
     case PhysicalOperatorType::HASH_JOIN: return "HASH_JOIN";
+    case PhysicalOperatorType::HASH_JOIN_VEC: return "HASH_JOIN_VEC";
+    case PhysicalOperatorType::ORDER_BY: return "ORDER_BY";
+    case PhysicalOperatorType::TOP_N: return "TOP_N";
+    case PhysicalOperatorType::LIMIT: return "LIMIT";
     case PhysicalOperatorType::EXPLAIN: return "EXPLAIN";
     case PhysicalOperatorType::PREDICATE: return "PREDICATE";
+    case PhysicalOperatorType::PREDICATE_VEC: return "PREDICATE_VEC";
     case PhysicalOperatorType::INSERT: return "INSERT";
     case PhysicalOperatorType::DELETE: return "DELETE";
     case PhysicalOperatorType::PROJECT: return "PROJECT";
@@ -34,6 +39,8 @@ string physical_operator_type_name(PhysicalOperatorType type)
     case PhysicalOperatorType::PROJECT_VEC: return "PROJECT_VEC";
     case PhysicalOperatorType::TABLE_SCAN_VEC: return "TABLE_SCAN_VEC";
     case PhysicalOperatorType::EXPR_VEC: return "EXPR_VEC";
+    case PhysicalOperatorType::GATHER_VEC: return "GATHER_VEC";
+    case PhysicalOperatorType::PIPELINE_VEC: return "PIPELINE_VEC";
     default: return "UNKNOWN";
   }
 }
@@ -39,6 +39,10 @@ enum class PhysicalOperatorType
   INDEX_SCAN,
   NESTED_LOOP_JOIN,
   HASH_JOIN,
+  HASH_JOIN_VEC,
+  ORDER_BY,
+  TOP_N,
+  LIMIT,
   EXPLAIN,
   PREDICATE,
   PREDICATE_VEC,
@@ -53,6 +57,8 @@ enum class PhysicalOperatorType
   GROUP_BY_VEC,
   AGGREGATE_VEC,
   EXPR_VEC,
+  GATHER_VEC,
+  PIPELINE_VEC,
 };
 
 /**
@@ -86,6 +92,52 @@ public:
 
   virtual RC tuple_schema(TupleSchema &schema) const { return RC::UNIMPLEMENTED; }
 
+  /**
+   * @name push 模式的接口
+   * @details 由 Pipeline 驱动算子执行，算子不再打开、读取和关闭自己的子算子。
+   * task 是 pipeline 中任务的编号，不同的任务可能在不同的线程中执行，算子需要为每个任务保存单独的状态。
+   * @{
+   */
+
+  /// 流式算子，每个输入的 Chunk 可以直接得到输出，可以放在 pipeline 的中间
+  virtual bool is_streaming() const { return false; }
+
+  /// 需要先读取全部输入的算子（pipeline breaker），作为 sink 结束一个 pipeline
+  virtual bool is_sink() const { return false; }
+
+  /// 作为 sink 时输入数据的子算子，有多个时每个子算子是一个任务
+  virtual vector<PhysicalOperator *> sink_children() { return {}; }
+
+  /// 流式算子为 task_num 个任务准备状态
+  virtual RC prepare_push(int task_num) { return RC::UNIMPLEMENTED; }
+
+  /**
+   * @brief 流式算子处理第一个子算子的一个 Chunk
+   * @param output 调用前是空的，没有输出时不需要设置
+   * @param has_more_output 输出已经满了，需要再用同一个 input 调用一次
+   */
+  virtual RC push(int task, Chunk &input, Chunk &output, bool &has_more_output) { return RC::UNIMPLEMENTED; }
+
+  /**
+   * @brief 所有任务的输入都处理完之后，输出算子中缓存的数据。只在一个任务中调用
+   */
+  virtual RC finish_push(int task, Chunk &output, bool &has_more_output)
+  {
+    has_more_output = false;
+    return RC::SUCCESS;
+  }
+
+  /// sink 为 task_num 个任务准备状态
+  virtual RC prepare_sink(int task_num) { return RC::UNIMPLEMENTED; }
+
+  /// 写入一个任务的一个 Chunk，不同的任务可能并发调用
+  virtual RC sink(int task, Chunk &chunk) { return RC::UNIMPLEMENTED; }
+
+  /// 所有数据都写入之后调用，之后由 next 返回结果
+  virtual RC finish_sink() { return RC::UNIMPLEMENTED; }
+
+  /** @} */
+
   void add_child(unique_ptr<PhysicalOperator> oper) { children_.emplace_back(std::move(oper)); }
 
   vector<unique_ptr<PhysicalOperator>> &children() { return children_; }
@@ -0,0 +1,266 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/pipeline.h"
+#include "common/log/log.h"
+#include "sql/operator/parallel_executor.h"
+
+void Pipeline::add_source(PhysicalOperator *source, bool materialized)
+{
+  sources_.push_back(source);
+  materialized_source_ = materialized;
+}
+
+void Pipeline::add_operator_front(PhysicalOperator *oper) { operators_.insert(operators_.begin(), oper); }
+
+void Pipeline::init_task(Task &task, int id)
+{
+  task.id     = id;
+  task.source = sources_[id];
+  task.chunks.clear();
+  for (size_t i = 0; i <= operators_.size(); i++) {
+    task.chunks.emplace_back(make_unique<Chunk>());
+  }
+  task.in_process.clear();
+  task.source_done = false;
+  task.finish      = false;
+  task.finish_pos  = 0;
+}
+
+RC Pipeline::execute(Trx *trx)
+{
+  ASSERT(sink_ != nullptr && !sources_.empty(), "pipeline without sink or source");
+
+  const int task_num = this->task_num();
+  RC        rc       = sink_->prepare_sink(task_num);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to prepare sink. sink=%s, rc=%s", sink_->name().c_str(), strrc(rc));
+    return rc;
+  }
+
+  for (PhysicalOperator *oper : operators_) {
+    rc = oper->prepare_push(task_num);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to prepare operator. operator=%s, rc=%s", oper->name().c_str(), strrc(rc));
+      return rc;
+    }
+  }
+
+  vector<Task> tasks(task_num);
+  rc = run_parallel(task_num, [this, trx, &tasks](int index) {
+    Task &task = tasks[index];
+    init_task(task, index);
+
+    RC rc = RC::SUCCESS;
+    if (!materialized_source_) {
+      rc = task.source->open(trx);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to open source. source=%s, rc=%s", task.source->name().c_str(), strrc(rc));
+        return rc;
+      }
+    }
+
+    rc = run_task(task);
+
+    // 表扫描持有页面的锁，在打开它的线程中关闭
+    if (!materialized_source_) {
+      RC close_rc = task.source->close();
+      if (OB_FAIL(close_rc)) {
+        LOG_WARN("failed to close source. source=%s, rc=%s", task.source->name().c_str(), strrc(close_rc));
+        rc = OB_SUCC(rc) ? close_rc : rc;
+      }
+    }
+    return rc;
+  });
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to run pipeline. pipeline=%s, rc=%s", to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  // 所有任务的输入都处理完之后，在一个任务中输出中间算子缓存的数据
+  tasks[0].finish = true;
+  rc              = run_task(tasks[0]);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to finish pipeline. pipeline=%s, rc=%s", to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  rc = sink_->finish_sink();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to finish sink. sink=%s, rc=%s", sink_->name().c_str(), strrc(rc));
+    return rc;
+  }
+
+  LOG_TRACE("pipeline done. pipeline=%s", to_string().c_str());
+  return rc;
+}
+
+RC Pipeline::open(Trx *trx)
+{
+  ASSERT(sink_ == nullptr && sources_.size() == 1, "the last pipeline should have only one source");
+
+  for (PhysicalOperator *oper : operators_) {
+    RC rc = oper->prepare_push(1);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to prepare operator. operator=%s, rc=%s", oper->name().c_str(), strrc(rc));
+      return rc;
+    }
+  }
+
+  init_task(root_task_, 0);
+  root_task_.finish = true;
+  if (materialized_source_) {
+    return RC::SUCCESS;
+  }
+
+  RC rc = root_task_.source->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open source. source=%s, rc=%s", root_task_.source->name().c_str(), strrc(rc));
+    return rc;
+  }
+  root_opened_ = true;
+  return rc;
+}
+
+RC Pipeline::next(Chunk &chunk)
+{
+  Chunk *result = nullptr;
+  RC     rc     = step(root_task_, result);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  return chunk.reference(*result);
+}
+
+RC Pipeline::close()
+{
+  if (!root_opened_) {
+    return RC::SUCCESS;
+  }
+  root_opened_ = false;
+  return root_task_.source->close();
+}
+
+string Pipeline::to_string() const
+{
+  string result;
+  if (!sources_.empty()) {
+    result = sources_[0]->name();
+    if (sources_.size() > 1) {
+      result += "(x" + std::to_string(sources_.size()) + ")";
+    }
+  }
+  for (PhysicalOperator *oper : operators_) {
+    result += " -> " + oper->name();
+  }
+  if (sink_ != nullptr) {
+    result += " -> " + sink_->name();
+  }
+  return result;
+}
+
+RC Pipeline::run_task(Task &task)
+{
+  RC     rc     = RC::SUCCESS;
+  Chunk *result = nullptr;
+  while (OB_SUCC(rc = step(task, result))) {
+    rc = sink_->sink(task.id, *result);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to sink chunk. sink=%s, rc=%s", sink_->name().c_str(), strrc(rc));
+      return rc;
+    }
+  }
+  return rc == RC::RECORD_EOF ? RC::SUCCESS : rc;
+}
+
+RC Pipeline::step(Task &task, Chunk *&result)
+{
+  RC rc = RC::SUCCESS;
+  while (true) {
+    size_t level = 0;
+    if (!task.in_process.empty()) {
+      level = task.in_process.back();
+    } else if (!task.source_done) {
+      Chunk &chunk = *task.chunks[0];
+      chunk.reset();
+      rc = task.source->next(chunk);
+      if (rc == RC::RECORD_EOF) {
+        task.source_done = true;
+        continue;
+      }
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to get chunk from source. source=%s, rc=%s", task.source->name().c_str(), strrc(rc));
+        return rc;
+      }
+      if (empty_chunk(chunk)) {
+        continue;
+      }
+    } else if (task.finish && task.finish_pos < operators_.size()) {
+      // finish_push 的输出从下一个算子开始处理
+      const size_t pos      = task.finish_pos;
+      Chunk       &output   = *task.chunks[pos + 1];
+      bool         has_more = false;
+      output.reset();
+      rc = operators_[pos]->finish_push(task.id, output, has_more);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to finish operator. operator=%s, rc=%s", operators_[pos]->name().c_str(), strrc(rc));
+        return rc;
+      }
+      if (!has_more) {
+        task.finish_pos++;
+      }
+      if (empty_chunk(output)) {
+        continue;
+      }
+      level = pos + 1;
+    } else {
+      return RC::RECORD_EOF;
+    }
+
+    bool has_output = false;
+    rc              = push(task, level, has_output);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    if (has_output) {
+      result = task.chunks.back().get();
+      return RC::SUCCESS;
+    }
+  }
+}
+
+RC Pipeline::push(Task &task, size_t level, bool &has_output)
+{
+  has_output = false;
+  for (size_t i = level; i < operators_.size(); i++) {
+    Chunk &output   = *task.chunks[i + 1];
+    bool   has_more = false;
+    output.reset();
+    RC rc = operators_[i]->push(task.id, *task.chunks[i], output, has_more);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to push chunk. operator=%s, rc=%s", operators_[i]->name().c_str(), strrc(rc));
+      return rc;
+    }
+
+    // 栈顶的算子是从上一次没有处理完的地方继续的
+    const bool resumed = !task.in_process.empty() && task.in_process.back() == i;
+    if (resumed && !has_more) {
+      task.in_process.pop_back();
+    } else if (!resumed && has_more) {
+      task.in_process.push_back(i);
+    }
+
+    if (empty_chunk(output)) {
+      return RC::SUCCESS;
+    }
+  }
+  has_output = true;
+  return RC::SUCCESS;
+}
@@ -0,0 +1,114 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/memory.h"
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "sql/operator/physical_operator.h"
+#include "storage/common/chunk.h"
+
+/**
+ * @brief push 模式执行的一段执行计划
+ * @ingroup PhysicalOperator
+ * @details 执行计划在 pipeline breaker（比如哈希表的构建、聚合）处切分成多个 pipeline。
+ * 每个 pipeline 从 source 读取 Chunk，依次 push 给中间的流式算子，最后交给 sink。
+ * 整个 pipeline 是一个紧凑的循环，中间算子之间不再有 next 的虚函数调用链。
+ *
+ * 一个 pipeline 可以有多个 source，比如共享 morsel 队列的多个表扫描算子。每个 source 是一个任务，
+ * 在 parallel_executor 中并行执行，中间算子和 sink 为每个任务保存单独的状态。
+ * 没有 sink 的 pipeline 是整个查询的最后一个，只有一个任务，由 next 逐个返回结果。
+ */
+class Pipeline
+{
+public:
+  Pipeline() = default;
+
+  /**
+   * @brief 增加一个 source
+   * @param materialized 是否是已经执行完 sink 的 pipeline breaker，这种 source 只调用 next，不再打开和关闭
+   */
+  void add_source(PhysicalOperator *source, bool materialized);
+
+  /**
+   * @brief 在最前面增加一个流式算子。切分执行计划时从上往下遍历，后遇到的算子先执行
+   */
+  void add_operator_front(PhysicalOperator *oper);
+
+  void set_sink(PhysicalOperator *sink) { sink_ = sink; }
+
+  PhysicalOperator *sink() const { return sink_; }
+  int               task_num() const { return static_cast<int>(sources_.size()); }
+
+  /**
+   * @brief 执行有 sink 的 pipeline，每个 source 一个任务，全部写入 sink 后结束 sink
+   */
+  RC execute(Trx *trx);
+
+  /**
+   * @brief 没有 sink 的 pipeline 用 open/next/close 逐个返回结果
+   */
+  RC open(Trx *trx);
+  RC next(Chunk &chunk);
+  RC close();
+
+  /**
+   * @brief 比如 `TABLE_SCAN_VEC(x4) -> PREDICATE_VEC -> GROUP_BY_VEC`
+   */
+  string to_string() const;
+
+private:
+  /**
+   * @brief 一个任务的执行状态
+   */
+  struct Task
+  {
+    int               id     = 0;
+    PhysicalOperator *source = nullptr;
+
+    vector<unique_ptr<Chunk>> chunks;      ///< chunks[0] 是 source 的输出，chunks[i + 1] 是第 i 个算子的输出
+    vector<size_t>            in_process;  ///< 还有输出没有返回的算子，下一次从栈顶的算子继续处理
+    bool                      source_done = false;
+    bool                      finish      = false;  ///< source 结束后是否调用算子的 finish_push
+    size_t                    finish_pos  = 0;      ///< 下一个调用 finish_push 的算子
+  };
+
+  void init_task(Task &task, int id);
+
+  /**
+   * @brief 执行到产生一个最终的输出
+   * @param result 最后一个算子的输出，在下一次调用之前有效
+   * @return 所有数据都处理完时返回 RECORD_EOF
+   */
+  RC step(Task &task, Chunk *&result);
+
+  /**
+   * @brief 把 chunks[level] push 给第 level 个算子以及后面所有的算子
+   * @return 是否产生了最终的输出
+   */
+  RC push(Task &task, size_t level, bool &has_output);
+
+  /**
+   * @brief 在当前线程中执行一个任务直到结束，结果写入 sink
+   */
+  RC run_task(Task &task);
+
+  static bool empty_chunk(const Chunk &chunk) { return chunk.column_num() == 0 || chunk.selected_rows() == 0; }
+
+private:
+  vector<PhysicalOperator *> sources_;
+  bool                       materialized_source_ = false;
+  vector<PhysicalOperator *> operators_;
+  PhysicalOperator          *sink_ = nullptr;
+
+  Task root_task_;           ///< 没有 sink 时由 next 驱动的任务
+  bool root_opened_ = false;
+};
@@ -0,0 +1,125 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/pipeline_vec_physical_operator.h"
+#include "common/log/log.h"
+
+string PipelineVecPhysicalOperator::param() const
+{
+  return "pipelines=" + std::to_string(pipelines_.size() + (root_pipeline_ != nullptr ? 1 : 0));
+}
+
+RC PipelineVecPhysicalOperator::build_pipelines()
+{
+  if (children_.size() != 1) {
+    LOG_WARN("pipeline operator should have one child");
+    return RC::INTERNAL;
+  }
+
+  pipelines_.clear();
+  root_pipeline_ = make_unique<Pipeline>();
+  RC rc          = build(children_[0].get(), *root_pipeline_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to build pipelines. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  for (const unique_ptr<Pipeline> &pipeline : pipelines_) {
+    LOG_TRACE("pipeline: %s", pipeline->to_string().c_str());
+  }
+  LOG_TRACE("pipeline: %s", root_pipeline_->to_string().c_str());
+  return rc;
+}
+
+RC PipelineVecPhysicalOperator::build(PhysicalOperator *oper, Pipeline &pipeline)
+{
+  if (oper->is_streaming() && !oper->children().empty()) {
+    pipeline.add_operator_front(oper);
+    // hash join 同时是 build 端 pipeline 的 sink
+    if (oper->is_sink()) {
+      RC rc = build_sink_pipeline(oper);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+    return build(oper->children()[0].get(), pipeline);
+  }
+
+  if (oper->is_sink()) {
+    pipeline.add_source(oper, true /*materialized*/);
+    return build_sink_pipeline(oper);
+  }
+
+  // sink 前面的 gather 不需要再汇总数据，每个子算子直接作为 pipeline 的一个任务
+  if (oper->type() == PhysicalOperatorType::GATHER_VEC && pipeline.sink() != nullptr && pipeline.task_num() == 0) {
+    for (unique_ptr<PhysicalOperator> &child : oper->children()) {
+      pipeline.add_source(child.get(), false /*materialized*/);
+    }
+    return RC::SUCCESS;
+  }
+
+  pipeline.add_source(oper, false /*materialized*/);
+  return RC::SUCCESS;
+}
+
+RC PipelineVecPhysicalOperator::build_sink_pipeline(PhysicalOperator *sink)
+{
+  auto pipeline = make_unique<Pipeline>();
+  pipeline->set_sink(sink);
+
+  vector<PhysicalOperator *> inputs = sink->sink_children();
+  if (inputs.empty()) {
+    LOG_WARN("sink operator has no input. sink=%s", sink->name().c_str());
+    return RC::INTERNAL;
+  }
+
+  if (inputs.size() == 1) {
+    RC rc = build(inputs[0], *pipeline);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  } else {
+    // 多个子算子共享数据源，比如并行的表扫描，每个子算子是一个任务
+    for (PhysicalOperator *input : inputs) {
+      pipeline->add_source(input, false /*materialized*/);
+    }
+  }
+
+  pipelines_.emplace_back(std::move(pipeline));
+  return RC::SUCCESS;
+}
+
+RC PipelineVecPhysicalOperator::open(Trx *trx)
+{
+  RC rc = build_pipelines();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  for (unique_ptr<Pipeline> &pipeline : pipelines_) {
+    rc = pipeline->execute(trx);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to execute pipeline. pipeline=%s, rc=%s", pipeline->to_string().c_str(), strrc(rc));
+      return rc;
+    }
+  }
+
+  return root_pipeline_->open(trx);
+}
+
+RC PipelineVecPhysicalOperator::next(Chunk &chunk) { return root_pipeline_->next(chunk); }
+
+RC PipelineVecPhysicalOperator::close()
+{
+  if (root_pipeline_ == nullptr) {
+    return RC::SUCCESS;
+  }
+  return root_pipeline_->close();
+}
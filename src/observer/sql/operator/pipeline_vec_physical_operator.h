@@ -0,0 +1,65 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/operator/physical_operator.h"
+#include "sql/operator/pipeline.h"
+
+/**
+ * @brief 用 push 模式执行子算子的物理算子(Vectorized)
+ * @ingroup PhysicalOperator
+ * @details execution_mode 为 pipeline 时放在向量化执行计划的最上面。open 时把子算子的执行计划切分成多个 Pipeline，
+ * 按照依赖关系依次执行所有有 sink 的 pipeline，最后一个 pipeline 由 next 逐个返回结果。
+ * 子算子都由 pipeline 驱动执行，不再调用它们的 open/next/close，表扫描这类 source 除外。
+ */
+class PipelineVecPhysicalOperator : public PhysicalOperator
+{
+public:
+  PipelineVecPhysicalOperator() = default;
+
+  virtual ~PipelineVecPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::PIPELINE_VEC; }
+
+  string param() const override;
+
+  RC open(Trx *trx) override;
+  RC next(Chunk &chunk) override;
+  RC close() override;
+
+  RC tuple_schema(TupleSchema &schema) const override { return children_[0]->tuple_schema(schema); }
+
+  /**
+   * @brief 切分执行计划，不执行
+   */
+  RC build_pipelines();
+
+  /// 有 sink 的 pipeline，按照执行的顺序排列
+  const vector<unique_ptr<Pipeline>> &pipelines() const { return pipelines_; }
+  const Pipeline                     *root_pipeline() const { return root_pipeline_.get(); }
+
+private:
+  /**
+   * @brief 把 oper 以及下面的算子加入到 pipeline 中
+   * @details 流式算子加在 pipeline 的最前面，继续处理它的第一个子算子；sink 算子是 pipeline 的 source，
+   * 同时为它创建一个新的 pipeline；其它算子作为 source 直接调用 next。
+   */
+  RC build(PhysicalOperator *oper, Pipeline &pipeline);
+
+  /**
+   * @brief 创建以 sink 结束的 pipeline，它依赖的 pipeline 排在它的前面
+   */
+  RC build_sink_pipeline(PhysicalOperator *sink);
+
+private:
+  vector<unique_ptr<Pipeline>> pipelines_;
+  unique_ptr<Pipeline>         root_pipeline_;
+};
@@ -0,0 +1,95 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/predicate_vec_physical_operator.h"
+#include "common/log/log.h"
+
+PredicateVecPhysicalOperator::PredicateVecPhysicalOperator(unique_ptr<Expression> expr) : expression_(std::move(expr))
+{
+  ASSERT(expression_->value_type() == AttrType::BOOLEANS, "predicate's expression should be BOOLEAN type");
+}
+
+RC PredicateVecPhysicalOperator::open(Trx *trx)
+{
+  if (children_.size() != 1) {
+    LOG_WARN("predicate operator must has one child");
+    return RC::INTERNAL;
+  }
+
+  return children_[0]->open(trx);
+}
+
+RC PredicateVecPhysicalOperator::next(Chunk &chunk)
+{
+  RC rc = RC::SUCCESS;
+  while (true) {
+    chunk_.reset();
+    rc = children_[0]->next(chunk_);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    rc = filter(chunk_, selection_, chunk);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    if (!selection_.empty()) {
+      break;
+    }
+  }
+  return rc;
+}
+
+RC PredicateVecPhysicalOperator::prepare_push(int task_num)
+{
+  task_selections_.resize(task_num);
+  return RC::SUCCESS;
+}
+
+RC PredicateVecPhysicalOperator::push(int task, Chunk &input, Chunk &output, bool &has_more_output)
+{
+  has_more_output = false;
+  return filter(input, task_selections_[task], output);
+}
+
+RC PredicateVecPhysicalOperator::filter(Chunk &input, vector<int> &selection, Chunk &output)
+{
+  if (input.has_selection()) {
+    selection = input.selection();
+  } else {
+    selection.resize(input.rows());
+    for (int i = 0; i < input.rows(); i++) {
+      selection[i] = i;
+    }
+  }
+
+  RC rc = expression_->filter(input, selection);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to filter chunk. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  if (selection.empty()) {
+    return RC::SUCCESS;
+  }
+
+  rc = output.reference(input);
+  if (OB_SUCC(rc)) {
+    output.set_selection(selection);
+  }
+  return rc;
+}
+
+RC PredicateVecPhysicalOperator::close()
+{
+  children_[0]->close();
+  return RC::SUCCESS;
+}
@@ -0,0 +1,52 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/expr/expression.h"
+#include "sql/operator/physical_operator.h"
+
+/**
+ * @brief 过滤/谓词物理算子(vectorized)
+ * @ingroup PhysicalOperator
+ * @details 对子算子输出的每个 Chunk 计算过滤条件，只生成选择向量，不拷贝也不移动列中的数据。
+ * 子算子的 Chunk 已经带有选择向量时，只对其中的行计算过滤条件。没有任何行满足条件的 Chunk 直接跳过。
+ * 这是一个流式算子，可以放在 pipeline 的中间。
+ */
+class PredicateVecPhysicalOperator : public PhysicalOperator
+{
+public:
+  PredicateVecPhysicalOperator(unique_ptr<Expression> expr);
+
+  virtual ~PredicateVecPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::PREDICATE_VEC; }
+  OpType               get_op_type() const override { return OpType::FILTER; }
+
+  RC open(Trx *trx) override;
+  RC next(Chunk &chunk) override;
+  RC close() override;
+
+  bool is_streaming() const override { return true; }
+  RC   prepare_push(int task_num) override;
+  RC   push(int task, Chunk &input, Chunk &output, bool &has_more_output) override;
+
+private:
+  /**
+   * @brief 计算 input 的过滤条件，有满足条件的行时让 output 引用 input 并设置选择向量
+   */
+  RC filter(Chunk &input, vector<int> &selection, Chunk &output);
+
+private:
+  unique_ptr<Expression> expression_;
+  Chunk                  chunk_;
+  vector<int>            selection_;
+  vector<vector<int>>    task_selections_;  ///< push 模式下每个任务的选择向量
+};
@@ -56,6 +56,12 @@ RC ProjectVecPhysicalOperator::next(Chunk &chunk)
   return rc;
 }
 
+RC ProjectVecPhysicalOperator::push(int task, Chunk &input, Chunk &output, bool &has_more_output)
+{
+  has_more_output = false;
+  return output.reference(input);
+}
+
 RC ProjectVecPhysicalOperator::close()
 {
   if (!children_.empty()) {
@@ -33,6 +33,10 @@ public:
 
   RC tuple_schema(TupleSchema &schema) const override;
 
+  bool is_streaming() const override { return true; }
+  RC   prepare_push(int task_num) override { return RC::SUCCESS; }
+  RC   push(int task, Chunk &input, Chunk &output, bool &has_more_output) override;
+
   vector<unique_ptr<Expression>> &expressions() { return expressions_; }
 
 private:
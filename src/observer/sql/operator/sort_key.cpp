@@ -0,0 +1,81 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/sort_key.h"
+#include "common/log/log.h"
+#include "sql/expr/expression.h"
+#include "sql/expr/tuple.h"
+
+static void append_uint32(uint32_t value, string &key)
+{
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    key.push_back(static_cast<char>((value >> shift) & 0xFF));
+  }
+}
+
+RC SortKey::append(const Value &value, bool ascending, string &key)
+{
+  const size_t start = key.size();
+  switch (value.attr_type()) {
+    case AttrType::INTS: {
+      append_uint32(static_cast<uint32_t>(value.get_int()) ^ 0x80000000U, key);
+    } break;
+    case AttrType::DATES: {
+      append_uint32(static_cast<uint32_t>(value.get_date().value()) ^ 0x80000000U, key);
+    } break;
+    case AttrType::FLOATS: {
+      float number = value.get_float();
+      if (number == 0) {
+        number = 0;  // -0 与 +0 相等
+      }
+      uint32_t bits = 0;
+      memcpy(&bits, &number, sizeof(bits));
+      bits = (bits & 0x80000000U) ? ~bits : (bits | 0x80000000U);
+      append_uint32(bits, key);
+    } break;
+    case AttrType::CHARS: {
+      key.append(value.data(), strnlen(value.data(), value.length()));
+      key.push_back('\0');
+    } break;
+    case AttrType::BOOLEANS: {
+      key.push_back(value.get_boolean() ? 1 : 0);
+    } break;
+    default: {
+      LOG_WARN("unsupported sort key type. type=%s", attr_type_to_string(value.attr_type()));
+      return RC::UNSUPPORTED;
+    }
+  }
+
+  if (!ascending) {
+    for (size_t i = start; i < key.size(); i++) {
+      key[i] = ~key[i];
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC SortKey::encode(
+    const vector<unique_ptr<Expression>> &exprs, const vector<bool> &ascending, const Tuple &tuple, string &key)
+{
+  key.clear();
+  Value value;
+  for (size_t i = 0; i < exprs.size(); i++) {
+    RC rc = exprs[i]->get_value(tuple, value);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to evaluate sort key. rc=%s", strrc(rc));
+      return rc;
+    }
+    rc = append(value, ascending[i], key);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
@@ -0,0 +1,43 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "common/sys/rc.h"
+#include "common/value.h"
+
+class Expression;
+class Tuple;
+
+/**
+ * @brief 把排序键编码成可以直接按字节比较的二进制串
+ * @ingroup PhysicalOperator
+ * @details 排序时只需要比较编码后的字符串(memcmp)，不需要按照类型逐列比较 Value。
+ * - 整数和日期：翻转符号位后按大端序保存；
+ * - 浮点数：正数翻转符号位，负数翻转所有位，再按大端序保存；
+ * - 字符串：保存所有字符，最后加一个 '\0'，这样短的前缀排在前面；
+ * 降序的列把这一列编码后的所有字节取反。
+ */
+class SortKey
+{
+public:
+  /**
+   * @brief 把 value 编码后追加到 key 中
+   */
+  static RC append(const Value &value, bool ascending, string &key);
+
+  /**
+   * @brief 计算 tuple 上所有排序表达式的值，编码到 key 中
+   */
+  static RC encode(
+      const vector<unique_ptr<Expression>> &exprs, const vector<bool> &ascending, const Tuple &tuple, string &key);
+};
@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "sql/operator/table_scan_vec_physical_operator.h"
 #include "event/sql_debug.h"
+#include "sql/expr/expression.h"
 #include "storage/table/table.h"
 
 using namespace std;
@@ -21,12 +22,14 @@ RC TableScanVecPhysicalOperator::open(Trx *trx)
     LOG_WARN("failed to get chunk scanner", strrc(rc));
     return rc;
   }
+  chunk_scanner_.set_zone_predicates(zone_predicates());
+  if (morsels_ != nullptr) {
+    chunk_scanner_.set_morsel_queue(morsels_.get());
+  }
   // TODO: don't need to fetch all columns from record manager
   for (int i = 0; i < table_->table_meta().field_num(); ++i) {
     all_columns_.add_column(
         make_unique<Column>(*table_->table_meta().field(i)), table_->table_meta().field(i)->field_id());
-    filterd_columns_.add_column(
-        make_unique<Column>(*table_->table_meta().field(i)), table_->table_meta().field(i)->field_id());
   }
   return rc;
 }
@@ -34,32 +37,32 @@ RC TableScanVecPhysicalOperator::open(Trx *trx)
 RC TableScanVecPhysicalOperator::next(Chunk &chunk)
 {
   RC rc = RC::SUCCESS;
+  while (true) {
+    all_columns_.reset_data();
+    rc = chunk_scanner_.next_chunk(all_columns_);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
 
-  all_columns_.reset_data();
-  filterd_columns_.reset_data();
-  if (OB_SUCC(rc = chunk_scanner_.next_chunk(all_columns_))) {
-    select_.assign(all_columns_.rows(), 1);
     if (predicates_.empty()) {
-      chunk.reference(all_columns_);
-    } else {
-      rc = filter(all_columns_);
-      if (rc != RC::SUCCESS) {
-        LOG_TRACE("filtered failed=%s", strrc(rc));
-        return rc;
-      }
-      // TODO: if all setted, it doesn't need to set one by one
-      for (int i = 0; i < all_columns_.rows(); i++) {
-        if (select_[i] == 0) {
-          continue;
-        }
-        for (int j = 0; j < all_columns_.column_num(); j++) {
-          filterd_columns_.column(j).append_one(
-              (char *)all_columns_.column(filterd_columns_.column_ids(j)).get_value(i).data());
-        }
-      }
-      chunk.reference(filterd_columns_);
+      return chunk.reference(all_columns_);
+    }
+
+    rc = filter(all_columns_);
+    if (rc != RC::SUCCESS) {
+      LOG_TRACE("filtered failed=%s", strrc(rc));
+      return rc;
+    }
+    // 不拷贝满足条件的行，只把选择向量交给下游算子
+    if (!selection_.empty()) {
+      break;
     }
   }
+
+  rc = chunk.reference(all_columns_);
+  if (OB_SUCC(rc)) {
+    chunk.set_selection(selection_);
+  }
   return rc;
 }
 
@@ -72,11 +75,56 @@ void TableScanVecPhysicalOperator::set_predicates(vector<unique_ptr<Expression>>
   predicates_ = std::move(exprs);
 }
 
+vector<ZonePredicate> TableScanVecPhysicalOperator::zone_predicates() const
+{
+  vector<ZonePredicate> zone_predicates;
+  for (const unique_ptr<Expression> &expr : predicates_) {
+    if (expr->type() != ExprType::COMPARISON) {
+      continue;
+    }
+
+    auto        comparison_expr = static_cast<ComparisonExpr *>(expr.get());
+    Expression *left            = comparison_expr->left().get();
+    Expression *right           = comparison_expr->right().get();
+    CompOp      comp            = comparison_expr->comp();
+    if (left->type() == ExprType::VALUE && right->type() == ExprType::FIELD) {
+      // 常量在左边时，交换左右两边，比较符号也要反过来
+      std::swap(left, right);
+      switch (comp) {
+        case LESS_THAN: comp = GREAT_THAN; break;
+        case LESS_EQUAL: comp = GREAT_EQUAL; break;
+        case GREAT_THAN: comp = LESS_THAN; break;
+        case GREAT_EQUAL: comp = LESS_EQUAL; break;
+        default: break;
+      }
+    }
+    if (left->type() != ExprType::FIELD || right->type() != ExprType::VALUE) {
+      continue;
+    }
+
+    const Field &field = static_cast<FieldExpr *>(left)->field();
+    const Value &value = static_cast<ValueExpr *>(right)->get_value();
+    if (field.table() != table_ || field.meta()->type() != value.attr_type()) {
+      continue;
+    }
+    zone_predicates.push_back(ZonePredicate{field.meta()->field_id(), comp, value});
+  }
+  return zone_predicates;
+}
+
 RC TableScanVecPhysicalOperator::filter(Chunk &chunk)
 {
+  selection_.resize(chunk.rows());
+  for (int i = 0; i < chunk.rows(); i++) {
+    selection_[i] = i;
+  }
+
   RC rc = RC::SUCCESS;
   for (unique_ptr<Expression> &expr : predicates_) {
-    rc = expr->eval(chunk, select_);
+    if (selection_.empty()) {
+      break;
+    }
+    rc = expr->filter(chunk, selection_);
     if (rc != RC::SUCCESS) {
       return rc;
     }
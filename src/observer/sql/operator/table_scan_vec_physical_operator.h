@@ -38,15 +38,29 @@ public:
 
   void set_predicates(vector<unique_ptr<Expression>> &&exprs);
 
+  /**
+   * @brief 与其它扫描算子共享同一个 morsel 队列，每个算子只扫描自己领取到的页面
+   * @details 用于并行扫描，多个算子分别在不同的线程中执行
+   */
+  void set_morsel_queue(shared_ptr<BufferPoolMorselQueue> morsels) { morsels_ = std::move(morsels); }
+
 private:
+  /**
+   * @brief 计算下推的过滤条件，满足条件的行号保存在 selection_ 中
+   */
   RC filter(Chunk &chunk);
 
+  /**
+   * @brief 从下推的过滤条件中提取 `列 op 常量` 形式的条件，用于根据 zone map 跳过页面
+   */
+  vector<ZonePredicate> zone_predicates() const;
+
 private:
   Table                         *table_ = nullptr;
   ReadWriteMode                  mode_  = ReadWriteMode::READ_WRITE;
   ChunkFileScanner               chunk_scanner_;
   Chunk                          all_columns_;
-  Chunk                          filterd_columns_;
-  vector<uint8_t>                select_;
+  vector<int>                    selection_;  ///< all_columns_ 中满足过滤条件的行
   vector<unique_ptr<Expression>> predicates_;
+  shared_ptr<BufferPoolMorselQueue> morsels_;
 };
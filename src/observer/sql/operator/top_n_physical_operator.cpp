@@ -0,0 +1,138 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/top_n_physical_operator.h"
+#include "common/lang/algorithm.h"
+#include "common/log/log.h"
+#include "sql/operator/order_by_physical_operator.h"
+#include "sql/operator/sort_key.h"
+
+TopNPhysicalOperator::TopNPhysicalOperator(
+    vector<unique_ptr<Expression>> &&order_by_exprs, vector<bool> &&ascending, int limit)
+    : order_by_exprs_(std::move(order_by_exprs)), ascending_(std::move(ascending)), limit_(limit)
+{
+  ASSERT(order_by_exprs_.size() == ascending_.size(), "order by expressions and directions should have the same size");
+}
+
+string TopNPhysicalOperator::param() const
+{
+  return OrderByPhysicalOperator::order_by_param(order_by_exprs_, ascending_) + " LIMIT " + std::to_string(limit_);
+}
+
+RC TopNPhysicalOperator::open(Trx *trx)
+{
+  if (children_.size() != 1) {
+    LOG_WARN("top-n operator must has one child");
+    return RC::INTERNAL;
+  }
+
+  RC rc = children_[0]->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open child operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rows_.clear();
+  row_index_ = 0;
+  specs_.clear();
+  if (limit_ <= 0) {
+    return RC::SUCCESS;
+  }
+
+  rc = fetch_rows();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  sort_heap(rows_.begin(), rows_.end());
+  return RC::SUCCESS;
+}
+
+RC TopNPhysicalOperator::fetch_rows()
+{
+  RC                rc       = RC::SUCCESS;
+  PhysicalOperator *child    = children_[0].get();
+  int64_t           sequence = 0;
+  string            key;
+  while (OB_SUCC(rc = child->next())) {
+    Tuple *tuple = child->current_tuple();
+    if (nullptr == tuple) {
+      LOG_WARN("failed to get tuple from child operator");
+      return RC::INTERNAL;
+    }
+
+    rc = SortKey::encode(order_by_exprs_, ascending_, *tuple, key);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    // 堆已经满了，只有比堆顶小的行才需要保留。sequence 一直递增，键相同时新的行总是更大
+    const bool full = static_cast<int>(rows_.size()) >= limit_;
+    if (full && key >= rows_.front().key) {
+      sequence++;
+      continue;
+    }
+
+    const int cell_num = tuple->cell_num();
+    if (specs_.empty()) {
+      for (int i = 0; i < cell_num; i++) {
+        TupleCellSpec spec;
+        rc = tuple->spec_at(i, spec);
+        if (OB_FAIL(rc)) {
+          LOG_WARN("failed to get tuple cell spec. index=%d, rc=%s", i, strrc(rc));
+          return rc;
+        }
+        specs_.push_back(spec);
+      }
+      tuple_.set_names(specs_);
+    }
+
+    if (full) {
+      pop_heap(rows_.begin(), rows_.end());
+      rows_.pop_back();
+    }
+
+    SortRow row;
+    row.key.swap(key);
+    row.sequence = sequence++;
+    row.values.resize(cell_num);
+    for (int i = 0; i < cell_num; i++) {
+      rc = tuple->cell_at(i, row.values[i]);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to get tuple cell. index=%d, rc=%s", i, strrc(rc));
+        return rc;
+      }
+    }
+    rows_.push_back(std::move(row));
+    push_heap(rows_.begin(), rows_.end());
+  }
+
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to get next tuple from child operator. rc=%s", strrc(rc));
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+RC TopNPhysicalOperator::next()
+{
+  if (row_index_ >= rows_.size()) {
+    return RC::RECORD_EOF;
+  }
+  tuple_.set_cells(rows_[row_index_].values);
+  row_index_++;
+  return RC::SUCCESS;
+}
+
+RC TopNPhysicalOperator::close()
+{
+  rows_.clear();
+  return children_[0]->close();
+}
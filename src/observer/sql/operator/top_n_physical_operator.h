@@ -0,0 +1,68 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/expr/tuple.h"
+#include "sql/operator/physical_operator.h"
+
+/**
+ * @brief Top-N 物理算子
+ * @ingroup PhysicalOperator
+ * @details ORDER BY 之后只需要前 limit 行时使用。open 时读取子算子的所有数据，用一个大小为 limit 的大根堆
+ * 保存当前最小的 limit 行，堆顶是其中最大的一行。新的一行只有比堆顶小时才会计算它的所有值并替换堆顶，
+ * 所以内存只和 limit 有关，不需要写临时文件。排序键相同时先到的行在前，与 OrderByPhysicalOperator 的结果一致。
+ */
+class TopNPhysicalOperator : public PhysicalOperator
+{
+public:
+  TopNPhysicalOperator(vector<unique_ptr<Expression>> &&order_by_exprs, vector<bool> &&ascending, int limit);
+  virtual ~TopNPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::TOP_N; }
+  OpType               get_op_type() const override { return OpType::ORDERBY; }
+
+  string param() const override;
+
+  RC open(Trx *trx) override;
+  RC next() override;
+  RC close() override;
+
+  Tuple *current_tuple() override { return &tuple_; }
+
+  RC tuple_schema(TupleSchema &schema) const override { return children_[0]->tuple_schema(schema); }
+
+private:
+  struct SortRow
+  {
+    string        key;
+    int64_t       sequence = 0;  ///< 在子算子输出中的顺序
+    vector<Value> values;
+
+    bool operator<(const SortRow &other) const
+    {
+      const int result = key.compare(other.key);
+      return result < 0 || (result == 0 && sequence < other.sequence);
+    }
+  };
+
+  RC fetch_rows();
+
+private:
+  vector<unique_ptr<Expression>> order_by_exprs_;
+  vector<bool>                   ascending_;
+  int                            limit_ = 0;
+
+  vector<SortRow> rows_;  ///< open 时是大根堆，读完子算子的数据后排成升序
+  size_t          row_index_ = 0;
+
+  vector<TupleCellSpec> specs_;
+  ValueListTuple        tuple_;
+};
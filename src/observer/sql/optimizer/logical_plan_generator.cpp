@@ -21,7 +21,9 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/explain_logical_operator.h"
 #include "sql/operator/insert_logical_operator.h"
 #include "sql/operator/join_logical_operator.h"
+#include "sql/operator/limit_logical_operator.h"
 #include "sql/operator/logical_operator.h"
+#include "sql/operator/order_by_logical_operator.h"
 #include "sql/operator/predicate_logical_operator.h"
 #include "sql/operator/project_logical_operator.h"
 #include "sql/operator/table_get_logical_operator.h"
@@ -138,11 +140,30 @@ RC LogicalPlanGenerator::create_plan(SelectStmt *select_stmt, unique_ptr<Logical
     last_oper = &group_by_oper;
   }
 
-  auto project_oper = make_unique<ProjectLogicalOperator>(std::move(select_stmt->query_expressions()));
+  // 排序在投影之前，这样可以按照没有出现在 select 中的字段排序
+  unique_ptr<LogicalOperator> order_by_oper;
+  if (!select_stmt->order_by().empty()) {
+    order_by_oper = make_unique<OrderByLogicalOperator>(
+        std::move(select_stmt->order_by()), std::move(select_stmt->order_by_ascending()));
+    if (*last_oper) {
+      order_by_oper->add_child(std::move(*last_oper));
+    }
+
+    last_oper = &order_by_oper;
+  }
+
+  unique_ptr<LogicalOperator> project_oper =
+      make_unique<ProjectLogicalOperator>(std::move(select_stmt->query_expressions()));
   if (*last_oper) {
     project_oper->add_child(std::move(*last_oper));
   }
 
+  if (select_stmt->limit() >= 0) {
+    auto limit_oper = make_unique<LimitLogicalOperator>(select_stmt->limit());
+    limit_oper->add_child(std::move(project_oper));
+    project_oper = std::move(limit_oper);
+  }
+
   logical_operator = std::move(project_oper);
   return RC::SUCCESS;
 }
@@ -282,7 +303,14 @@ RC LogicalPlanGenerator::create_group_by_plan(SelectStmt *select_stmt, unique_pt
 {
   vector<unique_ptr<Expression>> &group_by_expressions = select_stmt->group_by();
   vector<Expression *> aggregate_expressions;
-  vector<unique_ptr<Expression>> &query_expressions = select_stmt->query_expressions();
+  // order by 在 group by 之后计算，与 select 中的表达式一样需要绑定到 group by 的输出上
+  vector<unique_ptr<Expression> *> query_expressions;
+  for (unique_ptr<Expression> &expression : select_stmt->query_expressions()) {
+    query_expressions.push_back(&expression);
+  }
+  for (unique_ptr<Expression> &expression : select_stmt->order_by()) {
+    query_expressions.push_back(&expression);
+  }
   function<RC(unique_ptr<Expression>&)> collector = [&](unique_ptr<Expression> &expr) -> RC {
     RC rc = RC::SUCCESS;
     if (expr->type() == ExprType::AGGREGATION) {
@@ -325,17 +353,17 @@ RC LogicalPlanGenerator::create_group_by_plan(SelectStmt *select_stmt, unique_pt
   };
   
 
-  for (unique_ptr<Expression> &expression : query_expressions) {
-    bind_group_by_expr(expression);
+  for (unique_ptr<Expression> *expression : query_expressions) {
+    bind_group_by_expr(*expression);
   }
 
-  for (unique_ptr<Expression> &expression : query_expressions) {
-    find_unbound_column(expression);
+  for (unique_ptr<Expression> *expression : query_expressions) {
+    find_unbound_column(*expression);
   }
 
   // collect all aggregate expressions
-  for (unique_ptr<Expression> &expression : query_expressions) {
-    collector(expression);
+  for (unique_ptr<Expression> *expression : query_expressions) {
+    collector(*expression);
   }
 
   if (group_by_expressions.empty() && aggregate_expressions.empty()) {
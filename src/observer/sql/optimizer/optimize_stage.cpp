@@ -23,6 +23,7 @@ See the Mulan PSL v2 for more details. */
 #include "event/session_event.h"
 #include "event/sql_event.h"
 #include "sql/operator/logical_operator.h"
+#include "sql/operator/pipeline_vec_physical_operator.h"
 #include "sql/stmt/stmt.h"
 #include "sql/optimizer/cascade/optimizer.h"
 #include "sql/optimizer/optimizer_utils.h"
@@ -89,10 +90,18 @@ RC OptimizeStage::generate_physical_plan(
     unique_ptr<LogicalOperator> &logical_operator, unique_ptr<PhysicalOperator> &physical_operator, Session *session)
 {
   RC rc = RC::SUCCESS;
-  if (session->get_execution_mode() == ExecutionMode::CHUNK_ITERATOR && LogicalOperator::can_generate_vectorized_operator(logical_operator->type())) {
+  const ExecutionMode mode = session->get_execution_mode();
+  if ((mode == ExecutionMode::CHUNK_ITERATOR || mode == ExecutionMode::PIPELINE)
+      && logical_operator->can_generate_vectorized_operator()) {
     LOG_TRACE("use chunk iterator");
     session->set_used_chunk_mode(true);
     rc    = physical_plan_generator_.create_vec(*logical_operator, physical_operator, session);
+    if (OB_SUCC(rc) && mode == ExecutionMode::PIPELINE) {
+      LOG_TRACE("use pipeline");
+      auto pipeline_oper = make_unique<PipelineVecPhysicalOperator>();
+      pipeline_oper->add_child(std::move(physical_operator));
+      physical_operator = std::move(pipeline_oper);
+    }
   } else {
     LOG_TRACE("use tuple iterator");
     session->set_used_chunk_mode(false);
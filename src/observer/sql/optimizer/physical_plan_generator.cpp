@@ -12,8 +12,10 @@ See the Mulan PSL v2 for more details. */
 // Created by Wangyunlai on 2022/12/14.
 //
 
+#include "common/lang/algorithm.h"
 #include "common/log/log.h"
 #include "sql/expr/expression.h"
+#include "sql/expr/expression_iterator.h"
 #include "session/session.h"
 #include "sql/operator/aggregate_vec_physical_operator.h"
 #include "sql/operator/calc_logical_operator.h"
@@ -23,15 +25,22 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/explain_logical_operator.h"
 #include "sql/operator/explain_physical_operator.h"
 #include "sql/operator/expr_vec_physical_operator.h"
+#include "sql/operator/gather_vec_physical_operator.h"
 #include "sql/operator/group_by_vec_physical_operator.h"
 #include "sql/operator/hash_join_physical_operator.h"
+#include "sql/operator/hash_join_vec_physical_operator.h"
 #include "sql/operator/index_scan_physical_operator.h"
 #include "sql/operator/insert_logical_operator.h"
 #include "sql/operator/insert_physical_operator.h"
 #include "sql/operator/join_logical_operator.h"
+#include "sql/operator/limit_logical_operator.h"
+#include "sql/operator/limit_physical_operator.h"
 #include "sql/operator/nested_loop_join_physical_operator.h"
+#include "sql/operator/order_by_logical_operator.h"
+#include "sql/operator/order_by_physical_operator.h"
 #include "sql/operator/predicate_logical_operator.h"
 #include "sql/operator/predicate_physical_operator.h"
+#include "sql/operator/predicate_vec_physical_operator.h"
 #include "sql/operator/project_logical_operator.h"
 #include "sql/operator/project_physical_operator.h"
 #include "sql/operator/project_vec_physical_operator.h"
@@ -42,7 +51,9 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/hash_group_by_physical_operator.h"
 #include "sql/operator/scalar_group_by_physical_operator.h"
 #include "sql/operator/table_scan_vec_physical_operator.h"
+#include "sql/operator/top_n_physical_operator.h"
 #include "sql/optimizer/physical_plan_generator.h"
+#include "storage/table/table.h"
 
 using namespace std;
 
@@ -87,6 +98,14 @@ RC PhysicalPlanGenerator::create(LogicalOperator &logical_operator, unique_ptr<P
       return create_plan(static_cast<GroupByLogicalOperator &>(logical_operator), oper, session);
     } break;
 
+    case LogicalOperatorType::ORDER_BY: {
+      return create_plan(static_cast<OrderByLogicalOperator &>(logical_operator), oper, session);
+    } break;
+
+    case LogicalOperatorType::LIMIT: {
+      return create_plan(static_cast<LimitLogicalOperator &>(logical_operator), oper, session);
+    } break;
+
     default: {
       ASSERT(false, "unknown logical operator type");
       return RC::INVALID_ARGUMENT;
@@ -95,6 +114,89 @@ RC PhysicalPlanGenerator::create(LogicalOperator &logical_operator, unique_ptr<P
   return rc;
 }
 
+/**
+ * @brief 计算逻辑算子输出的 Chunk 中，每张表的第一列在 Chunk 中的位置
+ * @details 表扫描输出表的所有列，join 输出左边的所有列之后紧跟右边的所有列。
+ * 其它会改变输出列的算子返回 false。
+ */
+static bool chunk_layout(LogicalOperator &oper, vector<pair<const Table *, int>> &layout, int &column_num)
+{
+  switch (oper.type()) {
+    case LogicalOperatorType::TABLE_GET: {
+      const Table *table = static_cast<TableGetLogicalOperator &>(oper).table();
+      layout.emplace_back(table, column_num);
+      column_num += table->table_meta().field_num();
+      return true;
+    }
+    case LogicalOperatorType::JOIN:
+    case LogicalOperatorType::PREDICATE: {
+      for (unique_ptr<LogicalOperator> &child : oper.children()) {
+        if (!chunk_layout(*child, layout, column_num)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+/**
+ * @brief 根据 chunk_layout 计算的位置，设置表达式中字段在 Chunk 中的位置
+ * @details 默认情况下 FieldExpr 用字段在表中的位置读取 Chunk 中的列，join 输出的 Chunk 包含多张表的列，
+ * 需要加上表在 Chunk 中的偏移。已经设置过位置的表达式(比如 group by 的输出)不处理。
+ */
+static RC bind_chunk_positions(Expression &expr, const vector<pair<const Table *, int>> &layout)
+{
+  if (expr.pos() != -1) {
+    return RC::SUCCESS;
+  }
+
+  if (expr.type() != ExprType::FIELD) {
+    return ExpressionIterator::iterate_child_expr(
+        expr, [&layout](unique_ptr<Expression> &child) { return bind_chunk_positions(*child, layout); });
+  }
+
+  const Field &field = static_cast<FieldExpr &>(expr).field();
+  auto iter = find_if(layout.begin(), layout.end(), [&field](const auto &item) { return item.first == field.table(); });
+  if (iter == layout.end()) {
+    LOG_WARN("cannot find table of field in chunk. field=%s.%s", field.table_name(), field.field_name());
+    return RC::INTERNAL;
+  }
+
+  const TableMeta &table_meta = field.table()->table_meta();
+  for (int i = 0; i < table_meta.field_num(); i++) {
+    if (table_meta.field(i) == field.meta()) {
+      expr.set_pos(iter->second + i);
+      return RC::SUCCESS;
+    }
+  }
+  LOG_WARN("cannot find field in table. field=%s.%s", field.table_name(), field.field_name());
+  return RC::INTERNAL;
+}
+
+/**
+ * @brief 如果 child 的输出包含多张表，就为直接在它的输出上计算的表达式设置字段位置
+ */
+static RC bind_chunk_positions(LogicalOperator &child, const vector<Expression *> &expressions)
+{
+  vector<pair<const Table *, int>> layout;
+  int                              column_num = 0;
+  if (!chunk_layout(child, layout, column_num) || layout.size() <= 1) {
+    return RC::SUCCESS;
+  }
+
+  for (Expression *expr : expressions) {
+    RC rc = bind_chunk_positions(*expr, layout);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
 RC PhysicalPlanGenerator::create_vec(LogicalOperator &logical_operator, unique_ptr<PhysicalOperator> &oper, Session* session)
 {
   RC rc = RC::SUCCESS;
@@ -103,12 +205,18 @@ RC PhysicalPlanGenerator::create_vec(LogicalOperator &logical_operator, unique_p
     case LogicalOperatorType::TABLE_GET: {
       return create_vec_plan(static_cast<TableGetLogicalOperator &>(logical_operator), oper, session);
     } break;
+    case LogicalOperatorType::PREDICATE: {
+      return create_vec_plan(static_cast<PredicateLogicalOperator &>(logical_operator), oper, session);
+    } break;
     case LogicalOperatorType::PROJECTION: {
       return create_vec_plan(static_cast<ProjectLogicalOperator &>(logical_operator), oper, session);
     } break;
     case LogicalOperatorType::GROUP_BY: {
       return create_vec_plan(static_cast<GroupByLogicalOperator &>(logical_operator), oper, session);
     } break;
+    case LogicalOperatorType::JOIN: {
+      return create_vec_plan(static_cast<JoinLogicalOperator &>(logical_operator), oper, session);
+    } break;
     case LogicalOperatorType::EXPLAIN: {
       return create_vec_plan(static_cast<ExplainLogicalOperator &>(logical_operator), oper, session);
     } break;
@@ -308,30 +416,70 @@ RC PhysicalPlanGenerator::create_plan(JoinLogicalOperator &join_oper, unique_ptr
     LOG_WARN("join operator should have 2 children, but have %d", child_opers.size());
     return RC::INTERNAL;
   }
+  vector<unique_ptr<Expression>> &join_predicates = join_oper.get_join_predicates();
+
+  unique_ptr<PhysicalOperator> join_physical_oper;
   if (session->hash_join_on() && can_use_hash_join(join_oper)) {
-    // your code here
+    // PredicateToJoinRewriter 保证比较的左边只引用左表，右边只引用右表
+    vector<unique_ptr<Expression>> left_keys;
+    vector<unique_ptr<Expression>> right_keys;
+    for (unique_ptr<Expression> &predicate : join_predicates) {
+      auto comparison_expr = static_cast<ComparisonExpr *>(predicate.get());
+      left_keys.push_back(std::move(comparison_expr->left()));
+      right_keys.push_back(std::move(comparison_expr->right()));
+    }
+    join_oper.clear_join_predicates();
+    auto hash_join_oper = make_unique<HashJoinPhysicalOperator>(std::move(left_keys), std::move(right_keys));
+    hash_join_oper->set_memory_limit(session->operator_memory_limit());
+    join_physical_oper = std::move(hash_join_oper);
   } else {
-    unique_ptr<PhysicalOperator> join_physical_oper(new NestedLoopJoinPhysicalOperator());
-    for (auto &child_oper : child_opers) {
-      unique_ptr<PhysicalOperator> child_physical_oper;
-      rc = create(*child_oper, child_physical_oper, session);
-      if (rc != RC::SUCCESS) {
-        LOG_WARN("failed to create physical child oper. rc=%s", strrc(rc));
-        return rc;
-      }
+    join_physical_oper = make_unique<NestedLoopJoinPhysicalOperator>();
+  }
+
+  for (auto &child_oper : child_opers) {
+    unique_ptr<PhysicalOperator> child_physical_oper;
+    rc = create(*child_oper, child_physical_oper, session);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to create physical child oper. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    join_physical_oper->add_child(std::move(child_physical_oper));
+  }
 
-      join_physical_oper->add_child(std::move(child_physical_oper));
+  if (!join_predicates.empty()) {
+    // nested loop join 自己不处理连接条件，在上面加一个过滤算子
+    unique_ptr<Expression> predicate;
+    if (join_predicates.size() == 1) {
+      predicate = std::move(join_predicates.front());
+    } else {
+      predicate = make_unique<ConjunctionExpr>(ConjunctionExpr::Type::AND, join_predicates);
     }
+    join_oper.clear_join_predicates();
 
-    oper = std::move(join_physical_oper);
+    auto predicate_oper = make_unique<PredicatePhysicalOperator>(std::move(predicate));
+    predicate_oper->add_child(std::move(join_physical_oper));
+    join_physical_oper = std::move(predicate_oper);
   }
+
+  oper = std::move(join_physical_oper);
   return rc;
 }
 
 bool PhysicalPlanGenerator::can_use_hash_join(JoinLogicalOperator &join_oper)
 {
-  // your code here
-  return false;
+  vector<unique_ptr<Expression>> &join_predicates = join_oper.get_join_predicates();
+  if (join_predicates.empty()) {
+    return false;
+  }
+
+  for (unique_ptr<Expression> &predicate : join_predicates) {
+    if (predicate->type() != ExprType::COMPARISON ||
+        static_cast<ComparisonExpr *>(predicate.get())->comp() != CompOp::EQUAL_TO) {
+      return false;
+    }
+  }
+  return true;
 }
 
 RC PhysicalPlanGenerator::create_plan(CalcLogicalOperator &logical_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
@@ -372,10 +520,91 @@ RC PhysicalPlanGenerator::create_plan(GroupByLogicalOperator &logical_oper, uniq
   return rc;
 }
 
+RC PhysicalPlanGenerator::create_plan(OrderByLogicalOperator &logical_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
+{
+  RC rc = RC::SUCCESS;
+
+  ASSERT(logical_oper.children().size() == 1, "order by operator should have 1 child");
+
+  unique_ptr<PhysicalOperator> order_by_oper;
+  if (logical_oper.limit() >= 0) {
+    order_by_oper = make_unique<TopNPhysicalOperator>(
+        std::move(logical_oper.order_by_expressions()), std::move(logical_oper.ascending()), logical_oper.limit());
+  } else {
+    auto sort_oper = make_unique<OrderByPhysicalOperator>(
+        std::move(logical_oper.order_by_expressions()), std::move(logical_oper.ascending()));
+    sort_oper->set_memory_limit(session->operator_memory_limit());
+    order_by_oper = std::move(sort_oper);
+  }
+
+  unique_ptr<PhysicalOperator> child_physical_oper;
+  rc = create(*logical_oper.children().front(), child_physical_oper, session);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to create child physical operator of order by operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  order_by_oper->add_child(std::move(child_physical_oper));
+  oper = std::move(order_by_oper);
+  return rc;
+}
+
+/**
+ * @brief LIMIT 不超过这个值时，ORDER BY 使用 top-N 算子，只在内存中保存 limit 行
+ */
+static constexpr int TOP_N_MAX_LIMIT = 10000;
+
+RC PhysicalPlanGenerator::create_plan(LimitLogicalOperator &logical_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
+{
+  RC rc = RC::SUCCESS;
+
+  ASSERT(logical_oper.children().size() == 1, "limit operator should have 1 child");
+
+  // LIMIT 在投影之上，排序在投影之下。投影不改变行数，可以把 limit 交给排序算子
+  LogicalOperator &child_oper = *logical_oper.children().front();
+  if (logical_oper.limit() <= TOP_N_MAX_LIMIT && child_oper.type() == LogicalOperatorType::PROJECTION &&
+      child_oper.children().size() == 1 && child_oper.children().front()->type() == LogicalOperatorType::ORDER_BY) {
+    auto &order_by_oper = static_cast<OrderByLogicalOperator &>(*child_oper.children().front());
+    order_by_oper.set_limit(logical_oper.limit());
+  }
+
+  unique_ptr<PhysicalOperator> child_physical_oper;
+  rc = create(child_oper, child_physical_oper, session);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to create child physical operator of limit operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  oper = make_unique<LimitPhysicalOperator>(logical_oper.limit());
+  oper->add_child(std::move(child_physical_oper));
+  return rc;
+}
+
 RC PhysicalPlanGenerator::create_vec_plan(TableGetLogicalOperator &table_get_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
 {
   vector<unique_ptr<Expression>> &predicates = table_get_oper.predicates();
   Table *table = table_get_oper.table();
+
+  const int parallel_degree = session == nullptr ? 1 : session->parallel_degree();
+  if (parallel_degree > 1 && table_get_oper.read_write_mode() == ReadWriteMode::READ_ONLY) {
+    // 多个扫描算子共享同一个 morsel 队列，分别在不同的线程中扫描不同的页面，再由 gather 汇总
+    auto morsels     = make_shared<BufferPoolMorselQueue>();
+    auto gather_oper = make_unique<GatherVecPhysicalOperator>();
+    for (int i = 0; i < parallel_degree; i++) {
+      vector<unique_ptr<Expression>> worker_predicates;
+      for (const unique_ptr<Expression> &predicate : predicates) {
+        worker_predicates.push_back(predicate->copy());
+      }
+      auto table_scan_oper = make_unique<TableScanVecPhysicalOperator>(table, table_get_oper.read_write_mode());
+      table_scan_oper->set_predicates(std::move(worker_predicates));
+      table_scan_oper->set_morsel_queue(morsels);
+      gather_oper->add_child(std::move(table_scan_oper));
+    }
+    oper = std::move(gather_oper);
+    LOG_TRACE("use parallel vectorized table scan. parallel degree=%d", parallel_degree);
+    return RC::SUCCESS;
+  }
+
   TableScanVecPhysicalOperator *table_scan_oper = new TableScanVecPhysicalOperator(table, table_get_oper.read_write_mode());
   table_scan_oper->set_predicates(std::move(predicates));
   oper = unique_ptr<PhysicalOperator>(table_scan_oper);
@@ -384,16 +613,64 @@ RC PhysicalPlanGenerator::create_vec_plan(TableGetLogicalOperator &table_get_ope
   return RC::SUCCESS;
 }
 
+RC PhysicalPlanGenerator::create_vec_plan(PredicateLogicalOperator &pred_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
+{
+  vector<unique_ptr<LogicalOperator>> &children_opers = pred_oper.children();
+  ASSERT(children_opers.size() == 1, "predicate logical operator's sub oper number should be 1");
+
+  LogicalOperator &child_oper = *children_opers.front();
+
+  unique_ptr<PhysicalOperator> child_phy_oper;
+  RC                           rc = create_vec(child_oper, child_phy_oper, session);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to create child operator of predicate(vec) operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  vector<unique_ptr<Expression>> &expressions = pred_oper.expressions();
+  ASSERT(expressions.size() == 1, "predicate logical operator's children should be 1");
+
+  unique_ptr<Expression> expression = std::move(expressions.front());
+  rc = bind_chunk_positions(child_oper, {expression.get()});
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to bind expressions of predicate(vec) operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  oper = make_unique<PredicateVecPhysicalOperator>(std::move(expression));
+  oper->add_child(std::move(child_phy_oper));
+  return rc;
+}
+
 RC PhysicalPlanGenerator::create_vec_plan(GroupByLogicalOperator &logical_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
 {
   RC rc = RC::SUCCESS;
+
+  // 分组表达式和聚合函数的参数直接在子算子的输出上计算
+  vector<Expression *> child_expressions;
+  for (unique_ptr<Expression> &expr : logical_oper.group_by_expressions()) {
+    child_expressions.push_back(expr.get());
+  }
+  for (Expression *expr : logical_oper.aggregate_expressions()) {
+    child_expressions.push_back(static_cast<AggregateExpr *>(expr)->child().get());
+  }
+
+  // 没有分组时使用定长的聚合状态，参数类型不支持(比如字符串的 max)时当作只有一个分组的哈希聚合
+  bool use_aggregate_vec = logical_oper.group_by_expressions().empty();
+  for (Expression *expr : logical_oper.aggregate_expressions()) {
+    use_aggregate_vec = use_aggregate_vec && AggregateVecPhysicalOperator::support(*static_cast<AggregateExpr *>(expr));
+  }
+
   unique_ptr<PhysicalOperator> physical_oper = nullptr;
-  if (logical_oper.group_by_expressions().empty()) {
+  if (use_aggregate_vec) {
     physical_oper = make_unique<AggregateVecPhysicalOperator>(std::move(logical_oper.aggregate_expressions()));
   } else {
-    physical_oper = make_unique<GroupByVecPhysicalOperator>(
+    auto group_by_oper = make_unique<GroupByVecPhysicalOperator>(
       std::move(logical_oper.group_by_expressions()), std::move(logical_oper.aggregate_expressions()));
-
+    if (session != nullptr) {
+      group_by_oper->set_memory_limit(session->operator_memory_limit());
+    }
+    physical_oper = std::move(group_by_oper);
   }
 
   ASSERT(logical_oper.children().size() == 1, "group by operator should have 1 child");
@@ -406,12 +683,24 @@ RC PhysicalPlanGenerator::create_vec_plan(GroupByLogicalOperator &logical_oper,
     return rc;
   }
 
-  physical_oper->add_child(std::move(child_physical_oper));
+  rc = bind_chunk_positions(child_oper, child_expressions);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to bind expressions of group by(vec) operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  if (child_physical_oper->type() == PhysicalOperatorType::GATHER_VEC) {
+    // 并行扫描时由聚合算子直接驱动各个扫描算子，每个线程先聚合到自己的状态中再合并，不再经过 gather 汇总
+    for (unique_ptr<PhysicalOperator> &worker_oper : child_physical_oper->children()) {
+      physical_oper->add_child(std::move(worker_oper));
+    }
+    LOG_TRACE("use parallel aggregation. parallel degree=%d", static_cast<int>(physical_oper->children().size()));
+  } else {
+    physical_oper->add_child(std::move(child_physical_oper));
+  }
 
   oper = std::move(physical_oper);
   return rc;
-
-  return RC::SUCCESS;
 }
 
 RC PhysicalPlanGenerator::create_vec_plan(ProjectLogicalOperator &project_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
@@ -437,6 +726,11 @@ RC PhysicalPlanGenerator::create_vec_plan(ProjectLogicalOperator &project_oper,
     for (auto &expr : project_operator->expressions()) {
       expressions.push_back(expr.get());
     }
+    rc = bind_chunk_positions(*child_opers.front(), expressions);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to bind expressions of project operator. rc=%s", strrc(rc));
+      return rc;
+    }
     auto expr_operator = make_unique<ExprVecPhysicalOperator>(std::move(expressions));
     expr_operator->add_child(std::move(child_phy_oper));
     project_operator->add_child(std::move(expr_operator));
@@ -449,6 +743,69 @@ RC PhysicalPlanGenerator::create_vec_plan(ProjectLogicalOperator &project_oper,
 }
 
 
+RC PhysicalPlanGenerator::create_vec_plan(JoinLogicalOperator &join_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
+{
+  vector<unique_ptr<LogicalOperator>> &child_opers = join_oper.children();
+  if (child_opers.size() != 2) {
+    LOG_WARN("join operator should have 2 children, but have %d", child_opers.size());
+    return RC::INTERNAL;
+  }
+
+  // 向量化执行只实现了 hash join，没有等值连接条件时无法执行
+  if (!can_use_hash_join(join_oper)) {
+    LOG_WARN("vectorized join only supports equi-join");
+    return RC::UNIMPLEMENTED;
+  }
+
+  vector<unique_ptr<Expression>> left_keys;
+  vector<unique_ptr<Expression>> right_keys;
+  for (unique_ptr<Expression> &predicate : join_oper.get_join_predicates()) {
+    auto comparison_expr = static_cast<ComparisonExpr *>(predicate.get());
+    if (comparison_expr->left()->value_type() != comparison_expr->right()->value_type()) {
+      LOG_WARN("vectorized hash join requires join keys of the same type. predicate=%s", predicate->name());
+      return RC::UNIMPLEMENTED;
+    }
+  }
+  for (unique_ptr<Expression> &predicate : join_oper.get_join_predicates()) {
+    auto comparison_expr = static_cast<ComparisonExpr *>(predicate.get());
+    left_keys.push_back(std::move(comparison_expr->left()));
+    right_keys.push_back(std::move(comparison_expr->right()));
+  }
+  join_oper.clear_join_predicates();
+
+  vector<unique_ptr<Expression>> *keys[2] = {&left_keys, &right_keys};
+  vector<unique_ptr<PhysicalOperator>> child_physical_opers;
+  for (size_t i = 0; i < child_opers.size(); i++) {
+    unique_ptr<PhysicalOperator> child_physical_oper;
+    RC rc = create_vec(*child_opers[i], child_physical_oper, session);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to create child physical operator of join(vec). rc=%s", strrc(rc));
+      return rc;
+    }
+
+    vector<Expression *> key_exprs;
+    for (unique_ptr<Expression> &key : *keys[i]) {
+      key_exprs.push_back(key.get());
+    }
+    rc = bind_chunk_positions(*child_opers[i], key_exprs);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to bind join keys. rc=%s", strrc(rc));
+      return rc;
+    }
+    child_physical_opers.push_back(std::move(child_physical_oper));
+  }
+
+  auto join_physical_oper = make_unique<HashJoinVecPhysicalOperator>(std::move(left_keys), std::move(right_keys));
+  if (session != nullptr) {
+    join_physical_oper->set_memory_limit(session->operator_memory_limit());
+  }
+  for (unique_ptr<PhysicalOperator> &child_physical_oper : child_physical_opers) {
+    join_physical_oper->add_child(std::move(child_physical_oper));
+  }
+  oper = std::move(join_physical_oper);
+  return RC::SUCCESS;
+}
+
 RC PhysicalPlanGenerator::create_vec_plan(ExplainLogicalOperator &explain_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
 {
   vector<unique_ptr<LogicalOperator>> &child_opers = explain_oper.children();
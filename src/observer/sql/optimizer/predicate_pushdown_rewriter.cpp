@@ -60,7 +60,11 @@ RC PredicatePushdownRewriter::rewrite(unique_ptr<LogicalOperator> &oper, bool &c
 
   if (!pushdown_exprs.empty()) {
     change_made = true;
-    table_get_oper->set_predicates(std::move(pushdown_exprs));
+    // 多个 predicate 算子叠在同一个 table get 上时会多次下推，不能覆盖之前下推的条件
+    vector<unique_ptr<Expression>> &predicates = table_get_oper->predicates();
+    for (unique_ptr<Expression> &expr : pushdown_exprs) {
+      predicates.push_back(std::move(expr));
+    }
   }
   return rc;
 }
@@ -18,6 +18,25 @@ See the Mulan PSL v2 for more details. */
 RC PredicateRewriteRule::rewrite(unique_ptr<LogicalOperator> &oper, bool &change_made)
 {
   vector<unique_ptr<LogicalOperator>> &child_opers = oper->children();
+  if (child_opers.size() > 1) {
+    // 比如 join 的某个子节点是恒为 TRUE 的 predicate，直接用孙子节点替换它。
+    // 恒为 false 时不能简单的删除子节点，这里不处理
+    for (unique_ptr<LogicalOperator> &child_oper : child_opers) {
+      if (child_oper->type() != LogicalOperatorType::PREDICATE || child_oper->children().size() != 1 ||
+          child_oper->expressions().size() != 1 || child_oper->expressions().front()->type() != ExprType::VALUE) {
+        continue;
+      }
+
+      auto value_expr = static_cast<ValueExpr *>(child_oper->expressions().front().get());
+      if (value_expr->get_value().get_boolean()) {
+        unique_ptr<LogicalOperator> grand_child_oper = std::move(child_oper->children().front());
+        child_oper                                   = std::move(grand_child_oper);
+        change_made                                  = true;
+      }
+    }
+    return RC::SUCCESS;
+  }
+
   if (child_opers.size() != 1) {
     return RC::SUCCESS;
   }
@@ -9,3 +9,178 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #include "sql/optimizer/predicate_to_join_rule.h"
+#include "common/lang/unordered_set.h"
+#include "common/log/log.h"
+#include "sql/expr/expression.h"
+#include "sql/expr/expression_iterator.h"
+#include "sql/operator/join_logical_operator.h"
+#include "sql/operator/logical_operator.h"
+#include "sql/operator/predicate_logical_operator.h"
+#include "sql/operator/table_get_logical_operator.h"
+
+using TableSet = unordered_set<const Table *>;
+
+/**
+ * @brief 收集表达式中引用到的表
+ */
+static void collect_tables(Expression &expr, TableSet &tables)
+{
+  if (expr.type() == ExprType::FIELD) {
+    tables.insert(static_cast<FieldExpr &>(expr).field().table());
+    return;
+  }
+
+  ExpressionIterator::iterate_child_expr(expr, [&tables](unique_ptr<Expression> &child) {
+    collect_tables(*child, tables);
+    return RC::SUCCESS;
+  });
+}
+
+/**
+ * @brief 收集逻辑算子子树中扫描的表
+ */
+static void collect_tables(LogicalOperator &oper, TableSet &tables)
+{
+  if (oper.type() == LogicalOperatorType::TABLE_GET) {
+    tables.insert(static_cast<TableGetLogicalOperator &>(oper).table());
+    return;
+  }
+
+  for (unique_ptr<LogicalOperator> &child : oper.children()) {
+    collect_tables(*child, tables);
+  }
+}
+
+static bool contains_all(const TableSet &tables, const TableSet &subset)
+{
+  for (const Table *table : subset) {
+    if (tables.count(table) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+RC PredicateToJoinRewriter::rewrite(unique_ptr<LogicalOperator> &oper, bool &change_made)
+{
+  RC rc = RC::SUCCESS;
+  if (oper->type() != LogicalOperatorType::PREDICATE || oper->children().size() != 1) {
+    return rc;
+  }
+
+  LogicalOperator &child_oper = *oper->children().front();
+  if (child_oper.type() != LogicalOperatorType::JOIN) {
+    return rc;
+  }
+
+  vector<unique_ptr<Expression>> &predicate_exprs = oper->expressions();
+  if (predicate_exprs.size() != 1) {
+    return rc;
+  }
+
+  unique_ptr<Expression> &predicate_expr = predicate_exprs.front();
+  if (predicate_expr->type() != ExprType::CONJUNCTION) {
+    if (push_to_join(predicate_expr, child_oper) || push_to_child(predicate_expr, child_oper)) {
+      change_made    = true;
+      predicate_expr = make_unique<ValueExpr>(Value((bool)true));
+    }
+    return rc;
+  }
+
+  auto conjunction_expr = static_cast<ConjunctionExpr *>(predicate_expr.get());
+  if (conjunction_expr->conjunction_type() != ConjunctionExpr::Type::AND) {
+    return rc;
+  }
+
+  vector<unique_ptr<Expression>> &child_exprs = conjunction_expr->children();
+  for (auto iter = child_exprs.begin(); iter != child_exprs.end();) {
+    if (push_to_join(*iter, child_oper) || push_to_child(*iter, child_oper)) {
+      change_made = true;
+      iter        = child_exprs.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
+  if (child_exprs.empty()) {
+    // 与 PredicatePushdownRewriter 一样，predicate 算子删不掉，留一个恒为真的表达式
+    predicate_expr = make_unique<ValueExpr>(Value((bool)true));
+  }
+  return rc;
+}
+
+bool PredicateToJoinRewriter::push_to_join(unique_ptr<Expression> &expr, LogicalOperator &oper)
+{
+  if (expr->type() != ExprType::COMPARISON || oper.type() != LogicalOperatorType::JOIN) {
+    return false;
+  }
+
+  auto comparison_expr = static_cast<ComparisonExpr *>(expr.get());
+  if (comparison_expr->comp() != CompOp::EQUAL_TO) {
+    return false;
+  }
+
+  TableSet left_tables, right_tables;
+  collect_tables(*comparison_expr->left(), left_tables);
+  collect_tables(*comparison_expr->right(), right_tables);
+  if (left_tables.empty() || right_tables.empty()) {
+    return false;
+  }
+
+  ASSERT(oper.children().size() == 2, "join operator should have 2 children");
+  LogicalOperator &left_oper  = *oper.children()[0];
+  LogicalOperator &right_oper = *oper.children()[1];
+
+  TableSet left_oper_tables, right_oper_tables;
+  collect_tables(left_oper, left_oper_tables);
+  collect_tables(right_oper, right_oper_tables);
+
+  bool swapped = false;
+  if (contains_all(left_oper_tables, left_tables) && contains_all(right_oper_tables, right_tables)) {
+    swapped = false;
+  } else if (contains_all(left_oper_tables, right_tables) && contains_all(right_oper_tables, left_tables)) {
+    swapped = true;
+  } else {
+    // 两边的表都在同一侧，尝试下推到更下层的 join 中
+    return push_to_join(expr, left_oper) || push_to_join(expr, right_oper);
+  }
+
+  if (swapped) {
+    expr = make_unique<ComparisonExpr>(
+        CompOp::EQUAL_TO, std::move(comparison_expr->right()), std::move(comparison_expr->left()));
+  }
+
+  LOG_TRACE("push predicate to join. predicate=%s", expr->name());
+  static_cast<JoinLogicalOperator &>(oper).add_join_predicate(std::move(expr));
+  return true;
+}
+
+bool PredicateToJoinRewriter::push_to_child(unique_ptr<Expression> &expr, LogicalOperator &join_oper)
+{
+  // PredicatePushdownRewriter 不支持 OR，这里也不处理
+  if (expr->type() == ExprType::CONJUNCTION) {
+    return false;
+  }
+
+  TableSet expr_tables;
+  collect_tables(*expr, expr_tables);
+  if (expr_tables.empty()) {
+    return false;
+  }
+
+  for (unique_ptr<LogicalOperator> &child : join_oper.children()) {
+    TableSet child_tables;
+    collect_tables(*child, child_tables);
+    if (!contains_all(child_tables, expr_tables)) {
+      continue;
+    }
+
+    // 在子节点上面加一个 predicate 算子，后续会被其它规则继续下推到 table get 或者更下层的 join 中
+    LOG_TRACE("push predicate below join. predicate=%s", expr->name());
+    auto predicate_oper = make_unique<PredicateLogicalOperator>(std::move(expr));
+    predicate_oper->add_child(std::move(child));
+    child = std::move(predicate_oper);
+    return true;
+  }
+  return false;
+}
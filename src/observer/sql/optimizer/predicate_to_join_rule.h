@@ -16,6 +16,29 @@ See the Mulan PSL v2 for more details. */
 /**
  * @brief 将一些谓词表达式下推到join中
  * @ingroup Rewriter
+ * @details 只处理 join 上方 predicate 算子中使用 AND 连接的等值比较，并且比较的两边分别只引用 join
+ * 两侧的表，比如 `t1.a = t2.b`。这些条件会移动到能够同时看到两侧表的最下层 join 算子中，
+ * 作为 join 条件，物理计划可以据此选择 hash join。比较的左边总是引用 join 左侧的表。
+ * 只引用 join 一侧的表的条件会下推到那一侧，在 join 之前就过滤掉不需要的数据。
  */
-class PredicateToJoinRewriter
-{};
+class PredicateToJoinRewriter : public RewriteRule
+{
+public:
+  PredicateToJoinRewriter()          = default;
+  virtual ~PredicateToJoinRewriter() = default;
+
+  RC rewrite(unique_ptr<LogicalOperator> &oper, bool &change_made) override;
+
+private:
+  /**
+   * @brief 尝试把一个比较表达式移动到 oper 子树中的某个 join 算子上
+   * @return 移动成功返回 true，这时 expr 已经失效
+   */
+  bool push_to_join(unique_ptr<Expression> &expr, LogicalOperator &oper);
+
+  /**
+   * @brief 如果表达式只引用 join 一侧的表，就把它作为一个 predicate 算子放到这一侧的上面
+   * @return 移动成功返回 true，这时 expr 已经失效
+   */
+  bool push_to_child(unique_ptr<Expression> &expr, LogicalOperator &join_oper);
+};
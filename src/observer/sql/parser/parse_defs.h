@@ -86,12 +86,24 @@ struct ConditionSqlNode
  * 甚至可以包含复杂的表达式。
  */
 
+/**
+ * @brief 描述 order by 中的一项
+ * @ingroup SQLParser
+ */
+struct OrderBySqlNode
+{
+  unique_ptr<Expression> expression;        ///< 排序的表达式
+  bool                   ascending = true;  ///< 升序还是降序
+};
+
 struct SelectSqlNode
 {
   vector<unique_ptr<Expression>> expressions;  ///< 查询的表达式
   vector<string>                 relations;    ///< 查询的表
   vector<ConditionSqlNode>       conditions;   ///< 查询条件，使用AND串联起来多个条件
   vector<unique_ptr<Expression>> group_by;     ///< group by clause
+  vector<OrderBySqlNode>         order_by;     ///< order by clause
+  int                            limit = -1;   ///< limit clause，-1 表示没有 limit
 };
 
 /**
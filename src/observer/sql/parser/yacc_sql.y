@@ -65,6 +65,9 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
 //标识tokens
 %token  SEMICOLON
         BY
+        ORDER
+        ASC
+        LIMIT
         CREATE
         DROP
         GROUP
@@ -130,6 +133,8 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
   AttrInfoSqlNode *                          attr_info;
   Expression *                               expression;
   vector<unique_ptr<Expression>> *           expression_list;
+  OrderBySqlNode *                           order_by_item;
+  vector<OrderBySqlNode> *                   order_by_list;
   vector<Value> *                            value_list;
   vector<ConditionSqlNode> *                 condition_list;
   vector<RelAttrSqlNode> *                   rel_attr_list;
@@ -147,6 +152,8 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
 %destructor { delete $$; } <attr_info>
 %destructor { delete $$; } <expression>
 %destructor { delete $$; } <expression_list>
+%destructor { delete $$; } <order_by_item>
+%destructor { delete $$; } <order_by_list>
 %destructor { delete $$; } <value_list>
 %destructor { delete $$; } <condition_list>
 // %destructor { delete $$; } <rel_attr_list>
@@ -179,6 +186,10 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
 %type <expression>          expression
 %type <expression_list>     expression_list
 %type <expression_list>     group_by
+%type <order_by_item>       order_by_item
+%type <order_by_list>       order_by_list
+%type <order_by_list>       order_by
+%type <number>              limit
 %type <sql_node>            calc_stmt
 %type <sql_node>            select_stmt
 %type <sql_node>            insert_stmt
@@ -483,7 +494,7 @@ update_stmt:      /*  update 语句的语法解析树*/
     }
     ;
 select_stmt:        /*  select 语句的语法解析树*/
-    SELECT expression_list FROM rel_list where group_by
+    SELECT expression_list FROM rel_list where group_by order_by limit
     {
       $$ = new ParsedSqlNode(SCF_SELECT);
       if ($2 != nullptr) {
@@ -505,6 +516,13 @@ select_stmt:        /*  select 语句的语法解析树*/
         $$->selection.group_by.swap(*$6);
         delete $6;
       }
+
+      if ($7 != nullptr) {
+        $$->selection.order_by.swap(*$7);
+        delete $7;
+      }
+
+      $$->selection.limit = $8;
     }
     ;
 calc_stmt:
@@ -566,7 +584,9 @@ expression:
     | '*' {
       $$ = new StarExpr();
     }
-    // your code here
+    | ID LBRACE expression RBRACE {
+      $$ = create_aggregate_expression($1, $3, sql_string, &@$);
+    }
     ;
 
 rel_attr:
@@ -687,12 +707,67 @@ comp_op:
     | NE { $$ = NOT_EQUAL; }
     ;
 
-// your code here
 group_by:
     /* empty */
     {
       $$ = nullptr;
     }
+    | GROUP BY expression_list
+    {
+      $$ = $3;
+    }
+    ;
+order_by:
+    /* empty */
+    {
+      $$ = nullptr;
+    }
+    | ORDER BY order_by_list
+    {
+      $$ = $3;
+    }
+    ;
+order_by_list:
+    order_by_item
+    {
+      $$ = new vector<OrderBySqlNode>;
+      $$->push_back(std::move(*$1));
+      delete $1;
+    }
+    | order_by_item COMMA order_by_list
+    {
+      $$ = $3;
+      $$->insert($$->begin(), std::move(*$1));
+      delete $1;
+    }
+    ;
+order_by_item:
+    expression
+    {
+      $$ = new OrderBySqlNode;
+      $$->expression.reset($1);
+    }
+    | expression ASC
+    {
+      $$ = new OrderBySqlNode;
+      $$->expression.reset($1);
+    }
+    | expression DESC
+    {
+      $$ = new OrderBySqlNode;
+      $$->expression.reset($1);
+      $$->ascending = false;
+    }
+    ;
+limit:
+    /* empty */
+    {
+      $$ = -1;
+    }
+    | LIMIT number
+    {
+      $$ = $2;
+    }
     ;
 load_data_stmt:
     LOAD DATA INFILE SSS INTO TABLE ID 
@@ -82,6 +82,19 @@ RC SelectStmt::create(Db *db, SelectSqlNode &select_sql, Stmt *&stmt)
     }
   }
 
+  vector<unique_ptr<Expression>> order_by_expressions;
+  vector<bool>                   order_by_ascending;
+  for (OrderBySqlNode &order_by : select_sql.order_by) {
+    const size_t size = order_by_expressions.size();
+    RC rc = expression_binder.bind_expression(order_by.expression, order_by_expressions);
+    if (OB_FAIL(rc)) {
+      LOG_INFO("bind expression failed. rc=%s", strrc(rc));
+      return rc;
+    }
+    // `order by *` 这样的表达式可能绑定出多个表达式
+    order_by_ascending.insert(order_by_ascending.end(), order_by_expressions.size() - size, order_by.ascending);
+  }
+
   Table *default_table = nullptr;
   if (tables.size() == 1) {
     default_table = tables[0];
@@ -107,6 +120,9 @@ RC SelectStmt::create(Db *db, SelectSqlNode &select_sql, Stmt *&stmt)
   select_stmt->query_expressions_.swap(bound_expressions);
   select_stmt->filter_stmt_ = filter_stmt;
   select_stmt->group_by_.swap(group_by_expressions);
+  select_stmt->order_by_.swap(order_by_expressions);
+  select_stmt->order_by_ascending_.swap(order_by_ascending);
+  select_stmt->limit_ = select_sql.limit;
   stmt                      = select_stmt;
   return RC::SUCCESS;
 }
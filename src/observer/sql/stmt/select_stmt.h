@@ -44,10 +44,16 @@ public:
 
   vector<unique_ptr<Expression>> &query_expressions() { return query_expressions_; }
   vector<unique_ptr<Expression>> &group_by() { return group_by_; }
+  vector<unique_ptr<Expression>> &order_by() { return order_by_; }
+  vector<bool>                   &order_by_ascending() { return order_by_ascending_; }
+  int                             limit() const { return limit_; }
 
 private:
   vector<unique_ptr<Expression>> query_expressions_;
   vector<Table *>                tables_;
   FilterStmt                    *filter_stmt_ = nullptr;
   vector<unique_ptr<Expression>> group_by_;
+  vector<unique_ptr<Expression>> order_by_;
+  vector<bool>                   order_by_ascending_;  ///< order_by_ 中每一项是否升序
+  int                            limit_ = -1;          ///< -1 表示没有 limit
 };
@@ -186,7 +186,7 @@ list<Frame *> BPFrameManager::find_list(int buffer_pool_id)
 ////////////////////////////////////////////////////////////////////////////////
 BufferPoolIterator::BufferPoolIterator() {}
 BufferPoolIterator::~BufferPoolIterator() {}
-RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */)
+RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */, PageNum end_page /* = -1 */)
 {
   bitmap_.init(bp.file_header_->bitmap, bp.file_header_->page_count);
   if (start_page <= 0) {
@@ -194,14 +194,22 @@ RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */)
   } else {
     current_page_num_ = start_page - 1;
   }
+  end_page_num_ = end_page;
   return RC::SUCCESS;
 }
 
-bool BufferPoolIterator::has_next() { return bitmap_.next_setted_bit(current_page_num_ + 1) != -1; }
+bool BufferPoolIterator::has_next()
+{
+  PageNum next_page = bitmap_.next_setted_bit(current_page_num_ + 1);
+  return next_page != -1 && (end_page_num_ < 0 || next_page < end_page_num_);
+}
 
 PageNum BufferPoolIterator::next()
 {
   PageNum next_page = bitmap_.next_setted_bit(current_page_num_ + 1);
+  if (next_page != -1 && end_page_num_ >= 0 && next_page >= end_page_num_) {
+    next_page = -1;
+  }
   if (next_page != -1) {
     current_page_num_ = next_page;
   }
@@ -214,6 +222,24 @@ RC BufferPoolIterator::reset()
   return RC::SUCCESS;
 }
 
+void BufferPoolMorselQueue::init(DiskBufferPool &bp, PageNum start_page)
+{
+  call_once(init_flag_, [this, &bp, start_page]() {
+    end_page_num_ = bp.file_header_->page_count;
+    cursor_.store(start_page);
+  });
+}
+
+bool BufferPoolMorselQueue::next(PageNum &start, PageNum &end)
+{
+  start = cursor_.fetch_add(morsel_pages_);
+  if (start >= end_page_num_) {
+    return false;
+  }
+  end = min(start + morsel_pages_, end_page_num_);
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 DiskBufferPool::DiskBufferPool(
     BufferPoolManager &bp_manager, BPFrameManager &frame_manager, DoubleWriteBuffer &dblwr_manager, LogHandler &log_handler)
@@ -27,6 +27,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/lang/bitmap.h"
 #include "common/lang/lru_cache.h"
+#include "common/lang/atomic.h"
 #include "common/lang/mutex.h"
 #include "common/lang/memory.h"
 #include "common/lang/unordered_map.h"
@@ -170,7 +171,12 @@ public:
   BufferPoolIterator();
   ~BufferPoolIterator();
 
-  RC      init(DiskBufferPool &bp, PageNum start_page = 0);
+  /**
+   * @brief 初始化遍历的页面范围
+   * @param start_page 从哪个页面开始遍历
+   * @param end_page   遍历到哪个页面结束(不包含)，小于0表示遍历到文件末尾
+   */
+  RC      init(DiskBufferPool &bp, PageNum start_page = 0, PageNum end_page = -1);
   bool    has_next();
   PageNum next();
   RC      reset();
@@ -178,6 +184,39 @@ public:
 private:
   common::Bitmap bitmap_;
   PageNum        current_page_num_ = -1;
+  PageNum        end_page_num_     = -1;
+};
+
+/**
+ * @brief 把文件的页面切分成若干段(morsel)，由多个扫描线程通过原子游标领取
+ * @ingroup BufferPool
+ * @details 每一段都是 [start, end) 的页号范围，领取到的范围再交给 BufferPoolIterator 遍历。
+ * 页面总数在第一次 init 时确定，之后新分配的页面不会被扫描到。
+ */
+class BufferPoolMorselQueue
+{
+public:
+  static constexpr int DEFAULT_MORSEL_PAGES = 8;
+
+  explicit BufferPoolMorselQueue(int morsel_pages = DEFAULT_MORSEL_PAGES) : morsel_pages_(morsel_pages) {}
+
+  /**
+   * @brief 根据文件当前的页面个数确定要扫描的范围
+   * @details 多个扫描线程共享同一个队列，只有第一次调用会生效
+   */
+  void init(DiskBufferPool &bp, PageNum start_page);
+
+  /**
+   * @brief 领取下一段页面
+   * @return 所有页面都已经被领取时返回 false
+   */
+  bool next(PageNum &start, PageNum &end);
+
+private:
+  const int       morsel_pages_;
+  once_flag       init_flag_;
+  atomic<PageNum> cursor_{0};
+  PageNum         end_page_num_ = 0;
 };
 
 /**
@@ -313,6 +352,7 @@ private:
 
 private:
   friend class BufferPoolIterator;
+  friend class BufferPoolMorselQueue;
 };
 
 /**
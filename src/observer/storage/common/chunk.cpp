@@ -27,6 +27,9 @@ RC Chunk::reference(Chunk &chunk)
     columns_[i]->reference(chunk.column(i));
     column_ids_.push_back(chunk.column_ids(i));
   }
+  if (chunk.has_selection()) {
+    set_selection(chunk.selection());
+  }
   return RC::SUCCESS;
 }
 
@@ -38,6 +41,18 @@ int Chunk::rows() const
   return 0;
 }
 
+void Chunk::set_selection(const vector<int> &selection)
+{
+  selection_.assign(selection.begin(), selection.end());
+  has_selection_ = true;
+}
+
+void Chunk::clear_selection()
+{
+  selection_.clear();
+  has_selection_ = false;
+}
+
 int Chunk::capacity() const
 {
   if (!columns_.empty()) {
@@ -51,10 +66,12 @@ void Chunk::reset_data()
   for (auto &col : columns_) {
     col->reset_data();
   }
+  clear_selection();
 }
 
 void Chunk::reset()
 {
   columns_.clear();
   column_ids_.clear();
+  clear_selection();
 }
\ No newline at end of file
@@ -60,6 +60,28 @@ public:
    */
   int capacity() const;
 
+  /**
+   * @brief 设置选择向量
+   * @details 选择向量按升序保存有效的行号，没有设置时所有的行都有效。过滤算子只生成选择向量，
+   * 不移动列中的数据，下游算子通过 selected_rows 和 selected_row 访问有效的行。
+   * reference 会同时引用选择向量，reset 和 reset_data 会清除选择向量。
+   */
+  void set_selection(const vector<int> &selection);
+  void clear_selection();
+
+  bool               has_selection() const { return has_selection_; }
+  const vector<int> &selection() const { return selection_; }
+
+  /**
+   * @brief 有效的行数
+   */
+  int selected_rows() const { return has_selection_ ? static_cast<int>(selection_.size()) : rows(); }
+
+  /**
+   * @brief 第 i 个有效行在列中的行号
+   */
+  int selected_row(int i) const { return has_selection_ ? selection_[i] : i; }
+
   /**
    * @brief 从 Chunk 中获得指定行指定列的 Value
    * @param col_idx 列索引
@@ -82,4 +104,7 @@ private:
   // TODO: remove it and support multi-tables,
   // `columnd_ids` store the ids of child operator that need to be output
   vector<int> column_ids_;
+
+  bool        has_selection_ = false;
+  vector<int> selection_;
 };
@@ -8,6 +8,8 @@ EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
 MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
+#include "common/lang/algorithm.h"
+#include "common/lang/vector.h"
 #include "common/log/log.h"
 #include "storage/common/column.h"
 
@@ -129,4 +131,17 @@ void Column::reference(const Column &column)
   this->column_type_ = column.column_type();
   this->attr_type_   = column.attr_type();
   this->attr_len_    = column.attr_len();
-}
\ No newline at end of file
+}
+
+void Column::expand_constant(int count)
+{
+  if (column_type_ != Type::CONSTANT_COLUMN) {
+    return;
+  }
+
+  vector<char> value(data_, data_ + attr_len_);
+  init(attr_type_, attr_len_, max(count, 1));
+  for (int i = 0; i < count; i++) {
+    append_one(value.data());
+  }
+}
@@ -21,6 +21,8 @@ See the Mulan PSL v2 for more details. */
 class Column
 {
 public:
+  static constexpr size_t DEFAULT_CAPACITY = 8192;
+
   enum class Type
   {
     NORMAL_COLUMN,   /// Normal column represents a list of fixed-length values
@@ -73,6 +75,11 @@ public:
    */
   void reference(const Column &column);
 
+  /**
+   * @brief 把常量列展开成 count 行相同值的普通列，不是常量列时什么都不做
+   */
+  void expand_constant(int count);
+
   void set_column_type(Type column_type) { column_type_ = column_type; }
   void set_count(int count) { count_ = count; }
 
@@ -83,8 +90,6 @@ public:
   Type     column_type() const { return column_type_; }
 
 private:
-  static constexpr size_t DEFAULT_CAPACITY = 8192;
-
   char *data_ = nullptr;
   /// 当前列值数量
   int count_ = 0;
@@ -0,0 +1,240 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "storage/common/spill_file.h"
+#include "common/io/io.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/filesystem.h"
+#include "common/log/log.h"
+
+SpillFile::~SpillFile()
+{
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+RC SpillFile::open()
+{
+  error_code ec;
+  string     path = (filesystem::temp_directory_path(ec) / "miniob-spill-XXXXXX").string();
+  if (ec) {
+    path = "/tmp/miniob-spill-XXXXXX";
+  }
+
+  fd_ = ::mkstemp(path.data());
+  if (fd_ < 0) {
+    LOG_WARN("failed to create spill file. path=%s, errno=%d:%s", path.c_str(), errno, strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+  // 文件描述符关闭后文件就会被删除
+  ::unlink(path.c_str());
+
+  buffer_.resize(BUFFER_SIZE);
+  buffer_pos_  = 0;
+  buffer_size_ = 0;
+  reading_     = false;
+  LOG_TRACE("create spill file. path=%s, fd=%d", path.c_str(), fd_);
+  return RC::SUCCESS;
+}
+
+RC SpillFile::write(const char *data, int size)
+{
+  ASSERT(!reading_, "cannot write spill file after rewind");
+
+  const int32_t header = size;
+  const char   *parts[2]      = {reinterpret_cast<const char *>(&header), data};
+  const int     part_sizes[2] = {static_cast<int>(sizeof(header)), size};
+  for (int i = 0; i < 2; i++) {
+    const char *ptr  = parts[i];
+    int         left = part_sizes[i];
+    while (left > 0) {
+      if (buffer_pos_ == BUFFER_SIZE) {
+        RC rc = flush();
+        if (OB_FAIL(rc)) {
+          return rc;
+        }
+      }
+      const int n = min(left, BUFFER_SIZE - buffer_pos_);
+      memcpy(buffer_.data() + buffer_pos_, ptr, n);
+      buffer_pos_ += n;
+      ptr += n;
+      left -= n;
+    }
+  }
+
+  records_++;
+  bytes_ += sizeof(header) + size;
+  return RC::SUCCESS;
+}
+
+void SpillFile::serialize_values(const vector<Value> &values, vector<char> &buffer)
+{
+  for (const Value &value : values) {
+    const char    type   = static_cast<char>(value.attr_type());
+    const int32_t length = value.length();
+    buffer.push_back(type);
+    buffer.insert(buffer.end(),
+        reinterpret_cast<const char *>(&length), reinterpret_cast<const char *>(&length) + sizeof(length));
+    if (length > 0) {
+      buffer.insert(buffer.end(), value.data(), value.data() + length);
+    }
+  }
+}
+
+void SpillFile::deserialize_values(const char *data, int size, vector<Value> &values)
+{
+  values.clear();
+  const char *ptr = data;
+  const char *end = data + size;
+  while (ptr < end) {
+    const AttrType type   = static_cast<AttrType>(*ptr);
+    int32_t        length = 0;
+    memcpy(&length, ptr + 1, sizeof(length));
+    ptr += 1 + sizeof(length);
+
+    Value value;
+    switch (type) {
+      case AttrType::UNDEFINED: break;
+      case AttrType::CHARS: value.set_string(length > 0 ? ptr : "", length); break;
+      case AttrType::BOOLEANS: value.set_boolean(*ptr != 0); break;
+      default: {
+        value.set_type(type);
+        value.set_data(ptr, length);
+      } break;
+    }
+    values.push_back(std::move(value));
+    ptr += length;
+  }
+}
+
+RC SpillFile::write_values(const vector<Value> &values)
+{
+  value_buffer_.clear();
+  serialize_values(values, value_buffer_);
+  return write(value_buffer_.data(), static_cast<int>(value_buffer_.size()));
+}
+
+RC SpillFile::flush()
+{
+  if (buffer_pos_ == 0) {
+    return RC::SUCCESS;
+  }
+  int ret = common::writen(fd_, buffer_.data(), buffer_pos_);
+  if (ret != 0) {
+    LOG_WARN("failed to write spill file. fd=%d, ret=%d:%s", fd_, ret, strerror(ret));
+    return RC::IOERR_WRITE;
+  }
+  buffer_pos_ = 0;
+  return RC::SUCCESS;
+}
+
+RC SpillFile::rewind()
+{
+  if (!reading_) {
+    RC rc = flush();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    reading_ = true;
+  }
+
+  if (::lseek(fd_, 0, SEEK_SET) < 0) {
+    LOG_WARN("failed to seek spill file. fd=%d, errno=%d:%s", fd_, errno, strerror(errno));
+    return RC::IOERR_SEEK;
+  }
+  buffer_pos_  = 0;
+  buffer_size_ = 0;
+  return RC::SUCCESS;
+}
+
+RC SpillFile::fill()
+{
+  ssize_t n = ::read(fd_, buffer_.data(), BUFFER_SIZE);
+  if (n < 0) {
+    LOG_WARN("failed to read spill file. fd=%d, errno=%d:%s", fd_, errno, strerror(errno));
+    return RC::IOERR_READ;
+  }
+  if (n == 0) {
+    return RC::RECORD_EOF;
+  }
+  buffer_pos_  = 0;
+  buffer_size_ = static_cast<int>(n);
+  return RC::SUCCESS;
+}
+
+RC SpillFile::read_bytes(char *data, int size)
+{
+  while (size > 0) {
+    if (buffer_pos_ == buffer_size_) {
+      RC rc = fill();
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+    const int n = min(size, buffer_size_ - buffer_pos_);
+    memcpy(data, buffer_.data() + buffer_pos_, n);
+    buffer_pos_ += n;
+    data += n;
+    size -= n;
+  }
+  return RC::SUCCESS;
+}
+
+RC SpillFile::read(vector<char> &record)
+{
+  ASSERT(reading_, "rewind spill file before reading");
+
+  int32_t size = 0;
+  RC      rc   = read_bytes(reinterpret_cast<char *>(&size), sizeof(size));
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  record.resize(size);
+  rc = read_bytes(record.data(), size);
+  if (rc == RC::RECORD_EOF) {
+    LOG_WARN("spill file is truncated. fd=%d", fd_);
+    return RC::IOERR_READ;
+  }
+  return rc;
+}
+
+RC SpillFile::read_values(vector<Value> &values)
+{
+  RC rc = read(value_buffer_);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  deserialize_values(value_buffer_.data(), static_cast<int>(value_buffer_.size()), values);
+  return RC::SUCCESS;
+}
+
+RC SpillPartitions::file(int partition, SpillFile *&file)
+{
+  ASSERT(partition >= 0 && partition < PARTITION_NUM, "invalid partition %d", partition);
+  if (files_[partition] == nullptr) {
+    auto spill_file = make_unique<SpillFile>();
+    RC   rc         = spill_file->open();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    files_[partition] = std::move(spill_file);
+  }
+  file = files_[partition].get();
+  return RC::SUCCESS;
+}
@@ -0,0 +1,134 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/memory.h"
+#include "common/lang/vector.h"
+#include "common/sys/rc.h"
+#include "common/value.h"
+
+/**
+ * @brief 算子在内存不足时使用的临时文件
+ * @ingroup PhysicalOperator
+ * @details 文件创建在系统的临时目录下，创建之后立即删除文件名，关闭后空间会自动释放，进程异常退出也不会留下垃圾文件。
+ * 文件中保存一条条变长的记录，只能顺序写入，写完之后调用 rewind 从头开始顺序读取。
+ * 读写都带有缓存。
+ */
+class SpillFile
+{
+public:
+  SpillFile() = default;
+  ~SpillFile();
+
+  SpillFile(const SpillFile &)            = delete;
+  SpillFile &operator=(const SpillFile &) = delete;
+
+  RC open();
+
+  /**
+   * @brief 写入一条记录
+   */
+  RC write(const char *data, int size);
+
+  /**
+   * @brief 把一行数据序列化后作为一条记录写入
+   */
+  RC write_values(const vector<Value> &values);
+
+  /**
+   * @brief 结束写入，后续从文件头开始读取。可以多次调用，每次都从头开始读
+   */
+  RC rewind();
+
+  /**
+   * @brief 读取下一条记录
+   * @return 没有数据时返回 RECORD_EOF
+   */
+  RC read(vector<char> &record);
+
+  /**
+   * @brief 读取一条 write_values 写入的记录
+   */
+  RC read_values(vector<Value> &values);
+
+  /**
+   * @brief 把一行数据序列化后追加到 buffer 中
+   */
+  static void serialize_values(const vector<Value> &values, vector<char> &buffer);
+
+  /**
+   * @brief 从 serialize_values 生成的数据中解析出一行数据
+   */
+  static void deserialize_values(const char *data, int size, vector<Value> &values);
+
+  /// 写入的记录数
+  int64_t records() const { return records_; }
+  /// 写入的字节数，包含记录头
+  int64_t bytes() const { return bytes_; }
+
+private:
+  RC flush();
+  RC fill();
+  RC read_bytes(char *data, int size);
+
+private:
+  static constexpr int BUFFER_SIZE = 64 * 1024;
+
+  int          fd_      = -1;
+  bool         reading_ = false;
+  vector<char> buffer_;
+  int          buffer_pos_  = 0;  ///< 读取时，下一个要读取的位置；写入时，缓存中数据的长度
+  int          buffer_size_ = 0;  ///< 读取时，缓存中数据的长度
+  int64_t      records_     = 0;
+  int64_t      bytes_       = 0;
+  vector<char> value_buffer_;  ///< 序列化 Value 时使用的缓存
+};
+
+/**
+ * @brief 按照哈希值把数据写到多个临时文件中
+ * @ingroup PhysicalOperator
+ * @details 用于 grace hash join 和 hash 聚合。内存中的哈希表使用哈希值的低位选择哈希桶，
+ * 分区使用哈希值的高位，每一层递归分区使用不同的位，避免同一层的数据再次被分到同一个分区。
+ */
+class SpillPartitions
+{
+public:
+  static constexpr int PARTITION_BITS = 4;
+  static constexpr int PARTITION_NUM  = 1 << PARTITION_BITS;
+  /// 最多递归分区的层数，达到之后即使超过内存限制也在内存中处理，通常是因为大量相同的键
+  static constexpr int MAX_DEPTH = 4;
+
+  explicit SpillPartitions(int depth) : depth_(depth) {}
+
+  int depth() const { return depth_; }
+
+  /**
+   * @brief 哈希值在当前层中所属的分区
+   */
+  int partition_of(uint64_t hash) const
+  {
+    return static_cast<int>((hash >> (64 - (depth_ + 1) * PARTITION_BITS)) & (PARTITION_NUM - 1));
+  }
+
+  /**
+   * @brief 获取分区对应的文件，第一次访问时创建
+   */
+  RC file(int partition, SpillFile *&file);
+
+  /**
+   * @brief 取出分区的文件，分区中没有写入过数据时返回 nullptr
+   */
+  unique_ptr<SpillFile> release(int partition) { return std::move(files_[partition]); }
+
+private:
+  int                   depth_ = 0;
+  unique_ptr<SpillFile> files_[PARTITION_NUM];
+};
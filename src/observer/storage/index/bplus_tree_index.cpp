@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "storage/index/bplus_tree_index.h"
+#include "common/lang/algorithm.h"
 #include "common/log/log.h"
 #include "storage/table/table.h"
 #include "storage/db/db.h"
@@ -85,6 +86,26 @@ RC BplusTreeIndex::insert_entry(const char *record, const RID *rid)
   return index_handler_.insert_entry(record + field_meta_.offset(), rid);
 }
 
+RC BplusTreeIndex::insert_entries(span<const Record> records)
+{
+  AttrComparator comparator;
+  comparator.init(field_meta_.type(), field_meta_.len());
+
+  vector<int> order(records.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = static_cast<int>(i);
+  }
+  const int offset = field_meta_.offset();
+  sort(order.begin(), order.end(), [&records, &comparator, offset](int left, int right) {
+    int result = comparator(records[left].data() + offset, records[right].data() + offset);
+    if (result != 0) {
+      return result < 0;
+    }
+    return RID::compare(&records[left].rid(), &records[right].rid()) < 0;
+  });
+  return insert_entries_in_order(records, order);
+}
+
 RC BplusTreeIndex::delete_entry(const char *record, const RID *rid)
 {
   return index_handler_.delete_entry(record + field_meta_.offset(), rid);
@@ -32,6 +32,11 @@ public:
   RC close();
 
   RC insert_entry(const char *record, const RID *rid) override;
+
+  /**
+   * @brief 按照键值排序后再插入，相邻的插入大多落在同一个叶子节点上
+   */
+  RC insert_entries(span<const Record> records) override;
   RC delete_entry(const char *record, const RID *rid) override;
 
   /**
@@ -20,3 +20,37 @@ RC Index::init(const IndexMeta &index_meta, const FieldMeta &field_meta)
   field_meta_ = field_meta;
   return RC::SUCCESS;
 }
+
+RC Index::insert_entries(span<const Record> records)
+{
+  vector<int> order(records.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = static_cast<int>(i);
+  }
+  return insert_entries_in_order(records, order);
+}
+
+RC Index::insert_entries_in_order(span<const Record> records, const vector<int> &order)
+{
+  RC rc = RC::SUCCESS;
+  for (size_t i = 0; i < order.size(); i++) {
+    const Record &record = records[order[i]];
+    rc                   = insert_entry(record.data(), &record.rid());
+    if (OB_SUCC(rc)) {
+      continue;
+    }
+
+    LOG_TRACE("failed to insert entry into index. index=%s, rid=%s, rc=%s",
+              index_meta_.name(), record.rid().to_string().c_str(), strrc(rc));
+    for (size_t j = 0; j < i; j++) {
+      const Record &inserted = records[order[j]];
+      RC            rc2      = delete_entry(inserted.data(), &inserted.rid());
+      if (OB_FAIL(rc2)) {
+        LOG_WARN("failed to rollback index entry. index=%s, rid=%s, rc=%s",
+                 index_meta_.name(), inserted.rid().to_string().c_str(), strrc(rc2));
+      }
+    }
+    break;
+  }
+  return rc;
+}
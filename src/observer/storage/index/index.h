@@ -61,6 +61,14 @@ public:
    */
   virtual RC insert_entry(const char *record, const RID *rid) = 0;
 
+  /**
+   * @brief 批量插入数据
+   * @details 任意一条插入失败时，会删除这次已经插入的数据，索引保持不变
+   *
+   * @param records 插入的记录，记录的 rid 已经设置好
+   */
+  virtual RC insert_entries(span<const Record> records);
+
   /**
    * @brief 删除一条数据
    *
@@ -91,6 +99,11 @@ public:
 protected:
   RC init(const IndexMeta &index_meta, const FieldMeta &field_meta);
 
+  /**
+   * @brief 按照 order 指定的顺序插入 records，失败时删除已经插入的数据
+   */
+  RC insert_entries_in_order(span<const Record> records, const vector<int> &order);
+
 protected:
   IndexMeta index_meta_;  ///< 索引的元数据
   FieldMeta field_meta_;  ///< 当前实现仅考虑一个字段的索引
@@ -0,0 +1,460 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/record/column_encoding.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/bit.h"
+#include "common/lang/comparator.h"
+#include "common/lang/string_view.h"
+#include "common/log/log.h"
+#include "storage/common/column.h"
+
+/// 字典最多使用的位数，字典项太多时字典本身就会占用大量页面空间
+static constexpr int MAX_DICTIONARY_BIT_WIDTH = 12;
+
+/// 解码时每批处理的个数
+static constexpr int DECODE_BATCH_SIZE = 1024;
+
+static int align8(int size) { return (size + 7) & ~7; }
+
+/**
+ * @brief 按位压缩后占用的字节数
+ * @details 读写时每次访问 8 个字节，所以末尾多留 8 个字节，避免越界
+ */
+static int packed_size(int count, int bit_width) { return (int)(((int64_t)count * bit_width + 7) / 8) + 8; }
+
+static inline void bitpack_put(char *buf, int index, int bit_width, uint32_t value)
+{
+  const int64_t bit  = (int64_t)index * bit_width;
+  const int     skip = bit & 7;
+  const auto    mask = ((uint64_t(1) << bit_width) - 1) << skip;
+  uint64_t      word = 0;
+  memcpy(&word, buf + bit / 8, sizeof(word));
+  word = (word & ~mask) | ((uint64_t)value << skip);
+  memcpy(buf + bit / 8, &word, sizeof(word));
+}
+
+static inline uint32_t bitpack_get(const char *buf, int index, int bit_width)
+{
+  const int64_t bit  = (int64_t)index * bit_width;
+  uint64_t      word = 0;
+  memcpy(&word, buf + bit / 8, sizeof(word));
+  return (uint32_t)((word >> (bit & 7)) & ((uint64_t(1) << bit_width) - 1));
+}
+
+/**
+ * @brief RUN_LENGTH 编码需要预留的 run 个数
+ * @details 按照样本中 run 的密度，为后续追加的数据预留空间
+ */
+static int run_length_entry_capacity(const ColumnEncodingPlan &plan, int capacity)
+{
+  int extra_rows = std::max(0, capacity - plan.sample_rows);
+  int extra_runs = (int)(((int64_t)extra_rows * plan.sample_runs + plan.sample_rows - 1) / plan.sample_rows);
+  return plan.sample_runs + extra_runs + 1;
+}
+
+int compare_field_data(AttrType type, const char *left, int left_len, const char *right, int right_len)
+{
+  switch (type) {
+    case AttrType::INTS:
+    case AttrType::DATES: {
+      int32_t l = 0, r = 0;
+      memcpy(&l, left, sizeof(l));
+      memcpy(&r, right, sizeof(r));
+      return l < r ? -1 : (l > r ? 1 : 0);
+    }
+    case AttrType::FLOATS: {
+      float l = 0, r = 0;
+      memcpy(&l, left, sizeof(l));
+      memcpy(&r, right, sizeof(r));
+      return l < r ? -1 : (l > r ? 1 : 0);
+    }
+    case AttrType::CHARS: {
+      // 定长字段中字符串后面的部分填充的是 '\0'，需要先去掉
+      return common::compare_string(
+          (void *)left, strnlen(left, left_len), (void *)right, strnlen(right, right_len));
+    }
+    default: {
+      ASSERT(false, "unsupported type to compare: %d", static_cast<int>(type));
+      return 0;
+    }
+  }
+}
+
+bool compare_result_match(CompOp comp, int cmp_result)
+{
+  switch (comp) {
+    case EQUAL_TO: return cmp_result == 0;
+    case NOT_EQUAL: return cmp_result != 0;
+    case LESS_THAN: return cmp_result < 0;
+    case LESS_EQUAL: return cmp_result <= 0;
+    case GREAT_THAN: return cmp_result > 0;
+    case GREAT_EQUAL: return cmp_result >= 0;
+    default: return true;
+  }
+}
+
+const char *column_encoding_name(ColumnEncoding encoding)
+{
+  switch (encoding) {
+    case ColumnEncoding::PLAIN: return "plain";
+    case ColumnEncoding::DICTIONARY: return "dictionary";
+    case ColumnEncoding::RUN_LENGTH: return "run_length";
+    case ColumnEncoding::FRAME_OF_REFERENCE: return "frame_of_reference";
+    default: return "unknown";
+  }
+}
+
+ColumnEncodingPlan ColumnEncodingPlan::choose(AttrType attr_type, int attr_len, const char *values, int count)
+{
+  ColumnEncodingPlan plain;
+  plain.attr_type   = attr_type;
+  plain.attr_len    = attr_len;
+  plain.sample_rows = count;
+  if (count <= 0) {
+    return plain;
+  }
+
+  // 以两倍的行数来比较各种编码的大小，编码后页面可以容纳更多的行
+  const int          target = count * 2;
+  ColumnEncodingPlan best   = plain;
+  auto               try_plan = [&best, target](const ColumnEncodingPlan &plan) {
+    if (plan.encoded_size(target) < best.encoded_size(target)) {
+      best = plan;
+    }
+  };
+
+  int runs = 1;
+  for (int i = 1; i < count; i++) {
+    if (memcmp(values + (i - 1) * attr_len, values + i * attr_len, attr_len) != 0) {
+      runs++;
+    }
+  }
+  ColumnEncodingPlan run_length = plain;
+  run_length.encoding    = ColumnEncoding::RUN_LENGTH;
+  run_length.sample_runs = runs;
+  try_plan(run_length);
+
+  // 字典和游程编码都按原始字节判断是否相等，这样解码后的数据与编码前完全一致
+  vector<string_view> distinct;
+  distinct.reserve(count);
+  for (int i = 0; i < count; i++) {
+    distinct.emplace_back(values + i * attr_len, attr_len);
+  }
+  std::sort(distinct.begin(), distinct.end());
+  const int distinct_num = (int)(std::unique(distinct.begin(), distinct.end()) - distinct.begin());
+  const int dict_width   = std::bit_width((unsigned)distinct_num);
+  if (dict_width <= MAX_DICTIONARY_BIT_WIDTH) {
+    ColumnEncodingPlan dictionary = plain;
+    dictionary.encoding  = ColumnEncoding::DICTIONARY;
+    dictionary.bit_width = dict_width;
+    try_plan(dictionary);
+  }
+
+  if (attr_type == AttrType::INTS || attr_type == AttrType::DATES) {
+    int32_t min_value = INT32_MAX, max_value = INT32_MIN, last_value = INT32_MIN;
+    bool    ascending = true;
+    for (int i = 0; i < count; i++) {
+      int32_t value = 0;
+      memcpy(&value, values + i * attr_len, sizeof(value));
+      min_value  = std::min(min_value, value);
+      max_value  = std::max(max_value, value);
+      ascending  = ascending && value >= last_value;
+      last_value = value;
+    }
+    // 递增的数据(比如自增的主键)追加时还会继续增大，按照页面最多能存放的行数估算取值范围。
+    // 另外多留一位，给后续追加的数据预留取值范围
+    int64_t range = (int64_t)max_value - min_value;
+    if (ascending && count < Column::DEFAULT_CAPACITY) {
+      range = range * Column::DEFAULT_CAPACITY / count + 1;
+    }
+    const int width = std::bit_width((uint64_t)range) + 1;
+    if (width < 32) {
+      ColumnEncodingPlan frame_of_reference = plain;
+      frame_of_reference.encoding  = ColumnEncoding::FRAME_OF_REFERENCE;
+      frame_of_reference.bit_width = width;
+      frame_of_reference.reference = min_value;
+      try_plan(frame_of_reference);
+    }
+  }
+  return best;
+}
+
+int ColumnEncodingPlan::encoded_size(int capacity) const
+{
+  int size = sizeof(EncodedColumn::Header);
+  switch (encoding) {
+    case ColumnEncoding::PLAIN: size += capacity * attr_len; break;
+    case ColumnEncoding::DICTIONARY: size += (1 << bit_width) * attr_len + packed_size(capacity, bit_width); break;
+    case ColumnEncoding::RUN_LENGTH:
+      size += run_length_entry_capacity(*this, capacity) * (attr_len + (int)sizeof(int32_t));
+      break;
+    case ColumnEncoding::FRAME_OF_REFERENCE: size += packed_size(capacity, bit_width); break;
+  }
+  return align8(size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void EncodedColumn::init(const ColumnEncodingPlan &plan, int capacity)
+{
+  const int size = plan.encoded_size(capacity);
+  memset(header_, 0, size);
+
+  header_->encoding  = static_cast<int32_t>(plan.encoding);
+  header_->attr_type = static_cast<int32_t>(plan.attr_type);
+  header_->attr_len  = plan.attr_len;
+  header_->capacity  = capacity;
+  header_->bit_width = plan.bit_width;
+  header_->reference = plan.reference;
+  header_->entry_num = 0;
+  switch (plan.encoding) {
+    case ColumnEncoding::DICTIONARY: header_->entry_capacity = 1 << plan.bit_width; break;
+    case ColumnEncoding::RUN_LENGTH: header_->entry_capacity = run_length_entry_capacity(plan, capacity); break;
+    default: header_->entry_capacity = 0; break;
+  }
+}
+
+char *EncodedColumn::codes() const
+{
+  if (encoding() == ColumnEncoding::DICTIONARY) {
+    return entries() + header_->entry_capacity * header_->attr_len;
+  }
+  return payload();
+}
+
+int32_t *EncodedColumn::run_ends() const
+{
+  return reinterpret_cast<int32_t *>(entries() + header_->entry_capacity * header_->attr_len);
+}
+
+int EncodedColumn::find_run(int slot) const
+{
+  const int32_t *ends = run_ends();
+  return (int)(std::upper_bound(ends, ends + header_->entry_num, slot) - ends);
+}
+
+int EncodedColumn::find_entry(const char *value) const
+{
+  const int attr_len = header_->attr_len;
+  for (int i = 0; i < header_->entry_num; i++) {
+    if (memcmp(entries() + i * attr_len, value, attr_len) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool EncodedColumn::can_append(int slot, const char *value) const
+{
+  if (slot >= header_->capacity) {
+    return false;
+  }
+
+  switch (encoding()) {
+    case ColumnEncoding::PLAIN: return true;
+    case ColumnEncoding::DICTIONARY: return header_->entry_num < header_->entry_capacity || find_entry(value) >= 0;
+    case ColumnEncoding::RUN_LENGTH: {
+      const int last = header_->entry_num - 1;
+      if (last >= 0 && memcmp(entries() + last * header_->attr_len, value, header_->attr_len) == 0) {
+        return true;
+      }
+      return header_->entry_num < header_->entry_capacity;
+    }
+    case ColumnEncoding::FRAME_OF_REFERENCE: {
+      int32_t v = 0;
+      memcpy(&v, value, sizeof(v));
+      const int64_t diff = (int64_t)v - header_->reference;
+      return diff >= 0 && diff < (int64_t(1) << header_->bit_width);
+    }
+  }
+  return false;
+}
+
+void EncodedColumn::append(int slot, const char *value)
+{
+  ASSERT(can_append(slot, value), "cannot append value to encoded column. slot=%d", slot);
+
+  const int attr_len = header_->attr_len;
+  switch (encoding()) {
+    case ColumnEncoding::PLAIN: {
+      memcpy(payload() + slot * attr_len, value, attr_len);
+    } break;
+    case ColumnEncoding::DICTIONARY: {
+      int code = find_entry(value);
+      if (code < 0) {
+        code = header_->entry_num++;
+        memcpy(entries() + code * attr_len, value, attr_len);
+      }
+      bitpack_put(codes(), slot, header_->bit_width, (uint32_t)code);
+    } break;
+    case ColumnEncoding::RUN_LENGTH: {
+      int32_t  *ends = run_ends();
+      const int last = header_->entry_num - 1;
+      ASSERT(slot == (last >= 0 ? ends[last] : 0), "run length encoding only supports appending. slot=%d", slot);
+      if (last >= 0 && memcmp(entries() + last * attr_len, value, attr_len) == 0) {
+        ends[last] = slot + 1;
+      } else {
+        memcpy(entries() + header_->entry_num * attr_len, value, attr_len);
+        ends[header_->entry_num++] = slot + 1;
+      }
+    } break;
+    case ColumnEncoding::FRAME_OF_REFERENCE: {
+      int32_t v = 0;
+      memcpy(&v, value, sizeof(v));
+      bitpack_put(codes(), slot, header_->bit_width, (uint32_t)((int64_t)v - header_->reference));
+    } break;
+  }
+}
+
+void EncodedColumn::get(int slot, char *value) const
+{
+  const int attr_len = header_->attr_len;
+  switch (encoding()) {
+    case ColumnEncoding::PLAIN: {
+      memcpy(value, payload() + slot * attr_len, attr_len);
+    } break;
+    case ColumnEncoding::DICTIONARY: {
+      memcpy(value, entries() + bitpack_get(codes(), slot, header_->bit_width) * attr_len, attr_len);
+    } break;
+    case ColumnEncoding::RUN_LENGTH: {
+      memcpy(value, entries() + find_run(slot) * attr_len, attr_len);
+    } break;
+    case ColumnEncoding::FRAME_OF_REFERENCE: {
+      int32_t v = (int32_t)((int64_t)header_->reference + bitpack_get(codes(), slot, header_->bit_width));
+      memcpy(value, &v, sizeof(v));
+    } break;
+  }
+}
+
+void EncodedColumn::unpack(int start, int count, uint32_t *out) const
+{
+  const char *buf       = codes();
+  const int   bit_width = header_->bit_width;
+  for (int i = 0; i < count; i++) {
+    out[i] = bitpack_get(buf, start + i, bit_width);
+  }
+}
+
+void EncodedColumn::decode(int start, int count, char *dst) const
+{
+  const int attr_len = header_->attr_len;
+  switch (encoding()) {
+    case ColumnEncoding::PLAIN: {
+      memcpy(dst, payload() + start * attr_len, count * attr_len);
+    } break;
+
+    case ColumnEncoding::DICTIONARY: {
+      uint32_t    codes[DECODE_BATCH_SIZE];
+      const char *dict = entries();
+      for (int offset = 0; offset < count; offset += DECODE_BATCH_SIZE) {
+        const int batch = std::min(DECODE_BATCH_SIZE, count - offset);
+        unpack(start + offset, batch, codes);
+        char *out = dst + offset * attr_len;
+        if (attr_len == sizeof(int32_t)) {
+          // 4 字节的列最常见，单独处理，编译器可以生成更紧凑的循环
+          for (int i = 0; i < batch; i++) {
+            memcpy(out + i * sizeof(int32_t), dict + codes[i] * sizeof(int32_t), sizeof(int32_t));
+          }
+        } else {
+          for (int i = 0; i < batch; i++) {
+            memcpy(out + i * attr_len, dict + codes[i] * attr_len, attr_len);
+          }
+        }
+      }
+    } break;
+
+    case ColumnEncoding::RUN_LENGTH: {
+      const int32_t *ends = run_ends();
+      const int      end  = start + count;
+      char          *out  = dst;
+      for (int run = find_run(start), pos = start; pos < end; run++) {
+        const int   run_end = std::min(ends[run], end);
+        const char *value   = entries() + run * attr_len;
+        for (; pos < run_end; pos++, out += attr_len) {
+          memcpy(out, value, attr_len);
+        }
+      }
+    } break;
+
+    case ColumnEncoding::FRAME_OF_REFERENCE: {
+      uint32_t      codes[DECODE_BATCH_SIZE];
+      const int32_t reference = header_->reference;
+      for (int offset = 0; offset < count; offset += DECODE_BATCH_SIZE) {
+        const int batch = std::min(DECODE_BATCH_SIZE, count - offset);
+        unpack(start + offset, batch, codes);
+        int32_t *out = reinterpret_cast<int32_t *>(dst) + offset;
+        for (int i = 0; i < batch; i++) {
+          out[i] = (int32_t)(reference + (int64_t)codes[i]);
+        }
+      }
+    } break;
+  }
+}
+
+void EncodedColumn::select(CompOp comp, const char *value, int value_len, int count, vector<uint8_t> &select) const
+{
+  const int      attr_len  = header_->attr_len;
+  const AttrType attr_type = this->attr_type();
+  if (attr_type != AttrType::INTS && attr_type != AttrType::DATES && attr_type != AttrType::FLOATS &&
+      attr_type != AttrType::CHARS) {
+    return;
+  }
+
+  switch (encoding()) {
+    case ColumnEncoding::PLAIN: {
+    } break;
+
+    case ColumnEncoding::DICTIONARY: {
+      // 每个字典项只比较一次，之后只需要按下标查表
+      vector<uint8_t> match(header_->entry_capacity, 0);
+      for (int i = 0; i < header_->entry_num; i++) {
+        match[i] = compare_result_match(
+            comp, compare_field_data(attr_type, entries() + i * attr_len, attr_len, value, value_len));
+      }
+      uint32_t codes[DECODE_BATCH_SIZE];
+      for (int offset = 0; offset < count; offset += DECODE_BATCH_SIZE) {
+        const int batch = std::min(DECODE_BATCH_SIZE, count - offset);
+        unpack(offset, batch, codes);
+        for (int i = 0; i < batch; i++) {
+          select[offset + i] &= match[codes[i]];
+        }
+      }
+    } break;
+
+    case ColumnEncoding::RUN_LENGTH: {
+      const int32_t *ends = run_ends();
+      for (int run = 0, pos = 0; run < header_->entry_num && pos < count; run++) {
+        const int run_end = std::min(ends[run], count);
+        if (!compare_result_match(
+                comp, compare_field_data(attr_type, entries() + run * attr_len, attr_len, value, value_len))) {
+          memset(select.data() + pos, 0, run_end - pos);
+        }
+        pos = run_end;
+      }
+    } break;
+
+    case ColumnEncoding::FRAME_OF_REFERENCE: {
+      // 把常量转换到差值的空间中，直接与差值比较
+      int32_t v = 0;
+      memcpy(&v, value, sizeof(v));
+      const int64_t target = (int64_t)v - header_->reference;
+      uint32_t      codes[DECODE_BATCH_SIZE];
+      for (int offset = 0; offset < count; offset += DECODE_BATCH_SIZE) {
+        const int batch = std::min(DECODE_BATCH_SIZE, count - offset);
+        unpack(offset, batch, codes);
+        for (int i = 0; i < batch; i++) {
+          const int64_t code = codes[i];
+          select[offset + i] &= compare_result_match(comp, code < target ? -1 : (code > target ? 1 : 0));
+        }
+      }
+    } break;
+  }
+}
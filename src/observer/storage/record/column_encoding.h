@@ -0,0 +1,146 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/vector.h"
+#include "common/type/attr_type.h"
+#include "sql/parser/parse_defs.h"
+
+/**
+ * @brief 比较两个定长字段的原始数据
+ * @ingroup RecordManager
+ * @details 浮点数使用精确比较，与向量化执行中的比较方式保持一致。CHAR 类型会忽略末尾填充的 '\0'。
+ */
+int compare_field_data(AttrType type, const char *left, int left_len, const char *right, int right_len);
+
+/**
+ * @brief 根据比较结果判断是否满足比较运算符
+ */
+bool compare_result_match(CompOp comp, int cmp_result);
+
+/**
+ * @brief PAX 页面上一列数据的编码方式
+ * @ingroup RecordManager
+ */
+enum class ColumnEncoding : int32_t
+{
+  PLAIN,               ///< 不编码，直接存放定长数据
+  DICTIONARY,          ///< 字典编码，字典下标按位压缩存放
+  RUN_LENGTH,          ///< 游程编码，存放每一段相同值的值和结束位置
+  FRAME_OF_REFERENCE,  ///< 只用于整数，存放与基准值的差值，差值按位压缩存放
+};
+
+const char *column_encoding_name(ColumnEncoding encoding);
+
+/**
+ * @brief 根据一个页面上已有的数据，为某一列选出的编码方式及参数
+ * @ingroup RecordManager
+ */
+struct ColumnEncodingPlan
+{
+  ColumnEncoding encoding  = ColumnEncoding::PLAIN;
+  AttrType       attr_type = AttrType::UNDEFINED;
+  int            attr_len  = 0;
+  int            bit_width = 0;  ///< DICTIONARY/FRAME_OF_REFERENCE 中每个值占用的位数
+  int32_t        reference = 0;  ///< FRAME_OF_REFERENCE 的基准值
+  int            sample_rows = 0;  ///< 选择编码时看到的行数，用于估算 RUN_LENGTH 需要预留的空间
+  int            sample_runs = 0;  ///< 选择编码时看到的 run 个数
+
+  /**
+   * @brief 根据样本数据选择占用空间最小的编码
+   *
+   * @param attr_type 列的类型
+   * @param attr_len  列的长度
+   * @param values    连续存放的定长数据
+   * @param count     数据的个数
+   */
+  static ColumnEncodingPlan choose(AttrType attr_type, int attr_len, const char *values, int count);
+
+  /**
+   * @brief 按照当前编码存放 capacity 行数据需要占用的空间，已经按 8 字节对齐
+   */
+  int encoded_size(int capacity) const;
+};
+
+/**
+ * @brief 页面上一列编码后的数据
+ * @ingroup RecordManager
+ * @details 内存布局为 | EncodedColumnHeader | 编码数据 |，编码数据的格式：
+ * - PLAIN：capacity 个定长数据
+ * - DICTIONARY：entry_capacity 个字典项，之后是按 bit_width 压缩的字典下标
+ * - RUN_LENGTH：entry_capacity 个值，之后是 entry_capacity 个 int32_t 表示每个 run 的结束位置(不包含)
+ * - FRAME_OF_REFERENCE：按 bit_width 压缩的差值
+ *
+ * 编码后的页面只能在末尾追加数据。追加的值不能被当前编码表示时(比如字典已满，或者超出了差值的范围)，
+ * 调用者需要停止向这个页面写入。
+ */
+class EncodedColumn
+{
+public:
+  struct Header
+  {
+    int32_t encoding;
+    int32_t attr_type;
+    int32_t attr_len;
+    int32_t capacity;
+    int32_t bit_width;
+    int32_t entry_num;       ///< DICTIONARY 的字典项个数，或者 RUN_LENGTH 的 run 个数
+    int32_t entry_capacity;  ///< 最多可以有多少个字典项或者 run
+    int32_t reference;
+  };
+
+  explicit EncodedColumn(char *data) : header_(reinterpret_cast<Header *>(data)) {}
+
+  /**
+   * @brief 在 data 指向的内存上按照 plan 初始化一个空的编码列，内存大小为 plan.encoded_size(capacity)
+   */
+  void init(const ColumnEncodingPlan &plan, int capacity);
+
+  ColumnEncoding encoding() const { return static_cast<ColumnEncoding>(header_->encoding); }
+  AttrType       attr_type() const { return static_cast<AttrType>(header_->attr_type); }
+  int            attr_len() const { return header_->attr_len; }
+
+  /**
+   * @brief 判断能否把 value 追加到 slot 位置
+   * @details slot 必须是当前最后一个值的下一个位置
+   */
+  bool can_append(int slot, const char *value) const;
+  void append(int slot, const char *value);
+
+  /**
+   * @brief 读取单个值
+   */
+  void get(int slot, char *value) const;
+
+  /**
+   * @brief 把 [start, start + count) 位置上的数据解码到连续的内存中
+   */
+  void decode(int start, int count, char *dst) const;
+
+  /**
+   * @brief 直接在编码数据上计算 `value comp constant`，结果与 select 中 [0, count) 的位置做与运算
+   * @details PLAIN 编码的列不做处理
+   */
+  void select(CompOp comp, const char *value, int value_len, int count, vector<uint8_t> &select) const;
+
+private:
+  char    *payload() const { return reinterpret_cast<char *>(header_) + sizeof(Header); }
+  char    *entries() const { return payload(); }
+  char    *codes() const;
+  int32_t *run_ends() const;
+  int      find_run(int slot) const;
+  int      find_entry(const char *value) const;
+
+  void unpack(int start, int count, uint32_t *out) const;
+
+private:
+  Header *header_ = nullptr;
+};
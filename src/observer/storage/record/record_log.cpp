@@ -37,6 +37,7 @@ string RecordOperation::to_string() const
     case Type::INSERT: return ret + "INSERT";
     case Type::DELETE: return ret + "DELETE";
     case Type::UPDATE: return ret + "UPDATE";
+    case Type::INSERT_BATCH: return ret + "INSERT_BATCH";
     default: return ret + "UNKNOWN";
   }
 }
@@ -61,6 +62,9 @@ string RecordLogHeader::to_string() const
     case RecordOperation::Type::UPDATE: {
       ss << ", slot_num:" << slot_num;
     } break;
+    case RecordOperation::Type::INSERT_BATCH: {
+      ss << ", record_num:" << record_num;
+    } break;
     default: {
       ss << ", unknown operation type";
     } break;
@@ -129,6 +133,34 @@ RC RecordLogHandler::insert_record(Frame *frame, const RID &rid, const char *rec
   return rc;
 }
 
+RC RecordLogHandler::insert_records(Frame *frame, span<const Record> records)
+{
+  const int        record_num       = static_cast<int>(records.size());
+  const int        log_payload_size = RecordLogHeader::SIZE + record_num * (sizeof(SlotNum) + record_size_);
+  vector<char>     log_payload(log_payload_size);
+  RecordLogHeader *header = reinterpret_cast<RecordLogHeader *>(log_payload.data());
+  header->buffer_pool_id  = buffer_pool_id_;
+  header->operation_type  = RecordOperation(RecordOperation::Type::INSERT_BATCH).type_id();
+  header->page_num        = frame->page_num();
+  header->record_num      = record_num;
+  header->storage_format  = static_cast<int>(storage_format_);
+
+  SlotNum *slots = reinterpret_cast<SlotNum *>(log_payload.data() + RecordLogHeader::SIZE);
+  char    *data  = reinterpret_cast<char *>(slots + record_num);
+  for (int i = 0; i < record_num; i++) {
+    ASSERT(records[i].rid().page_num == frame->page_num(), "records of a batch should be in the same page");
+    slots[i] = records[i].rid().slot_num;
+    memcpy(data + i * record_size_, records[i].data(), record_size_);
+  }
+
+  LSN lsn = 0;
+  RC  rc  = log_handler_->append(lsn, LogModule::Id::RECORD_MANAGER, std::move(log_payload));
+  if (OB_SUCC(rc) && lsn > 0) {
+    frame->set_lsn(lsn);
+  }
+  return rc;
+}
+
 RC RecordLogHandler::update_record(Frame *frame, const RID &rid, const char *record)
 {
   const int        log_payload_size = RecordLogHeader::SIZE + record_size_;
@@ -220,6 +252,9 @@ RC RecordLogReplayer::replay(const LogEntry &entry)
     case RecordOperation::Type::INSERT: {
       rc = replay_insert(*buffer_pool, *log_header);
     } break;
+    case RecordOperation::Type::INSERT_BATCH: {
+      rc = replay_insert_batch(*buffer_pool, *log_header);
+    } break;
     case RecordOperation::Type::DELETE: {
       rc = replay_delete(*buffer_pool, *log_header);
     } break;
@@ -285,6 +320,38 @@ RC RecordLogReplayer::replay_insert(DiskBufferPool &buffer_pool, const RecordLog
   return rc;
 }
 
+RC RecordLogReplayer::replay_insert_batch(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header)
+{
+  VacuousLogHandler             vacuous_log_handler;
+  unique_ptr<RecordPageHandler> record_page_handler(
+      RecordPageHandler::create(StorageFormat(log_header.storage_format)));
+
+  RC rc = record_page_handler->init(buffer_pool, vacuous_log_handler, log_header.page_num, ReadWriteMode::READ_WRITE);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("fail to init record page handler. page num=%d, rc=%s", log_header.page_num, strrc(rc));
+    return rc;
+  }
+
+  const int      record_size = record_page_handler->record_real_size();
+  const SlotNum *slots       = reinterpret_cast<const SlotNum *>(log_header.data);
+  const char    *records     = reinterpret_cast<const char *>(slots + log_header.record_num);
+  for (int i = 0; i < log_header.record_num; i++) {
+    RID rid(log_header.page_num, slots[i]);
+    rc = record_page_handler->insert_record(records + i * record_size, &rid);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("fail to recover insert record. page num=%d, slot num=%d, rc=%s", 
+               log_header.page_num, slots[i], strrc(rc));
+      return rc;
+    }
+    if (rid.slot_num != slots[i]) {
+      LOG_WARN("recovered record is not in the logged slot. page num=%d, logged slot=%d, slot=%d",
+               log_header.page_num, slots[i], rid.slot_num);
+    }
+  }
+
+  return rc;
+}
+
 RC RecordLogReplayer::replay_delete(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header)
 {
   VacuousLogHandler             vacuous_log_handler;
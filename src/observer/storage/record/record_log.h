@@ -24,6 +24,7 @@ See the Mulan PSL v2 for more details. */
 #include "sql/parser/parse_defs.h"
 
 struct RID;
+class Record;
 class LogHandler;
 class Frame;
 class BufferPoolManager;
@@ -41,7 +42,8 @@ public:
     INIT_PAGE,  /// 初始化空页面
     INSERT,     /// 插入一条记录
     DELETE,     /// 删除一条记录
-    UPDATE      /// 更新一条记录
+    UPDATE,     /// 更新一条记录
+    INSERT_BATCH  /// 在同一个页面上插入多条记录
   };
 
 public:
@@ -69,6 +71,7 @@ struct RecordLogHeader
   {
     SlotNum slot_num;
     int32_t record_size;
+    int32_t record_num;  ///< INSERT_BATCH 中记录的个数
   };
 
   char data[0];
@@ -109,6 +112,14 @@ public:
    */
   RC insert_record(Frame *frame, const RID &rid, const char *record);
 
+  /**
+   * @brief 插入同一个页面上的多条记录，只记录一条日志
+   * @details 日志内容为 | RecordLogHeader | record_num 个 SlotNum | record_num 条记录 |
+   * @param frame 页帧
+   * @param records 插入的记录，rid 已经设置好，并且都在 frame 对应的页面上
+   */
+  RC insert_records(Frame *frame, span<const Record> records);
+
   /**
    * @brief 删除一条记录
    * @param frame 页帧
@@ -147,6 +158,7 @@ public:
 private:
   RC replay_init_page(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
   RC replay_insert(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
+  RC replay_insert_batch(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
   RC replay_delete(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
   RC replay_update(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
 
@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 // Created by Meiyi & Longda on 2021/4/13.
 //
 #include "storage/record/record_manager.h"
+#include "common/lang/bit.h"
 #include "common/log/log.h"
 #include "storage/common/condition_filter.h"
 #include "storage/trx/trx.h"
@@ -59,6 +60,50 @@ int page_record_capacity(int page_size, int record_size, int fixed_size)
  */
 int page_bitmap_size(int record_capacity) { return (record_capacity + 7) / 8; }
 
+/**
+ * @brief 把 bitmap 中连续的有效槽位合并成区间 [first, first + second)
+ * @details 每次处理 64 个槽位，借助 countr_zero 直接跳到下一个有效/无效槽位，
+ * 而不是逐位检查。页面写满时只会得到一个区间，稀疏页面也不需要遍历所有空槽位。
+ *
+ * @param bitmap          页面上的 bitmap
+ * @param record_capacity bitmap 中有效的位数
+ * @param runs            返回的有效槽位区间
+ */
+void page_slot_runs(const char *bitmap, int record_capacity, vector<pair<int, int>> &runs)
+{
+  runs.clear();
+
+  const int bitmap_size = page_bitmap_size(record_capacity);
+  int       run_start   = -1;
+  for (int base = 0; base < record_capacity; base += 64) {
+    uint64_t word = 0;
+    memcpy(&word, bitmap + base / 8, std::min(8, bitmap_size - base / 8));
+    if (record_capacity - base < 64) {
+      word &= (uint64_t(1) << (record_capacity - base)) - 1;
+    }
+
+    int pos = 0;
+    while (pos < 64) {
+      // 在区间外时找下一个 1，在区间内时找下一个 0
+      const uint64_t rest = (run_start < 0 ? word : ~word) >> pos;
+      if (rest == 0) {
+        break;
+      }
+      pos += countr_zero(rest);
+      if (run_start < 0) {
+        run_start = base + pos;
+      } else {
+        runs.emplace_back(run_start, base + pos - run_start);
+        run_start = -1;
+      }
+    }
+  }
+
+  if (run_start >= 0) {
+    runs.emplace_back(run_start, record_capacity - run_start);
+  }
+}
+
 string PageHeader::to_string() const
 {
   stringstream ss;
@@ -271,6 +316,29 @@ RC RowRecordPageHandler::insert_record(const char *data, RID *rid)
   ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
          "cannot insert record into page while the page is readonly");
 
+  SlotNum index = -1;
+  RC      rc    = place_record(data, index);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  rc = log_handler_.insert_record(frame_, RID(get_page_num(), index), data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to insert record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = index;
+  }
+
+  // LOG_TRACE("Insert record. rid page_num=%d, slot num=%d", get_page_num(), index);
+  return RC::SUCCESS;
+}
+
+RC RowRecordPageHandler::place_record(const char *data, SlotNum &slot_num)
+{
   if (page_header_->record_num == page_header_->record_capacity) {
     LOG_WARN("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
     return RC::RECORD_NOMEM;
@@ -282,24 +350,13 @@ RC RowRecordPageHandler::insert_record(const char *data, RID *rid)
   bitmap.set_bit(index);
   page_header_->record_num++;
 
-  RC rc = log_handler_.insert_record(frame_, RID(get_page_num(), index), data);
-  if (OB_FAIL(rc)) {
-    LOG_ERROR("Failed to insert record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
-    // return rc; // ignore errors
-  }
-
   // assert index < page_header_->record_capacity
   char *record_data = get_record_data(index);
   memcpy(record_data, data, page_header_->record_real_size);
 
   frame_->mark_dirty();
 
-  if (rid) {
-    rid->page_num = get_page_num();
-    rid->slot_num = index;
-  }
-
-  // LOG_TRACE("Insert record. rid page_num=%d, slot num=%d", get_page_num(), index);
+  slot_num = index;
   return RC::SUCCESS;
 }
 
@@ -414,11 +471,77 @@ PageNum RecordPageHandler::get_page_num() const
 
 bool RecordPageHandler::is_full() const { return page_header_->record_num >= page_header_->record_capacity; }
 
+RC RecordPageHandler::insert_records(span<Record> records, int &inserted)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot insert record into page while the page is readonly");
+
+  RC rc    = RC::SUCCESS;
+  inserted = 0;
+  while (inserted < static_cast<int>(records.size()) && can_insert(records[inserted].data())) {
+    SlotNum slot_num = -1;
+    rc               = place_record(records[inserted].data(), slot_num);
+    if (OB_FAIL(rc)) {
+      break;
+    }
+    records[inserted].set_rid(get_page_num(), slot_num);
+    inserted++;
+  }
+
+  if (inserted > 0) {
+    // 前面已经写入页面的记录仍然有效，所以即使后面的记录写入失败，也要记录日志
+    RC log_rc = log_handler_.insert_records(frame_, records.first(inserted));
+    if (OB_FAIL(log_rc)) {
+      LOG_ERROR("Failed to insert records. page_num %d:%d. rc=%s", 
+                disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(log_rc));
+      // return rc; // ignore errors
+    }
+  }
+  return rc;
+}
+
+bool PaxRecordPageHandler::is_full() const
+{
+  if (is_encoded()) {
+    // 编码后的页面只能在末尾追加，删除留下的空位不再复用
+    const PaxEncodedPageInfo *info = encoded_info();
+    return info->closed != 0 || info->next_slot >= page_header_->record_capacity;
+  }
+  return RecordPageHandler::is_full();
+}
+
 RC PaxRecordPageHandler::insert_record(const char *data, RID *rid)
 {
   ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
          "cannot insert record into page while the page is readonly");
 
+  SlotNum index = -1;
+  RC      rc    = place_record(data, index);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  rc = log_handler_.insert_record(frame_, RID(get_page_num(), index), data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to insert record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = index;
+  }
+
+  // LOG_TRACE("Insert record. rid page_num=%d, slot num=%d", get_page_num(), index);
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::place_record(const char *data, SlotNum &slot_num)
+{
+  if (is_encoded()) {
+    return place_encoded_record(data, slot_num);
+  }
+
   if (page_header_->record_num == page_header_->record_capacity) {
     LOG_WARN("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
     return RC::RECORD_NOMEM;
@@ -430,12 +553,6 @@ RC PaxRecordPageHandler::insert_record(const char *data, RID *rid)
   bitmap.set_bit(index);
   page_header_->record_num++;
 
-  RC rc = log_handler_.insert_record(frame_, RID(get_page_num(), index), data);
-  if (OB_FAIL(rc)) {
-    LOG_ERROR("Failed to insert record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
-    // return rc; // ignore errors
-  }
-
   // assert index < page_header_->record_capacity
   auto len = 0;
   for (size_t i = 0; i < static_cast<size_t>(page_header_->column_num); ++i) {
@@ -446,12 +563,7 @@ RC PaxRecordPageHandler::insert_record(const char *data, RID *rid)
 
   frame_->mark_dirty();
 
-  if (rid) {
-    rid->page_num = get_page_num();
-    rid->slot_num = index;
-  }
-
-  // LOG_TRACE("Insert record. rid page_num=%d, slot num=%d", get_page_num(), index);
+  slot_num = index;
   return RC::SUCCESS;
 }
 
@@ -498,13 +610,27 @@ RC PaxRecordPageHandler::get_record(const RID &rid, Record &record)
 
   // 首先计算总记录长度
   int total_len = 0;
-  for (size_t i = 0; i < static_cast<size_t>(page_header_->column_num); ++i) {
-    total_len += get_field_len(i);
+  if (is_encoded()) {
+    total_len = page_header_->record_real_size;
+  } else {
+    for (size_t i = 0; i < static_cast<size_t>(page_header_->column_num); ++i) {
+      total_len += get_field_len(i);
+    }
   }
 
   // 分配内存
   record.new_record(total_len);
 
+  if (is_encoded()) {
+    int offset = 0;
+    for (int i = 0; i < page_header_->column_num; ++i) {
+      EncodedColumn column = encoded_column(i);
+      column.get(rid.slot_num, record.data() + offset);
+      offset += column.attr_len();
+    }
+    return RC::SUCCESS;
+  }
+
   // 将各列数据复制到 record 中
   int offset = 0;
   for (size_t i = 0; i < static_cast<size_t>(page_header_->column_num); ++i) {
@@ -517,7 +643,9 @@ RC PaxRecordPageHandler::get_record(const RID &rid, Record &record)
 }
 
 // TODO: specify the column_ids that chunk needed. currenly we get all columns
-RC PaxRecordPageHandler::get_chunk(Chunk &chunk)
+RC PaxRecordPageHandler::get_chunk(Chunk &chunk) { return get_chunk(chunk, vector<ZonePredicate>()); }
+
+RC PaxRecordPageHandler::get_chunk(Chunk &chunk, const vector<ZonePredicate> &predicates)
 {
   if (page_header_->record_num == 0) {
     LOG_DEBUG("Page is empty, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
@@ -532,32 +660,249 @@ RC PaxRecordPageHandler::get_chunk(Chunk &chunk)
     return RC::INTERNAL;
   }
 
-  // 初始化 bitmap 以检查记录有效性
-  Bitmap bitmap(bitmap_, page_header_->record_capacity);
-
   for (size_t i = 0; i < static_cast<size_t>(chunk.column_num()); ++i) {
     int col_id = chunk.column_ids(i);
     if (col_id < 0 || col_id >= page_header_->column_num) {
       LOG_ERROR("Invalid column id %d, page_num %d:%d.", col_id, disk_buffer_pool_->file_desc(), frame_->page_num());
       return RC::INVALID_ARGUMENT;
     }
-    chunk.column(i).reset_data();
-    for (size_t j = 0; j < static_cast<size_t>(page_header_->record_capacity); ++j) {
-      if (!bitmap.get_bit(j)) {
+  }
+
+  if (is_encoded()) {
+    return get_encoded_chunk(chunk, predicates);
+  }
+
+  // 同一列在页面内是连续存放的，所以每段连续的有效槽位只需要一次 memcpy。
+  // 页面写满时，每列只拷贝一次；稀疏页面则直接跳过空槽位。
+  vector<pair<int, int>> runs;
+  page_slot_runs(bitmap_, page_header_->record_capacity, runs);
+
+  for (size_t i = 0; i < static_cast<size_t>(chunk.column_num()); ++i) {
+    int     col_id    = chunk.column_ids(i);
+    int     field_len = get_field_len(col_id);
+    Column &column    = chunk.column(i);
+    if (column.capacity() < page_header_->record_num || column.attr_len() != field_len) {
+      LOG_ERROR("Chunk column %d can not hold page data, capacity=%d, attr_len=%d, page_num %d:%d.", 
+                i, column.capacity(), column.attr_len(), disk_buffer_pool_->file_desc(), frame_->page_num());
+      return RC::INTERNAL;
+    }
+
+    char *dst = column.data();
+    for (const auto &[start_slot, slot_count] : runs) {
+      const int run_len = slot_count * field_len;
+      memcpy(dst, get_field_data(start_slot, col_id), run_len);
+      dst += run_len;
+    }
+    column.set_count(page_header_->record_num);
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::get_encoded_chunk(Chunk &chunk, const vector<ZonePredicate> &predicates)
+{
+  const int slot_num = encoded_info()->next_slot;
+
+  // 先在编码数据上计算过滤条件，只解码满足条件的记录
+  vector<uint8_t> select;
+  for (const ZonePredicate &predicate : predicates) {
+    if (predicate.col_id < 0 || predicate.col_id >= page_header_->column_num) {
+      continue;
+    }
+    EncodedColumn column = encoded_column(predicate.col_id);
+    if (column.attr_type() != predicate.value.attr_type()) {
+      continue;
+    }
+    if (select.empty()) {
+      Bitmap bitmap(bitmap_, page_header_->record_capacity);
+      select.resize(slot_num);
+      for (int i = 0; i < slot_num; i++) {
+        select[i] = bitmap.get_bit(i) ? 1 : 0;
+      }
+    }
+    column.select(predicate.comp, predicate.value.data(), predicate.value.length(), slot_num, select);
+  }
+
+  vector<pair<int, int>> runs;
+  if (select.empty()) {
+    page_slot_runs(bitmap_, slot_num, runs);
+  } else {
+    for (int i = 0; i < slot_num;) {
+      if (select[i] == 0) {
+        i++;
         continue;
       }
-      char *field_data = get_field_data(j, col_id);
-      RC    rc         = chunk.column(i).append_one(field_data);
-      if (OB_FAIL(rc)) {
-        LOG_ERROR("Failed to append data to chunk column %d, page_num %d:%d, rc=%s", 
-                  i, disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
-        return rc;
+      int start = i;
+      while (i < slot_num && select[i] != 0) {
+        i++;
+      }
+      runs.emplace_back(start, i - start);
+    }
+  }
+
+  int row_num = 0;
+  for (const auto &run : runs) {
+    row_num += run.second;
+  }
+  if (row_num == 0) {
+    return RC::RECORD_EOF;
+  }
+
+  for (int i = 0; i < chunk.column_num(); ++i) {
+    EncodedColumn encoded = encoded_column(chunk.column_ids(i));
+    Column       &column  = chunk.column(i);
+    if (column.capacity() < row_num || column.attr_len() != encoded.attr_len()) {
+      LOG_ERROR("Chunk column %d can not hold page data, capacity=%d, attr_len=%d, page_num %d:%d.", 
+                i, column.capacity(), column.attr_len(), disk_buffer_pool_->file_desc(), frame_->page_num());
+      return RC::INTERNAL;
+    }
+
+    char *dst = column.data();
+    for (const auto &[start_slot, slot_count] : runs) {
+      encoded.decode(start_slot, slot_count, dst);
+      dst += slot_count * encoded.attr_len();
+    }
+    column.set_count(row_num);
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::encode_page(const TableMeta &table_meta)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot encode page while the page is readonly");
+
+  // 只对写满的页面做编码，这时所有的 slot 都是有效的
+  const int column_num = page_header_->column_num;
+  const int row_num    = page_header_->record_capacity;
+  if (is_encoded() || page_header_->record_num != row_num || column_num != table_meta.field_num()) {
+    return RC::SUCCESS;
+  }
+
+  vector<ColumnEncodingPlan> plans;
+  plans.reserve(column_num);
+  for (int i = 0; i < column_num; i++) {
+    plans.push_back(
+        ColumnEncodingPlan::choose(table_meta.field(i)->type(), get_field_len(i), get_field_data(0, i), row_num));
+  }
+
+  const int column_index_size = align8(column_num * sizeof(int));
+  const int info_size         = align8(sizeof(PaxEncodedPageInfo));
+  auto      page_size         = [&](int capacity) {
+    int size = align8(PAGE_HEADER_SIZE + page_bitmap_size(capacity)) + column_index_size + info_size;
+    for (const ColumnEncodingPlan &plan : plans) {
+      size += plan.encoded_size(capacity);
+    }
+    return size;
+  };
+
+  // 找到编码后能容纳的最多记录数，但不超过一个 Chunk 的默认容量，这样一个页面总能放进一个 Chunk 中
+  int low = row_num, high = static_cast<int>(Column::DEFAULT_CAPACITY);
+  while (low < high) {
+    int mid = (low + high + 1) / 2;
+    if (page_size(mid) <= BP_PAGE_DATA_SIZE) {
+      low = mid;
+    } else {
+      high = mid - 1;
+    }
+  }
+  const int capacity = low;
+  if (capacity <= row_num) {
+    LOG_TRACE("no space gain from encoding page. page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::SUCCESS;
+  }
+
+  // 先在临时内存中构造新的页面，再整体复制回来
+  vector<char> page(BP_PAGE_DATA_SIZE, 0);
+  PageHeader  *header = reinterpret_cast<PageHeader *>(page.data());
+  *header                 = *page_header_;
+  header->record_size     = 0;
+  header->record_capacity = capacity;
+  header->col_idx_offset  = align8(PAGE_HEADER_SIZE + page_bitmap_size(capacity));
+  header->data_offset     = header->col_idx_offset + column_index_size;
+
+  PaxEncodedPageInfo *info = reinterpret_cast<PaxEncodedPageInfo *>(page.data() + header->data_offset);
+  info->next_slot          = row_num;
+  info->closed             = 0;
+
+  memcpy(page.data() + PAGE_HEADER_SIZE, bitmap_, page_bitmap_size(row_num));
+
+  int *column_index = reinterpret_cast<int *>(page.data() + header->col_idx_offset);
+  int  offset       = header->data_offset + info_size;
+  for (int i = 0; i < column_num; i++) {
+    column_index[i] = offset;
+    EncodedColumn column(page.data() + offset);
+    column.init(plans[i], capacity);
+    for (int slot = 0; slot < row_num; slot++) {
+      column.append(slot, get_field_data(slot, i));
+    }
+    offset += plans[i].encoded_size(capacity);
+  }
+
+  memcpy(frame_->data(), page.data(), BP_PAGE_DATA_SIZE);
+  frame_->mark_dirty();
+  LOG_TRACE("encode page done. page_num %d:%d, capacity %d -> %d.", 
+            disk_buffer_pool_->file_desc(), frame_->page_num(), row_num, capacity);
+  return RC::SUCCESS;
+}
+
+bool PaxRecordPageHandler::can_insert(const char *data)
+{
+  if (is_full()) {
+    return false;
+  }
+  if (!is_encoded()) {
+    return true;
+  }
+
+  const int slot   = encoded_info()->next_slot;
+  int       offset = 0;
+  for (int i = 0; i < page_header_->column_num; i++) {
+    EncodedColumn column = encoded_column(i);
+    if (!column.can_append(slot, data + offset)) {
+      // 以后的记录也很可能无法表示，不再向这个页面插入数据
+      if (rw_mode_ != ReadWriteMode::READ_ONLY) {
+        encoded_info()->closed = 1;
+        frame_->mark_dirty();
       }
+      return false;
     }
+    offset += column.attr_len();
+  }
+  return true;
+}
+
+RC PaxRecordPageHandler::place_encoded_record(const char *data, SlotNum &slot_num)
+{
+  if (!can_insert(data)) {
+    LOG_WARN("Page can not hold the record, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
+
+  PaxEncodedPageInfo *info  = encoded_info();
+  const int           index = info->next_slot;
+  Bitmap              bitmap(bitmap_, page_header_->record_capacity);
+  bitmap.set_bit(index);
+  page_header_->record_num++;
+  info->next_slot++;
+
+  int offset = 0;
+  for (int i = 0; i < page_header_->column_num; i++) {
+    EncodedColumn column = encoded_column(i);
+    column.append(index, data + offset);
+    offset += column.attr_len();
   }
+
+  frame_->mark_dirty();
+
+  slot_num = index;
   return RC::SUCCESS;
 }
 
+EncodedColumn PaxRecordPageHandler::encoded_column(int col_id)
+{
+  int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
+  return EncodedColumn(frame_->data() + col_idx[col_id]);
+}
+
 char *PaxRecordPageHandler::get_field_data(SlotNum slot_num, int col_id)
 {
   int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
@@ -582,7 +927,8 @@ int PaxRecordPageHandler::get_field_len(int col_id)
 
 RecordFileHandler::~RecordFileHandler() { this->close(); }
 
-RC RecordFileHandler::init(DiskBufferPool &buffer_pool, LogHandler &log_handler, TableMeta *table_meta)
+RC RecordFileHandler::init(
+    DiskBufferPool &buffer_pool, LogHandler &log_handler, TableMeta *table_meta, const char *zone_map_file)
 {
   if (disk_buffer_pool_ != nullptr) {
     LOG_ERROR("record file handler has been openned.");
@@ -593,7 +939,14 @@ RC RecordFileHandler::init(DiskBufferPool &buffer_pool, LogHandler &log_handler,
   log_handler_      = &log_handler;
   table_meta_       = table_meta;
 
-  RC rc = init_free_pages();
+  // zone map 文件不存在或者已经失效时，在遍历页面的同时重建
+  bool rebuild_zone_map = false;
+  if (storage_format_ == StorageFormat::PAX_FORMAT && table_meta_ != nullptr) {
+    zone_map_.init(*table_meta_, zone_map_file);
+    rebuild_zone_map = zone_map_.enabled() && OB_FAIL(zone_map_.load());
+  }
+
+  RC rc = init_free_pages(rebuild_zone_map);
 
   LOG_INFO("open record file handle done. rc=%s", strrc(rc));
   return RC::SUCCESS;
@@ -609,7 +962,7 @@ void RecordFileHandler::close()
   }
 }
 
-RC RecordFileHandler::init_free_pages()
+RC RecordFileHandler::init_free_pages(bool rebuild_zone_map)
 {
   // 遍历当前文件上所有页面，找到没有满的页面
   // 这个效率很低，会降低启动速度
@@ -634,19 +987,26 @@ RC RecordFileHandler::init_free_pages()
     if (!record_page_handler->is_full()) {
       free_pages_.insert(current_page_num);
     }
+
+    if (rebuild_zone_map) {
+      RecordPageIterator record_iterator;
+      Record             record;
+      record_iterator.init(record_page_handler.get());
+      while (record_iterator.has_next() && OB_SUCC(record_iterator.next(record))) {
+        zone_map_.update(current_page_num, record.data());
+      }
+    }
     record_page_handler->cleanup();
   }
   LOG_INFO("record file handler init free pages done. free page num=%d, rc=%s", free_pages_.size(), strrc(rc));
   return rc;
 }
 
-RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
+RC RecordFileHandler::get_insertable_page(const char *data, int record_size, RecordPageHandler &record_page_handler)
 {
-  RC ret = RC::SUCCESS;
-
-  unique_ptr<RecordPageHandler> record_page_handler(RecordPageHandler::create(storage_format_));
-  bool                          page_found       = false;
-  PageNum                       current_page_num = 0;
+  RC      ret              = RC::SUCCESS;
+  bool    page_found       = false;
+  PageNum current_page_num = 0;
 
   // 当前要访问free_pages对象，所以需要加锁。在非并发编译模式下，不需要考虑这个锁
   lock_.lock();
@@ -655,18 +1015,18 @@ RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
   while (!free_pages_.empty()) {
     current_page_num = *free_pages_.begin();
 
-    ret = record_page_handler->init(*disk_buffer_pool_, *log_handler_, current_page_num, ReadWriteMode::READ_WRITE);
+    ret = record_page_handler.init(*disk_buffer_pool_, *log_handler_, current_page_num, ReadWriteMode::READ_WRITE);
     if (OB_FAIL(ret)) {
       lock_.unlock();
       LOG_WARN("failed to init record page handler. page num=%d, rc=%d:%s", current_page_num, ret, strrc(ret));
       return ret;
     }
 
-    if (!record_page_handler->is_full()) {
+    if (record_page_handler.can_insert(data)) {
       page_found = true;
       break;
     }
-    record_page_handler->cleanup();
+    record_page_handler.cleanup();
     free_pages_.erase(free_pages_.begin());
   }
   lock_.unlock();  // 如果找到了一个有效的页面，那么此时已经拿到了页面的写锁
@@ -681,7 +1041,7 @@ RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
 
     current_page_num = frame->page_num();
 
-    ret = record_page_handler->init_empty_page(
+    ret = record_page_handler.init_empty_page(
         *disk_buffer_pool_, *log_handler_, current_page_num, record_size, table_meta_);
     if (OB_FAIL(ret)) {
       frame->unpin();
@@ -701,9 +1061,90 @@ RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
     free_pages_.insert(current_page_num);
     lock_.unlock();
   }
+  return ret;
+}
+
+void RecordFileHandler::encode_full_page(RecordPageHandler &record_page_handler)
+{
+  // PAX 页面写满后做编码，编码后的页面可以继续追加更多的记录
+  if (storage_format_ == StorageFormat::PAX_FORMAT && table_meta_ != nullptr && record_page_handler.is_full()) {
+    RC rc = record_page_handler.encode_page(*table_meta_);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to encode page. page num=%d, rc=%s", record_page_handler.get_page_num(), strrc(rc));
+    }
+  }
+}
+
+RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
+{
+  unique_ptr<RecordPageHandler> record_page_handler(RecordPageHandler::create(storage_format_));
+
+  RC ret = get_insertable_page(data, record_size, *record_page_handler);
+  if (OB_FAIL(ret)) {
+    return ret;
+  }
+
+  // 先放宽 zone map 再写入数据，避免并发扫描时根据过时的 zone map 跳过这个页面。
+  // 插入失败时 zone map 只是比实际数据宽一些，不影响正确性
+  zone_map_.update(record_page_handler->get_page_num(), data);
 
   // 找到空闲位置
-  return record_page_handler->insert_record(data, rid);
+  ret = record_page_handler->insert_record(data, rid);
+  if (OB_SUCC(ret)) {
+    encode_full_page(*record_page_handler);
+  }
+  return ret;
+}
+
+RC RecordFileHandler::insert_records(span<Record> records)
+{
+  RC  ret    = RC::SUCCESS;
+  int offset = 0;
+
+  unique_ptr<RecordPageHandler> record_page_handler(RecordPageHandler::create(storage_format_));
+  while (offset < static_cast<int>(records.size())) {
+    ret = get_insertable_page(records[offset].data(), records[offset].len(), *record_page_handler);
+    if (OB_FAIL(ret)) {
+      break;
+    }
+
+    // 每个页面只 pin 一次，尽量写满后再换下一个页面
+    const PageNum page_num = record_page_handler->get_page_num();
+    while (offset < static_cast<int>(records.size())) {
+      int inserted = 0;
+      ret          = record_page_handler->insert_records(records.subspan(offset), inserted);
+
+      // 与 insert_record 不同，这里写入之后才放宽 zone map。此时仍然持有页面的写锁，
+      // 并发的扫描即使跳过了这个页面，也只相当于在这次插入之前完成了扫描
+      for (int i = 0; i < inserted; i++) {
+        zone_map_.update(page_num, records[offset + i].data());
+      }
+      offset += inserted;
+      if (OB_FAIL(ret) || inserted == 0) {
+        break;
+      }
+
+      // PAX 页面编码后可能还可以继续写入
+      encode_full_page(*record_page_handler);
+    }
+    record_page_handler->cleanup();
+
+    if (OB_FAIL(ret)) {
+      LOG_WARN("failed to insert records into page. page num=%d, rc=%s", page_num, strrc(ret));
+      break;
+    }
+  }
+
+  // 保证要么全部插入成功，要么全部失败
+  if (OB_FAIL(ret)) {
+    for (int i = 0; i < offset; i++) {
+      RC rc = delete_record(&records[i].rid());
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to rollback inserted record. rid=%s, rc=%s", records[i].rid().to_string().c_str(), strrc(rc));
+      }
+    }
+  }
+  return ret;
 }
 
 RC RecordFileHandler::recover_insert_record(const char *data, int record_size, const RID &rid)
@@ -718,7 +1159,11 @@ RC RecordFileHandler::recover_insert_record(const char *data, int record_size, c
     return ret;
   }
 
-  return record_page_handler->recover_insert_record(data, rid);
+  ret = record_page_handler->recover_insert_record(data, rid);
+  if (OB_SUCC(ret)) {
+    zone_map_.update(rid.page_num, data);
+  }
+  return ret;
 }
 
 RC RecordFileHandler::delete_record(const RID *rid)
@@ -797,6 +1242,9 @@ RC RecordFileHandler::visit_record(const RID &rid, function<bool(Record &)> upda
   bool updated = updater(record);
   if (updated) {
     rc = page_handler->update_record(rid, record.data());
+    if (OB_SUCC(rc)) {
+      zone_map_.update(rid.page_num, record.data());
+    }
   }
   return rc;
 }
@@ -818,8 +1266,7 @@ RC ChunkFileScanner::close_scan()
   return RC::SUCCESS;
 }
 RC ChunkFileScanner::open_scan_chunk(
-
-    Table *table, DiskBufferPool &buffer_pool, LogHandler &log_handler, ReadWriteMode mode)
+    Table *table, DiskBufferPool &buffer_pool, LogHandler &log_handler, ReadWriteMode mode, const ZoneMap *zone_map)
 {
   close_scan();
 
@@ -827,6 +1274,9 @@ RC ChunkFileScanner::open_scan_chunk(
   disk_buffer_pool_ = &buffer_pool;
   log_handler_      = &log_handler;
   rw_mode_          = mode;
+  zone_map_         = zone_map;
+  zone_predicates_.clear();
+  morsels_ = nullptr;
 
   RC rc = bp_iterator_.init(buffer_pool, 1);
   if (rc != RC::SUCCESS) {
@@ -842,23 +1292,51 @@ RC ChunkFileScanner::open_scan_chunk(
   return rc;
 }
 
+void ChunkFileScanner::set_morsel_queue(BufferPoolMorselQueue *morsels)
+{
+  morsels_ = morsels;
+  if (morsels_ != nullptr) {
+    // 第 0 个页面是文件头，与 open_scan_chunk 一样从第 1 个页面开始
+    morsels_->init(*disk_buffer_pool_, 1);
+    bp_iterator_.init(*disk_buffer_pool_, 1, 1);
+  }
+}
+
+bool ChunkFileScanner::next_morsel()
+{
+  PageNum start = 0, end = 0;
+  if (morsels_ == nullptr || !morsels_->next(start, end)) {
+    return false;
+  }
+  bp_iterator_.init(*disk_buffer_pool_, start, end);
+  return true;
+}
+
 RC ChunkFileScanner::next_chunk(Chunk &chunk)
 {
   RC rc = RC::SUCCESS;
 
-  while (bp_iterator_.has_next()) {
+  while (bp_iterator_.has_next() || next_morsel()) {
+    if (!bp_iterator_.has_next()) {
+      continue;
+    }
     PageNum page_num = bp_iterator_.next();
     record_page_handler_->cleanup();
+    // 在加载页面之前根据 zone map 判断是否可以跳过
+    if (zone_map_ != nullptr && !zone_map_->may_match(page_num, zone_predicates_)) {
+      continue;
+    }
     rc = record_page_handler_->init(*disk_buffer_pool_, *log_handler_, page_num, rw_mode_);
     if (OB_FAIL(rc)) {
       LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", page_num, strrc(rc));
       return rc;
     }
-    rc = record_page_handler_->get_chunk(chunk);
+    rc = record_page_handler_->get_chunk(chunk, zone_predicates_);
     if (rc == RC::SUCCESS) {
       return rc;
     } else if (rc == RC::RECORD_EOF) {
-      break;
+      // 空页面或者所有记录都被过滤掉了，后面的页面上可能还有数据
+      continue;
     } else {
       LOG_WARN("failed to get chunk from page. page_num=%d, rc=%s", page_num, strrc(rc));
       return rc;
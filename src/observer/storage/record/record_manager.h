@@ -19,7 +19,9 @@ See the Mulan PSL v2 for more details. */
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/common/chunk.h"
 #include "storage/record/record.h"
+#include "storage/record/column_encoding.h"
 #include "storage/record/record_log.h"
+#include "storage/record/zone_map.h"
 #include "common/types.h"
 
 class LogHandler;
@@ -76,6 +78,18 @@ struct PageHeader
   string to_string() const;
 };
 
+/**
+ * @brief 编码后的 PAX 页面的附加信息，存放在 PageHeader::data_offset 处
+ * @ingroup RecordManager
+ * @details 编码后的页面不再按定长存放记录，PageHeader::record_size 置为 0 作为编码页面的标记。
+ * 这样原始页面的格式和容量保持不变。
+ */
+struct PaxEncodedPageInfo
+{
+  int32_t next_slot;  ///< 编码后的页面只能追加，这里记录下一条记录的位置
+  int32_t closed;     ///< 新的记录不能被当前编码表示时置为 1，页面不再接受插入
+};
+
 /**
  * @brief 遍历一个页面中每条记录的iterator
  * @ingroup RecordManager
@@ -181,6 +195,16 @@ public:
    */
   virtual RC insert_record(const char *data, RID *rid) { return RC::UNIMPLEMENTED; }
 
+  /**
+   * @brief 在当前页面上批量插入记录
+   * @details 从 records 的第一条开始，尽量多地写入当前页面，页面放不下时停止。
+   * 写入的所有记录只记录一条日志。
+   *
+   * @param records  要插入的记录，写入成功的记录会设置 rid
+   * @param inserted 写入当前页面的记录个数
+   */
+  RC insert_records(span<Record> records, int &inserted);
+
   /**
    * @brief 数据库恢复时，在指定位置插入数据
    *
@@ -218,6 +242,21 @@ public:
    */
   virtual RC get_chunk(Chunk &chunk) { return RC::UNIMPLEMENTED; }
 
+  /**
+   * @brief 获取整个页面中指定列的记录，同时尽量用 predicates 过滤掉不满足条件的记录
+   * @details 只是粗略的过滤，返回的记录中仍然可能有不满足条件的，调用者需要再做一次过滤。
+   * 如果所有记录都被过滤掉，返回 RECORD_EOF。
+   */
+  virtual RC get_chunk(Chunk &chunk, const vector<ZonePredicate> &predicates) { return get_chunk(chunk); }
+
+  /**
+   * @brief 页面写满后，对各列数据做编码，腾出空间容纳更多记录
+   * @details 只有 PAX 页面支持。编码没有收益时，页面保持不变
+   *
+   * @param table_meta 表的元数据，用来获取各列的类型
+   */
+  virtual RC encode_page(const TableMeta &table_meta) { return RC::UNIMPLEMENTED; }
+
   /**
    * @brief 返回该记录页的页号
    */
@@ -226,9 +265,25 @@ public:
   /**
    * @brief 当前页面是否已经没有空闲位置插入新的记录
    */
-  bool is_full() const;
+  virtual bool is_full() const;
+
+  /**
+   * @brief 当前页面能否插入指定的记录
+   * @details 编码后的页面不仅要有空闲位置，新的记录还要能被当前的编码表示
+   */
+  virtual bool can_insert(const char *data) { return !is_full(); }
+
+  int record_real_size() const { return page_header_->record_real_size; }
 
 protected:
+  /**
+   * @brief 把记录写入页面上的空闲位置，不记录日志
+   *
+   * @param data     要插入的记录
+   * @param slot_num 如果写入成功，通过这个参数返回记录的位置
+   */
+  virtual RC place_record(const char *data, SlotNum &slot_num) { return RC::UNIMPLEMENTED; }
+
   /**
    * @details
    * 前面在计算record_capacity时并没有考虑对齐，但第一个record需要8字节对齐
@@ -297,6 +352,9 @@ public:
    * @param record 返回指定的数据。这里不会将数据复制出来，而是使用指针，所以调用者必须保证数据使用期间受到保护
    */
   virtual RC get_record(const RID &rid, Record &record) override;
+
+protected:
+  virtual RC place_record(const char *data, SlotNum &slot_num) override;
 };
 
 /**
@@ -342,12 +400,45 @@ public:
    */
   virtual RC get_chunk(Chunk &chunk) override;
 
+  /**
+   * @brief 以 Chunk 格式获取页面中的记录，编码后的页面会直接在编码数据上计算 predicates
+   */
+  virtual RC get_chunk(Chunk &chunk, const vector<ZonePredicate> &predicates) override;
+
+  /**
+   * @brief 对写满的页面做编码
+   * @details 根据页面上已有的数据为每一列选择编码方式(参考 ColumnEncodingPlan)，并按照编码后的大小
+   * 重新计算页面能够容纳的记录数。编码不改变已有记录的 slot，所以 RID 仍然有效。
+   * 之后新的记录只能追加在已有记录的后面，删除记录留下的空位不再复用。
+   */
+  virtual RC encode_page(const TableMeta &table_meta) override;
+
+  virtual bool is_full() const override;
+
+  virtual bool can_insert(const char *data) override;
+
+protected:
+  virtual RC place_record(const char *data, SlotNum &slot_num) override;
+
 private:
   // get the field data by `slot_num` and `column id`
   char *get_field_data(SlotNum slot_num, int col_id);
 
   // get the field length by `column id`, all columns are fixed length.
   int get_field_len(int col_id);
+
+  bool is_encoded() const { return page_header_->record_size == 0; }
+
+  PaxEncodedPageInfo *encoded_info() const
+  {
+    return reinterpret_cast<PaxEncodedPageInfo *>(frame_->data() + page_header_->data_offset);
+  }
+
+  EncodedColumn encoded_column(int col_id);
+
+  RC place_encoded_record(const char *data, SlotNum &slot_num);
+
+  RC get_encoded_chunk(Chunk &chunk, const vector<ZonePredicate> &predicates);
 };
 /**
  * @brief 管理整个文件中记录的增删改查
@@ -363,9 +454,11 @@ public:
   /**
    * @brief 初始化
    *
-   * @param buffer_pool 当前操作的是哪个文件
+   * @param buffer_pool   当前操作的是哪个文件
+   * @param zone_map_file PAX 表的 zone map 持久化文件，为空时 zone map 只保存在内存中
    */
-  RC init(DiskBufferPool &buffer_pool, LogHandler &log_handler, TableMeta *table_meta);
+  RC init(DiskBufferPool &buffer_pool, LogHandler &log_handler, TableMeta *table_meta,
+      const char *zone_map_file = nullptr);
 
   /**
    * @brief 关闭，做一些资源清理的工作
@@ -388,6 +481,15 @@ public:
    */
   RC insert_record(const char *data, int record_size, RID *rid);
 
+  /**
+   * @brief 批量插入记录
+   * @details 每个页面只 pin 一次，尽量多地写入记录，每个页面上的记录只记录一条日志。
+   * 任意一条记录插入失败时，已经插入的记录会被删除。
+   *
+   * @param records 要插入的记录，插入成功后会设置每条记录的 rid
+   */
+  RC insert_records(span<Record> records);
+
   /**
    * @brief 数据库恢复时，在指定文件指定位置插入数据
    *
@@ -401,11 +503,29 @@ public:
 
   RC visit_record(const RID &rid, function<bool(Record &)> updater);
 
+  /**
+   * @brief 每个页面上各列的取值范围，只有 PAX 表会维护
+   */
+  ZoneMap &zone_map() { return zone_map_; }
+
 private:
   /**
    * @brief 初始化当前没有填满记录的页面，初始化free_pages_成员
+   *
+   * @param rebuild_zone_map 是否同时根据页面上的记录重建 zone map
    */
-  RC init_free_pages();
+  RC init_free_pages(bool rebuild_zone_map);
+
+  /**
+   * @brief 找到一个可以插入 data 的页面，没有时分配一个新的页面
+   * @details 成功时 record_page_handler 已经持有页面的写锁
+   */
+  RC get_insertable_page(const char *data, int record_size, RecordPageHandler &record_page_handler);
+
+  /**
+   * @brief PAX 页面写满时对页面做编码
+   */
+  void encode_full_page(RecordPageHandler &record_page_handler);
 
 private:
   DiskBufferPool        *disk_buffer_pool_ = nullptr;
@@ -414,6 +534,7 @@ private:
   common::Mutex          lock_;  ///< 当编译时增加-DCONCURRENCY=ON 选项时，才会真正的支持并发
   StorageFormat          storage_format_;
   TableMeta             *table_meta_;
+  ZoneMap                zone_map_;
 };
 
 /**
@@ -427,8 +548,23 @@ public:
   ChunkFileScanner() = default;
   ~ChunkFileScanner();
 
-  // TODO: not support filter and transaction
-  RC open_scan_chunk(Table *table, DiskBufferPool &buffer_pool, LogHandler &log_handler, ReadWriteMode mode);
+  // TODO: not support transaction
+  RC open_scan_chunk(Table *table, DiskBufferPool &buffer_pool, LogHandler &log_handler, ReadWriteMode mode,
+      const ZoneMap *zone_map = nullptr);
+
+  /**
+   * @brief 设置用于跳过页面的过滤条件
+   * @details zone map 表明不可能满足这些条件的页面，不会被加载。
+   * 这里只是粗略的过滤，返回的 Chunk 中仍然可能有不满足条件的记录。
+   */
+  void set_zone_predicates(vector<ZonePredicate> &&predicates) { zone_predicates_ = std::move(predicates); }
+
+  /**
+   * @brief 只扫描从 morsels 中领取到的页面
+   * @details 多个 ChunkFileScanner 共享同一个 morsels 时，每个页面只会被其中一个扫描到，
+   * 用于多线程并行扫描同一张表。需要在 open_scan_chunk 之后、next_chunk 之前调用。
+   */
+  void set_morsel_queue(BufferPoolMorselQueue *morsels);
 
   /**
    * @brief 关闭一个文件扫描，释放相应的资源
@@ -440,6 +576,13 @@ public:
    */
   RC next_chunk(Chunk &chunk);
 
+private:
+  /**
+   * @brief 从 morsels_ 中领取下一段页面
+   * @return 没有更多的页面时返回 false
+   */
+  bool next_morsel();
+
 private:
   Table *table_ = nullptr;  ///< 当前遍历的是哪张表。
 
@@ -449,4 +592,9 @@ private:
 
   BufferPoolIterator bp_iterator_;                    ///< 遍历buffer pool的所有页面
   RecordPageHandler *record_page_handler_ = nullptr;  ///< 处理文件某页面的记录
+
+  const ZoneMap        *zone_map_ = nullptr;  ///< 为空时不跳过任何页面
+  vector<ZonePredicate> zone_predicates_;
+
+  BufferPoolMorselQueue *morsels_ = nullptr;  ///< 为空时扫描文件的所有页面
 };
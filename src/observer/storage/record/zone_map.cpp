@@ -0,0 +1,232 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/record/zone_map.h"
+#include "storage/record/column_encoding.h"
+#include "common/lang/fstream.h"
+#include "common/log/log.h"
+#include "storage/table/table_meta.h"
+
+using namespace common;
+
+static constexpr int32_t ZONE_MAP_MAGIC = 0x7a6f6e65;  // "zone"
+
+static bool zone_supported(AttrType type)
+{
+  return type == AttrType::INTS || type == AttrType::DATES || type == AttrType::FLOATS || type == AttrType::CHARS;
+}
+
+void ZoneMap::init(const TableMeta &table_meta, const char *file)
+{
+  file_        = file == nullptr ? "" : file;
+  record_size_ = 0;
+  columns_.clear();
+  pages_.clear();
+  // 与 PaxRecordPageHandler::insert_record 一样，按照字段顺序和长度拆分记录
+  int offset = 0;
+  for (int i = 0; i < table_meta.field_num(); i++) {
+    const FieldMeta *field = table_meta.field(i);
+    if (zone_supported(field->type())) {
+      columns_.push_back(ColumnInfo{field->field_id(), field->type(), offset, field->len()});
+    }
+    offset += field->len();
+  }
+  record_size_ = offset;
+  dirty_     = false;
+  persisted_ = false;
+}
+
+RC ZoneMap::load()
+{
+  if (file_.empty()) {
+    return RC::FILE_NOT_EXIST;
+  }
+
+  ifstream fs(file_, ios_base::in | ios_base::binary);
+  if (!fs.is_open()) {
+    LOG_INFO("zone map file does not exist. file=%s", file_.c_str());
+    return RC::FILE_NOT_EXIST;
+  }
+
+  int32_t magic = 0, record_size = 0, column_num = 0, page_num = 0;
+  fs.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  fs.read(reinterpret_cast<char *>(&record_size), sizeof(record_size));
+  fs.read(reinterpret_cast<char *>(&column_num), sizeof(column_num));
+  fs.read(reinterpret_cast<char *>(&page_num), sizeof(page_num));
+  if (!fs || magic != ZONE_MAP_MAGIC || record_size != record_size_ ||
+      column_num != static_cast<int32_t>(columns_.size()) || page_num < 0) {
+    LOG_WARN("invalid zone map file header. file=%s", file_.c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  vector<PageZone> pages(page_num);
+  for (PageZone &zone : pages) {
+    char valid = 0;
+    fs.read(&valid, sizeof(valid));
+    zone.valid = valid != 0;
+    if (zone.valid) {
+      zone.min.resize(record_size_);
+      zone.max.resize(record_size_);
+      fs.read(zone.min.data(), record_size_);
+      fs.read(zone.max.data(), record_size_);
+    }
+    if (!fs) {
+      LOG_WARN("zone map file is truncated. file=%s", file_.c_str());
+      return RC::IOERR_READ;
+    }
+  }
+
+  lock_guard guard(lock_);
+  pages_.swap(pages);
+  dirty_     = false;
+  persisted_ = true;
+  LOG_INFO("load zone map done. file=%s, pages=%d", file_.c_str(), page_num);
+  return RC::SUCCESS;
+}
+
+RC ZoneMap::sync()
+{
+  lock_guard guard(lock_);
+  if (file_.empty() || !dirty_) {
+    return RC::SUCCESS;
+  }
+
+  // 与表元数据一样，先写临时文件再 rename，防止文件内容不完整
+  string   tmp_file = file_ + ".tmp";
+  ofstream fs(tmp_file, ios_base::out | ios_base::binary | ios_base::trunc);
+  if (!fs.is_open()) {
+    LOG_ERROR("Failed to open file for write. file name=%s, errmsg=%s", tmp_file.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  const int32_t header[] = {
+      ZONE_MAP_MAGIC, record_size_, static_cast<int32_t>(columns_.size()), static_cast<int32_t>(pages_.size())};
+  fs.write(reinterpret_cast<const char *>(header), sizeof(header));
+  for (const PageZone &zone : pages_) {
+    const char valid = zone.valid ? 1 : 0;
+    fs.write(&valid, sizeof(valid));
+    if (zone.valid) {
+      fs.write(zone.min.data(), record_size_);
+      fs.write(zone.max.data(), record_size_);
+    }
+  }
+  fs.close();
+  if (!fs) {
+    LOG_ERROR("Failed to write zone map file: %s. sys err=%d:%s", tmp_file.c_str(), errno, strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+
+  if (rename(tmp_file.c_str(), file_.c_str()) != 0) {
+    LOG_ERROR("Failed to rename tmp zone map file (%s) to %s. system error=%d:%s",
+              tmp_file.c_str(), file_.c_str(), errno, strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+
+  dirty_     = false;
+  persisted_ = true;
+  return RC::SUCCESS;
+}
+
+void ZoneMap::update(PageNum page_num, const char *record)
+{
+  if (!enabled()) {
+    return;
+  }
+
+  lock_guard guard(lock_);
+  if (persisted_) {
+    remove_file();
+  }
+  dirty_ = true;
+
+  if (static_cast<size_t>(page_num) >= pages_.size()) {
+    pages_.resize(page_num + 1);
+  }
+
+  PageZone &zone = pages_[page_num];
+  if (!zone.valid) {
+    zone.valid = true;
+    zone.min.assign(record, record_size_);
+    zone.max.assign(record, record_size_);
+    return;
+  }
+
+  for (const ColumnInfo &column : columns_) {
+    const char *value = record + column.offset;
+    char       *min   = zone.min.data() + column.offset;
+    char       *max   = zone.max.data() + column.offset;
+    if (compare_field_data(column.type, value, column.len, min, column.len) < 0) {
+      memcpy(min, value, column.len);
+    } else if (compare_field_data(column.type, value, column.len, max, column.len) > 0) {
+      memcpy(max, value, column.len);
+    }
+  }
+}
+
+bool ZoneMap::may_match(PageNum page_num, const vector<ZonePredicate> &predicates) const
+{
+  if (!enabled() || predicates.empty()) {
+    return true;
+  }
+
+  lock_.lock_shared();
+  if (page_num < 0 || static_cast<size_t>(page_num) >= pages_.size() || !pages_[page_num].valid) {
+    lock_.unlock_shared();
+    return true;
+  }
+
+  const PageZone &zone   = pages_[page_num];
+  bool            result = true;
+  for (const ZonePredicate &predicate : predicates) {
+    const ColumnInfo *column = find_column(predicate.col_id);
+    if (column == nullptr || predicate.value.attr_type() != column->type) {
+      continue;
+    }
+
+    const char *value     = predicate.value.data();
+    const int   value_len = predicate.value.length();
+    const int   cmp_min   = compare_field_data(column->type, zone.min.data() + column->offset, column->len, value, value_len);
+    const int   cmp_max   = compare_field_data(column->type, zone.max.data() + column->offset, column->len, value, value_len);
+    switch (predicate.comp) {
+      case EQUAL_TO: result = cmp_min <= 0 && cmp_max >= 0; break;
+      case NOT_EQUAL: result = !(cmp_min == 0 && cmp_max == 0); break;
+      case LESS_THAN: result = cmp_min < 0; break;
+      case LESS_EQUAL: result = cmp_min <= 0; break;
+      case GREAT_THAN: result = cmp_max > 0; break;
+      case GREAT_EQUAL: result = cmp_max >= 0; break;
+      default: break;
+    }
+    if (!result) {
+      break;
+    }
+  }
+  lock_.unlock_shared();
+  return result;
+}
+
+bool ZoneMap::has_column(int col_id) const { return find_column(col_id) != nullptr; }
+
+const ZoneMap::ColumnInfo *ZoneMap::find_column(int col_id) const
+{
+  for (const ColumnInfo &column : columns_) {
+    if (column.col_id == col_id) {
+      return &column;
+    }
+  }
+  return nullptr;
+}
+
+void ZoneMap::remove_file()
+{
+  if (::remove(file_.c_str()) != 0 && errno != ENOENT) {
+    LOG_WARN("failed to remove zone map file. file=%s, errno=%d:%s", file_.c_str(), errno, strerror(errno));
+  }
+  persisted_ = false;
+}
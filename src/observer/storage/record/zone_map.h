@@ -0,0 +1,119 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/mutex.h"
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "common/sys/rc.h"
+#include "common/types.h"
+#include "common/value.h"
+#include "sql/parser/parse_defs.h"
+
+class TableMeta;
+
+/**
+ * @brief 可以下推到 zone map 上的过滤条件，形如 `column op value`
+ * @ingroup RecordManager
+ */
+struct ZonePredicate
+{
+  int    col_id;  ///< 列在页面中的编号，与 FieldMeta::field_id 一致
+  CompOp comp;
+  Value  value;   ///< 类型与列的类型相同
+};
+
+/**
+ * @brief PAX 表每个页面上每一列的最小值/最大值
+ * @ingroup RecordManager
+ * @details 插入记录时放宽对应页面的取值范围，删除记录时不收缩，所以 zone map 总是页面实际数据的一个超集，
+ * 据此跳过页面是安全的。
+ * zone map 保存在与数据文件同目录的独立文件中。加载后，第一次修改时就删除该文件，直到下一次 sync 再重新写入，
+ * 这样磁盘上存在的 zone map 文件一定不会比数据文件"窄"。文件不存在或者内容不合法时，由调用者扫描所有页面重建。
+ * 当前没有 NULL 值，所以不记录 null count。
+ */
+class ZoneMap
+{
+public:
+  ZoneMap()  = default;
+  ~ZoneMap() = default;
+
+  /**
+   * @brief 初始化各列信息
+   *
+   * @param table_meta 表的元数据，只会记录支持比较大小的列
+   * @param file       zone map 持久化使用的文件，为空时不做持久化
+   */
+  void init(const TableMeta &table_meta, const char *file);
+
+  bool enabled() const { return !columns_.empty(); }
+
+  /**
+   * @brief 从 init 时指定的文件中加载 zone map
+   * @details 文件不存在或者与当前表结构不匹配时返回错误，调用者需要重建 zone map
+   */
+  RC load();
+
+  /**
+   * @brief 如果有修改，就将 zone map 写入文件
+   * @details 调用前需要保证数据页面已经刷盘
+   */
+  RC sync();
+
+  /**
+   * @brief 插入一条记录后，放宽记录所在页面上各列的取值范围
+   *
+   * @param page_num 记录所在页面
+   * @param record   行格式的记录数据
+   */
+  void update(PageNum page_num, const char *record);
+
+  /**
+   * @brief 判断页面上是否可能存在满足所有条件的记录
+   * @details 没有该页面的统计信息时返回 true
+   */
+  bool may_match(PageNum page_num, const vector<ZonePredicate> &predicates) const;
+
+  /**
+   * @brief 指定的列是否维护了 zone map
+   */
+  bool has_column(int col_id) const;
+
+private:
+  struct ColumnInfo
+  {
+    int      col_id;
+    AttrType type;
+    int      offset;  ///< 在记录中的偏移
+    int      len;
+  };
+
+  /// 每个页面按照记录格式存放最小值和最大值，只有 columns_ 中的列是有效的
+  struct PageZone
+  {
+    bool   valid = false;
+    string min;
+    string max;
+  };
+
+  const ColumnInfo *find_column(int col_id) const;
+
+  void remove_file();
+
+private:
+  mutable common::SharedMutex lock_;
+  string                      file_;
+  int                         record_size_ = 0;
+  vector<ColumnInfo>          columns_;
+  vector<PageZone>            pages_;  ///< 按页面编号索引
+  bool                        dirty_     = false;
+  bool                        persisted_ = false;  ///< 磁盘上的 zone map 文件是否与内存一致
+};
@@ -19,6 +19,7 @@ See the Mulan PSL v2 for more details. */
 HeapTableEngine::~HeapTableEngine()
 {
   if (record_handler_ != nullptr) {
+    record_handler_->zone_map().sync();
     delete record_handler_;
     record_handler_ = nullptr;
   }
@@ -61,6 +62,46 @@ RC HeapTableEngine::insert_record(Record &record)
   return rc;
 }
 
+RC HeapTableEngine::insert_records(span<Record> records)
+{
+  RC rc = record_handler_->insert_records(records);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Insert records failed. table name=%s, record num=%d, rc=%s",
+              table_meta_->name(), static_cast<int>(records.size()), strrc(rc));
+    return rc;
+  }
+
+  // 每个索引内部失败时会自己回滚，这里只需要回滚之前已经插入成功的索引
+  size_t index_num = 0;
+  for (; index_num < indexes_.size(); index_num++) {
+    rc = indexes_[index_num]->insert_entries(records);
+    if (OB_FAIL(rc)) {  // 可能出现了键值重复
+      break;
+    }
+  }
+  if (OB_SUCC(rc)) {
+    return rc;
+  }
+
+  for (size_t i = 0; i < index_num; i++) {
+    for (const Record &record : records) {
+      RC rc2 = indexes_[i]->delete_entry(record.data(), &record.rid());
+      if (rc2 != RC::SUCCESS) {
+        LOG_ERROR("Failed to rollback index data when insert index entries failed. table name=%s, rc=%d:%s",
+                  table_meta_->name(), rc2, strrc(rc2));
+      }
+    }
+  }
+  for (const Record &record : records) {
+    RC rc2 = record_handler_->delete_record(&record.rid());
+    if (rc2 != RC::SUCCESS) {
+      LOG_PANIC("Failed to rollback record data when insert index entries failed. table name=%s, rc=%d:%s",
+                table_meta_->name(), rc2, strrc(rc2));
+    }
+  }
+  return rc;
+}
+
 RC HeapTableEngine::visit_record(const RID &rid, function<bool(Record &)> visitor)
 {
   return record_handler_->visit_record(rid, visitor);
@@ -102,7 +143,7 @@ RC HeapTableEngine::get_record_scanner(RecordScanner *&scanner, Trx *trx, ReadWr
 
 RC HeapTableEngine::get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode)
 {
-  RC rc = scanner.open_scan_chunk(table_, *data_buffer_pool_, db_->log_handler(), mode);
+  RC rc = scanner.open_scan_chunk(table_, *data_buffer_pool_, db_->log_handler(), mode, &record_handler_->zone_map());
   if (rc != RC::SUCCESS) {
     LOG_ERROR("failed to open scanner. rc=%s", strrc(rc));
   }
@@ -250,6 +291,13 @@ RC HeapTableEngine::sync()
   }
 
   rc = data_buffer_pool_->flush_all_pages();
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to flush table's pages. table=%s, rc=%d:%s", table_meta_->name(), rc, strrc(rc));
+    return rc;
+  }
+
+  // zone map 必须在数据页面刷盘之后再写入
+  rc = record_handler_->zone_map().sync();
   LOG_INFO("Sync table over. table=%s", table_meta_->name());
   return rc;
 }
@@ -285,7 +333,8 @@ RC HeapTableEngine::init()
 
   record_handler_ = new RecordFileHandler(table_meta_->storage_format());
 
-  rc = record_handler_->init(*data_buffer_pool_, db_->log_handler(), table_meta_);
+  string zone_map_file = table_zone_map_file(db_->path().c_str(), table_meta_->name());
+  rc = record_handler_->init(*data_buffer_pool_, db_->log_handler(), table_meta_, zone_map_file.c_str());
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to init record handler. rc=%s", strrc(rc));
     delete record_handler_;
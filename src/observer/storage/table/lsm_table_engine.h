@@ -29,6 +29,7 @@ public:
   ~LsmTableEngine() override = default;
 
   RC insert_record(Record &record) override;
+  RC insert_records(span<Record> records) override;
   RC delete_record(const Record &record) override { return RC::UNIMPLEMENTED; }
   RC insert_record_with_trx(Record &record, Trx *trx) override { return RC::UNIMPLEMENTED; }
   RC delete_record_with_trx(const Record &record, Trx *trx) override { return RC::UNIMPLEMENTED; }
@@ -180,6 +180,11 @@ RC Table::insert_record(Record &record)
   return engine_->insert_record(record);
 }
 
+RC Table::insert_records(span<Record> records)
+{
+  return engine_->insert_records(records);
+}
+
 RC Table::visit_record(const RID &rid, function<bool(Record &)> visitor)
 {
   return engine_->visit_record(rid, visitor);
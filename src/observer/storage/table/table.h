@@ -82,6 +82,14 @@ public:
    * @param record[in/out] 传入的数据包含具体的数据，插入成功会通过此字段返回RID
    */
   RC insert_record(Record &record);
+
+  /**
+   * @brief 在当前的表中批量插入记录
+   * @details 数据按页面批量写入，每个页面只记录一条日志，索引也批量插入。
+   * 任意一条记录插入失败时，整批数据都不会插入。
+   * @param records[in/out] 插入成功会通过每条记录返回RID
+   */
+  RC insert_records(span<Record> records);
   RC delete_record(const Record &record);
 
   RC insert_record_with_trx(Record &record, Trx *trx);
@@ -16,7 +16,7 @@ See the Mulan PSL v2 for more details. */
 
 using namespace std;
 
-TEST(AggregateHashTableTest, DISABLED_standard_hash_table)
+TEST(AggregateHashTableTest, standard_hash_table)
 {
   // single group by column, single aggregate column
   {
@@ -103,8 +103,336 @@ TEST(AggregateHashTableTest, DISABLED_standard_hash_table)
   }
 }
 
-#ifdef USE_SIMD
-TEST(AggregateHashTableTest, DISABLED_linear_probing_hash_table)
+TEST(AggregateHashTableTest, standard_hash_table_spill)
+{
+  // 分组数远大于内存限制，需要写临时文件并多次递归分区
+  const int group_num = 20000;
+  const int row_num   = group_num * 3;
+
+  AggregateExpr             sum_expr(AggregateExpr::Type::SUM, nullptr);
+  AggregateExpr             count_expr(AggregateExpr::Type::COUNT, nullptr);
+  AggregateExpr             max_expr(AggregateExpr::Type::MAX, nullptr);
+  std::vector<Expression *> aggregate_exprs = {&sum_expr, &count_expr, &max_expr};
+  auto standard_hash_table = std::make_unique<StandardAggregateHashTable>(aggregate_exprs, 16 * 1024);
+
+  for (int start = 0; start < row_num; start += 1000) {
+    Chunk group_chunk;
+    Chunk aggr_chunk;
+    group_chunk.add_column(std::make_unique<Column>(AttrType::INTS, 4), 0);
+    for (int i = 0; i < 3; i++) {
+      aggr_chunk.add_column(std::make_unique<Column>(AttrType::INTS, 4), i);
+    }
+    for (int i = start; i < start + 1000; i++) {
+      int key = i % group_num;
+      group_chunk.column(0).append_one((char *)&key);
+      for (int j = 0; j < 3; j++) {
+        aggr_chunk.column(j).append_one((char *)&i);
+      }
+    }
+    ASSERT_EQ(standard_hash_table->add_chunk(group_chunk, aggr_chunk), RC::SUCCESS);
+  }
+  ASSERT_TRUE(standard_hash_table->spilled());
+
+  StandardAggregateHashTable::Scanner scanner(standard_hash_table.get());
+  scanner.open_scan();
+  std::vector<bool> seen(group_num, false);
+  int               rows = 0;
+  while (true) {
+    Chunk output_chunk;
+    for (int i = 0; i < 4; i++) {
+      output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), i);
+    }
+    RC rc = scanner.next(output_chunk);
+    if (rc == RC::RECORD_EOF) {
+      break;
+    }
+    ASSERT_EQ(rc, RC::SUCCESS);
+    for (int i = 0; i < output_chunk.rows(); i++) {
+      int key = output_chunk.get_value(0, i).get_int();
+      ASSERT_FALSE(seen[key]);
+      seen[key] = true;
+      ASSERT_EQ(output_chunk.get_value(1, i).get_int(), key * 3 + group_num * 3);
+      ASSERT_EQ(output_chunk.get_value(2, i).get_int(), 3);
+      ASSERT_EQ(output_chunk.get_value(3, i).get_int(), key + group_num * 2);
+    }
+    rows += output_chunk.rows();
+  }
+  ASSERT_EQ(rows, group_num);
+}
+
+TEST(AggregateHashTableTest, standard_hash_table_all_aggregates)
+{
+  // 多个分组列(float, char, date)，所有的聚合函数，只聚合选中的行
+  Chunk group_chunk;
+  Chunk aggr_chunk;
+  group_chunk.add_column(std::make_unique<Column>(AttrType::FLOATS, 4), 0);
+  group_chunk.add_column(std::make_unique<Column>(AttrType::CHARS, 4), 1);
+  group_chunk.add_column(std::make_unique<Column>(AttrType::DATES, 4), 2);
+  for (int i = 0; i < 5; i++) {
+    aggr_chunk.add_column(std::make_unique<Column>(AttrType::INTS, 4), i);
+  }
+
+  const int row_num = 1000;
+  for (int i = 0; i < row_num; i++) {
+    float f    = (i % 4) / 2.0f;
+    char  s[4] = {static_cast<char>('a' + i % 2), 0, 0, 0};
+    int   date = 20240101 + i % 4;
+    group_chunk.column(0).append_one((char *)&f);
+    group_chunk.column(1).append_one(s);
+    group_chunk.column(2).append_one((char *)&date);
+    for (int j = 0; j < 5; j++) {
+      aggr_chunk.column(j).append_one((char *)&i);
+    }
+  }
+  std::vector<int> selection;
+  for (int i = 0; i < row_num; i += 2) {
+    selection.push_back(i);
+  }
+  group_chunk.set_selection(selection);
+
+  AggregateExpr             count_expr(AggregateExpr::Type::COUNT, nullptr);
+  AggregateExpr             sum_expr(AggregateExpr::Type::SUM, nullptr);
+  AggregateExpr             avg_expr(AggregateExpr::Type::AVG, nullptr);
+  AggregateExpr             max_expr(AggregateExpr::Type::MAX, nullptr);
+  AggregateExpr             min_expr(AggregateExpr::Type::MIN, nullptr);
+  std::vector<Expression *> aggregate_exprs = {&count_expr, &sum_expr, &avg_expr, &max_expr, &min_expr};
+  StandardAggregateHashTable hash_table(aggregate_exprs);
+  ASSERT_EQ(hash_table.add_chunk(group_chunk, aggr_chunk), RC::SUCCESS);
+
+  Chunk output_chunk;
+  output_chunk.add_column(make_unique<Column>(AttrType::FLOATS, 4), 0);
+  output_chunk.add_column(make_unique<Column>(AttrType::CHARS, 4), 1);
+  output_chunk.add_column(make_unique<Column>(AttrType::DATES, 4), 2);
+  output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 3);
+  output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 4);
+  output_chunk.add_column(make_unique<Column>(AttrType::FLOATS, 4), 5);
+  output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 6);
+  output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 7);
+  StandardAggregateHashTable::Scanner scanner(&hash_table);
+  scanner.open_scan();
+  ASSERT_EQ(scanner.next(output_chunk), RC::SUCCESS);
+  // 只有偶数行，分组是 i % 4 = 0 或 2
+  ASSERT_EQ(output_chunk.rows(), 2);
+  for (int i = 0; i < output_chunk.rows(); i++) {
+    const int key = static_cast<int>(output_chunk.get_value(0, i).get_float() * 2);
+    ASSERT_TRUE(key == 0 || key == 2);
+    ASSERT_STREQ(output_chunk.get_value(1, i).get_string().c_str(), "a");
+    ASSERT_EQ(reinterpret_cast<int *>(output_chunk.column(2).data())[i], 20240101 + key);
+    // key, key + 4, ..., key + 996
+    ASSERT_EQ(output_chunk.get_value(3, i).get_int(), row_num / 4);
+    ASSERT_EQ(output_chunk.get_value(4, i).get_int(), (key + key + 996) * (row_num / 4) / 2);
+    ASSERT_FLOAT_EQ(output_chunk.get_value(5, i).get_float(), (key + key + 996) / 2.0f);
+    ASSERT_EQ(output_chunk.get_value(6, i).get_int(), key + 996);
+    ASSERT_EQ(output_chunk.get_value(7, i).get_int(), key);
+  }
+}
+
+TEST(AggregateHashTableTest, standard_hash_table_avg_spill)
+{
+  // AVG 的部分结果写到临时文件后，sum 和行数都要合并
+  const int group_num = 5000;
+  AggregateExpr             avg_expr(AggregateExpr::Type::AVG, nullptr);
+  std::vector<Expression *> aggregate_exprs = {&avg_expr};
+  StandardAggregateHashTable hash_table(aggregate_exprs, 16 * 1024);
+
+  for (int round = 0; round < 4; round++) {
+    Chunk group_chunk;
+    Chunk aggr_chunk;
+    group_chunk.add_column(std::make_unique<Column>(AttrType::INTS, 4), 0);
+    aggr_chunk.add_column(std::make_unique<Column>(AttrType::INTS, 4), 0);
+    for (int i = 0; i < group_num; i++) {
+      int value = i + round;
+      group_chunk.column(0).append_one((char *)&i);
+      aggr_chunk.column(0).append_one((char *)&value);
+    }
+    ASSERT_EQ(hash_table.add_chunk(group_chunk, aggr_chunk), RC::SUCCESS);
+  }
+  ASSERT_TRUE(hash_table.spilled());
+
+  StandardAggregateHashTable::Scanner scanner(&hash_table);
+  scanner.open_scan();
+  int rows = 0;
+  while (true) {
+    Chunk output_chunk;
+    output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 0);
+    output_chunk.add_column(make_unique<Column>(AttrType::FLOATS, 4), 1);
+    RC rc = scanner.next(output_chunk);
+    if (rc == RC::RECORD_EOF) {
+      break;
+    }
+    ASSERT_EQ(rc, RC::SUCCESS);
+    for (int i = 0; i < output_chunk.rows(); i++) {
+      int key = output_chunk.get_value(0, i).get_int();
+      ASSERT_FLOAT_EQ(output_chunk.get_value(1, i).get_float(), key + 1.5f);
+    }
+    rows += output_chunk.rows();
+  }
+  ASSERT_EQ(rows, group_num);
+}
+
+TEST(AggregateHashTableTest, standard_hash_table_many_groups)
+{
+  // (int, char) 组成的分组键，分组数远大于初始的槽位数，每个分组出现两次
+  const int group_num  = 30000;
+  const int chunk_num  = 8;
+  const int chunk_rows = group_num * 2 / chunk_num;
+
+  AggregateExpr              count_expr(AggregateExpr::Type::COUNT, nullptr);
+  AggregateExpr              max_expr(AggregateExpr::Type::MAX, nullptr);
+  AggregateExpr              min_expr(AggregateExpr::Type::MIN, nullptr);
+  std::vector<Expression *>  aggregate_exprs = {&count_expr, &max_expr, &min_expr};
+  StandardAggregateHashTable hash_table(aggregate_exprs);
+
+  for (int c = 0; c < chunk_num; c++) {
+    Chunk group_chunk;
+    Chunk aggr_chunk;
+    group_chunk.add_column(std::make_unique<Column>(AttrType::INTS, 4, chunk_rows), 0);
+    group_chunk.add_column(std::make_unique<Column>(AttrType::CHARS, 8, chunk_rows), 1);
+    aggr_chunk.add_column(std::make_unique<Column>(AttrType::INTS, 4, chunk_rows), 0);
+    aggr_chunk.add_column(std::make_unique<Column>(AttrType::CHARS, 8, chunk_rows), 1);
+    aggr_chunk.add_column(std::make_unique<Column>(AttrType::CHARS, 8, chunk_rows), 2);
+    for (int i = c * chunk_rows; i < (c + 1) * chunk_rows; i++) {
+      const int key  = i % group_num;
+      const int high = key / 100;
+      // 字符串后面的填充字节不同，分组仍然相同
+      char name[8];
+      memset(name, i < group_num ? 'x' : 'y', sizeof(name));
+      snprintf(name, sizeof(name), "k%d", key % 100);
+      char value[8] = {0};
+      snprintf(value, sizeof(value), "v%d", i);
+      group_chunk.column(0).append_one((char *)&high);
+      group_chunk.column(1).append_one(name);
+      aggr_chunk.column(0).append_one((char *)&i);
+      aggr_chunk.column(1).append_one(value);
+      aggr_chunk.column(2).append_one(value);
+    }
+    ASSERT_EQ(hash_table.add_chunk(group_chunk, aggr_chunk), RC::SUCCESS);
+  }
+  ASSERT_FALSE(hash_table.spilled());
+  ASSERT_EQ(hash_table.group_count(), group_num);
+
+  StandardAggregateHashTable::Scanner scanner(&hash_table);
+  scanner.open_scan();
+  std::vector<bool> seen(group_num, false);
+  int               rows = 0;
+  while (true) {
+    Chunk output_chunk;
+    output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 0);
+    output_chunk.add_column(make_unique<Column>(AttrType::CHARS, 8), 1);
+    output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 2);
+    output_chunk.add_column(make_unique<Column>(AttrType::CHARS, 8), 3);
+    output_chunk.add_column(make_unique<Column>(AttrType::CHARS, 8), 4);
+    RC rc = scanner.next(output_chunk);
+    if (rc == RC::RECORD_EOF) {
+      break;
+    }
+    ASSERT_EQ(rc, RC::SUCCESS);
+    for (int i = 0; i < output_chunk.rows(); i++) {
+      const std::string name = output_chunk.get_value(1, i).get_string();
+      const int         key  = output_chunk.get_value(0, i).get_int() * 100 + atoi(name.c_str() + 1);
+      ASSERT_FALSE(seen[key]);
+      seen[key] = true;
+      ASSERT_EQ(output_chunk.get_value(2, i).get_int(), 2);
+      // 按字符串比较
+      const std::string first  = "v" + std::to_string(key);
+      const std::string second = "v" + std::to_string(key + group_num);
+      ASSERT_EQ(output_chunk.get_value(3, i).get_string(), std::max(first, second));
+      ASSERT_EQ(output_chunk.get_value(4, i).get_string(), std::min(first, second));
+    }
+    rows += output_chunk.rows();
+  }
+  ASSERT_EQ(rows, group_num);
+}
+
+TEST(AggregateHashTableTest, standard_hash_table_merge)
+{
+  // 4 个部分结果按照分区合并到 3 个哈希表中，每行属于哪个部分结果由行号决定，最后一个部分结果写过临时文件
+  const int group_num   = 1000;
+  const int row_num     = 20000;
+  const int partial_num = 4;
+
+  AggregateExpr             count_expr(AggregateExpr::Type::COUNT, nullptr);
+  AggregateExpr             sum_expr(AggregateExpr::Type::SUM, nullptr);
+  AggregateExpr             avg_expr(AggregateExpr::Type::AVG, nullptr);
+  AggregateExpr             max_expr(AggregateExpr::Type::MAX, nullptr);
+  AggregateExpr             min_expr(AggregateExpr::Type::MIN, nullptr);
+  std::vector<Expression *> aggregate_exprs = {&count_expr, &sum_expr, &avg_expr, &max_expr, &min_expr};
+
+  std::vector<std::unique_ptr<StandardAggregateHashTable>> partials;
+  for (int p = 0; p < partial_num; p++) {
+    const int64_t memory_limit = p == partial_num - 1 ? 4096 : StandardAggregateHashTable::DEFAULT_MEMORY_LIMIT;
+    partials.push_back(std::make_unique<StandardAggregateHashTable>(aggregate_exprs, memory_limit));
+
+    Chunk group_chunk;
+    Chunk aggr_chunk;
+    group_chunk.add_column(std::make_unique<Column>(AttrType::INTS, 4, row_num), 0);
+    for (int i = 0; i < 5; i++) {
+      aggr_chunk.add_column(std::make_unique<Column>(AttrType::INTS, 4, row_num), i);
+    }
+    for (int i = p; i < row_num; i += partial_num) {
+      const int key = i % group_num;
+      group_chunk.column(0).append_one((char *)&key);
+      for (int j = 0; j < 5; j++) {
+        aggr_chunk.column(j).append_one((char *)&i);
+      }
+    }
+    ASSERT_EQ(partials.back()->add_chunk(group_chunk, aggr_chunk), RC::SUCCESS);
+  }
+  ASSERT_FALSE(partials[0]->spilled());
+  ASSERT_TRUE(partials[partial_num - 1]->spilled());
+
+  const int partition_num = 3;
+  std::vector<std::unique_ptr<StandardAggregateHashTable>> merged;
+  for (int partition = 0; partition < partition_num; partition++) {
+    merged.push_back(std::make_unique<StandardAggregateHashTable>(aggregate_exprs));
+    for (int p = 0; p < partial_num - 1; p++) {
+      ASSERT_EQ(merged.back()->merge(*partials[p], partition, partition_num), RC::SUCCESS);
+    }
+  }
+  // 写过临时文件的部分结果逐个分区读出来再合并
+  RC rc = RC::SUCCESS;
+  while (OB_SUCC(rc = partials[partial_num - 1]->load_next_partition())) {
+    for (int partition = 0; partition < partition_num; partition++) {
+      ASSERT_EQ(merged[partition]->merge(*partials[partial_num - 1], partition, partition_num), RC::SUCCESS);
+    }
+  }
+  ASSERT_EQ(rc, RC::RECORD_EOF);
+
+  std::vector<bool> seen(group_num, false);
+  int               groups = 0;
+  for (auto &hash_table : merged) {
+    StandardAggregateHashTable::Scanner scanner(hash_table.get());
+    scanner.open_scan();
+    while (true) {
+      Chunk output_chunk;
+      for (int i = 0; i < 6; i++) {
+        output_chunk.add_column(make_unique<Column>(i == 3 ? AttrType::FLOATS : AttrType::INTS, 4), i);
+      }
+      RC rc = scanner.next(output_chunk);
+      if (rc == RC::RECORD_EOF) {
+        break;
+      }
+      ASSERT_EQ(rc, RC::SUCCESS);
+      for (int i = 0; i < output_chunk.rows(); i++) {
+        // 分组 key 的行是 key, key + group_num, ..., 共 row_num / group_num 行
+        const int key   = output_chunk.get_value(0, i).get_int();
+        const int count = row_num / group_num;
+        const int sum   = key * count + group_num * count * (count - 1) / 2;
+        ASSERT_FALSE(seen[key]);
+        seen[key] = true;
+        ASSERT_EQ(output_chunk.get_value(1, i).get_int(), count);
+        ASSERT_EQ(output_chunk.get_value(2, i).get_int(), sum);
+        ASSERT_FLOAT_EQ(output_chunk.get_value(3, i).get_float(), (float)sum / count);
+        ASSERT_EQ(output_chunk.get_value(4, i).get_int(), key + group_num * (count - 1));
+        ASSERT_EQ(output_chunk.get_value(5, i).get_int(), key);
+      }
+      groups += output_chunk.rows();
+    }
+  }
+  ASSERT_EQ(groups, group_num);
+}
+
+static void check_linear_probing_hash_table()
 {
   // simple case
   {
@@ -174,8 +502,66 @@ TEST(AggregateHashTableTest, DISABLED_linear_probing_hash_table)
     ASSERT_STREQ(output_chunk.get_value(1, 0).get_string().c_str(), "501");
     ASSERT_STREQ(output_chunk.get_value(1, 1).get_string().c_str(), "501");
   }
+
+  // 分组数超过初始容量需要扩容，包含负数和与 EMPTY_KEY 相等的键，只聚合选中的行
+  {
+    const int group_num = 3000;
+    Chunk     group_chunk;
+    Chunk     aggr_chunk;
+    group_chunk.add_column(std::make_unique<Column>(AttrType::INTS, 4), 0);
+    aggr_chunk.add_column(std::make_unique<Column>(AttrType::INTS, 4), 0);
+    std::vector<int> selection;
+    for (int i = 0; i < group_num * 2; i++) {
+      int key   = i % group_num - 1;
+      int value = 1;
+      group_chunk.column(0).append_one((char *)&key);
+      aggr_chunk.column(0).append_one((char *)&value);
+      if (i % 7 != 0) {
+        selection.push_back(i);
+      }
+    }
+    group_chunk.set_selection(selection);
+
+    auto hash_table = std::make_unique<LinearProbingAggregateHashTable<int>>(AggregateExpr::Type::SUM, 64);
+    ASSERT_EQ(hash_table->add_chunk(group_chunk, aggr_chunk), RC::SUCCESS);
+
+    std::vector<int> expected(group_num, 0);
+    for (int row : selection) {
+      expected[row % group_num]++;
+    }
+    LinearProbingAggregateHashTable<int>::Scanner scanner(hash_table.get());
+    scanner.open_scan();
+    int rows = 0;
+    while (true) {
+      Chunk output_chunk;
+      output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 0);
+      output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 1);
+      RC rc = scanner.next(output_chunk);
+      if (rc == RC::RECORD_EOF) {
+        break;
+      }
+      ASSERT_EQ(rc, RC::SUCCESS);
+      for (int i = 0; i < output_chunk.rows(); i++) {
+        int key = output_chunk.get_value(0, i).get_int();
+        ASSERT_EQ(output_chunk.get_value(1, i).get_int(), expected[key + 1]) << "key=" << key;
+      }
+      rows += output_chunk.rows();
+    }
+    ASSERT_EQ(rows, group_num);
+  }
+}
+
+// 每个 CPU 支持的 SIMD 级别都检查一遍，低于 AVX2 时逐个写入
+TEST(AggregateHashTableTest, linear_probing_hash_table)
+{
+  const SimdLevel max_level = detect_simd_level();
+  for (int level = 0; level <= static_cast<int>(max_level); level++) {
+    set_simd_level(static_cast<SimdLevel>(level));
+    SCOPED_TRACE(simd_level_name(simd_level()));
+    check_linear_probing_hash_table();
+  }
+  set_simd_level(max_level);
 }
-#endif
 
 int main(int argc, char **argv)
 {
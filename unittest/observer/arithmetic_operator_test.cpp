@@ -83,15 +83,14 @@ TEST(ArithmeticTest, arithmetic_test)
       ASSERT_EQ(result[i], -1);
     }
   }
-// sum
-#ifdef USE_SIMD
+  // sum
   {
     int              size = 100;
     std::vector<int> a(size, 0);
     for (int i = 0; i < size; i++) {
       a[i] = i;
     }
-    int res = mm256_sum_epi32(a.data(), size);
+    int res = simd_sum_epi32(a.data(), size);
     ASSERT_EQ(res, 4950);
   }
   {
@@ -100,10 +99,106 @@ TEST(ArithmeticTest, arithmetic_test)
     for (int i = 0; i < size; i++) {
       a[i] = i;
     }
-    int res = mm256_sum_ps(a.data(), size);
+    float res = simd_sum_ps(a.data(), size);
     ASSERT_FLOAT_EQ(res, 4950.0);
   }
-#endif
+}
+
+template <typename T>
+static void check_simd_kernels(const SimdKernels &kernels, const std::vector<T> &left, const std::vector<T> &right)
+{
+  const SimdCompare compares[] = {
+      SimdCompare::EQ, SimdCompare::NE, SimdCompare::LT, SimdCompare::LE, SimdCompare::GT, SimdCompare::GE};
+  const SimdArithmetic arithmetics[] = {
+      SimdArithmetic::ADD, SimdArithmetic::SUB, SimdArithmetic::MUL, SimdArithmetic::DIV};
+  const SimdKernels   &scalar        = simd_kernels(SimdLevel::SCALAR);
+
+  // 包含不足一个向量宽度的长度
+  for (int n : {0, 1, 7, 8, 15, 16, 17, 100}) {
+    T expected_sum = 0;
+    for (int i = 0; i < n; i++) {
+      expected_sum += left[i];
+    }
+    if constexpr (std::is_same<T, int>::value) {
+      ASSERT_EQ(kernels.sum_epi32(left.data(), n), expected_sum) << "n=" << n;
+    } else {
+      ASSERT_NEAR(kernels.sum_ps(left.data(), n), expected_sum, 1e-3) << "n=" << n;
+    }
+
+    for (int constant = 0; constant < 4; constant++) {
+      const bool left_const  = (constant & 1) != 0;
+      const bool right_const = (constant & 2) != 0;
+      for (SimdCompare op : compares) {
+        std::vector<uint8_t> expected(n, 1);
+        std::vector<uint8_t> result(n, 1);
+        std::vector<int>     expected_sel(n);
+        std::vector<int>     result_sel(n);
+        int                  expected_count = 0;
+        int                  count          = 0;
+        if constexpr (std::is_same<T, int>::value) {
+          scalar.compare_epi32(op, left.data(), left_const, right.data(), right_const, n, expected.data());
+          kernels.compare_epi32(op, left.data(), left_const, right.data(), right_const, n, result.data());
+          expected_count = scalar.select_epi32(
+              op, left.data(), left_const, right.data(), right_const, nullptr, n, expected_sel.data());
+          count = kernels.select_epi32(op, left.data(), left_const, right.data(), right_const, nullptr, n, result_sel.data());
+        } else {
+          scalar.compare_ps(op, left.data(), left_const, right.data(), right_const, n, expected.data());
+          kernels.compare_ps(op, left.data(), left_const, right.data(), right_const, n, result.data());
+          expected_count = scalar.select_ps(
+              op, left.data(), left_const, right.data(), right_const, nullptr, n, expected_sel.data());
+          count = kernels.select_ps(op, left.data(), left_const, right.data(), right_const, nullptr, n, result_sel.data());
+        }
+        ASSERT_EQ(expected, result) << "op=" << static_cast<int>(op) << " n=" << n << " constant=" << constant;
+        expected_sel.resize(expected_count);
+        result_sel.resize(count);
+        ASSERT_EQ(expected_sel, result_sel) << "op=" << static_cast<int>(op) << " n=" << n << " constant=" << constant;
+      }
+
+      for (SimdArithmetic op : arithmetics) {
+        std::vector<T> expected(n);
+        std::vector<T> result(n);
+        if constexpr (std::is_same<T, int>::value) {
+          scalar.arithmetic_epi32(op, left.data(), left_const, right.data(), right_const, expected.data(), n);
+          kernels.arithmetic_epi32(op, left.data(), left_const, right.data(), right_const, result.data(), n);
+        } else {
+          scalar.arithmetic_ps(op, left.data(), left_const, right.data(), right_const, expected.data(), n);
+          kernels.arithmetic_ps(op, left.data(), left_const, right.data(), right_const, result.data(), n);
+        }
+        ASSERT_EQ(expected, result) << "op=" << static_cast<int>(op) << " n=" << n << " constant=" << constant;
+      }
+    }
+  }
+}
+
+// 每个 CPU 支持的 SIMD 级别的结果都与标量实现相同
+TEST(ArithmeticTest, simd_kernels)
+{
+  std::vector<int>   int_left, int_right;
+  std::vector<float> float_left, float_right;
+  for (int i = 0; i < 100; i++) {
+    int_left.push_back((i * 37) % 101 - 50);
+    int_right.push_back((i * 11) % 67 - 30 == 0 ? 1 : (i * 11) % 67 - 30);
+    float_left.push_back(((i * 37) % 101 - 50) / 4.0f);
+    float_right.push_back(((i * 11) % 67 - 29) / 8.0f + 0.0625f);
+  }
+
+  const SimdLevel max_level = detect_simd_level();
+  for (int level = 0; level <= static_cast<int>(max_level); level++) {
+    const SimdKernels &kernels = simd_kernels(static_cast<SimdLevel>(level));
+    ASSERT_EQ(kernels.level, static_cast<SimdLevel>(level));
+    SCOPED_TRACE(simd_level_name(kernels.level));
+    check_simd_kernels(kernels, int_left, int_right);
+    check_simd_kernels(kernels, float_left, float_right);
+  }
+
+  SimdLevel level;
+  ASSERT_TRUE(parse_simd_level("AVX2", level));
+  ASSERT_EQ(level, SimdLevel::AVX2);
+  ASSERT_FALSE(parse_simd_level("mmx", level));
+  ASSERT_LE(set_simd_level(SimdLevel::AVX512), max_level);
+  ASSERT_EQ(set_simd_level(SimdLevel::SCALAR), SimdLevel::SCALAR);
+  ASSERT_EQ(simd_level(), SimdLevel::SCALAR);
+  set_simd_level(max_level);
 }
 
 int main(int argc, char **argv)
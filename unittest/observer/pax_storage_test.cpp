@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 #include <sstream>
 #include <filesystem>
 #include <utility>
+#include <functional>
 
 #define protected public
 #define private public
@@ -95,7 +96,7 @@ TEST_P(PaxRecordFileScannerWithParam, test_file_iterator)
   Chunk     chunk;
   FieldMeta fm;
   fm.init("col1", AttrType::INTS, 0, 4, true, 0);
-  auto col1 = std::make_unique<Column>(fm, 2048);
+  auto col1 = std::make_unique<Column>(fm, Column::DEFAULT_CAPACITY);
   chunk.add_column(std::move(col1), 0);
   count = 0;
   while (OB_SUCC(rc = chunk_scanner.next_chunk(chunk))) {
@@ -351,6 +352,322 @@ TEST_P(PaxPageHandlerTestWithParam, PaxPageHandler)
   delete bpm;
 }
 
+TEST(PaxZoneMapTest, skip_pages)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "zone_map_test.bp";
+  const char *zone_map_file       = "zone_map_test.zonemap";
+  filesystem::remove(record_manager_file);
+  filesystem::remove(zone_map_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, record_manager_file, bp));
+
+  TableMeta table_meta;
+  table_meta.fields_.resize(2);
+  table_meta.fields_[0].attr_type_ = AttrType::INTS;
+  table_meta.fields_[0].attr_len_  = 4;
+  table_meta.fields_[0].field_id_  = 0;
+  table_meta.fields_[1].attr_type_ = AttrType::INTS;
+  table_meta.fields_[1].attr_len_  = 4;
+  table_meta.fields_[1].field_id_  = 1;
+
+  RecordFileHandler file_handler(StorageFormat::PAX_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, &table_meta, zone_map_file));
+
+  // 第一列是递增的，所以每个页面上第一列的取值范围互不重叠
+  const int record_num = 10000;
+  char      record_data[8];
+  for (int i = 0; i < record_num; i++) {
+    int col2 = i % 7;
+    memcpy(record_data, &i, sizeof(i));
+    memcpy(record_data + 4, &col2, sizeof(col2));
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, sizeof(record_data), &rid));
+  }
+
+  Table table;
+  table.table_meta_.storage_format_ = StorageFormat::PAX_FORMAT;
+
+  FieldMeta fm;
+  fm.init("col1", AttrType::INTS, 0, 4, true, 0);
+  Chunk chunk;
+  chunk.add_column(std::make_unique<Column>(fm, Column::DEFAULT_CAPACITY), 0);
+
+  auto scan = [&](vector<ZonePredicate> predicates, int &total, int &matched) {
+    ChunkFileScanner chunk_scanner;
+    ASSERT_EQ(RC::SUCCESS,
+        chunk_scanner.open_scan_chunk(
+            &table, *bp, log_handler, ReadWriteMode::READ_ONLY, &file_handler.zone_map()));
+    chunk_scanner.set_zone_predicates(std::move(predicates));
+    total   = 0;
+    matched = 0;
+    RC rc   = RC::SUCCESS;
+    while (OB_SUCC(rc = chunk_scanner.next_chunk(chunk))) {
+      total += chunk.rows();
+      for (int i = 0; i < chunk.rows(); i++) {
+        matched += chunk.get_value(0, i).get_int() >= 9000 ? 1 : 0;
+      }
+      chunk.reset_data();
+    }
+    ASSERT_EQ(rc, RC::RECORD_EOF);
+  };
+
+  int total = 0, matched = 0;
+  scan({}, total, matched);
+  ASSERT_EQ(total, record_num);
+  ASSERT_EQ(matched, 1000);
+
+  scan({ZonePredicate{0, GREAT_EQUAL, Value(9000)}}, total, matched);
+  ASSERT_LT(total, record_num);
+  ASSERT_EQ(matched, 1000);
+
+  scan({ZonePredicate{0, LESS_THAN, Value(0)}}, total, matched);
+  ASSERT_EQ(total, 0);
+
+  scan({ZonePredicate{1, EQUAL_TO, Value(7)}}, total, matched);
+  ASSERT_EQ(total, 0);
+
+  // 持久化后重新加载，结果应该一致
+  ASSERT_EQ(RC::SUCCESS, bp->flush_all_pages());
+  ASSERT_EQ(RC::SUCCESS, file_handler.zone_map().sync());
+  ASSERT_TRUE(filesystem::exists(zone_map_file));
+
+  ZoneMap zone_map;
+  zone_map.init(table_meta, zone_map_file);
+  ASSERT_EQ(RC::SUCCESS, zone_map.load());
+  vector<ZonePredicate> predicates{ZonePredicate{0, GREAT_EQUAL, Value(9000)}};
+  int                   loaded_matched_pages = 0, matched_pages = 0;
+  for (PageNum page_num = 1; page_num < 64; page_num++) {
+    matched_pages += file_handler.zone_map().may_match(page_num, predicates) ? 1 : 0;
+    loaded_matched_pages += zone_map.may_match(page_num, predicates) ? 1 : 0;
+  }
+  ASSERT_EQ(matched_pages, loaded_matched_pages);
+  ASSERT_LT(matched_pages, 63);
+
+  // 修改数据后，磁盘上的 zone map 就失效了
+  RID rid;
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, sizeof(record_data), &rid));
+  ASSERT_FALSE(filesystem::exists(zone_map_file));
+
+  file_handler.close();
+  bpm->close_file(record_manager_file);
+  delete bpm;
+  filesystem::remove(zone_map_file);
+}
+
+TEST(PaxMorselScanTest, parallel_scan)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "morsel_scan_test.bp";
+  filesystem::remove(record_manager_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, record_manager_file, bp));
+
+  TableMeta table_meta;
+  table_meta.fields_.resize(2);
+  table_meta.fields_[0].attr_type_ = AttrType::INTS;
+  table_meta.fields_[0].attr_len_  = 4;
+  table_meta.fields_[0].field_id_  = 0;
+  table_meta.fields_[1].attr_type_ = AttrType::INTS;
+  table_meta.fields_[1].attr_len_  = 4;
+  table_meta.fields_[1].field_id_  = 1;
+
+  RecordFileHandler file_handler(StorageFormat::PAX_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, &table_meta, nullptr));
+
+  const int record_num = 50000;
+  char      record_data[8];
+  for (int i = 0; i < record_num; i++) {
+    int col2 = i % 13;
+    memcpy(record_data, &i, sizeof(i));
+    memcpy(record_data + 4, &col2, sizeof(col2));
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, sizeof(record_data), &rid));
+  }
+
+  Table table;
+  table.table_meta_.storage_format_ = StorageFormat::PAX_FORMAT;
+
+  // 多个线程共享同一个 morsel 队列，每条记录应该恰好被扫描到一次
+  const int             thread_num = 4;
+  BufferPoolMorselQueue morsels(2);
+  vector<atomic<int>>   seen(record_num);
+  vector<int>           thread_rows(thread_num, 0);
+  vector<RC>            thread_rc(thread_num, RC::SUCCESS);
+  vector<thread>        threads;
+  for (int t = 0; t < thread_num; t++) {
+    threads.emplace_back([&, t]() {
+      FieldMeta fm;
+      fm.init("col1", AttrType::INTS, 0, 4, true, 0);
+      Chunk chunk;
+      chunk.add_column(std::make_unique<Column>(fm, Column::DEFAULT_CAPACITY), 0);
+
+      ChunkFileScanner chunk_scanner;
+      RC rc = chunk_scanner.open_scan_chunk(&table, *bp, log_handler, ReadWriteMode::READ_ONLY);
+      if (OB_FAIL(rc)) {
+        thread_rc[t] = rc;
+        return;
+      }
+      chunk_scanner.set_morsel_queue(&morsels);
+      while (OB_SUCC(rc = chunk_scanner.next_chunk(chunk))) {
+        for (int i = 0; i < chunk.rows(); i++) {
+          seen[chunk.get_value(0, i).get_int()]++;
+        }
+        thread_rows[t] += chunk.rows();
+        chunk.reset_data();
+      }
+      thread_rc[t] = rc;
+    });
+  }
+  for (thread &t : threads) {
+    t.join();
+  }
+
+  int total = 0;
+  for (int t = 0; t < thread_num; t++) {
+    ASSERT_EQ(thread_rc[t], RC::RECORD_EOF);
+    total += thread_rows[t];
+  }
+  ASSERT_EQ(total, record_num);
+  for (int i = 0; i < record_num; i++) {
+    ASSERT_EQ(seen[i].load(), 1);
+  }
+
+  file_handler.close();
+  bpm->close_file(record_manager_file);
+  delete bpm;
+}
+
+TEST(PaxEncodingTest, encoded_pages)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "pax_encoding_test.bp";
+  filesystem::remove(record_manager_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, record_manager_file, bp));
+
+  // 第一列递增(FRAME_OF_REFERENCE)，第二列取值很少(DICTIONARY)，第三列是很长的 run(RUN_LENGTH)
+  TableMeta table_meta;
+  table_meta.fields_.resize(3);
+  table_meta.fields_[0].attr_type_ = AttrType::INTS;
+  table_meta.fields_[0].attr_len_  = 4;
+  table_meta.fields_[0].field_id_  = 0;
+  table_meta.fields_[1].attr_type_ = AttrType::INTS;
+  table_meta.fields_[1].attr_len_  = 4;
+  table_meta.fields_[1].field_id_  = 1;
+  table_meta.fields_[2].attr_type_ = AttrType::CHARS;
+  table_meta.fields_[2].attr_len_  = 8;
+  table_meta.fields_[2].field_id_  = 2;
+
+  RecordFileHandler file_handler(StorageFormat::PAX_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, &table_meta));
+
+  auto make_record = [](int i, char *data) {
+    int col2 = i % 7;
+    memcpy(data, &i, sizeof(i));
+    memcpy(data + 4, &col2, sizeof(col2));
+    memset(data + 8, 0, 8);
+    memcpy(data + 8, i < 5000 ? "aaaa" : "bbbb", 4);
+  };
+
+  const int   record_num = 20000;
+  char        record_data[16];
+  vector<RID> rids;
+  for (int i = 0; i < record_num; i++) {
+    make_record(i, record_data);
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, sizeof(record_data), &rid));
+    rids.push_back(rid);
+  }
+
+  // 编码后一个页面可以存放远多于原始格式的记录
+  const int raw_capacity = (BP_PAGE_DATA_SIZE - sizeof(PageHeader)) / sizeof(record_data);
+  ASSERT_LT(rids.back().page_num, record_num / raw_capacity / 2);
+
+  Record record;
+  for (int i = 0; i < record_num; i += 97) {
+    make_record(i, record_data);
+    ASSERT_EQ(RC::SUCCESS, file_handler.get_record(rids[i], record));
+    ASSERT_EQ(0, memcmp(record.data(), record_data, sizeof(record_data)));
+  }
+
+  for (int i = 0; i < record_num; i += 10) {
+    ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[i]));
+  }
+
+  Table table;
+  table.table_meta_.storage_format_ = StorageFormat::PAX_FORMAT;
+
+  FieldMeta fm0, fm1, fm2;
+  fm0.init("col0", AttrType::INTS, 0, 4, true, 0);
+  fm1.init("col1", AttrType::INTS, 4, 4, true, 1);
+  fm2.init("col2", AttrType::CHARS, 8, 8, true, 2);
+  Chunk chunk;
+  chunk.add_column(std::make_unique<Column>(fm0, Column::DEFAULT_CAPACITY), 0);
+  chunk.add_column(std::make_unique<Column>(fm1, Column::DEFAULT_CAPACITY), 1);
+  chunk.add_column(std::make_unique<Column>(fm2, Column::DEFAULT_CAPACITY), 2);
+
+  // 过滤条件直接在编码数据上计算，返回的数据必须完全满足条件
+  auto scan = [&](vector<ZonePredicate> predicates, function<bool(int)> expected) {
+    ChunkFileScanner chunk_scanner;
+    ASSERT_EQ(RC::SUCCESS, chunk_scanner.open_scan_chunk(&table, *bp, log_handler, ReadWriteMode::READ_ONLY));
+    chunk_scanner.set_zone_predicates(std::move(predicates));
+    int expected_count = 0;
+    for (int i = 0; i < record_num; i++) {
+      expected_count += (i % 10 != 0 && expected(i)) ? 1 : 0;
+    }
+    int count = 0;
+    RC  rc    = RC::SUCCESS;
+    while (OB_SUCC(rc = chunk_scanner.next_chunk(chunk))) {
+      for (int i = 0; i < chunk.rows(); i++) {
+        int value = chunk.get_value(0, i).get_int();
+        ASSERT_NE(value % 10, 0);
+        ASSERT_TRUE(expected(value));
+        ASSERT_EQ(chunk.get_value(1, i).get_int(), value % 7);
+        ASSERT_EQ(chunk.get_value(2, i).get_string(), value < 5000 ? "aaaa" : "bbbb");
+      }
+      count += chunk.rows();
+      chunk.reset_data();
+    }
+    ASSERT_EQ(rc, RC::RECORD_EOF);
+    ASSERT_EQ(count, expected_count);
+  };
+
+  scan({}, [](int) { return true; });
+  scan({ZonePredicate{0, GREAT_EQUAL, Value(12345)}}, [](int i) { return i >= 12345; });
+  scan({ZonePredicate{0, LESS_THAN, Value(-1)}}, [](int) { return false; });
+  scan({ZonePredicate{1, EQUAL_TO, Value(3)}}, [](int i) { return i % 7 == 3; });
+  scan({ZonePredicate{1, NOT_EQUAL, Value(3)}, ZonePredicate{2, EQUAL_TO, Value("bbbb", 4)}},
+      [](int i) { return i % 7 != 3 && i >= 5000; });
+
+  // 不能被编码表示的值不会追加到编码后的页面上，但仍然可以正确写入和读取
+  int big = 1 << 30;
+  make_record(big, record_data);
+  RID rid;
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, sizeof(record_data), &rid));
+  ASSERT_EQ(RC::SUCCESS, file_handler.get_record(rid, record));
+  ASSERT_EQ(0, memcmp(record.data(), record_data, sizeof(record_data)));
+
+  file_handler.close();
+  bpm->close_file(record_manager_file);
+  delete bpm;
+}
+
 INSTANTIATE_TEST_SUITE_P(
     PaxFileScannerTests, PaxRecordFileScannerWithParam, testing::Values(1, 10, 100, 1000, 2000, 10000));
 
@@ -0,0 +1,270 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "common/lang/algorithm.h"
+#include "common/lang/functional.h"
+#include "common/lang/vector.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/gather_vec_physical_operator.h"
+#include "sql/operator/group_by_vec_physical_operator.h"
+#include "sql/operator/hash_join_vec_physical_operator.h"
+#include "sql/operator/pipeline_vec_physical_operator.h"
+#include "sql/operator/predicate_vec_physical_operator.h"
+#include "storage/field/field_meta.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+
+/**
+ * @brief 按照 Chunk 依次输出 [begin, end) 中的行，第 i 行的两列分别是 first[i] 和 second[i]
+ */
+class ChunkSourceOperator : public PhysicalOperator
+{
+public:
+  ChunkSourceOperator(const vector<int> &first, const vector<int> &second, int begin, int end, int chunk_size)
+      : first_(first), second_(second), begin_(begin), end_(end), chunk_size_(chunk_size)
+  {}
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::TABLE_SCAN_VEC; }
+
+  RC open(Trx *trx) override
+  {
+    opened_  = true;
+    current_ = begin_;
+    return RC::SUCCESS;
+  }
+
+  RC next(Chunk &chunk) override
+  {
+    EXPECT_TRUE(opened_);
+    if (current_ >= end_) {
+      return RC::RECORD_EOF;
+    }
+
+    chunk_.reset();
+    chunk_.add_column(make_unique<Column>(AttrType::INTS, sizeof(int), chunk_size_), 0);
+    chunk_.add_column(make_unique<Column>(AttrType::INTS, sizeof(int), chunk_size_), 1);
+    const int rows = min(chunk_size_, end_ - current_);
+    chunk_.column(0).append((char *)(first_.data() + current_), rows);
+    chunk_.column(1).append((char *)(second_.data() + current_), rows);
+    current_ += rows;
+    return chunk.reference(chunk_);
+  }
+
+  RC close() override
+  {
+    EXPECT_TRUE(opened_);
+    opened_ = false;
+    return RC::SUCCESS;
+  }
+
+private:
+  const vector<int> &first_;
+  const vector<int> &second_;
+  int                begin_;
+  int                end_;
+  int                chunk_size_;
+  int                current_ = 0;
+  bool               opened_  = false;
+  Chunk              chunk_;
+};
+
+class PipelineTest : public testing::Test
+{
+protected:
+  PipelineTest()
+      : first_meta_("a", AttrType::INTS, 0, sizeof(int), true, 0),
+        second_meta_("b", AttrType::INTS, sizeof(int), sizeof(int), true, 1),
+        third_meta_("c", AttrType::INTS, 0, sizeof(int), true, 2),
+        fourth_meta_("d", AttrType::INTS, 0, sizeof(int), true, 3)
+  {}
+
+  /// 引用 Chunk 中第 index 列的字段表达式
+  unique_ptr<Expression> field(int index)
+  {
+    const FieldMeta *metas[] = {&first_meta_, &second_meta_, &third_meta_, &fourth_meta_};
+    return make_unique<FieldExpr>(nullptr, metas[index]);
+  }
+
+  /**
+   * @brief [0, rows) 分成 parts 个算子，parts > 1 时放在 gather 下面
+   */
+  unique_ptr<PhysicalOperator> source(const vector<int> &first, const vector<int> &second, int parts)
+  {
+    const int rows = static_cast<int>(first.size());
+    if (parts == 1) {
+      return make_unique<ChunkSourceOperator>(first, second, 0, rows, CHUNK_SIZE);
+    }
+
+    auto gather = make_unique<GatherVecPhysicalOperator>();
+    for (int i = 0; i < parts; i++) {
+      gather->add_child(
+          make_unique<ChunkSourceOperator>(first, second, rows * i / parts, rows * (i + 1) / parts, CHUNK_SIZE));
+    }
+    return gather;
+  }
+
+  /**
+   * @brief select b, sum(a), count(a) from source where a > 10 group by b
+   */
+  unique_ptr<PhysicalOperator> group_by(unique_ptr<PhysicalOperator> child, int group_index, int value_index)
+  {
+    auto predicate = make_unique<PredicateVecPhysicalOperator>(make_unique<ComparisonExpr>(
+        CompOp::GREAT_THAN, field(value_index), make_unique<ValueExpr>(Value(10))));
+    predicate->add_child(std::move(child));
+
+    aggregates_.push_back(make_unique<AggregateExpr>(AggregateExpr::Type::SUM, field(value_index)));
+    Expression *sum = aggregates_.back().get();
+    aggregates_.push_back(make_unique<AggregateExpr>(AggregateExpr::Type::COUNT, field(value_index)));
+    Expression *count = aggregates_.back().get();
+
+    vector<unique_ptr<Expression>> group_by_exprs;
+    group_by_exprs.push_back(field(group_index));
+    auto oper = make_unique<GroupByVecPhysicalOperator>(std::move(group_by_exprs), vector<Expression *>{sum, count});
+    oper->add_child(std::move(predicate));
+    return oper;
+  }
+
+  /**
+   * @brief 左表的 a 与右表的 a 做等值连接，输出左表的 a、b 和右表的 a、b
+   */
+  unique_ptr<HashJoinVecPhysicalOperator> hash_join(
+      unique_ptr<PhysicalOperator> left, unique_ptr<PhysicalOperator> right)
+  {
+    vector<unique_ptr<Expression>> left_keys;
+    vector<unique_ptr<Expression>> right_keys;
+    left_keys.push_back(field(0));
+    right_keys.push_back(field(0));
+    auto oper = make_unique<HashJoinVecPhysicalOperator>(std::move(left_keys), std::move(right_keys));
+    oper->add_child(std::move(left));
+    oper->add_child(std::move(right));
+    return oper;
+  }
+
+  static vector<vector<int>> collect(PhysicalOperator &oper)
+  {
+    vector<vector<int>> rows;
+    EXPECT_EQ(RC::SUCCESS, oper.open(nullptr));
+    Chunk chunk;
+    RC    rc = RC::SUCCESS;
+    while (OB_SUCC(rc = oper.next(chunk))) {
+      for (int i = 0; i < chunk.selected_rows(); i++) {
+        vector<int> row;
+        for (int col = 0; col < chunk.column_num(); col++) {
+          row.push_back(chunk.column(col).get_value(chunk.selected_row(i)).get_int());
+        }
+        rows.push_back(std::move(row));
+      }
+    }
+    EXPECT_EQ(RC::RECORD_EOF, rc);
+    EXPECT_EQ(RC::SUCCESS, oper.close());
+    sort(rows.begin(), rows.end());
+    return rows;
+  }
+
+  /**
+   * @brief 分别用 pull 模式和 pipeline 执行同一个执行计划，结果应该相同
+   */
+  vector<vector<int>> check_pipeline(const function<unique_ptr<PhysicalOperator>()> &plan)
+  {
+    unique_ptr<PhysicalOperator> pull_plan = plan();
+    vector<vector<int>>          expected  = collect(*pull_plan);
+
+    PipelineVecPhysicalOperator pipeline;
+    pipeline.add_child(plan());
+    vector<vector<int>> result = collect(pipeline);
+    EXPECT_EQ(expected, result);
+    return result;
+  }
+
+protected:
+  static constexpr int CHUNK_SIZE = 100;
+
+  FieldMeta                         first_meta_;
+  FieldMeta                         second_meta_;
+  FieldMeta                         third_meta_;
+  FieldMeta                         fourth_meta_;
+  vector<unique_ptr<AggregateExpr>> aggregates_;
+};
+
+TEST_F(PipelineTest, group_by)
+{
+  vector<int> first;
+  vector<int> second;
+  for (int i = 0; i < 5000; i++) {
+    first.push_back(i % 97);
+    second.push_back(i % 13);
+  }
+
+  for (int parts : {1, 4}) {
+    vector<vector<int>> result = check_pipeline([&]() { return group_by(source(first, second, parts), 1, 0); });
+    ASSERT_EQ(13, static_cast<int>(result.size()));
+  }
+}
+
+TEST_F(PipelineTest, hash_join)
+{
+  // 右表每个连接键有两行，左表一个 Chunk 的结果超过一个输出 Chunk 的容量
+  vector<int> left_first;
+  vector<int> left_second;
+  for (int i = 0; i < 3000; i++) {
+    left_first.push_back(i % 50);
+    left_second.push_back(i);
+  }
+  vector<int> right_first;
+  vector<int> right_second;
+  for (int i = 0; i < 200; i++) {
+    right_first.push_back(i % 100);
+    right_second.push_back(-i);
+  }
+
+  for (int64_t memory_limit : {HashJoinVecPhysicalOperator::DEFAULT_MEMORY_LIMIT, int64_t(1)}) {
+    for (int parts : {1, 3}) {
+      vector<vector<int>> result = check_pipeline([&]() -> unique_ptr<PhysicalOperator> {
+        auto join = hash_join(source(left_first, left_second, parts), source(right_first, right_second, parts));
+        join->set_memory_limit(memory_limit);
+        return join;
+      });
+      ASSERT_EQ(6000, static_cast<int>(result.size())) << "memory_limit=" << memory_limit << ", parts=" << parts;
+
+      // 连接的结果再分组聚合，hash join 在 group by 的 pipeline 中间
+      result = check_pipeline([&]() -> unique_ptr<PhysicalOperator> {
+        auto join = hash_join(source(left_first, left_second, parts), source(right_first, right_second, parts));
+        join->set_memory_limit(memory_limit);
+        return group_by(std::move(join), 3, 1);
+      });
+      ASSERT_EQ(100, static_cast<int>(result.size())) << "memory_limit=" << memory_limit << ", parts=" << parts;
+    }
+  }
+}
+
+TEST_F(PipelineTest, build_pipelines)
+{
+  vector<int> first(10, 1);
+  vector<int> second(10, 2);
+
+  PipelineVecPhysicalOperator pipeline;
+  pipeline.add_child(group_by(hash_join(source(first, second, 2), source(first, second, 1)), 1, 0));
+  ASSERT_EQ(RC::SUCCESS, pipeline.build_pipelines());
+
+  // build 端的 pipeline 最先执行，group by 前面的 gather 拆成了两个任务
+  const vector<unique_ptr<Pipeline>> &pipelines = pipeline.pipelines();
+  ASSERT_EQ(2, static_cast<int>(pipelines.size()));
+  EXPECT_EQ("TABLE_SCAN_VEC -> HASH_JOIN_VEC", pipelines[0]->to_string());
+  EXPECT_EQ("TABLE_SCAN_VEC(x2) -> HASH_JOIN_VEC -> PREDICATE_VEC -> GROUP_BY_VEC", pipelines[1]->to_string());
+  EXPECT_EQ(2, pipelines[1]->task_num());
+  EXPECT_EQ("GROUP_BY_VEC", pipeline.root_pipeline()->to_string());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
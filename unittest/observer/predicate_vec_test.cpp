@@ -0,0 +1,211 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "common/lang/limits.h"
+#include "common/lang/vector.h"
+#include "sql/expr/arithmetic_operator.hpp"
+#include "sql/expr/expression.h"
+#include "storage/common/chunk.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+
+static const CompOp ALL_OPS[] = {EQUAL_TO, LESS_EQUAL, NOT_EQUAL, LESS_THAN, GREAT_EQUAL, GREAT_THAN};
+
+template <typename T>
+static bool compare(T left, T right, CompOp op)
+{
+  switch (op) {
+    case EQUAL_TO: return left == right;
+    case LESS_EQUAL: return left <= right;
+    case NOT_EQUAL: return left != right;
+    case LESS_THAN: return left < right;
+    case GREAT_EQUAL: return left >= right;
+    case GREAT_THAN: return left > right;
+    default: return false;
+  }
+}
+
+/**
+ * @brief 用逐行比较的结果检查 compare_select，包括连续的行、稀疏的选择向量、常量，以及不足一个向量宽度的尾部
+ */
+template <typename T>
+static void check_compare_select_once(const vector<T> &left, const vector<T> &right)
+{
+  const int   size = static_cast<int>(left.size());
+  vector<int> sparse;
+  for (int i = 0; i < size; i += 3) {
+    sparse.push_back(i);
+  }
+
+  for (CompOp op : ALL_OPS) {
+    vector<int> expected;
+    vector<int> result(size);
+    for (int i = 0; i < size; i++) {
+      if (compare(left[i], right[i], op)) {
+        expected.push_back(i);
+      }
+    }
+    int count = compare_select<T, false, false>(left.data(), right.data(), nullptr, size, result.data(), op);
+    result.resize(count);
+    ASSERT_EQ(expected, result) << "op=" << op;
+
+    expected.clear();
+    result = sparse;
+    for (int row : sparse) {
+      if (compare(left[row], right[row], op)) {
+        expected.push_back(row);
+      }
+    }
+    // 输入和输出使用同一个数组
+    count = compare_select<T, false, false>(
+        left.data(), right.data(), result.data(), static_cast<int>(sparse.size()), result.data(), op);
+    result.resize(count);
+    ASSERT_EQ(expected, result) << "op=" << op;
+
+    expected.clear();
+    result.resize(size);
+    for (int i = 0; i < size; i++) {
+      if (compare(left[i], right[0], op)) {
+        expected.push_back(i);
+      }
+    }
+    count = compare_select<T, false, true>(left.data(), right.data(), nullptr, size, result.data(), op);
+    result.resize(count);
+    ASSERT_EQ(expected, result) << "op=" << op;
+
+    expected.clear();
+    result = sparse;
+    for (int row : sparse) {
+      if (compare(left[0], right[row], op)) {
+        expected.push_back(row);
+      }
+    }
+    count = compare_select<T, true, false>(
+        left.data(), right.data(), result.data(), static_cast<int>(sparse.size()), result.data(), op);
+    result.resize(count);
+    ASSERT_EQ(expected, result) << "op=" << op;
+  }
+}
+
+/// 每个 CPU 支持的 SIMD 级别都检查一遍
+template <typename T>
+static void check_compare_select(const vector<T> &left, const vector<T> &right)
+{
+  const SimdLevel max_level = detect_simd_level();
+  for (int level = 0; level <= static_cast<int>(max_level); level++) {
+    set_simd_level(static_cast<SimdLevel>(level));
+    SCOPED_TRACE(simd_level_name(simd_level()));
+    check_compare_select_once(left, right);
+  }
+  set_simd_level(max_level);
+}
+
+TEST(PredicateVecTest, compare_select_int)
+{
+  vector<int> left;
+  vector<int> right;
+  for (int i = 0; i < 1027; i++) {
+    left.push_back((i * 37) % 101 - 50);
+    right.push_back((i * 11) % 67 - 30);
+  }
+  check_compare_select(left, right);
+}
+
+TEST(PredicateVecTest, compare_select_float)
+{
+  vector<float> left;
+  vector<float> right;
+  for (int i = 0; i < 1021; i++) {
+    left.push_back(((i * 37) % 101 - 50) / 4.0f);
+    right.push_back(((i * 11) % 67 - 30) / 4.0f);
+  }
+  // NaN 与任何值都不相等
+  left[13]  = numeric_limits<float>::quiet_NaN();
+  right[26] = numeric_limits<float>::quiet_NaN();
+  check_compare_select(left, right);
+}
+
+class PredicateVecChunkTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    ids_.init("id", AttrType::INTS, 0, sizeof(int), true, 0);
+    names_.init("name", AttrType::CHARS, sizeof(int), 4, true, 1);
+
+    auto id_column   = make_unique<Column>(AttrType::INTS, sizeof(int));
+    auto name_column = make_unique<Column>(AttrType::CHARS, 4);
+    for (int i = 0; i < ROWS; i++) {
+      char name[4] = {0};
+      snprintf(name, sizeof(name), "n%d", i % 10);
+      id_column->append_one(reinterpret_cast<char *>(&i));
+      name_column->append_one(name);
+    }
+    chunk_.add_column(std::move(id_column), 0);
+    chunk_.add_column(std::move(name_column), 1);
+
+    selection_.resize(ROWS);
+    for (int i = 0; i < ROWS; i++) {
+      selection_[i] = i;
+    }
+  }
+
+  unique_ptr<Expression> id_compare(CompOp op, int value)
+  {
+    return make_unique<ComparisonExpr>(op, make_unique<FieldExpr>(nullptr, &ids_), make_unique<ValueExpr>(Value(value)));
+  }
+
+protected:
+  static constexpr int ROWS = 100;
+
+  FieldMeta   ids_;
+  FieldMeta   names_;
+  Chunk       chunk_;
+  vector<int> selection_;
+};
+
+TEST_F(PredicateVecChunkTest, conjunction)
+{
+  vector<unique_ptr<Expression>> children;
+  children.push_back(id_compare(GREAT_EQUAL, 10));
+  children.push_back(id_compare(LESS_THAN, 20));
+  ConjunctionExpr and_expr(ConjunctionExpr::Type::AND, children);
+  ASSERT_EQ(RC::SUCCESS, and_expr.filter(chunk_, selection_));
+  ASSERT_EQ(10, static_cast<int>(selection_.size()));
+  for (int i = 0; i < 10; i++) {
+    ASSERT_EQ(10 + i, selection_[i]);
+  }
+
+  // 在已经过滤过的行上继续计算
+  children.clear();
+  children.push_back(id_compare(LESS_THAN, 12));
+  children.push_back(id_compare(EQUAL_TO, 15));
+  children.push_back(id_compare(GREAT_THAN, 17));
+  ConjunctionExpr or_expr(ConjunctionExpr::Type::OR, children);
+  ASSERT_EQ(RC::SUCCESS, or_expr.filter(chunk_, selection_));
+  ASSERT_EQ((vector<int>{10, 11, 15, 18, 19}), selection_);
+}
+
+TEST_F(PredicateVecChunkTest, chars)
+{
+  ComparisonExpr expr(EQUAL_TO, make_unique<FieldExpr>(nullptr, &names_), make_unique<ValueExpr>(Value("n3")));
+  ASSERT_EQ(RC::SUCCESS, expr.filter(chunk_, selection_));
+  ASSERT_EQ(ROWS / 10, static_cast<int>(selection_.size()));
+  for (int row : selection_) {
+    ASSERT_EQ(3, row % 10);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
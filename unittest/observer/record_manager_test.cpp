@@ -363,6 +363,121 @@ TEST(RecordManager, durability)
   bpm2.close_file(record_manager_file.c_str());
 }
 
+TEST(RecordManager, batch_insert_durability)
+{
+  /*
+   * 测试场景：
+   * 1. 逐条插入一些记录，再删除一部分，让前面的页面留下空闲位置
+   * 2. 批量插入多批记录，一批数据会跨越多个页面
+   * 3. 重启数据库，检查记录是否恢复
+   */
+  filesystem::path directory("record_manager_batch_insert_durability");
+  filesystem::remove_all(directory);
+  ASSERT_TRUE(filesystem::create_directories(directory));
+
+  filesystem::path record_manager_file = directory / "record_manager.bp";
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(bpm.init(make_unique<VacuousDoubleWriteBuffer>()), RC::SUCCESS);
+
+  DiskLogHandler        log_handler;
+  IntegratedLogReplayer log_replayer(bpm);
+  ASSERT_EQ(log_handler.init(directory.c_str()), RC::SUCCESS);
+  ASSERT_EQ(log_handler.replay(log_replayer, 0), RC::SUCCESS);
+  ASSERT_EQ(log_handler.start(), RC::SUCCESS);
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(bpm.create_file(record_manager_file.c_str()), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(log_handler, record_manager_file.c_str(), buffer_pool), RC::SUCCESS);
+  ASSERT_NE(buffer_pool, nullptr);
+
+  RecordFileHandler record_file_handler(StorageFormat::ROW_FORMAT);
+  ASSERT_EQ(record_file_handler.init(*buffer_pool, log_handler, nullptr), RC::SUCCESS);
+
+  const int record_size = 100;
+  char      record_data[record_size];
+  memset(record_data, 0, sizeof(record_data));
+
+  unordered_map<RID, string, RIDHash> record_map;
+  vector<RID>                         single_rids;
+  for (int i = 0; i < 200; i++) {
+    snprintf(record_data, sizeof(record_data), "single %d", i);
+    RID rid;
+    ASSERT_EQ(record_file_handler.insert_record(record_data, record_size, &rid), RC::SUCCESS);
+    single_rids.push_back(rid);
+    record_map.emplace(rid, string(record_data, record_size));
+  }
+  for (size_t i = 0; i < single_rids.size(); i += 3) {
+    ASSERT_EQ(record_file_handler.delete_record(&single_rids[i]), RC::SUCCESS);
+    record_map.erase(single_rids[i]);
+  }
+
+  const int batch_num  = 5;
+  const int batch_size = 300;
+  for (int batch = 0; batch < batch_num; batch++) {
+    vector<Record> records(batch_size);
+    for (int i = 0; i < batch_size; i++) {
+      snprintf(record_data, sizeof(record_data), "batch %d record %d", batch, i);
+      ASSERT_EQ(records[i].copy_data(record_data, record_size), RC::SUCCESS);
+    }
+    ASSERT_EQ(record_file_handler.insert_records(records), RC::SUCCESS);
+    for (const Record &record : records) {
+      ASSERT_TRUE(record_map.emplace(record.rid(), string(record.data(), record_size)).second);
+    }
+  }
+
+  for (const auto &[rid, record] : record_map) {
+    Record record_data;
+    ASSERT_EQ(record_file_handler.get_record(rid, record_data), RC::SUCCESS);
+    ASSERT_EQ(memcmp(record_data.data(), record.c_str(), record.size()), 0);
+  }
+
+  // 把文件复制出来，只靠日志恢复批量插入的数据
+  filesystem::path record_manager_file_copy = directory / "record_manager_copy.bp";
+  filesystem::copy_file(record_manager_file, record_manager_file_copy);
+  bpm.close_file(record_manager_file.c_str());
+  filesystem::remove(record_manager_file);
+  ASSERT_EQ(log_handler.stop(), RC::SUCCESS);
+  ASSERT_EQ(log_handler.await_termination(), RC::SUCCESS);
+
+  DiskLogHandler    log_handler2;
+  BufferPoolManager bpm2;
+  ASSERT_EQ(RC::SUCCESS, bpm2.init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *buffer_pool2 = nullptr;
+  filesystem::copy(record_manager_file_copy, record_manager_file);
+  ASSERT_EQ(bpm2.open_file(log_handler2, record_manager_file.c_str(), buffer_pool2), RC::SUCCESS);
+  ASSERT_NE(buffer_pool2, nullptr);
+
+  IntegratedLogReplayer log_replayer2(bpm2);
+  ASSERT_EQ(log_handler2.init(directory.c_str()), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.replay(log_replayer2, 0), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.start(), RC::SUCCESS);
+
+  RecordFileHandler record_file_handler2(StorageFormat::ROW_FORMAT);
+  ASSERT_EQ(record_file_handler2.init(*buffer_pool2, log_handler2, nullptr), RC::SUCCESS);
+  for (const auto &[rid, record] : record_map) {
+    Record record_data;
+    ASSERT_EQ(record_file_handler2.get_record(rid, record_data), RC::SUCCESS);
+    ASSERT_EQ(memcmp(record_data.data(), record.c_str(), record.size()), 0);
+  }
+
+  VacuousTrx        trx;
+  int               count = 0;
+  Record            record;
+  HeapRecordScanner scanner(
+      nullptr /*table*/, *buffer_pool2, &trx, log_handler2, ReadWriteMode::READ_ONLY, nullptr /*condition_filter*/);
+  ASSERT_EQ(scanner.open_scan(), RC::SUCCESS);
+  while (OB_SUCC(scanner.next(record))) {
+    count++;
+  }
+  scanner.close_scan();
+  ASSERT_EQ(count, static_cast<int>(record_map.size()));
+
+  ASSERT_EQ(log_handler2.stop(), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.await_termination(), RC::SUCCESS);
+  bpm2.close_file(record_manager_file.c_str());
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,86 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/sort_key.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+
+static string key_of(const Value &value, bool ascending = true)
+{
+  string key;
+  EXPECT_EQ(SortKey::append(value, ascending, key), RC::SUCCESS);
+  return key;
+}
+
+/**
+ * @brief values 已经按照升序排列，编码后的键也应该是升序，降序编码后应该是降序
+ */
+static void check_order(const vector<Value> &values)
+{
+  for (size_t i = 1; i < values.size(); i++) {
+    const string prev = values[i - 1].to_string();
+    const string curr = values[i].to_string();
+    EXPECT_LT(key_of(values[i - 1]), key_of(values[i])) << prev << " vs " << curr;
+    EXPECT_GT(key_of(values[i - 1], false), key_of(values[i], false)) << prev << " vs " << curr;
+  }
+}
+
+TEST(SortKeyTest, ints)
+{
+  check_order({Value(INT32_MIN), Value(-1000), Value(-1), Value(0), Value(1), Value(255), Value(256), Value(INT32_MAX)});
+}
+
+TEST(SortKeyTest, floats)
+{
+  check_order({Value(-1e30f), Value(-2.5f), Value(-0.5f), Value(0.0f), Value(1e-20f), Value(0.5f), Value(2.5f), Value(1e30f)});
+  EXPECT_EQ(key_of(Value(-0.0f)), key_of(Value(0.0f)));
+}
+
+TEST(SortKeyTest, dates)
+{
+  vector<Value> values;
+  for (const Date &date : {Date(1970, 1, 1), Date(1999, 12, 31), Date(2000, 1, 1), Date(2000, 2, 29), Date(2038, 1, 19)}) {
+    Value value;
+    value.set_date(date);
+    values.push_back(value);
+  }
+  check_order(values);
+}
+
+TEST(SortKeyTest, chars)
+{
+  check_order({Value(""), Value("a"), Value("ab"), Value("abc"), Value("b"), Value("\x80")});
+  // 定长的字符串后面可能有 '\0' 填充
+  Value padded;
+  padded.set_string("ab\0\0", 4);
+  EXPECT_EQ(key_of(padded), key_of(Value("ab")));
+}
+
+TEST(SortKeyTest, multi_columns)
+{
+  // (1, "b") < (1, "ba") < (2, "a")，第一列降序时 (2, "a") 排在最前面
+  auto make_key = [](int id, const char *name, bool id_ascending) {
+    string key;
+    EXPECT_EQ(SortKey::append(Value(id), id_ascending, key), RC::SUCCESS);
+    EXPECT_EQ(SortKey::append(Value(name), true, key), RC::SUCCESS);
+    return key;
+  };
+  EXPECT_LT(make_key(1, "b", true), make_key(1, "ba", true));
+  EXPECT_LT(make_key(1, "ba", true), make_key(2, "a", true));
+  EXPECT_LT(make_key(2, "a", false), make_key(1, "b", false));
+  EXPECT_LT(make_key(1, "b", false), make_key(1, "ba", false));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
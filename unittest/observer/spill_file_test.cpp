@@ -0,0 +1,84 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string>
+
+#include "storage/common/spill_file.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+
+TEST(SpillFileTest, records)
+{
+  SpillFile file;
+  ASSERT_EQ(file.open(), RC::SUCCESS);
+
+  // 记录比缓存大，需要跨越多次读写
+  const int record_num = 1000;
+  for (int i = 0; i < record_num; i++) {
+    string record(i * 131, static_cast<char>('a' + i % 26));
+    ASSERT_EQ(file.write(record.data(), static_cast<int>(record.size())), RC::SUCCESS);
+  }
+  ASSERT_EQ(file.records(), record_num);
+
+  // 可以多次从头读取
+  for (int round = 0; round < 2; round++) {
+    ASSERT_EQ(file.rewind(), RC::SUCCESS);
+    vector<char> record;
+    for (int i = 0; i < record_num; i++) {
+      ASSERT_EQ(file.read(record), RC::SUCCESS);
+      ASSERT_EQ(static_cast<int>(record.size()), i * 131);
+      ASSERT_EQ(string(record.data(), record.size()), string(i * 131, static_cast<char>('a' + i % 26)));
+    }
+    ASSERT_EQ(file.read(record), RC::RECORD_EOF);
+  }
+}
+
+TEST(SpillFileTest, values)
+{
+  SpillFile file;
+  ASSERT_EQ(file.open(), RC::SUCCESS);
+
+  vector<Value> values = {Value(1), Value(2.5f), Value("hello"), Value(""), Value(true)};
+  ASSERT_EQ(file.write_values(values), RC::SUCCESS);
+  ASSERT_EQ(file.rewind(), RC::SUCCESS);
+
+  vector<Value> result;
+  ASSERT_EQ(file.read_values(result), RC::SUCCESS);
+  ASSERT_EQ(result.size(), values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    ASSERT_EQ(result[i].attr_type(), values[i].attr_type());
+    ASSERT_EQ(result[i].to_string(), values[i].to_string());
+  }
+  ASSERT_EQ(file.read_values(result), RC::RECORD_EOF);
+}
+
+TEST(SpillFileTest, partitions)
+{
+  // 每一层使用哈希值中不同的位
+  SpillPartitions level0(0);
+  SpillPartitions level1(1);
+  const uint64_t  hash = 0xAB00000000000000ULL;
+  ASSERT_EQ(level0.partition_of(hash), 0xA);
+  ASSERT_EQ(level1.partition_of(hash), 0xB);
+
+  ASSERT_EQ(level0.release(3), nullptr);
+  SpillFile *file = nullptr;
+  ASSERT_EQ(level0.file(3, file), RC::SUCCESS);
+  ASSERT_NE(file, nullptr);
+  ASSERT_EQ(level0.release(3).get(), file);
+  ASSERT_EQ(level0.release(3), nullptr);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}